@@ -12,22 +12,28 @@
 #include <list>
 #include <vector>
 #include <set>
+#include <unordered_map>
 
 #include "pugixml.h"
 #include "variation_unit.h"
+#include "reading_matrix.h"
 
 using namespace std;
 
 class apparatus {
 private:
 	list<string> list_wit;
+	unordered_map<string, unsigned int> wit_inds;
 	vector<variation_unit> variation_units;
+	reading_matrix matrix;
 public:
 	apparatus();
 	apparatus(const pugi::xml_node & xml, bool drop_ambiguous, bool merge_splits, const set<string> & trivial_reading_types);
 	virtual ~apparatus();
 	list<string> get_list_wit() const;
-	vector<variation_unit> get_variation_units() const;
+	int get_witness_index(const string & wit_id) const;
+	const vector<variation_unit> & get_variation_units() const;
+	const reading_matrix & get_reading_matrix() const;
 	int get_extant_passages_for_witness(const string & wit_id) const;
 };
 
@@ -0,0 +1,112 @@
+/*
+ * cache_reader.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: jjmccollum
+ */
+
+#ifndef CACHE_READER_H
+#define CACHE_READER_H
+
+#include <string>
+#include <list>
+#include <vector>
+#include <set>
+#include <unordered_map>
+#include <memory>
+#include <cstddef>
+
+#include "sqlite3.h"
+#include "roaring.hh"
+#include "local_stemma.h"
+#include "variation_unit.h"
+#include "witness.h"
+#include "set_cover_solver.h"
+#include "global_stemma.h"
+#include "textual_flow.h"
+
+using namespace std;
+
+//Default limit on the estimated size of the genealogical comparisons a cache_reader keeps decoded (256 MiB):
+const size_t DEFAULT_MAX_CACHED_BYTES = size_t(256) << 20;
+
+//Define data structure for a witness's decoded genealogical comparisons in the cache of a cache_reader:
+struct cached_genealogical_comparisons {
+	unordered_map<string, genealogical_comparison> comps; //genealogical comparisons of all witnesses relative to this witness, keyed by their IDs
+	size_t n_bytes; //estimated size of the comparisons in memory
+	list<unsigned int>::iterator lru_it; //position of this witness in the recency list
+};
+
+/**
+ * Reads the contents of a genealogical cache database written by populate_db.
+ * The witness and variation unit IDs are read once when the reader is constructed,
+ * the statements for repeated lookups are prepared once and reused,
+ * and the genealogical comparisons relative to each witness are kept decoded in a least-recently-used cache,
+ * so repeated lookups do not go back to the database.
+ * Each distinct bitmap of the comparisons is decoded once and shared by every comparison that holds it.
+ * If the database has a POTENTIAL_ANCESTORS table, then the rankings of potential ancestors can be read from it without decoding any comparisons,
+ * and if it has SUBSTEMMATA or TEXTUAL_FLOW_EDGES tables, then the optimal substemmata of the witnesses or the textual flow at each variation unit
+ * can be read from them without being calculated again.
+ */
+class cache_reader {
+private:
+	sqlite3 * db = NULL;
+	bool open = false;
+	vector<string> wit_ids;
+	unordered_map<string, unsigned int> wit_inds;
+	vector<string> vu_ids;
+	vector<string> vu_labels;
+	vector<int> vu_connectivities;
+	unordered_map<string, unsigned int> vu_inds;
+	sqlite3_stmt * select_primary_comparisons_stmt = NULL;
+	sqlite3_stmt * select_secondary_comparisons_stmt = NULL;
+	sqlite3_stmt * select_bitmap_stmt = NULL;
+	sqlite3_stmt * select_reading_support_stmt = NULL;
+	sqlite3_stmt * select_potential_ancestor_rankings_stmt = NULL;
+	sqlite3_stmt * select_substemmata_stmt = NULL;
+	sqlite3_stmt * select_textual_flow_edges_stmt = NULL;
+	size_t max_cached_bytes = DEFAULT_MAX_CACHED_BYTES;
+	size_t cached_bytes = 0;
+	list<unsigned int> lru; //witness keys, from most to least recently used
+	unordered_map<unsigned int, cached_genealogical_comparisons> cache;
+	unordered_map<string, genealogical_comparison> empty_comps;
+	unordered_map<sqlite3_int64, weak_ptr<const Roaring>> bitmaps; //decoded bitmaps, keyed by their keys in the BITMAPS table
+	shared_ptr<const Roaring> get_bitmap(sqlite3_int64 bitmap_id);
+	void decode_genealogical_comparison(sqlite3_stmt * stmt, int col, genealogical_comparison & comp);
+	void prune_bitmaps();
+	void decode_potential_ancestor_ranking(sqlite3_stmt * stmt, int col, potential_ancestor_ranking & ranking) const;
+	void evict();
+	string select_variation_units(const set<unsigned int> & selected_vu_inds);
+public:
+	cache_reader(sqlite3 * _db);
+	cache_reader(sqlite3 * _db, size_t _max_cached_bytes);
+	cache_reader(const cache_reader &) = delete;
+	cache_reader & operator=(const cache_reader &) = delete;
+	virtual ~cache_reader();
+	void close();
+	bool is_open() const;
+	const vector<string> & get_witness_ids() const;
+	int get_witness_index(const string & wit_id) const;
+	bool witness_id_exists(const string & wit_id) const;
+	const vector<string> & get_variation_unit_ids() const;
+	const vector<string> & get_variation_unit_labels() const;
+	int get_variation_unit_index(const string & vu_id) const;
+	bool variation_unit_id_exists(const string & vu_id) const;
+	size_t get_max_cached_bytes() const;
+	size_t get_cached_bytes() const;
+	const unordered_map<string, genealogical_comparison> & get_genealogical_comparisons(const string & wit_id);
+	unordered_map<string, unordered_map<string, genealogical_comparison>> get_secondary_witness_genealogical_comparisons(const string & primary_wit_id);
+	bool has_potential_ancestor_rankings() const;
+	list<potential_ancestor_ranking> get_potential_ancestor_rankings(const string & wit_id);
+	unordered_map<string, list<potential_ancestor_ranking>> get_potential_ancestors();
+	bool has_substemmata() const;
+	list<set_cover_solution> get_substemmata(const string & wit_id);
+	list<global_stemma_edge> get_global_stemma_edges();
+	bool has_textual_flow_edges() const;
+	list<textual_flow_edge> get_textual_flow_edges(unsigned int vu_ind);
+	unordered_map<string, list<string>> get_reading_support(unsigned int vu_ind);
+	list<local_stemma> get_local_stemmata(const set<unsigned int> & selected_vu_inds);
+	list<variation_unit> get_variation_units(const set<unsigned int> & selected_vu_inds);
+};
+
+#endif /* CACHE_READER_H */
@@ -0,0 +1,202 @@
+/*
+ * cache_schema.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: jjmccollum
+ */
+
+#ifndef CACHE_SCHEMA_H
+#define CACHE_SCHEMA_H
+
+#include <string>
+
+using namespace std;
+
+//SQL to create the READINGS table:
+const string CREATE_READINGS_TABLE_SQL = "DROP TABLE IF EXISTS READINGS;"
+		"CREATE TABLE READINGS ("
+		"VARIATION_UNIT_ID INTEGER NOT NULL, "
+		"READING TEXT NOT NULL);";
+
+//SQL to index the READINGS table:
+const string CREATE_READINGS_INDEX_SQL = "DROP INDEX IF EXISTS READINGS_IDX;"
+		"CREATE INDEX READINGS_IDX ON READINGS (VARIATION_UNIT_ID, READING);";
+
+//SQL to create the READING_RELATIONS table:
+const string CREATE_READING_RELATIONS_TABLE_SQL = "DROP TABLE IF EXISTS READING_RELATIONS;"
+		"CREATE TABLE READING_RELATIONS ("
+		"VARIATION_UNIT_ID INTEGER NOT NULL, "
+		"PRIOR TEXT NOT NULL, "
+		"POSTERIOR TEXT NOT NULL, "
+		"WEIGHT REAL NOT NULL);";
+
+//SQL to index the READING_RELATIONS table:
+const string CREATE_READING_RELATIONS_INDEX_SQL = "DROP INDEX IF EXISTS READING_RELATIONS_IDX;"
+		"CREATE INDEX READING_RELATIONS_IDX ON READING_RELATIONS (VARIATION_UNIT_ID, PRIOR, POSTERIOR);";
+
+//SQL to create the READING_SUPPORT table:
+const string CREATE_READING_SUPPORT_TABLE_SQL = "DROP TABLE IF EXISTS READING_SUPPORT;"
+		"CREATE TABLE READING_SUPPORT ("
+		"VARIATION_UNIT_ID INTEGER NOT NULL, "
+		"WITNESS_ID INTEGER NOT NULL, "
+		"READING TEXT NOT NULL);";
+
+//SQL to index the READING_SUPPORT table:
+const string CREATE_READING_SUPPORT_INDEX_SQL = "DROP INDEX IF EXISTS READING_SUPPORT_IDX;"
+		"CREATE INDEX READING_SUPPORT_IDX ON READING_SUPPORT (VARIATION_UNIT_ID, WITNESS_ID, READING);";
+
+//SQL to create the VARIATION_UNITS table, which maps each variation unit's integer key to its ID, label, and connectivity:
+const string CREATE_VARIATION_UNITS_TABLE_SQL = "DROP TABLE IF EXISTS VARIATION_UNITS;"
+		"CREATE TABLE VARIATION_UNITS ("
+		"VARIATION_UNIT_ID INTEGER PRIMARY KEY, "
+		"VARIATION_UNIT TEXT NOT NULL, "
+		"LABEL TEXT, "
+		"CONNECTIVITY INT NOT NULL);";
+
+//SQL to index the VARIATION_UNITS table by variation unit ID:
+const string CREATE_VARIATION_UNITS_INDEX_SQL = "DROP INDEX IF EXISTS VARIATION_UNITS_IDX;"
+		"CREATE INDEX VARIATION_UNITS_IDX ON VARIATION_UNITS (VARIATION_UNIT);";
+
+//SQL to create the WITNESSES table, which maps each witness's integer key to its ID:
+const string CREATE_WITNESSES_TABLE_SQL = "DROP TABLE IF EXISTS WITNESSES;"
+		"CREATE TABLE WITNESSES ("
+		"WITNESS_ID INTEGER PRIMARY KEY, "
+		"WITNESS TEXT NOT NULL);";
+
+//SQL to index the WITNESSES table by witness ID:
+const string CREATE_WITNESSES_INDEX_SQL = "DROP INDEX IF EXISTS WITNESSES_IDX;"
+		"CREATE INDEX WITNESSES_IDX ON WITNESSES (WITNESS);";
+
+//SQL to create the BITMAPS table, which stores each distinct serialized bitmap of the genealogical comparisons once,
+//along with a hash of its contents by which it can be found again:
+const string CREATE_BITMAPS_TABLE_SQL = "DROP TABLE IF EXISTS BITMAPS;"
+		"CREATE TABLE BITMAPS ("
+		"BITMAP_ID INTEGER PRIMARY KEY, "
+		"HASH INTEGER NOT NULL, "
+		"BITMAP BLOB NOT NULL);";
+
+//SQL to create the GENEALOGICAL_COMPARISONS table, which is clustered on its primary key of primary and secondary witness keys,
+//so the comparisons relative to each primary witness are stored together.
+//The agreements and explained readings of each comparison are the keys of their bitmaps in the BITMAPS table:
+const string CREATE_GENEALOGICAL_COMPARISONS_TABLE_SQL = "DROP TABLE IF EXISTS GENEALOGICAL_COMPARISONS;"
+		"CREATE TABLE GENEALOGICAL_COMPARISONS ("
+		"PRIMARY_WIT_ID INTEGER NOT NULL, "
+		"SECONDARY_WIT_ID INTEGER NOT NULL, "
+		"AGREEMENTS_ID INTEGER NOT NULL, "
+		"EXPLAINED_ID INTEGER NOT NULL, "
+		"COST REAL NOT NULL, "
+		"PRIMARY KEY (PRIMARY_WIT_ID, SECONDARY_WIT_ID)) WITHOUT ROWID;";
+
+//SQL to index the GENEALOGICAL_COMPARISONS table by secondary witness key;
+//since the table has no rowid, each index entry also holds the primary witness key, so the index is effectively on (SECONDARY_WIT_ID, PRIMARY_WIT_ID):
+const string CREATE_GENEALOGICAL_COMPARISONS_INDEX_SQL = "DROP INDEX IF EXISTS GENEALOGICAL_COMPARISONS_SECONDARY_IDX;"
+		"CREATE INDEX GENEALOGICAL_COMPARISONS_SECONDARY_IDX ON GENEALOGICAL_COMPARISONS (SECONDARY_WIT_ID);";
+
+//SQL to create the POTENTIAL_ANCESTORS table, which holds the ranking of every other witness as a potential ancestor of each witness,
+//clustered on its primary key of primary and secondary witness keys.
+//The secondary witness is a potential ancestor of the primary witness if POTENTIAL_ANCESTOR is 1,
+//while its rank is positive if the primary witness has more posterior readings than prior ones;
+//the PRIOR and POSTERIOR columns count the variation units where the primary witness has a prior or posterior reading:
+const string CREATE_POTENTIAL_ANCESTORS_TABLE_SQL = "DROP TABLE IF EXISTS POTENTIAL_ANCESTORS;"
+		"CREATE TABLE POTENTIAL_ANCESTORS ("
+		"PRIMARY_WIT_ID INTEGER NOT NULL, "
+		"SECONDARY_WIT_ID INTEGER NOT NULL, "
+		"RANK INTEGER NOT NULL, "
+		"POTENTIAL_ANCESTOR INTEGER NOT NULL, "
+		"AGREEMENTS INTEGER NOT NULL, "
+		"PASS INTEGER NOT NULL, "
+		"PRIOR INTEGER NOT NULL, "
+		"POSTERIOR INTEGER NOT NULL, "
+		"COST REAL NOT NULL, "
+		"PRIMARY KEY (PRIMARY_WIT_ID, SECONDARY_WIT_ID)) WITHOUT ROWID;";
+
+//SQL to create the SUBSTEMMATA table, which holds the optimal substemmata of each witness, one row per ancestor in each solution,
+//clustered on its primary key of primary witness key, solution index, and ancestor index.
+//The COST and AGREEMENTS columns hold the totals for the whole solution,
+//and the WEIGHT column holds the proportion of the primary witness's extant passages where it agrees with the ancestor:
+const string CREATE_SUBSTEMMATA_TABLE_SQL = "DROP TABLE IF EXISTS SUBSTEMMATA;"
+		"CREATE TABLE SUBSTEMMATA ("
+		"PRIMARY_WIT_ID INTEGER NOT NULL, "
+		"SOLUTION_ID INTEGER NOT NULL, "
+		"ANCESTOR_ID INTEGER NOT NULL, "
+		"SECONDARY_WIT_ID INTEGER NOT NULL, "
+		"WEIGHT REAL NOT NULL, "
+		"COST REAL NOT NULL, "
+		"AGREEMENTS INTEGER NOT NULL, "
+		"PRIMARY KEY (PRIMARY_WIT_ID, SOLUTION_ID, ANCESTOR_ID)) WITHOUT ROWID;";
+
+//SQL to drop the SUBSTEMMATA table:
+const string DROP_SUBSTEMMATA_TABLE_SQL = "DROP TABLE IF EXISTS SUBSTEMMATA;";
+
+//SQL to create the TEXTUAL_FLOW_EDGES table, which holds the textual flow edge to each witness with potential ancestors at each variation unit,
+//clustered on its primary key of variation unit key and descendant witness key.
+//The TYPE column holds the value of the edge's flow_type (1 for EQUAL, 2 for CHANGE, and 3 for LOSS),
+//and the CONNECTIVITY column holds the zero-based connectivity rank of the ancestor:
+const string CREATE_TEXTUAL_FLOW_EDGES_TABLE_SQL = "DROP TABLE IF EXISTS TEXTUAL_FLOW_EDGES;"
+		"CREATE TABLE TEXTUAL_FLOW_EDGES ("
+		"VARIATION_UNIT_ID INTEGER NOT NULL, "
+		"DESCENDANT_WIT_ID INTEGER NOT NULL, "
+		"ANCESTOR_WIT_ID INTEGER NOT NULL, "
+		"TYPE INTEGER NOT NULL, "
+		"CONNECTIVITY INTEGER NOT NULL, "
+		"STRENGTH REAL NOT NULL, "
+		"PRIMARY KEY (VARIATION_UNIT_ID, DESCENDANT_WIT_ID)) WITHOUT ROWID;";
+
+//SQL to drop the TEXTUAL_FLOW_EDGES table:
+const string DROP_TEXTUAL_FLOW_EDGES_TABLE_SQL = "DROP TABLE IF EXISTS TEXTUAL_FLOW_EDGES;";
+
+//SQL to select the reading support of the variation unit with the bound key, as (witness key, reading) rows:
+const string SELECT_READING_SUPPORT_SQL = "SELECT WITNESS_ID, READING FROM READING_SUPPORT WHERE VARIATION_UNIT_ID=?";
+
+//SQL to select the serialized bitmap with the bound key:
+const string SELECT_BITMAP_SQL = "SELECT BITMAP FROM BITMAPS WHERE BITMAP_ID=?";
+
+//SQL to delete the bitmaps that are no longer the agreements or explained readings of any genealogical comparison:
+const string DELETE_UNREFERENCED_BITMAPS_SQL = "DELETE FROM BITMAPS WHERE BITMAP_ID NOT IN (SELECT AGREEMENTS_ID FROM GENEALOGICAL_COMPARISONS) "
+		"AND BITMAP_ID NOT IN (SELECT EXPLAINED_ID FROM GENEALOGICAL_COMPARISONS)";
+
+//SQL to select the comparisons of every witness relative to the witness with the bound key,
+//as (secondary witness key, agreements bitmap key, explained bitmap key, cost) rows in order of the secondary witness keys:
+const string SELECT_PRIMARY_WITNESS_GENEALOGICAL_COMPARISONS_SQL = "SELECT SECONDARY_WIT_ID, AGREEMENTS_ID, EXPLAINED_ID, COST "
+		"FROM GENEALOGICAL_COMPARISONS WHERE PRIMARY_WIT_ID=? ORDER BY SECONDARY_WIT_ID";
+
+//SQL to select the comparisons of every other witness relative to itself and relative to the witness with the bound ID,
+//as (primary witness ID, secondary witness ID, agreements bitmap key, explained bitmap key, cost) rows.
+//The first half finds the comparisons relative to the bound witness through the secondary witness index,
+//and the second half looks up each other witness's comparison relative to itself by primary key,
+//so the query reads O(W) rows of the table rather than scanning all W^2 of them:
+const string SELECT_SECONDARY_WITNESS_GENEALOGICAL_COMPARISONS_SQL = "SELECT P.WITNESS, S.WITNESS, G.AGREEMENTS_ID, G.EXPLAINED_ID, G.COST "
+		"FROM WITNESSES AS S INNER JOIN GENEALOGICAL_COMPARISONS AS G ON G.SECONDARY_WIT_ID=S.WITNESS_ID INNER JOIN WITNESSES AS P ON P.WITNESS_ID=G.PRIMARY_WIT_ID "
+		"WHERE S.WITNESS=?1 AND G.PRIMARY_WIT_ID<>G.SECONDARY_WIT_ID "
+		"UNION ALL "
+		"SELECT W.WITNESS, W.WITNESS, G.AGREEMENTS_ID, G.EXPLAINED_ID, G.COST "
+		"FROM WITNESSES AS W INNER JOIN GENEALOGICAL_COMPARISONS AS G ON G.PRIMARY_WIT_ID=W.WITNESS_ID AND G.SECONDARY_WIT_ID=W.WITNESS_ID "
+		"WHERE W.WITNESS<>?1";
+
+//SQL to select the rankings of every other witness relative to the witness with the bound key,
+//as (secondary witness key, rank, potential ancestor flag, agreements, pass, prior, posterior, cost) rows in decreasing order of agreements and then in order of the secondary witness keys:
+const string SELECT_POTENTIAL_ANCESTOR_RANKINGS_SQL = "SELECT SECONDARY_WIT_ID, RANK, POTENTIAL_ANCESTOR, AGREEMENTS, PASS, PRIOR, POSTERIOR, COST "
+		"FROM POTENTIAL_ANCESTORS WHERE PRIMARY_WIT_ID=? ORDER BY AGREEMENTS DESC, SECONDARY_WIT_ID";
+
+//SQL to select the rankings of the potential ancestors of every witness,
+//as (primary witness key, secondary witness key, rank, potential ancestor flag, agreements, pass, prior, posterior, cost) rows
+//in order of the primary witness keys, then in decreasing order of agreements, and then in order of the secondary witness keys:
+const string SELECT_ALL_POTENTIAL_ANCESTORS_SQL = "SELECT PRIMARY_WIT_ID, SECONDARY_WIT_ID, RANK, POTENTIAL_ANCESTOR, AGREEMENTS, PASS, PRIOR, POSTERIOR, COST "
+		"FROM POTENTIAL_ANCESTORS WHERE POTENTIAL_ANCESTOR=1 ORDER BY PRIMARY_WIT_ID, AGREEMENTS DESC, SECONDARY_WIT_ID";
+
+//SQL to select the optimal substemmata of the witness with the bound key,
+//as (solution index, secondary witness key, cost, agreements) rows in order of the solutions and then of the ancestors within each solution:
+const string SELECT_SUBSTEMMATA_SQL = "SELECT SOLUTION_ID, SECONDARY_WIT_ID, COST, AGREEMENTS "
+		"FROM SUBSTEMMATA WHERE PRIMARY_WIT_ID=? ORDER BY SOLUTION_ID, ANCESTOR_ID";
+
+//SQL to select the edges of the global stemma from the first optimal substemma of every witness,
+//as (primary witness key, secondary witness key, weight) rows in order of the primary witness keys and then of the ancestors within each substemma:
+const string SELECT_GLOBAL_STEMMA_EDGES_SQL = "SELECT PRIMARY_WIT_ID, SECONDARY_WIT_ID, WEIGHT "
+		"FROM SUBSTEMMATA WHERE SOLUTION_ID=0 ORDER BY PRIMARY_WIT_ID, ANCESTOR_ID";
+
+//SQL to select the textual flow edges at the variation unit with the bound key,
+//as (descendant witness key, ancestor witness key, type, connectivity, strength) rows in order of the descendant witness keys:
+const string SELECT_TEXTUAL_FLOW_EDGES_SQL = "SELECT DESCENDANT_WIT_ID, ANCESTOR_WIT_ID, TYPE, CONNECTIVITY, STRENGTH "
+		"FROM TEXTUAL_FLOW_EDGES WHERE VARIATION_UNIT_ID=? ORDER BY DESCENDANT_WIT_ID";
+
+#endif /* CACHE_SCHEMA_H */
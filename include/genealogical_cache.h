@@ -0,0 +1,91 @@
+/*
+ * genealogical_cache.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: jjmccollum
+ */
+
+#ifndef GENEALOGICAL_CACHE_H
+#define GENEALOGICAL_CACHE_H
+
+#include <string>
+#include <list>
+#include <vector>
+#include <unordered_map>
+#include <cstdio>
+#include <cstdint>
+
+#include "roaring.hh"
+#include "witness.h"
+
+using namespace std;
+
+//Define data structure for an entry in the offset table of a binary genealogical cache,
+//which describes the genealogical comparison of one witness (the column) relative to another (the row):
+struct genealogical_cache_entry {
+	uint64_t agreements_offset; //offset of the agreements bitmap in the file
+	uint64_t explained_offset; //offset of the explained bitmap in the file
+	uint32_t agreements_size; //size of the agreements bitmap in bytes
+	uint32_t explained_size; //size of the explained bitmap in bytes
+	float cost;
+	uint32_t present; //1 if the two witnesses were compared, and 0 otherwise
+};
+
+/**
+ * Writes genealogical comparisons to a binary genealogical cache file.
+ * The file holds a header, the witness IDs, each bitmap in Roaring's frozen serialization (aligned to 32 bytes),
+ * and a table of offsets with one entry for each ordered pair of witnesses.
+ */
+class genealogical_cache_writer {
+private:
+	FILE * file = NULL;
+	unordered_map<string, unsigned int> wit_inds;
+	vector<genealogical_cache_entry> entries;
+	uint64_t position = 0;
+	vector<char> buffer;
+	bool write_bytes(const void * bytes, size_t n_bytes);
+	bool write_padding();
+	bool write_bitmap(const Roaring & bitmap, uint64_t & offset, uint32_t & size);
+public:
+	genealogical_cache_writer(const string & path, const list<string> & list_wit);
+	genealogical_cache_writer(const genealogical_cache_writer &) = delete;
+	genealogical_cache_writer & operator=(const genealogical_cache_writer &) = delete;
+	virtual ~genealogical_cache_writer();
+	bool is_open() const;
+	bool add(const string & primary_wit_id, const string & secondary_wit_id, const genealogical_comparison & comp);
+	bool close();
+};
+
+/**
+ * Reads genealogical comparisons from a binary genealogical cache file.
+ * The file is memory-mapped, and its bitmaps are accessed as frozen views of the mapped file, so nothing is parsed when it is opened.
+ */
+class genealogical_cache {
+private:
+	const char * data = NULL;
+	size_t size = 0;
+	bool mapped = false;
+	vector<string> wit_ids;
+	unordered_map<string, unsigned int> wit_inds;
+	const genealogical_cache_entry * entries = NULL;
+	mutable vector<const roaring_bitmap_t *> views;
+	const roaring_bitmap_t * get_view(uint64_t offset, uint32_t n_bytes, size_t view_ind) const;
+	void close();
+public:
+	genealogical_cache();
+	genealogical_cache(const string & path);
+	genealogical_cache(const genealogical_cache &) = delete;
+	genealogical_cache & operator=(const genealogical_cache &) = delete;
+	virtual ~genealogical_cache();
+	bool is_open() const;
+	const vector<string> & get_witness_ids() const;
+	int get_witness_index(const string & wit_id) const;
+	bool has_genealogical_comparison(unsigned int wit_ind, unsigned int other_wit_ind) const;
+	const roaring_bitmap_t * get_agreements(unsigned int wit_ind, unsigned int other_wit_ind) const;
+	const roaring_bitmap_t * get_explained(unsigned int wit_ind, unsigned int other_wit_ind) const;
+	float get_cost(unsigned int wit_ind, unsigned int other_wit_ind) const;
+	genealogical_comparison get_genealogical_comparison(unsigned int wit_ind, unsigned int other_wit_ind) const;
+	unordered_map<string, genealogical_comparison> get_genealogical_comparisons(const string & wit_id) const;
+};
+
+#endif /* GENEALOGICAL_CACHE_H */
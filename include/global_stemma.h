@@ -10,6 +10,7 @@
 #include <iostream>
 #include <string>
 #include <list>
+#include <vector>
 
 #include "witness.h"
 
@@ -35,6 +36,7 @@ private:
 public:
 	global_stemma();
 	global_stemma(const list<witness> & witnesses);
+	global_stemma(const vector<string> & list_wit, const list<global_stemma_edge> & edges);
 	virtual ~global_stemma();
 	global_stemma_graph get_graph() const;
 	void to_dot(ostream & out, bool format_edges);
@@ -10,8 +10,10 @@
 #include <iostream>
 #include <string>
 #include <list>
+#include <vector>
 #include <set>
 #include <map>
+#include <cstdint>
 
 #include "pugixml.h"
 
@@ -36,18 +38,27 @@ private:
 	string id;
 	string label;
 	local_stemma_graph graph;
-	map<pair<string, string>, float> shortest_paths;
+	map<string, unsigned int> reading_inds;
+	unsigned int n_readings = 0;
+	vector<float> shortest_path_lengths; //n_readings x n_readings, row-major, with infinity where there is no path
+	vector<uint64_t> reachability; //packed bitmask of the readings reachable from each reading, one row of words per reading
+	void index_readings(const vector<string> & readings);
+	void populate_shortest_paths();
 public:
 	local_stemma();
 	local_stemma(const pugi::xml_node & xml, const string & vu_id, const string & vu_label, const set<pair<string, string>> & split_pairs, const set<string> & trivial_readings, const set<string> & dropped_readings);
+	local_stemma(const pugi::xml_node & xml, const string & vu_id, const string & vu_label, const vector<string> & readings, const set<pair<string, string>> & split_pairs, const set<string> & trivial_readings, const set<string> & dropped_readings);
 	local_stemma(const string & _id, const string & _label, const local_stemma_graph & _graph);
 	virtual ~local_stemma();
 	string get_id() const;
 	string get_label() const;
 	local_stemma_graph get_graph() const;
-	map<pair<string, string>, float> get_shortest_paths() const;
+	unsigned int get_n_readings() const;
+	int get_reading_index(const string & r) const;
 	bool path_exists(const string & r1, const string & r2) const;
+	bool path_exists(unsigned int r1, unsigned int r2) const;
 	float get_shortest_path_length(const string & r1, const string & r2) const;
+	float get_shortest_path_length(unsigned int r1, unsigned int r2) const;
 	void to_dot(ostream & out, bool print_weights);
 };
 
@@ -0,0 +1,54 @@
+/*
+ * reading_matrix.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: jjmccollum
+ */
+
+#ifndef READING_MATRIX_H
+#define READING_MATRIX_H
+
+#include <vector>
+#include <cstdint>
+
+#include "variation_unit.h"
+
+using namespace std;
+
+/**
+ * Enumeration of instruction sets that a reading matrix can use to compare witnesses.
+ */
+enum instruction_set {SCALAR_INSTRUCTIONS, SSE4_INSTRUCTIONS, AVX2_INSTRUCTIONS};
+
+//Define data structure for the comparison of two rows of a reading matrix:
+struct row_comparison {
+	vector<uint64_t> agreements;
+	vector<uint64_t> explained;
+	float cost;
+};
+
+class reading_matrix {
+private:
+	unsigned int n_witnesses = 0;
+	unsigned int n_units = 0;
+	bool wide = false; //whether any variation unit has too many readings for 8-bit cells
+	vector<uint8_t> narrow_cells; //reading indices, one row of variation units per witness
+	vector<uint16_t> wide_cells; //used instead of narrow_cells if the matrix is wide
+	vector<float> path_lengths; //for each variation unit, a table of path lengths from each reading (row) to each reading (column)
+	vector<int32_t> offsets; //the offset of each variation unit's table in the path lengths vector
+	vector<int32_t> strides; //the row length of each variation unit's table, where the last row and column stand for lacunae
+public:
+	reading_matrix();
+	reading_matrix(const vector<variation_unit> & variation_units, unsigned int _n_witnesses);
+	virtual ~reading_matrix();
+	unsigned int get_n_witnesses() const;
+	unsigned int get_n_units() const;
+	static instruction_set get_instruction_set();
+	static void get_set_bits(const vector<uint64_t> & words, vector<uint32_t> & inds);
+	float compare(unsigned int wit_ind, unsigned int other_wit_ind, vector<uint64_t> & agreements, vector<uint64_t> & explained) const;
+	float compare(unsigned int wit_ind, unsigned int other_wit_ind, vector<uint64_t> & agreements, vector<uint64_t> & explained, instruction_set isa) const;
+	void compare_both_ways(unsigned int wit_ind, unsigned int other_wit_ind, row_comparison & comp, row_comparison & reverse_comp) const;
+	void compare_both_ways(unsigned int wit_ind, unsigned int other_wit_ind, row_comparison & comp, row_comparison & reverse_comp, instruction_set isa) const;
+};
+
+#endif /* READING_MATRIX_H */
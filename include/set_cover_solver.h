@@ -11,7 +11,10 @@
 #include <list>
 #include <stack>
 #include <vector>
+#include <map>
+#include <unordered_map>
 #include <limits>
+#include <cstdint>
 
 #include "roaring.hh"
 
@@ -30,6 +33,83 @@ struct branch_and_bound_node {
 	node_state state;
 };
 
+/**
+ * Data structure representing a subtree of the branch and bound search, given by the rows accepted and the rows remaining at its root.
+ */
+struct branch_and_bound_task {
+	Roaring accepted;
+	Roaring remaining;
+};
+
+/**
+ * Enumeration of lower bounds that can be used to prune branch and bound nodes.
+ * The accepted cost bound is the cost of the rows accepted so far.
+ * The column cost bound adds, for each column left uncovered, the lowest share of its cost that a remaining row covering it spends on each uncovered column it covers.
+ * The disjoint columns bound adds the lowest cost of a remaining row covering each of a set of uncovered columns no two of which are covered by the same remaining row.
+ * The Lagrangian bound starts from the column cost bound and improves it with subgradient updates of the Lagrangian relaxation of the uncovered columns.
+ */
+enum bound_type {ACCEPTED_COST, COLUMN_COST, DISJOINT_COLUMNS, LAGRANGIAN};
+
+/**
+ * Data structure recording how many branch and bound nodes a lower bound was evaluated at and how many of them it pruned.
+ */
+struct bound_statistics {
+	unsigned long evaluations;
+	unsigned long prunes;
+};
+
+/**
+ * Data structure recording the number of nodes visited by branch and bound,
+ * the number of them pruned because no feasible solution lies under them,
+ * and the statistics of each lower bound used.
+ */
+struct branch_and_bound_statistics {
+	unsigned long nodes;
+	unsigned long infeasible;
+	map<bound_type, bound_statistics> bounds;
+};
+
+/**
+ * Data structure recording how a set cover instance was reduced before branch and bound:
+ * the number of passes made until no reduction applied,
+ * the number of rows fixed because they uniquely cover a column,
+ * the number of rows dropped because a cheaper row covers every column they cover,
+ * the number of columns dropped because every row covering another column covers them,
+ * and the numbers of rows and columns left for branch and bound.
+ */
+struct reduction_statistics {
+	unsigned int passes;
+	unsigned int fixed_rows;
+	unsigned int dominated_rows;
+	unsigned int dominated_columns;
+	unsigned int remaining_rows;
+	unsigned int remaining_columns;
+};
+
+/**
+ * Data structure counting how many accepted rows and how many available (i.e., accepted or remaining) rows cover each target column at a branch and bound node,
+ * indexed by the columns' order in the target set, along with the number of target columns that none of them cover.
+ * The counts are updated incrementally as rows are accepted, rejected, and restored,
+ * so that whether the accepted rows or the available rows cover the target can be checked without forming their unions.
+ */
+struct coverage_counts {
+	vector<unsigned int> accepted; //number of accepted rows covering each column
+	vector<unsigned int> available; //number of available rows covering each column
+	unsigned int uncovered_by_accepted;
+	unsigned int uncovered_by_available;
+};
+
+/**
+ * Data structure representing the target columns left uncovered at a branch and bound node,
+ * indexed by their order in the uncovered set, along with the remaining rows that cover them.
+ */
+struct uncovered_column_set {
+	vector<Roaring> column_rows; //remaining rows covering each uncovered column
+	vector<float> min_costs; //lowest cost of a remaining row covering each uncovered column
+	vector<double> min_shares; //lowest cost of a remaining row covering each uncovered column, divided by the number of uncovered columns the row covers
+	vector<vector<unsigned int>> row_columns; //uncovered columns covered by each row
+};
+
 /**
  * Data structure representing a set cover row, including the ID of the witness it represents and its cost.
  */
@@ -54,11 +134,28 @@ private:
 	vector<set_cover_row> rows;
 	Roaring target;
 	float fixed_ub = numeric_limits<float>::infinity();
+	unsigned int n_threads = 1;
+	list<bound_type> bounds = {ACCEPTED_COST, COLUMN_COST, DISJOINT_COLUMNS};
+	vector<Roaring> column_rows; //rows covering each target column, indexed by the column's order in the target set
+	vector<vector<unsigned int>> row_targets; //target columns covered by each row, given by their order in the target set
+	branch_and_bound_statistics statistics;
+	reduction_statistics reduction;
+	unsigned int n_words = 0; //number of 64-bit words in each dense row, or 0 if the target set is too wide for dense rows
+	vector<uint64_t> dense_rows; //target columns covered by each row, given by their order in the target set, as n_words words per row
+	vector<uint64_t> dense_target; //every target column, as n_words words
+	void index_dense_rows();
 public:
 	set_cover_solver();
 	set_cover_solver(const vector<set_cover_row> & _rows, const Roaring & _target);
 	set_cover_solver(const vector<set_cover_row> & _rows, const Roaring & _target, float _fixed_ub);
 	virtual ~set_cover_solver();
+	unsigned int get_n_threads() const;
+	void set_n_threads(unsigned int _n_threads);
+	const list<bound_type> & get_bounds() const;
+	void set_bounds(const list<bound_type> & _bounds);
+	const branch_and_bound_statistics & get_statistics() const;
+	const reduction_statistics & get_reduction_statistics() const;
+	bool has_dense_rows() const;
 	set_cover_solution get_solution_from_rows(const Roaring & solution_rows) const;
 	Roaring get_uncovered_columns() const;
 	Roaring get_unique_rows() const;
@@ -66,9 +163,22 @@ public:
 	void remove_redundant_rows_from_solution(Roaring & initial_solution_rows) const;
 	set_cover_solution get_trivial_solution() const;
 	set_cover_solution get_greedy_solution() const;
+	bool reduce(Roaring & fixed_rows, Roaring & reduced_rows, Roaring & reduced_target, float & reduced_ub);
 	void branch(const Roaring & remaining, stack<branch_and_bound_node> & nodes);
 	float bound(const Roaring & solution_rows) const;
+	void index_columns();
+	void init_coverage_counts(const Roaring & accepted, const Roaring & remaining, coverage_counts & coverage) const;
+	void add_accepted_row(unsigned int row_ind, coverage_counts & coverage) const;
+	void remove_accepted_row(unsigned int row_ind, coverage_counts & coverage) const;
+	void add_available_row(unsigned int row_ind, coverage_counts & coverage) const;
+	void remove_available_row(unsigned int row_ind, coverage_counts & coverage) const;
+	void get_uncovered_column_set(const coverage_counts & coverage, const Roaring & remaining, uncovered_column_set & uncovered) const;
+	double get_column_cost_bound(const uncovered_column_set & uncovered) const;
+	double get_disjoint_columns_bound(const uncovered_column_set & uncovered) const;
+	double get_lagrangian_bound(const uncovered_column_set & uncovered, double gap) const;
+	bool visit(const Roaring & accepted, const Roaring & remaining, const coverage_counts & coverage, float & ub, bool is_ub_fixed, unordered_map<string, Roaring> & distinct_row_sets, branch_and_bound_statistics & node_statistics) const;
 	void branch_and_bound(list<set_cover_solution> & solutions);
+	void parallel_branch_and_bound(list<set_cover_solution> & solutions);
 	void solve(list<set_cover_solution> & solutions);
 };
 
@@ -10,6 +10,7 @@
 #include <iostream>
 #include <string>
 #include <list>
+#include <unordered_map>
 
 #include "pugixml.h"
 #include "variation_unit.h"
@@ -36,6 +37,8 @@ struct textual_flow_graph {
 	list<textual_flow_edge> edges;
 };
 
+list<textual_flow_edge> get_textual_flow_edges(const variation_unit & vu, const list<string> & list_wit, const unordered_map<string, list<potential_ancestor_ranking>> & potential_ancestors);
+
 class textual_flow {
 private:
 	string label;
@@ -45,6 +48,8 @@ private:
 public:
 	textual_flow();
 	textual_flow(const variation_unit & vu, const list<witness> & witnesses);
+	textual_flow(const variation_unit & vu, const list<string> & list_wit, const unordered_map<string, list<potential_ancestor_ranking>> & potential_ancestors);
+	textual_flow(const variation_unit & vu, const list<string> & list_wit, const list<textual_flow_edge> & edges);
 	virtual ~textual_flow();
 	string get_label() const;
 	list<string> get_readings() const;
@@ -15,32 +15,44 @@
 #include <set>
 #include <unordered_map>
 #include <limits>
+#include <cstdint>
 
 #include "pugixml.h"
+#include "roaring.hh"
 #include "local_stemma.h"
 
 
 using namespace std;
 
+//Reading index recorded in a variation unit's reading support for a witness that is lacunose there:
+const uint16_t LACUNA = numeric_limits<uint16_t>::max();
+
 class variation_unit {
 private:
 	string id;
 	string label;
-	list<string> readings;
-	unordered_map<string, string> reading_support;
+	vector<string> readings;
+	vector<uint16_t> reading_support; //reading indices, indexed by witness index
 	int connectivity = numeric_limits<int>::max(); //absolute connectivity by default
 	local_stemma stemma;
+	vector<Roaring> attesting_witnesses; //for each reading, the witnesses that attest it
+	vector<Roaring> agreeing_witnesses; //for each reading, the witnesses with readings equal to it
+	vector<Roaring> prior_witnesses; //for each reading, the witnesses with readings prior to it at a positive cost
+	void populate_witness_bitmaps();
 public:
 	variation_unit();
-	variation_unit(const pugi::xml_node & xml, bool drop_ambiguous, bool merge_splits, const set<string> & trivial_reading_type);
-	variation_unit(const string & _id, const string & _label, const list<string> & _readings, const unordered_map<string, string> & _reading_support, int _connectivity, const local_stemma _stemma);
+	variation_unit(const pugi::xml_node & xml, const unordered_map<string, unsigned int> & wit_inds, bool drop_ambiguous, bool merge_splits, const set<string> & trivial_reading_type);
+	variation_unit(const string & _id, const string & _label, const vector<string> & _readings, const vector<uint16_t> & _reading_support, int _connectivity, const local_stemma _stemma);
 	virtual ~variation_unit();
 	string get_id() const;
 	string get_label() const;
-	list<string> get_readings() const;
-	unordered_map<string, string> get_reading_support() const;
+	const vector<string> & get_readings() const;
+	const vector<uint16_t> & get_reading_support() const;
 	int get_connectivity() const;
-	local_stemma get_local_stemma() const;
+	const local_stemma & get_local_stemma() const;
+	const vector<Roaring> & get_attesting_witnesses() const;
+	const vector<Roaring> & get_agreeing_witnesses() const;
+	const vector<Roaring> & get_prior_witnesses() const;
 };
 
 #endif /* VARIATION_UNIT_H */
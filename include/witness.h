@@ -10,20 +10,46 @@
 
 #include <string>
 #include <list>
+#include <vector>
 #include <unordered_map>
+#include <memory>
 
 #include "roaring.hh"
 #include "apparatus.h"
+#include "set_cover_solver.h"
 
 using namespace std;
 
-//Define data structure for genealogical comparison:
+//Define the kernels available for calculating genealogical comparisons:
+enum comparison_kernel {SCALAR, UNIT_MAJOR, SIMD};
+
+//Define data structure for genealogical comparison
+//(its bitmaps are immutable, so they can be shared by all comparisons with the same contents,
+//such as the comparisons of two witnesses in both directions where they agree in the same places):
 struct genealogical_comparison {
-	Roaring agreements;
-	Roaring explained;
+	shared_ptr<const Roaring> agreements;
+	shared_ptr<const Roaring> explained;
 	float cost;
 };
 
+//Define data structure for the ranking of another witness as a potential ancestor of a witness:
+struct potential_ancestor_ranking {
+	string id; //ID of the other witness
+	int rank; //rank of the other witness by the direction of its readings (positive if the witness has more posterior readings than prior ones, 0 if as many, and -1 if fewer)
+	bool potential_ancestor; //whether the other witness explains the witness in more variation units than the witness explains it
+	int agreements; //number of variation units where the two witnesses agree
+	int pass; //number of variation units where both witnesses are extant
+	int prior; //number of variation units where the witness has a reading prior to that of the other witness
+	int posterior; //number of variation units where the witness has a reading posterior to that of the other witness
+	float cost; //genealogical cost of the other witness relative to the witness
+};
+
+//Calculate the genealogical comparisons between a witness and a list of other witnesses in both directions:
+void compare_witnesses_both_ways(const string & wit_id, const list<string> & list_wit, const apparatus & app, comparison_kernel kernel, vector<genealogical_comparison> & comps, vector<genealogical_comparison> & reverse_comps);
+
+//Sort and rank a list of other witnesses as potential ancestors of a witness:
+void rank_potential_ancestors(list<potential_ancestor_ranking> & rankings);
+
 class witness {
 private:
 	string id;
@@ -34,16 +60,26 @@ public:
 	witness();
 	witness(const string & _id, const apparatus & app);
 	witness(const string & _id, const list<string> & list_wit, const apparatus & app);
+	witness(const string & _id, const list<string> & list_wit, const apparatus & app, comparison_kernel kernel);
 	witness(const string & _id, const unordered_map<string, genealogical_comparison> & _genealogical_comparisons);
+	witness(const string & _id, unordered_map<string, genealogical_comparison> && _genealogical_comparisons);
 	virtual ~witness();
 	string get_id() const;
-	unordered_map<string, genealogical_comparison> get_genealogical_comparisons() const;
+	const unordered_map<string, genealogical_comparison> & get_genealogical_comparisons() const;
 	genealogical_comparison get_genealogical_comparison_for_witness(const string & other_id) const;
 	bool potential_ancestor_comp(const witness & w1, const witness & w2) const;
 	list<string> get_potential_ancestor_ids() const;
 	void set_potential_ancestor_ids(const list<witness> & witnesses);
+	void set_potential_ancestor_ids(const list<string> & _potential_ancestor_ids);
+	list<potential_ancestor_ranking> get_potential_ancestor_rankings(const list<witness> & witnesses) const;
+	list<set_cover_solution> get_optimal_substemmata() const;
+	list<set_cover_solution> get_optimal_substemmata(unsigned int n_threads) const;
 	list<string> get_global_stemma_ancestor_ids() const;
 	void set_global_stemma_ancestor_ids();
+	void set_global_stemma_ancestor_ids(unsigned int n_threads);
 };
 
+//Rank the potential ancestors of every witness in a list:
+unordered_map<string, list<potential_ancestor_ranking>> rank_all_potential_ancestors(const list<witness> & witnesses);
+
 #endif /* WITNESS_H */
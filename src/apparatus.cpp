@@ -14,6 +14,7 @@
 #include "pugixml.h"
 #include "apparatus.h"
 #include "variation_unit.h"
+#include "reading_matrix.h"
 
 using namespace std;
 
@@ -30,20 +31,27 @@ apparatus::apparatus() {
  * and a set of strings indicating reading types that should be treated as trivial are also expected.
  */
 apparatus::apparatus(const pugi::xml_node & xml, bool drop_ambiguous, bool merge_splits, const set<string> & trivial_reading_types) {
-	//Populate the list of witness IDs first:
+	//Populate the list of witness IDs first, assigning each witness an index in the order in which it is listed:
 	list_wit = list<string>();
+	wit_inds = unordered_map<string, unsigned int>();
 	for (pugi::xpath_node wit_path : xml.select_nodes("teiHeader/sourceDesc/listWit/witness")) {
 		pugi::xml_node wit = wit_path.node();
 		string wit_id = wit.attribute("xml:id") ? wit.attribute("xml:id").value() : (wit.attribute("id") ? wit.attribute("id").value() : (wit.attribute("n") ? wit.attribute("n").value() : ""));
-		list_wit.push_back(wit_id);
+		if (wit_inds.find(wit_id) == wit_inds.end()) {
+			unsigned int wit_ind = wit_inds.size();
+			wit_inds[wit_id] = wit_ind;
+			list_wit.push_back(wit_id);
+		}
 	}
 	//Then parse the variation units:
 	variation_units = vector<variation_unit>();
 	for (pugi::xpath_node app_path : xml.select_nodes("descendant::app")) {
 		pugi::xml_node app = app_path.node();
-		variation_unit vu = variation_unit(app, drop_ambiguous, merge_splits, trivial_reading_types);
+		variation_unit vu = variation_unit(app, wit_inds, drop_ambiguous, merge_splits, trivial_reading_types);
 		variation_units.push_back(vu);
 	}
+	//Then lay out the readings of all witnesses in a matrix for fast comparisons:
+	matrix = reading_matrix(variation_units, list_wit.size());
 }
 
 /**
@@ -60,21 +68,39 @@ list<string> apparatus::get_list_wit() const {
 	return list_wit;
 }
 
+/**
+ * Returns the index of the witness with the given ID in this apparatus's list of witnesses,
+ * or -1 if there is no such witness.
+ */
+int apparatus::get_witness_index(const string & wit_id) const {
+	return wit_inds.find(wit_id) != wit_inds.end() ? int(wit_inds.at(wit_id)) : -1;
+}
+
 /**
  * Returns this apparatus's vector of variation_units.
  */
-vector<variation_unit> apparatus::get_variation_units() const {
+const vector<variation_unit> & apparatus::get_variation_units() const {
 	return variation_units;
 }
 
+/**
+ * Returns this apparatus's matrix of witness readings.
+ */
+const reading_matrix & apparatus::get_reading_matrix() const {
+	return matrix;
+}
+
 /**
  * Returns the number of passages at which the witness with the given ID is extant.
  */
 int apparatus::get_extant_passages_for_witness(const string & wit_id) const {
 	int extant_passages = 0;
-	for (variation_unit vu : variation_units) {
-		unordered_map<string, string> reading_support = vu.get_reading_support();
-		if (reading_support.find(wit_id) != reading_support.end()) {
+	int wit_ind = get_witness_index(wit_id);
+	if (wit_ind < 0) {
+		return extant_passages;
+	}
+	for (const variation_unit & vu : variation_units) {
+		if (vu.get_reading_support()[wit_ind] != LACUNA) {
 			extant_passages++;
 		}
 	}
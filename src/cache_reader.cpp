@@ -0,0 +1,753 @@
+/*
+ * cache_reader.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: jjmccollum
+ */
+
+#include <iostream>
+#include <string>
+#include <list>
+#include <vector>
+#include <set>
+#include <unordered_map>
+#include <memory>
+#include <limits>
+#include <algorithm>
+
+#include "sqlite3.h"
+#include "roaring.hh"
+#include "cache_schema.h"
+#include "local_stemma.h"
+#include "variation_unit.h"
+#include "witness.h"
+#include "cache_reader.h"
+
+using namespace std;
+
+/**
+ * Constructs a reader for the given open SQLite database, with the default limit on the size of its genealogical comparison cache.
+ */
+cache_reader::cache_reader(sqlite3 * _db) : cache_reader(_db, DEFAULT_MAX_CACHED_BYTES) {
+
+}
+
+/**
+ * Constructs a reader for the given open SQLite database, which it does not take ownership of,
+ * that keeps at most the given estimated number of bytes of decoded genealogical comparisons in its cache.
+ * The comparisons relative to the most recently requested witness are always kept, even if they exceed this limit,
+ * so a limit of 0 means that only they are kept.
+ * If the database does not have the expected tables, then the reader will not be open.
+ */
+cache_reader::cache_reader(sqlite3 * _db, size_t _max_cached_bytes) {
+	int rc; //to store SQLite macros
+	db = _db;
+	max_cached_bytes = _max_cached_bytes;
+	//Read in the witness IDs, which are keyed by their indices:
+	sqlite3_stmt * select_from_witnesses_stmt;
+	rc = sqlite3_prepare_v2(db, "SELECT WITNESS FROM WITNESSES ORDER BY WITNESS_ID", -1, & select_from_witnesses_stmt, 0);
+	if (rc != SQLITE_OK) {
+		return;
+	}
+	while (sqlite3_step(select_from_witnesses_stmt) == SQLITE_ROW) {
+		string wit_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_witnesses_stmt, 0)));
+		wit_inds[wit_id] = wit_ids.size();
+		wit_ids.push_back(wit_id);
+	}
+	sqlite3_finalize(select_from_witnesses_stmt);
+	//Then read in the variation unit IDs, labels, and connectivity values, which are also keyed by their indices:
+	sqlite3_stmt * select_from_variation_units_stmt;
+	rc = sqlite3_prepare_v2(db, "SELECT VARIATION_UNIT, LABEL, CONNECTIVITY FROM VARIATION_UNITS ORDER BY VARIATION_UNIT_ID", -1, & select_from_variation_units_stmt, 0);
+	if (rc != SQLITE_OK) {
+		return;
+	}
+	while (sqlite3_step(select_from_variation_units_stmt) == SQLITE_ROW) {
+		string vu_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_variation_units_stmt, 0)));
+		const unsigned char * vu_label = sqlite3_column_text(select_from_variation_units_stmt, 1);
+		vu_inds[vu_id] = vu_ids.size();
+		vu_ids.push_back(vu_id);
+		vu_labels.push_back(vu_label != NULL ? string(reinterpret_cast<const char *>(vu_label)) : string());
+		vu_connectivities.push_back(sqlite3_column_int(select_from_variation_units_stmt, 2));
+	}
+	sqlite3_finalize(select_from_variation_units_stmt);
+	//Then prepare the statements for repeated lookups:
+	rc = sqlite3_prepare_v2(db, SELECT_PRIMARY_WITNESS_GENEALOGICAL_COMPARISONS_SQL.c_str(), -1, & select_primary_comparisons_stmt, 0);
+	if (rc != SQLITE_OK) {
+		return;
+	}
+	rc = sqlite3_prepare_v2(db, SELECT_SECONDARY_WITNESS_GENEALOGICAL_COMPARISONS_SQL.c_str(), -1, & select_secondary_comparisons_stmt, 0);
+	if (rc != SQLITE_OK) {
+		return;
+	}
+	rc = sqlite3_prepare_v2(db, SELECT_BITMAP_SQL.c_str(), -1, & select_bitmap_stmt, 0);
+	if (rc != SQLITE_OK) {
+		return;
+	}
+	rc = sqlite3_prepare_v2(db, SELECT_READING_SUPPORT_SQL.c_str(), -1, & select_reading_support_stmt, 0);
+	if (rc != SQLITE_OK) {
+		return;
+	}
+	//The POTENTIAL_ANCESTORS table is optional, so if it is missing, then the statement to read it is left unprepared:
+	rc = sqlite3_prepare_v2(db, SELECT_POTENTIAL_ANCESTOR_RANKINGS_SQL.c_str(), -1, & select_potential_ancestor_rankings_stmt, 0);
+	if (rc != SQLITE_OK) {
+		select_potential_ancestor_rankings_stmt = NULL;
+	}
+	//So is the SUBSTEMMATA table:
+	rc = sqlite3_prepare_v2(db, SELECT_SUBSTEMMATA_SQL.c_str(), -1, & select_substemmata_stmt, 0);
+	if (rc != SQLITE_OK) {
+		select_substemmata_stmt = NULL;
+	}
+	//And so is the TEXTUAL_FLOW_EDGES table:
+	rc = sqlite3_prepare_v2(db, SELECT_TEXTUAL_FLOW_EDGES_SQL.c_str(), -1, & select_textual_flow_edges_stmt, 0);
+	if (rc != SQLITE_OK) {
+		select_textual_flow_edges_stmt = NULL;
+	}
+	open = true;
+}
+
+/**
+ * Default destructor.
+ */
+cache_reader::~cache_reader() {
+	close();
+}
+
+/**
+ * Returns the bitmap with the given key in the BITMAPS table.
+ * If the bitmap is still held by a genealogical comparison read earlier, then that bitmap is shared rather than decoded again.
+ * If there is no bitmap with the given key, then an empty bitmap is returned.
+ */
+shared_ptr<const Roaring> cache_reader::get_bitmap(sqlite3_int64 bitmap_id) {
+	weak_ptr<const Roaring> & interned = bitmaps[bitmap_id];
+	shared_ptr<const Roaring> bitmap = interned.lock();
+	if (bitmap) {
+		return bitmap;
+	}
+	sqlite3_bind_int64(select_bitmap_stmt, 1, bitmap_id);
+	if (sqlite3_step(select_bitmap_stmt) == SQLITE_ROW) {
+		int n_bytes = sqlite3_column_bytes(select_bitmap_stmt, 0);
+		const char * buf = reinterpret_cast<const char *>(sqlite3_column_blob(select_bitmap_stmt, 0));
+		bitmap = make_shared<const Roaring>(Roaring::readSafe(buf, n_bytes));
+	}
+	else {
+		bitmap = make_shared<const Roaring>();
+	}
+	sqlite3_reset(select_bitmap_stmt);
+	interned = bitmap;
+	return bitmap;
+}
+
+/**
+ * Decodes the genealogical comparison whose agreements bitmap key, explained bitmap key, and cost columns start at the given column of the current row of the given statement
+ * into the given genealogical comparison.
+ */
+void cache_reader::decode_genealogical_comparison(sqlite3_stmt * stmt, int col, genealogical_comparison & comp) {
+	comp.agreements = get_bitmap(sqlite3_column_int64(stmt, col));
+	comp.explained = get_bitmap(sqlite3_column_int64(stmt, col + 1));
+	comp.cost = float(sqlite3_column_double(stmt, col + 2));
+	return;
+}
+
+/**
+ * Decodes the ranking whose secondary witness key, rank, potential ancestor flag, agreements, pass, prior, posterior, and cost columns start at the given column of the current row of the given statement
+ * into the given potential ancestor ranking.
+ */
+void cache_reader::decode_potential_ancestor_ranking(sqlite3_stmt * stmt, int col, potential_ancestor_ranking & ranking) const {
+	ranking.id = wit_ids[sqlite3_column_int(stmt, col)];
+	ranking.rank = sqlite3_column_int(stmt, col + 1);
+	ranking.potential_ancestor = sqlite3_column_int(stmt, col + 2) != 0;
+	ranking.agreements = sqlite3_column_int(stmt, col + 3);
+	ranking.pass = sqlite3_column_int(stmt, col + 4);
+	ranking.prior = sqlite3_column_int(stmt, col + 5);
+	ranking.posterior = sqlite3_column_int(stmt, col + 6);
+	ranking.cost = float(sqlite3_column_double(stmt, col + 7));
+	return;
+}
+
+/**
+ * Evicts the least recently used genealogical comparisons from the cache until it is within its size limit,
+ * always keeping the most recently used comparisons.
+ */
+void cache_reader::evict() {
+	while (cached_bytes > max_cached_bytes && lru.size() > 1) {
+		unsigned int wit_ind = lru.back();
+		cached_bytes -= cache.at(wit_ind).n_bytes;
+		cache.erase(wit_ind);
+		lru.pop_back();
+	}
+	prune_bitmaps();
+	return;
+}
+
+/**
+ * Forgets the decoded bitmaps that are no longer held by any genealogical comparison.
+ */
+void cache_reader::prune_bitmaps() {
+	unordered_map<sqlite3_int64, weak_ptr<const Roaring>>::iterator it = bitmaps.begin();
+	while (it != bitmaps.end()) {
+		if (it->second.expired()) {
+			it = bitmaps.erase(it);
+		}
+		else {
+			it++;
+		}
+	}
+	return;
+}
+
+/**
+ * Creates a temporary SELECTED_VARIATION_UNITS table in the database and populates it with the given variation unit keys,
+ * so that queries can be restricted to those variation units with a single join rather than one lookup per variation unit.
+ * The returned SQL clause restricts a table with a VARIATION_UNIT_ID column to the selected variation units;
+ * if all variation units are selected, then no table is created, and the clause is empty.
+ */
+string cache_reader::select_variation_units(const set<unsigned int> & selected_vu_inds) {
+	if (selected_vu_inds.size() >= vu_ids.size()) {
+		return string();
+	}
+	int rc; //to store SQLite macros
+	char * create_selected_variation_units_error_msg;
+	rc = sqlite3_exec(db, "DROP TABLE IF EXISTS temp.SELECTED_VARIATION_UNITS;"
+			"CREATE TEMP TABLE SELECTED_VARIATION_UNITS (VARIATION_UNIT_ID INTEGER PRIMARY KEY);", NULL, 0, & create_selected_variation_units_error_msg);
+	if (rc != SQLITE_OK) {
+		cerr << "Error creating table SELECTED_VARIATION_UNITS: " << create_selected_variation_units_error_msg << endl;
+		sqlite3_free(create_selected_variation_units_error_msg);
+		exit(1);
+	}
+	//Insert the keys within a single transaction, unless the caller has already begun one:
+	char * transaction_error_msg;
+	bool own_transaction = sqlite3_get_autocommit(db) != 0;
+	if (own_transaction) {
+		sqlite3_exec(db, "BEGIN TRANSACTION", NULL, NULL, & transaction_error_msg);
+	}
+	sqlite3_stmt * insert_into_selected_variation_units_stmt;
+	sqlite3_prepare_v2(db, "INSERT INTO SELECTED_VARIATION_UNITS VALUES (?)", -1, & insert_into_selected_variation_units_stmt, 0);
+	for (unsigned int vu_ind : selected_vu_inds) {
+		sqlite3_bind_int(insert_into_selected_variation_units_stmt, 1, vu_ind);
+		sqlite3_step(insert_into_selected_variation_units_stmt);
+		sqlite3_reset(insert_into_selected_variation_units_stmt);
+	}
+	sqlite3_finalize(insert_into_selected_variation_units_stmt);
+	if (own_transaction) {
+		sqlite3_exec(db, "END TRANSACTION", NULL, NULL, & transaction_error_msg);
+	}
+	return " WHERE VARIATION_UNIT_ID IN (SELECT VARIATION_UNIT_ID FROM SELECTED_VARIATION_UNITS)";
+}
+
+/**
+ * Finalizes the reader's prepared statements, so that the database can be closed.
+ * The witness and variation unit IDs and the cached genealogical comparisons remain available,
+ * but nothing more can be read from the database.
+ */
+void cache_reader::close() {
+	sqlite3_finalize(select_primary_comparisons_stmt);
+	sqlite3_finalize(select_secondary_comparisons_stmt);
+	sqlite3_finalize(select_bitmap_stmt);
+	sqlite3_finalize(select_reading_support_stmt);
+	sqlite3_finalize(select_potential_ancestor_rankings_stmt);
+	sqlite3_finalize(select_substemmata_stmt);
+	sqlite3_finalize(select_textual_flow_edges_stmt);
+	select_primary_comparisons_stmt = NULL;
+	select_secondary_comparisons_stmt = NULL;
+	select_bitmap_stmt = NULL;
+	select_reading_support_stmt = NULL;
+	select_potential_ancestor_rankings_stmt = NULL;
+	select_substemmata_stmt = NULL;
+	select_textual_flow_edges_stmt = NULL;
+	open = false;
+	return;
+}
+
+/**
+ * Returns a flag indicating whether the database was read successfully and the reader has not been closed.
+ */
+bool cache_reader::is_open() const {
+	return open;
+}
+
+/**
+ * Returns the IDs of the witnesses in the database, indexed by their keys.
+ */
+const vector<string> & cache_reader::get_witness_ids() const {
+	return wit_ids;
+}
+
+/**
+ * Returns the key of the witness with the given ID, or -1 if there is no such witness.
+ */
+int cache_reader::get_witness_index(const string & wit_id) const {
+	unordered_map<string, unsigned int>::const_iterator it = wit_inds.find(wit_id);
+	return it != wit_inds.end() ? int(it->second) : -1;
+}
+
+/**
+ * Determines if the database contains a witness with the given ID.
+ */
+bool cache_reader::witness_id_exists(const string & wit_id) const {
+	return wit_inds.find(wit_id) != wit_inds.end();
+}
+
+/**
+ * Returns the IDs of the variation units in the database, indexed by their keys.
+ */
+const vector<string> & cache_reader::get_variation_unit_ids() const {
+	return vu_ids;
+}
+
+/**
+ * Returns the labels of the variation units in the database, indexed by their keys.
+ */
+const vector<string> & cache_reader::get_variation_unit_labels() const {
+	return vu_labels;
+}
+
+/**
+ * Returns the key of the variation unit with the given ID, or -1 if there is no such variation unit.
+ */
+int cache_reader::get_variation_unit_index(const string & vu_id) const {
+	unordered_map<string, unsigned int>::const_iterator it = vu_inds.find(vu_id);
+	return it != vu_inds.end() ? int(it->second) : -1;
+}
+
+/**
+ * Determines if the database contains a variation unit with the given ID.
+ */
+bool cache_reader::variation_unit_id_exists(const string & vu_id) const {
+	return vu_inds.find(vu_id) != vu_inds.end();
+}
+
+/**
+ * Returns the limit on the estimated size of the genealogical comparisons kept in the cache.
+ */
+size_t cache_reader::get_max_cached_bytes() const {
+	return max_cached_bytes;
+}
+
+/**
+ * Returns the estimated size of the genealogical comparisons currently kept in the cache.
+ */
+size_t cache_reader::get_cached_bytes() const {
+	return cached_bytes;
+}
+
+/**
+ * Returns a map of the genealogical comparisons of all witnesses relative to the witness with the given ID, keyed by the other witnesses' IDs.
+ * The comparisons are decoded from the GENEALOGICAL_COMPARISONS table the first time they are requested and served from the cache thereafter.
+ * The returned reference remains valid until the comparisons relative to another witness are requested.
+ * If there is no witness with the given ID, or the comparisons are not cached and the reader has been closed, then an empty map is returned.
+ */
+const unordered_map<string, genealogical_comparison> & cache_reader::get_genealogical_comparisons(const string & wit_id) {
+	int wit_ind = get_witness_index(wit_id);
+	if (wit_ind < 0) {
+		return empty_comps;
+	}
+	//If the comparisons are already cached, then mark them as the most recently used and return them:
+	unordered_map<unsigned int, cached_genealogical_comparisons>::iterator it = cache.find(wit_ind);
+	if (it != cache.end()) {
+		lru.splice(lru.begin(), lru, it->second.lru_it);
+		return it->second.comps;
+	}
+	//Otherwise, decode them directly into a new cache entry, if the reader is still open:
+	if (!open) {
+		return empty_comps;
+	}
+	lru.push_front(wit_ind);
+	cached_genealogical_comparisons & entry = cache[wit_ind];
+	entry.lru_it = lru.begin();
+	entry.n_bytes = 0;
+	entry.comps.reserve(wit_ids.size());
+	sqlite3_bind_int(select_primary_comparisons_stmt, 1, wit_ind);
+	while (sqlite3_step(select_primary_comparisons_stmt) == SQLITE_ROW) {
+		unsigned int secondary_wit_ind = sqlite3_column_int(select_primary_comparisons_stmt, 0);
+		if (secondary_wit_ind >= wit_ids.size()) {
+			continue;
+		}
+		const string & secondary_wit_id = wit_ids[secondary_wit_ind];
+		genealogical_comparison & comp = entry.comps[secondary_wit_id];
+		decode_genealogical_comparison(select_primary_comparisons_stmt, 1, comp);
+		//Estimate the memory held by this entry of the map, including its key and node
+		//(since bitmaps can be shared with any number of other comparisons, each comparison is charged for its bitmaps in full, so this is an upper bound):
+		entry.n_bytes += sizeof(genealogical_comparison) + sizeof(string) + secondary_wit_id.capacity() + 2 * sizeof(void *);
+		entry.n_bytes += comp.agreements->getSizeInBytes(false) + comp.explained->getSizeInBytes(false);
+	}
+	sqlite3_reset(select_primary_comparisons_stmt);
+	cached_bytes += entry.n_bytes;
+	evict();
+	return entry.comps;
+}
+
+/**
+ * Returns a map of each other witness's genealogical comparisons relative to itself and the witness with the given ID, keyed by the other witnesses' IDs.
+ * If the comparisons relative to every other witness are already cached, then the result is assembled from the cache;
+ * otherwise, just the required comparisons are read from the GENEALOGICAL_COMPARISONS table.
+ */
+unordered_map<string, unordered_map<string, genealogical_comparison>> cache_reader::get_secondary_witness_genealogical_comparisons(const string & primary_wit_id) {
+	unordered_map<string, unordered_map<string, genealogical_comparison>> secondary_witness_genealogical_comparisons = unordered_map<string, unordered_map<string, genealogical_comparison>>();
+	int primary_wit_ind = get_witness_index(primary_wit_id);
+	if (primary_wit_ind < 0) {
+		return secondary_witness_genealogical_comparisons;
+	}
+	//Check if the comparisons relative to every other witness are cached:
+	bool all_cached = true;
+	for (unsigned int wit_ind = 0; wit_ind < wit_ids.size(); wit_ind++) {
+		if (int(wit_ind) != primary_wit_ind && cache.find(wit_ind) == cache.end()) {
+			all_cached = false;
+			break;
+		}
+	}
+	if (all_cached) {
+		for (unsigned int wit_ind = 0; wit_ind < wit_ids.size(); wit_ind++) {
+			if (int(wit_ind) == primary_wit_ind) {
+				continue;
+			}
+			const unordered_map<string, genealogical_comparison> & comps = cache.at(wit_ind).comps;
+			unordered_map<string, genealogical_comparison> secondary_comps = unordered_map<string, genealogical_comparison>();
+			for (const string & other_wit_id : {wit_ids[wit_ind], primary_wit_id}) {
+				unordered_map<string, genealogical_comparison>::const_iterator comp_it = comps.find(other_wit_id);
+				if (comp_it != comps.end()) {
+					secondary_comps[other_wit_id] = comp_it->second;
+				}
+			}
+			if (!secondary_comps.empty()) {
+				secondary_witness_genealogical_comparisons[wit_ids[wit_ind]] = secondary_comps;
+			}
+		}
+		return secondary_witness_genealogical_comparisons;
+	}
+	//Otherwise, read the comparisons from the database, if the reader is still open:
+	if (!open) {
+		return secondary_witness_genealogical_comparisons;
+	}
+	sqlite3_bind_text(select_secondary_comparisons_stmt, 1, primary_wit_id.c_str(), -1, SQLITE_STATIC);
+	while (sqlite3_step(select_secondary_comparisons_stmt) == SQLITE_ROW) {
+		string wit_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_secondary_comparisons_stmt, 0)));
+		string other_wit_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_secondary_comparisons_stmt, 1)));
+		genealogical_comparison & comp = secondary_witness_genealogical_comparisons[wit_id][other_wit_id];
+		decode_genealogical_comparison(select_secondary_comparisons_stmt, 2, comp);
+	}
+	sqlite3_reset(select_secondary_comparisons_stmt);
+	sqlite3_clear_bindings(select_secondary_comparisons_stmt);
+	prune_bitmaps();
+	return secondary_witness_genealogical_comparisons;
+}
+
+/**
+ * Determines if the rankings of potential ancestors can be read from the POTENTIAL_ANCESTORS table of the database.
+ */
+bool cache_reader::has_potential_ancestor_rankings() const {
+	return open && select_potential_ancestor_rankings_stmt != NULL;
+}
+
+/**
+ * Returns the rankings of all other witnesses as potential ancestors of the witness with the given ID,
+ * sorted in decreasing order of agreements and then in the order of the witnesses' keys.
+ * The rankings are read from the POTENTIAL_ANCESTORS table, so no genealogical comparisons are decoded.
+ * If there is no witness with the given ID or the table cannot be read, then an empty list is returned.
+ */
+list<potential_ancestor_ranking> cache_reader::get_potential_ancestor_rankings(const string & wit_id) {
+	list<potential_ancestor_ranking> rankings = list<potential_ancestor_ranking>();
+	int wit_ind = get_witness_index(wit_id);
+	if (wit_ind < 0 || !has_potential_ancestor_rankings()) {
+		return rankings;
+	}
+	sqlite3_bind_int(select_potential_ancestor_rankings_stmt, 1, wit_ind);
+	while (sqlite3_step(select_potential_ancestor_rankings_stmt) == SQLITE_ROW) {
+		if ((unsigned int) sqlite3_column_int(select_potential_ancestor_rankings_stmt, 0) >= wit_ids.size()) {
+			continue;
+		}
+		potential_ancestor_ranking ranking;
+		decode_potential_ancestor_ranking(select_potential_ancestor_rankings_stmt, 0, ranking);
+		rankings.push_back(ranking);
+	}
+	sqlite3_reset(select_potential_ancestor_rankings_stmt);
+	return rankings;
+}
+
+/**
+ * Returns a map of the rankings of the potential ancestors of every witness, keyed by witness ID,
+ * where each witness's potential ancestors are sorted in decreasing order of agreements and then in the order of their keys.
+ * The rankings are read from the POTENTIAL_ANCESTORS table in a single scan, so no genealogical comparisons are decoded.
+ * If the table cannot be read, then an empty map is returned.
+ */
+unordered_map<string, list<potential_ancestor_ranking>> cache_reader::get_potential_ancestors() {
+	unordered_map<string, list<potential_ancestor_ranking>> potential_ancestors = unordered_map<string, list<potential_ancestor_ranking>>();
+	if (!has_potential_ancestor_rankings()) {
+		return potential_ancestors;
+	}
+	sqlite3_stmt * select_potential_ancestors_stmt;
+	int rc = sqlite3_prepare_v2(db, SELECT_ALL_POTENTIAL_ANCESTORS_SQL.c_str(), -1, & select_potential_ancestors_stmt, 0);
+	if (rc != SQLITE_OK) {
+		return potential_ancestors;
+	}
+	while (sqlite3_step(select_potential_ancestors_stmt) == SQLITE_ROW) {
+		unsigned int wit_ind = sqlite3_column_int(select_potential_ancestors_stmt, 0);
+		unsigned int other_wit_ind = sqlite3_column_int(select_potential_ancestors_stmt, 1);
+		if (wit_ind >= wit_ids.size() || other_wit_ind >= wit_ids.size()) {
+			continue;
+		}
+		potential_ancestor_ranking ranking;
+		decode_potential_ancestor_ranking(select_potential_ancestors_stmt, 1, ranking);
+		potential_ancestors[wit_ids[wit_ind]].push_back(ranking);
+	}
+	sqlite3_finalize(select_potential_ancestors_stmt);
+	return potential_ancestors;
+}
+
+/**
+ * Determines if the optimal substemmata of the witnesses can be read from the SUBSTEMMATA table of the database.
+ */
+bool cache_reader::has_substemmata() const {
+	return open && select_substemmata_stmt != NULL;
+}
+
+/**
+ * Returns the optimal substemmata of the witness with the given ID, in the order in which the solver found them.
+ * The rows of each solution only have their IDs set, since the substemmata are read from the SUBSTEMMATA table without decoding any comparisons.
+ * If there is no witness with the given ID, the witness has no substemma, or the table cannot be read, then an empty list is returned.
+ */
+list<set_cover_solution> cache_reader::get_substemmata(const string & wit_id) {
+	list<set_cover_solution> solutions = list<set_cover_solution>();
+	int wit_ind = get_witness_index(wit_id);
+	if (wit_ind < 0 || !has_substemmata()) {
+		return solutions;
+	}
+	sqlite3_bind_int(select_substemmata_stmt, 1, wit_ind);
+	int prev_solution_ind = -1;
+	while (sqlite3_step(select_substemmata_stmt) == SQLITE_ROW) {
+		int solution_ind = sqlite3_column_int(select_substemmata_stmt, 0);
+		unsigned int other_wit_ind = sqlite3_column_int(select_substemmata_stmt, 1);
+		if (other_wit_ind >= wit_ids.size()) {
+			continue;
+		}
+		//Start a new solution whenever the solution index changes:
+		if (solution_ind != prev_solution_ind) {
+			set_cover_solution solution;
+			solution.rows = list<set_cover_row>();
+			solution.cost = float(sqlite3_column_double(select_substemmata_stmt, 2));
+			solution.agreements = sqlite3_column_int(select_substemmata_stmt, 3);
+			solutions.push_back(solution);
+			prev_solution_ind = solution_ind;
+		}
+		set_cover_row row;
+		row.id = wit_ids[other_wit_ind];
+		solutions.back().rows.push_back(row);
+	}
+	sqlite3_reset(select_substemmata_stmt);
+	return solutions;
+}
+
+/**
+ * Returns the edges of the global stemma, taken from the first optimal substemma of every witness in the SUBSTEMMATA table.
+ * The edges are ordered by the keys of their descendants and then by the order of the ancestors in each substemma.
+ * If the table cannot be read, then an empty list is returned.
+ */
+list<global_stemma_edge> cache_reader::get_global_stemma_edges() {
+	list<global_stemma_edge> edges = list<global_stemma_edge>();
+	if (!has_substemmata()) {
+		return edges;
+	}
+	sqlite3_stmt * select_global_stemma_edges_stmt;
+	int rc = sqlite3_prepare_v2(db, SELECT_GLOBAL_STEMMA_EDGES_SQL.c_str(), -1, & select_global_stemma_edges_stmt, 0);
+	if (rc != SQLITE_OK) {
+		return edges;
+	}
+	while (sqlite3_step(select_global_stemma_edges_stmt) == SQLITE_ROW) {
+		unsigned int wit_ind = sqlite3_column_int(select_global_stemma_edges_stmt, 0);
+		unsigned int other_wit_ind = sqlite3_column_int(select_global_stemma_edges_stmt, 1);
+		if (wit_ind >= wit_ids.size() || other_wit_ind >= wit_ids.size()) {
+			continue;
+		}
+		global_stemma_edge e;
+		e.ancestor = wit_ids[other_wit_ind];
+		e.descendant = wit_ids[wit_ind];
+		e.weight = float(sqlite3_column_double(select_global_stemma_edges_stmt, 2));
+		edges.push_back(e);
+	}
+	sqlite3_finalize(select_global_stemma_edges_stmt);
+	return edges;
+}
+
+/**
+ * Determines if the textual flow at each variation unit can be read from the TEXTUAL_FLOW_EDGES table of the database.
+ */
+bool cache_reader::has_textual_flow_edges() const {
+	return open && select_textual_flow_edges_stmt != NULL;
+}
+
+/**
+ * Returns the textual flow edges at the variation unit with the given key, in the order of the keys of their descendants.
+ * If there is no variation unit with the given key or the table cannot be read, then an empty list is returned.
+ */
+list<textual_flow_edge> cache_reader::get_textual_flow_edges(unsigned int vu_ind) {
+	list<textual_flow_edge> edges = list<textual_flow_edge>();
+	if (vu_ind >= vu_ids.size() || !has_textual_flow_edges()) {
+		return edges;
+	}
+	sqlite3_bind_int(select_textual_flow_edges_stmt, 1, vu_ind);
+	while (sqlite3_step(select_textual_flow_edges_stmt) == SQLITE_ROW) {
+		unsigned int wit_ind = sqlite3_column_int(select_textual_flow_edges_stmt, 0);
+		unsigned int other_wit_ind = sqlite3_column_int(select_textual_flow_edges_stmt, 1);
+		if (wit_ind >= wit_ids.size() || other_wit_ind >= wit_ids.size()) {
+			continue;
+		}
+		textual_flow_edge e;
+		e.descendant = wit_ids[wit_ind];
+		e.ancestor = wit_ids[other_wit_ind];
+		e.type = flow_type(sqlite3_column_int(select_textual_flow_edges_stmt, 2));
+		e.connectivity = sqlite3_column_int(select_textual_flow_edges_stmt, 3);
+		e.strength = float(sqlite3_column_double(select_textual_flow_edges_stmt, 4));
+		edges.push_back(e);
+	}
+	sqlite3_reset(select_textual_flow_edges_stmt);
+	return edges;
+}
+
+/**
+ * Returns a map of the readings of each witness at the variation unit with the given key, keyed by the witnesses' IDs.
+ */
+unordered_map<string, list<string>> cache_reader::get_reading_support(unsigned int vu_ind) {
+	unordered_map<string, list<string>> reading_support = unordered_map<string, list<string>>();
+	if (!open) {
+		return reading_support;
+	}
+	sqlite3_bind_int(select_reading_support_stmt, 1, vu_ind);
+	while (sqlite3_step(select_reading_support_stmt) == SQLITE_ROW) {
+		unsigned int wit_ind = sqlite3_column_int(select_reading_support_stmt, 0);
+		if (wit_ind >= wit_ids.size()) {
+			continue;
+		}
+		string rdg_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_reading_support_stmt, 1)));
+		reading_support[wit_ids[wit_ind]].push_back(rdg_id);
+	}
+	sqlite3_reset(select_reading_support_stmt);
+	return reading_support;
+}
+
+/**
+ * Using the READINGS and READING_RELATIONS tables of the database,
+ * constructs and returns the local stemmata of the variation units with the given keys, in order of their keys.
+ * Each table is read in a single scan, restricted to the given variation units if they are not all of the variation units.
+ */
+list<local_stemma> cache_reader::get_local_stemmata(const set<unsigned int> & selected_vu_inds) {
+	list<local_stemma> local_stemmata = list<local_stemma>();
+	int rc; //to store SQLite macros
+	string filter_sql = select_variation_units(selected_vu_inds);
+	unsigned int n_vus = vu_ids.size();
+	//Populate the local stemma graphs, starting with their vertices:
+	vector<local_stemma_graph> graphs = vector<local_stemma_graph>(n_vus);
+	sqlite3_stmt * select_from_readings_stmt;
+	sqlite3_prepare_v2(db, ("SELECT VARIATION_UNIT_ID, READING FROM READINGS" + filter_sql + " ORDER BY ROWID").c_str(), -1, & select_from_readings_stmt, 0);
+	rc = sqlite3_step(select_from_readings_stmt);
+	while (rc == SQLITE_ROW) {
+		unsigned int vu_ind = sqlite3_column_int(select_from_readings_stmt, 0);
+		if (vu_ind < n_vus) {
+			local_stemma_vertex v;
+			v.id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_readings_stmt, 1)));
+			graphs[vu_ind].vertices.push_back(v);
+		}
+		rc = sqlite3_step(select_from_readings_stmt);
+	}
+	sqlite3_finalize(select_from_readings_stmt);
+	//Then add their edges:
+	sqlite3_stmt * select_from_reading_relations_stmt;
+	sqlite3_prepare_v2(db, ("SELECT VARIATION_UNIT_ID, PRIOR, POSTERIOR, WEIGHT FROM READING_RELATIONS" + filter_sql + " ORDER BY ROWID").c_str(), -1, & select_from_reading_relations_stmt, 0);
+	rc = sqlite3_step(select_from_reading_relations_stmt);
+	while (rc == SQLITE_ROW) {
+		unsigned int vu_ind = sqlite3_column_int(select_from_reading_relations_stmt, 0);
+		if (vu_ind < n_vus) {
+			local_stemma_edge e;
+			e.prior = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_reading_relations_stmt, 1)));
+			e.posterior = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_reading_relations_stmt, 2)));
+			e.weight = float(sqlite3_column_double(select_from_reading_relations_stmt, 3));
+			graphs[vu_ind].edges.push_back(e);
+		}
+		rc = sqlite3_step(select_from_reading_relations_stmt);
+	}
+	sqlite3_finalize(select_from_reading_relations_stmt);
+	//Then construct the local stemmata:
+	for (unsigned int vu_ind : selected_vu_inds) {
+		if (vu_ind < n_vus) {
+			local_stemmata.push_back(local_stemma(vu_ids[vu_ind], vu_labels[vu_ind], graphs[vu_ind]));
+		}
+	}
+	return local_stemmata;
+}
+
+/**
+ * Using the READINGS, READING_SUPPORT, and READING_RELATIONS tables of the database,
+ * constructs and returns the variation units with the given keys, in order of their keys.
+ * Each table is read in a single scan, restricted to the given variation units if they are not all of the variation units.
+ * The witnesses' keys determine the indices used in the variation units' reading support.
+ */
+list<variation_unit> cache_reader::get_variation_units(const set<unsigned int> & selected_vu_inds) {
+	list<variation_unit> variation_units = list<variation_unit>();
+	int rc; //to store SQLite macros
+	string filter_sql = select_variation_units(selected_vu_inds);
+	unsigned int n_vus = vu_ids.size();
+	unsigned int n_wits = wit_ids.size();
+	//Get the readings, which also serve as the vertices of the local stemmata:
+	vector<vector<string>> readings = vector<vector<string>>(n_vus);
+	vector<local_stemma_graph> graphs = vector<local_stemma_graph>(n_vus);
+	sqlite3_stmt * select_from_readings_stmt;
+	sqlite3_prepare_v2(db, ("SELECT VARIATION_UNIT_ID, READING FROM READINGS" + filter_sql + " ORDER BY ROWID").c_str(), -1, & select_from_readings_stmt, 0);
+	rc = sqlite3_step(select_from_readings_stmt);
+	while (rc == SQLITE_ROW) {
+		unsigned int vu_ind = sqlite3_column_int(select_from_readings_stmt, 0);
+		if (vu_ind < n_vus) {
+			local_stemma_vertex v;
+			v.id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_readings_stmt, 1)));
+			readings[vu_ind].push_back(v.id);
+			graphs[vu_ind].vertices.push_back(v);
+		}
+		rc = sqlite3_step(select_from_readings_stmt);
+	}
+	sqlite3_finalize(select_from_readings_stmt);
+	//Then get the reading support vectors:
+	vector<vector<uint16_t>> reading_supports = vector<vector<uint16_t>>(n_vus);
+	for (unsigned int vu_ind : selected_vu_inds) {
+		if (vu_ind < n_vus) {
+			reading_supports[vu_ind] = vector<uint16_t>(n_wits, LACUNA);
+		}
+	}
+	sqlite3_stmt * select_from_reading_support_stmt;
+	sqlite3_prepare_v2(db, ("SELECT VARIATION_UNIT_ID, WITNESS_ID, READING FROM READING_SUPPORT" + filter_sql).c_str(), -1, & select_from_reading_support_stmt, 0);
+	rc = sqlite3_step(select_from_reading_support_stmt);
+	while (rc == SQLITE_ROW) {
+		unsigned int vu_ind = sqlite3_column_int(select_from_reading_support_stmt, 0);
+		unsigned int wit_ind = sqlite3_column_int(select_from_reading_support_stmt, 1);
+		if (vu_ind < n_vus && wit_ind < n_wits && !reading_supports[vu_ind].empty()) {
+			string rdg_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_reading_support_stmt, 2)));
+			const vector<string> & vu_readings = readings[vu_ind];
+			vector<string>::const_iterator rdg_it = find(vu_readings.begin(), vu_readings.end(), rdg_id);
+			if (rdg_it != vu_readings.end()) {
+				reading_supports[vu_ind][wit_ind] = uint16_t(rdg_it - vu_readings.begin());
+			}
+		}
+		rc = sqlite3_step(select_from_reading_support_stmt);
+	}
+	sqlite3_finalize(select_from_reading_support_stmt);
+	//Then get the edges of the local stemmata:
+	sqlite3_stmt * select_from_reading_relations_stmt;
+	sqlite3_prepare_v2(db, ("SELECT VARIATION_UNIT_ID, PRIOR, POSTERIOR, WEIGHT FROM READING_RELATIONS" + filter_sql + " ORDER BY ROWID").c_str(), -1, & select_from_reading_relations_stmt, 0);
+	rc = sqlite3_step(select_from_reading_relations_stmt);
+	while (rc == SQLITE_ROW) {
+		unsigned int vu_ind = sqlite3_column_int(select_from_reading_relations_stmt, 0);
+		if (vu_ind < n_vus) {
+			local_stemma_edge e;
+			e.prior = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_reading_relations_stmt, 1)));
+			e.posterior = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_reading_relations_stmt, 2)));
+			e.weight = float(sqlite3_column_double(select_from_reading_relations_stmt, 3));
+			graphs[vu_ind].edges.push_back(e);
+		}
+		rc = sqlite3_step(select_from_reading_relations_stmt);
+	}
+	sqlite3_finalize(select_from_reading_relations_stmt);
+	//Then construct the variation units:
+	for (unsigned int vu_ind : selected_vu_inds) {
+		if (vu_ind < n_vus) {
+			local_stemma stemma = local_stemma(vu_ids[vu_ind], vu_labels[vu_ind], graphs[vu_ind]);
+			variation_units.push_back(variation_unit(vu_ids[vu_ind], vu_labels[vu_ind], readings[vu_ind], reading_supports[vu_ind], vu_connectivities[vu_ind], stemma));
+		}
+	}
+	return variation_units;
+}
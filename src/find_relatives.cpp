@@ -16,8 +16,10 @@
 
 #include "cxxopts.h"
 #include "sqlite3.h"
+#include "cache_reader.h"
 #include "roaring.hh"
 #include "witness.h"
+#include "genealogical_cache.h"
 #include "apparatus.h"
 #include "variation_unit.h"
 
@@ -42,187 +44,43 @@ struct witness_comparison {
 };
 
 /**
- * Determines if the WITNESSES table of the given SQLite database
- * contains a row with the given witness ID.
- */
-bool witness_id_exists(sqlite3 * input_db, const string & wit_id) {
-	bool witness_id_exists = false;
-	int rc; //to store SQLite macros
-	sqlite3_stmt * select_from_witnesses_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM WITNESSES WHERE WITNESS=?", -1, & select_from_witnesses_stmt, 0);
-	sqlite3_bind_text(select_from_witnesses_stmt, 1, wit_id.c_str(), -1, SQLITE_STATIC);
-	rc = sqlite3_step(select_from_witnesses_stmt);
-	witness_id_exists = (rc == SQLITE_ROW) ? true : false;
-	sqlite3_finalize(select_from_witnesses_stmt);
-	return witness_id_exists;
-}
-
-/**
- * Retrieves all rows from the WITNESSES table of the given SQLite database
- * and returns a list of witness IDs populated with its contents.
- */
-list<string> get_witness_ids(sqlite3 * input_db) {
-	list<string> witness_ids = list<string>();
-	int rc; //to store SQLite macros
-	sqlite3_stmt * select_from_witnesses_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM WITNESSES ORDER BY ROWID", -1, & select_from_witnesses_stmt, 0);
-	rc = sqlite3_step(select_from_witnesses_stmt);
-	while (rc == SQLITE_ROW) {
-		string wit_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_witnesses_stmt, 0)));
-		witness_ids.push_back(wit_id);
-		rc = sqlite3_step(select_from_witnesses_stmt);
-	}
-	sqlite3_finalize(select_from_witnesses_stmt);
-	return witness_ids;
-}
-
-/**
- * Retrieves rows for the given variation unit from the READING_SUPPORT table of the given SQLite database
- * and returns a reading support map populated with its contents.
- */
-unordered_map<string, list<string>> get_reading_support(sqlite3 * input_db, const string & vu_id) {
-	unordered_map<string, list<string>> reading_support = unordered_map<string, list<string>>();
-	int rc; //to store SQLite macros
-	sqlite3_stmt * select_from_reading_support_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM READING_SUPPORT WHERE VARIATION_UNIT=?", -1, & select_from_reading_support_stmt, 0);
-	sqlite3_bind_text(select_from_reading_support_stmt, 1, vu_id.c_str(), -1, SQLITE_STATIC);
-	rc = sqlite3_step(select_from_reading_support_stmt);
-	while (rc == SQLITE_ROW) {
-		string wit_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_reading_support_stmt, 1)));
-		string rdg_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_reading_support_stmt, 2)));
-		//Add an entry for this witness if there isn't one already:
-		if (reading_support.find(wit_id) == reading_support.end()) {
-			reading_support[wit_id] = list<string>();
-		}
-		reading_support[wit_id].push_back(rdg_id);
-		rc = sqlite3_step(select_from_reading_support_stmt);
-	}
-	sqlite3_finalize(select_from_reading_support_stmt);
-	return reading_support;
-}
-
-/**
- * Retrieves rows relative to the given primary witness ID from the GENEALOGICAL_COMPARISONS table of the given SQLite database
+ * Retrieves the genealogical comparisons relative to the given primary witness ID from the given binary genealogical cache
  * and returns a map of genealogical comparisons populated with its contents.
  */
-unordered_map<string, genealogical_comparison> get_primary_witness_genealogical_comparisons(sqlite3 * input_db, const string & _primary_wit_id) {
-	unordered_map<string, genealogical_comparison> primary_witness_genealogical_comparisons = unordered_map<string, genealogical_comparison>();
-	int rc; //to store SQLite macros
-	sqlite3_stmt * select_from_genealogical_comparisons_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM GENEALOGICAL_COMPARISONS WHERE PRIMARY_WIT=?", -1, & select_from_genealogical_comparisons_stmt, 0);
-	sqlite3_bind_text(select_from_genealogical_comparisons_stmt, 1, _primary_wit_id.c_str(), -1, SQLITE_STATIC);
-	rc = sqlite3_step(select_from_genealogical_comparisons_stmt);
-	while (rc == SQLITE_ROW) {
-		genealogical_comparison comp;
-		string primary_wit_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_genealogical_comparisons_stmt, 0)));
-		string secondary_wit_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_genealogical_comparisons_stmt, 1)));
-		int agreements_bytes = sqlite3_column_bytes(select_from_genealogical_comparisons_stmt, 2);
-		const char * agreements_buf = reinterpret_cast<const char *>(sqlite3_column_blob(select_from_genealogical_comparisons_stmt, 2));
-		Roaring agreements = Roaring::readSafe(agreements_buf, agreements_bytes);
-		comp.agreements = agreements;
-		int explained_bytes = sqlite3_column_bytes(select_from_genealogical_comparisons_stmt, 3);
-		const char * explained_buf = reinterpret_cast<const char *>(sqlite3_column_blob(select_from_genealogical_comparisons_stmt, 3));
-		Roaring explained = Roaring::readSafe(explained_buf, explained_bytes);
-		comp.explained = explained;
-		float cost = float(sqlite3_column_double(select_from_genealogical_comparisons_stmt, 4));
-		comp.cost = cost;
-		primary_witness_genealogical_comparisons[secondary_wit_id] = comp;
-		rc = sqlite3_step(select_from_genealogical_comparisons_stmt);
-	}
-	sqlite3_finalize(select_from_genealogical_comparisons_stmt);
-	return primary_witness_genealogical_comparisons;
+unordered_map<string, genealogical_comparison> get_primary_witness_genealogical_comparisons(const genealogical_cache & cache, const string & _primary_wit_id) {
+	return cache.get_genealogical_comparisons(_primary_wit_id);
 }
 
 /**
- * Retrieves rows corresponding to the each secondary witness's genealogical comparisons relative to itself and the given primary witness
- * from the GENEALOGICAL_COMPARISONS table of the given SQLite database
+ * Retrieves each secondary witness's genealogical comparisons relative to itself and the given primary witness
+ * from the given binary genealogical cache
  * and returns a map of genealogical comparison maps populated with its contents.
  */
-unordered_map<string, unordered_map<string, genealogical_comparison>> get_secondary_witness_genealogical_comparisons(sqlite3 * input_db, const string & _primary_wit_id) {
+unordered_map<string, unordered_map<string, genealogical_comparison>> get_secondary_witness_genealogical_comparisons(const genealogical_cache & cache, const string & _primary_wit_id) {
 	unordered_map<string, unordered_map<string, genealogical_comparison>> secondary_witness_genealogical_comparisons = unordered_map<string, unordered_map<string, genealogical_comparison>>();
-	int rc; //to store SQLite macros
-	sqlite3_stmt * select_from_genealogical_comparisons_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM GENEALOGICAL_COMPARISONS WHERE (PRIMARY_WIT=SECONDARY_WIT) <> (SECONDARY_WIT=?)", -1, & select_from_genealogical_comparisons_stmt, 0);
-	sqlite3_bind_text(select_from_genealogical_comparisons_stmt, 1, _primary_wit_id.c_str(), -1, SQLITE_STATIC);
-	rc = sqlite3_step(select_from_genealogical_comparisons_stmt);
-	while (rc == SQLITE_ROW) {
-		genealogical_comparison comp;
-		string primary_wit_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_genealogical_comparisons_stmt, 0)));
-		//Check if there is already a comparison map for this witness in the output map, and create one if not:
-		if (secondary_witness_genealogical_comparisons.find(primary_wit_id) == secondary_witness_genealogical_comparisons.end()) {
-			secondary_witness_genealogical_comparisons[primary_wit_id] = unordered_map<string, genealogical_comparison>();
+	int primary_wit_ind = cache.get_witness_index(_primary_wit_id);
+	if (primary_wit_ind < 0) {
+		return secondary_witness_genealogical_comparisons;
+	}
+	const vector<string> & wit_ids = cache.get_witness_ids();
+	for (unsigned int wit_ind = 0; wit_ind < wit_ids.size(); wit_ind++) {
+		if (int(wit_ind) == primary_wit_ind) {
+			continue;
+		}
+		unordered_map<string, genealogical_comparison> comps = unordered_map<string, genealogical_comparison>();
+		if (cache.has_genealogical_comparison(wit_ind, wit_ind)) {
+			comps[wit_ids[wit_ind]] = cache.get_genealogical_comparison(wit_ind, wit_ind);
+		}
+		if (cache.has_genealogical_comparison(wit_ind, primary_wit_ind)) {
+			comps[_primary_wit_id] = cache.get_genealogical_comparison(wit_ind, primary_wit_ind);
+		}
+		if (!comps.empty()) {
+			secondary_witness_genealogical_comparisons[wit_ids[wit_ind]] = comps;
 		}
-		string secondary_wit_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_genealogical_comparisons_stmt, 1)));
-		int agreements_bytes = sqlite3_column_bytes(select_from_genealogical_comparisons_stmt, 2);
-		const char * agreements_buf = reinterpret_cast<const char *>(sqlite3_column_blob(select_from_genealogical_comparisons_stmt, 2));
-		Roaring agreements = Roaring::readSafe(agreements_buf, agreements_bytes);
-		comp.agreements = agreements;
-		int explained_bytes = sqlite3_column_bytes(select_from_genealogical_comparisons_stmt, 3);
-		const char * explained_buf = reinterpret_cast<const char *>(sqlite3_column_blob(select_from_genealogical_comparisons_stmt, 3));
-		Roaring explained = Roaring::readSafe(explained_buf, explained_bytes);
-		comp.explained = explained;
-		float cost = float(sqlite3_column_double(select_from_genealogical_comparisons_stmt, 4));
-		comp.cost = cost;
-		secondary_witness_genealogical_comparisons.at(primary_wit_id)[secondary_wit_id] = comp;
-		rc = sqlite3_step(select_from_genealogical_comparisons_stmt);
 	}
-	sqlite3_finalize(select_from_genealogical_comparisons_stmt);
 	return secondary_witness_genealogical_comparisons;
 }
 
-/**
- * Determines if the VARIATION_UNITS table of the given SQLite database
- * contains a row with the given variation unit ID.
- */
-bool variation_unit_id_exists(sqlite3 * input_db, const string & vu_id) {
-	bool variation_unit_id_exists = false;
-	int rc; //to store SQLite macros
-	sqlite3_stmt * select_from_variation_units_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM VARIATION_UNITS WHERE VARIATION_UNIT=?", -1, & select_from_variation_units_stmt, 0);
-	sqlite3_bind_text(select_from_variation_units_stmt, 1, vu_id.c_str(), -1, SQLITE_STATIC);
-	rc = sqlite3_step(select_from_variation_units_stmt);
-	variation_unit_id_exists = (rc == SQLITE_ROW) ? true : false;
-	sqlite3_finalize(select_from_variation_units_stmt);
-	return variation_unit_id_exists;
-}
-
-/**
- * Retrieves all rows from the VARIATION_UNITS table of the given SQLite database
- * and returns a vector of variation_unit IDs populated with its contents.
- */
-vector<string> get_variation_unit_ids(sqlite3 * input_db) {
-	vector<string> variation_unit_ids = vector<string>();
-	int rc; //to store SQLite macros
-	sqlite3_stmt * select_from_variation_units_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM VARIATION_UNITS ORDER BY ROWID", -1, & select_from_variation_units_stmt, 0);
-	rc = sqlite3_step(select_from_variation_units_stmt);
-	while (rc == SQLITE_ROW) {
-		string vu_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_variation_units_stmt, 0)));
-		variation_unit_ids.push_back(vu_id);
-		rc = sqlite3_step(select_from_variation_units_stmt);
-	}
-	sqlite3_finalize(select_from_variation_units_stmt);
-	return variation_unit_ids;
-}
-
-/**
- * Returns the label for the given variation unit ID from the VARIATION_UNITS table of the given SQLite database.
- */
-string get_variation_unit_label(sqlite3 * input_db, const string & vu_id) {
-	string variation_unit_label = string();
-	int rc; //to store SQLite macros
-	sqlite3_stmt * select_from_variation_units_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM VARIATION_UNITS WHERE VARIATION_UNIT=?", -1, & select_from_variation_units_stmt, 0);
-	sqlite3_bind_text(select_from_variation_units_stmt, 1, vu_id.c_str(), -1, SQLITE_STATIC);
-	rc = sqlite3_step(select_from_variation_units_stmt);
-	while (rc == SQLITE_ROW) {
-		variation_unit_label = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_variation_units_stmt, 1)));
-		break;
-	}
-	sqlite3_finalize(select_from_variation_units_stmt);
-	return variation_unit_label;
-}
-
 /**
  * Given primary witness ID, a variation unit label, a list of readings supported by the primary witness,
  * a filter reading, and a list of witness comparisons (assumed to be sorted in decreasing order of agreements),
@@ -315,15 +173,17 @@ int main(int argc, char* argv[]) {
 	//Read in the command-line options:
 	string filter_reading = string();
 	string input_db_name = string();
+	string binary_cache_name = string();
 	string primary_wit_id = string();
 	string vu_id = string();
 	try {
 		cxxopts::Options options("find_relatives", "Get a table of genealogical relationships between the witness with the given ID and other witnesses at a given passage, as specified by the user.\nOptionally, the user can optionally specify a reading ID for the given passage, in which case the output will be restricted to the witnesses preserving that reading.");
-		options.custom_help("[-h] [-r reading] input_db witness passage");
+		options.custom_help("[-h] [-r reading] [--binary-cache path] input_db witness passage");
 		//options.positional_help("").show_positional_help();
 		options.add_options("")
 				("h,help", "print this help")
-				("r,reading", "ID of desired variant reading", cxxopts::value<string>());
+				("r,reading", "ID of desired variant reading", cxxopts::value<string>())
+				("binary-cache", "read genealogical relationships from the binary cache file at this path (as written by populate_db) instead of from the database", cxxopts::value<string>());
 		options.add_options("positional")
 				("input_db", "genealogical cache database", cxxopts::value<string>())
 				("witness", "ID of the witness whose relatives are desired, as found in its <witness> element in the XML file", cxxopts::value<string>())
@@ -335,6 +195,9 @@ int main(int argc, char* argv[]) {
 			cout << options.help({""}) << endl;
 			exit(0);
 		}
+		if (args.count("binary-cache")) {
+			binary_cache_name = args["binary-cache"].as<string>();
+		}
 		//Parse the optional arguments:
 		if (args.count("r")) {
 			filter_reading = args["r"].as<string>();
@@ -362,26 +225,62 @@ int main(int argc, char* argv[]) {
 		cerr << "Error opening database " << input_db_name << ": " << sqlite3_errmsg(input_db) << endl;
 		exit(1);
 	}
+	cache_reader reader(input_db);
+	if (!reader.is_open()) {
+		cerr << "Error reading database " << input_db_name << ": " << sqlite3_errmsg(input_db) << endl;
+		exit(1);
+	}
 	//Check if the primary witness ID is in the database:
-	bool primary_wit_exists = witness_id_exists(input_db, primary_wit_id);
+	bool primary_wit_exists = reader.witness_id_exists(primary_wit_id);
 	if (!primary_wit_exists) {
 		cerr << "Error: The WITNESSES table has no rows with WITNESS = " << primary_wit_id << "." << endl;
 		exit(1);
 	}
 	cout << "Retrieving genealogical relationships for witnesses..." << endl;
 	//Retrieve a list of all witness IDs:
-	list<string> list_wit = get_witness_ids(input_db);
-	//Retrieve a map of reading support for this variation unit:
-	unordered_map<string, list<string>> reading_support = get_reading_support(input_db, vu_id);
-	//Retrieve all necessary genealogical comparisons relative to the primary witness:
-	unordered_map<string, genealogical_comparison> primary_witness_genealogical_comparisons = get_primary_witness_genealogical_comparisons(input_db, primary_wit_id);
-	//Retrieve all necessary genealogical comparisons relative to the secondary witnesses:
-	unordered_map<string, unordered_map<string, genealogical_comparison>> secondary_witness_genealogical_comparisons = get_secondary_witness_genealogical_comparisons(input_db, primary_wit_id);
+	list<string> list_wit = list<string>(reader.get_witness_ids().begin(), reader.get_witness_ids().end());
+	//Retrieve the rankings of all secondary witnesses relative to the primary witness from the POTENTIAL_ANCESTORS table, if there is one;
+	//otherwise, calculate them from the genealogical comparisons relative to the primary witness and the secondary witnesses,
+	//read either from the binary cache, if one was specified, or from the database:
+	list<potential_ancestor_ranking> rankings;
+	if (binary_cache_name.empty() && reader.has_potential_ancestor_rankings()) {
+		rankings = reader.get_potential_ancestor_rankings(primary_wit_id);
+	}
+	else {
+		unordered_map<string, genealogical_comparison> primary_witness_genealogical_comparisons;
+		unordered_map<string, unordered_map<string, genealogical_comparison>> secondary_witness_genealogical_comparisons;
+		if (binary_cache_name.empty()) {
+			primary_witness_genealogical_comparisons = reader.get_genealogical_comparisons(primary_wit_id);
+			secondary_witness_genealogical_comparisons = reader.get_secondary_witness_genealogical_comparisons(primary_wit_id);
+		}
+		else {
+			genealogical_cache cache(binary_cache_name);
+			if (!cache.is_open()) {
+				cerr << "Error opening binary cache " << binary_cache_name << ": not a valid genealogical cache file." << endl;
+				exit(1);
+			}
+			primary_witness_genealogical_comparisons = get_primary_witness_genealogical_comparisons(cache, primary_wit_id);
+			secondary_witness_genealogical_comparisons = get_secondary_witness_genealogical_comparisons(cache, primary_wit_id);
+		}
+		//Initialize the primary witness using its genealogical comparisons with all witnesses,
+		//and the secondary witnesses using their genealogical comparisons with just themselves and the primary witness:
+		witness primary_wit = witness(primary_wit_id, primary_witness_genealogical_comparisons);
+		list<witness> witnesses = list<witness>();
+		for (string wit_id : list_wit) {
+			if (wit_id == primary_wit_id) {
+				witnesses.push_back(primary_wit);
+			}
+			else {
+				witnesses.push_back(witness(wit_id, secondary_witness_genealogical_comparisons.at(wit_id)));
+			}
+		}
+		rankings = primary_wit.get_potential_ancestor_rankings(witnesses);
+	}
 	cout << "Retrieving variation units..." << endl;
 	//Retrieve a vector of all variation unit IDs:
-	vector<string> vu_ids = get_variation_unit_ids(input_db);
+	const vector<string> & vu_ids = reader.get_variation_unit_ids();
 	//Check if the input passage is a variation unit ID in the database:
-	bool variation_unit_matched = variation_unit_id_exists(input_db, vu_id);
+	bool variation_unit_matched = reader.variation_unit_id_exists(vu_id);
 	//If no match is found, the try to treat the ID as an index:
 	if (!variation_unit_matched) {
 		bool is_number = true;
@@ -406,69 +305,36 @@ int main(int argc, char* argv[]) {
 		vu_id = vu_ids[vu_ind];
 	}
 	//Get the variation unit's label:
-	string vu_label = get_variation_unit_label(input_db, vu_id);
+	unsigned int vu_ind = reader.get_variation_unit_index(vu_id);
+	string vu_label = reader.get_variation_unit_labels()[vu_ind];
+	//Retrieve a map of reading support for this variation unit:
+	unordered_map<string, list<string>> reading_support = reader.get_reading_support(vu_ind);
 	//Close the database:
 	cout << "Closing database..." << endl;
+	reader.close();
 	sqlite3_close(input_db);
 	cout << "Database closed." << endl;
-	//Now calculate the comparison metrics between the primary witness and all of the secondary witnesses:
+	//Now calculate the comparison metrics between the primary witness and all of the secondary witnesses,
+	//which are already sorted from highest number of agreements to lowest:
 	list<witness_comparison> comparisons = list<witness_comparison>();
-	for (string secondary_wit_id : list_wit) {
-		//Skip the primary witness:
-		if (secondary_wit_id == primary_wit_id) {
-			continue;
-		}
-		genealogical_comparison primary_primary_comp = primary_witness_genealogical_comparisons.at(primary_wit_id);
-		genealogical_comparison primary_secondary_comp = primary_witness_genealogical_comparisons.at(secondary_wit_id);
-		genealogical_comparison secondary_primary_comp = secondary_witness_genealogical_comparisons.at(secondary_wit_id).at(primary_wit_id);
-		genealogical_comparison secondary_secondary_comp = secondary_witness_genealogical_comparisons.at(secondary_wit_id).at(secondary_wit_id);
-		Roaring primary_extant = primary_primary_comp.explained;
-		Roaring secondary_extant = secondary_secondary_comp.explained;
-		Roaring mutually_extant = primary_extant & secondary_extant;
-		Roaring agreements = primary_secondary_comp.agreements;
-		Roaring primary_explained_by_secondary = primary_secondary_comp.explained;
-		Roaring secondary_explained_by_primary = secondary_primary_comp.explained;
+	for (const potential_ancestor_ranking & ranking : rankings) {
 		witness_comparison comparison;
-		comparison.id = secondary_wit_id;
+		comparison.id = ranking.id;
 		comparison.rdgs = list<string>();
-		if (reading_support.find(secondary_wit_id) != reading_support.end()) {
-			comparison.rdgs = reading_support[secondary_wit_id];
+		if (reading_support.find(ranking.id) != reading_support.end()) {
+			comparison.rdgs = reading_support[ranking.id];
 		}
-		comparison.pass = mutually_extant.cardinality();
-		comparison.eq = agreements.cardinality();
-		comparison.prior = (secondary_explained_by_primary ^ agreements).cardinality();
-		comparison.posterior = (primary_explained_by_secondary ^ agreements).cardinality();
+		comparison.pass = ranking.pass;
+		comparison.eq = ranking.agreements;
+		comparison.prior = ranking.prior;
+		comparison.posterior = ranking.posterior;
 		comparison.norel = comparison.pass - comparison.eq - comparison.prior - comparison.posterior;
 		comparison.perc = comparison.pass > 0 ? (100 * float(comparison.eq) / float(comparison.pass)) : 0;
 		comparison.dir = comparison.prior > comparison.posterior ? -1 : (comparison.posterior > comparison.prior ? 1 : 0);
-		comparison.cost = comparison.dir < 0 ? -1 : primary_secondary_comp.cost;
+		comparison.nr = ranking.rank;
+		comparison.cost = comparison.dir < 0 ? -1 : ranking.cost;
 		comparisons.push_back(comparison);
 	}
-	//Sort the list of comparisons from highest number of agreements to lowest:
-	comparisons.sort([](const witness_comparison & wc1, const witness_comparison & wc2) {
-		return wc1.eq > wc2.eq;
-	});
-	//Pass through the sorted list of comparisons to assign ancestral ranks:
-	int nr = 0;
-	int nr_value = numeric_limits<int>::max();
-	for (witness_comparison & comparison : comparisons) {
-		//Only assign positive ancestral ranks to witnesses prior to this one:
-		if (comparison.dir == 1) {
-			//Only increment the rank if the number of agreements is lower than that of the previous potential ancestor:
-			if (comparison.eq < nr_value) {
-				nr_value = comparison.eq;
-				nr++;
-			}
-			comparison.nr = nr;
-
-		}
-		else if (comparison.dir == 0) {
-			comparison.nr = 0;
-		}
-		else {
-			comparison.nr = -1;
-		}
-	}
 	list<string> primary_wit_readings = reading_support.find(primary_wit_id) != reading_support.end() ? reading_support.at(primary_wit_id) : list<string>();
 	print_relatives(primary_wit_id, vu_label, primary_wit_readings, filter_reading, comparisons);
 	exit(0);
@@ -0,0 +1,398 @@
+/*
+ * genealogical_cache.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: jjmccollum
+ */
+
+#ifdef _WIN32
+	#include <malloc.h> //for _aligned_malloc() support
+#else
+	#include <sys/mman.h> //for mmap() support
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+#include <string>
+#include <list>
+#include <vector>
+#include <unordered_map>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "roaring.hh"
+#include "witness.h"
+#include "genealogical_cache.h"
+
+using namespace std;
+
+//Define data structure for the header of a binary genealogical cache:
+struct genealogical_cache_header {
+	char magic[8];
+	uint32_t byte_order; //the frozen serialization of bitmaps depends on the byte order of the platform that wrote it
+	uint32_t n_witnesses;
+	uint64_t table_offset;
+	uint64_t file_size;
+};
+
+//Define the values that identify a binary genealogical cache:
+static const char GENEALOGICAL_CACHE_MAGIC[8] = {'O', 'C', 'B', 'G', 'M', 'G', 'C', '1'};
+static const uint32_t GENEALOGICAL_CACHE_BYTE_ORDER = 0x01020304;
+
+//Define the alignment that frozen views require of their buffers:
+static const uint64_t FROZEN_ALIGNMENT = 32;
+
+/**
+ * Constructs a writer for a binary genealogical cache at the given path for the given list of witnesses.
+ * The header and witness IDs are written immediately, and the offset table is written when the writer is closed.
+ */
+genealogical_cache_writer::genealogical_cache_writer(const string & path, const list<string> & list_wit) {
+	file = fopen(path.c_str(), "wb");
+	if (file == NULL) {
+		return;
+	}
+	unsigned int n_witnesses = list_wit.size();
+	entries = vector<genealogical_cache_entry>(n_witnesses * n_witnesses);
+	memset(entries.data(), 0, entries.size() * sizeof(genealogical_cache_entry));
+	//Write a placeholder header, to be filled in when the writer is closed:
+	genealogical_cache_header header;
+	memset(& header, 0, sizeof(header));
+	bool ok = write_bytes(& header, sizeof(header));
+	//Then write the length and contents of each witness ID:
+	for (const string & wit_id : list_wit) {
+		unsigned int wit_ind = wit_inds.size();
+		wit_inds[wit_id] = wit_ind;
+		uint32_t length = wit_id.size();
+		ok = ok && write_bytes(& length, sizeof(length)) && write_bytes(wit_id.data(), wit_id.size());
+	}
+	ok = ok && write_padding();
+	if (!ok) {
+		fclose(file);
+		file = NULL;
+	}
+}
+
+/**
+ * Default destructor for genealogical_cache_writer.
+ * If the writer has not been closed, then the file it was writing is left incomplete.
+ */
+genealogical_cache_writer::~genealogical_cache_writer() {
+	if (file != NULL) {
+		fclose(file);
+	}
+}
+
+/**
+ * Writes the given bytes to the file and advances the current position.
+ * The return value is false if the write fails.
+ */
+bool genealogical_cache_writer::write_bytes(const void * bytes, size_t n_bytes) {
+	if (n_bytes > 0 && fwrite(bytes, 1, n_bytes, file) != n_bytes) {
+		return false;
+	}
+	position += n_bytes;
+	return true;
+}
+
+/**
+ * Writes zeroes to the file until the current position is aligned for a frozen bitmap.
+ */
+bool genealogical_cache_writer::write_padding() {
+	static const char zeroes[FROZEN_ALIGNMENT] = {0};
+	return write_bytes(zeroes, (FROZEN_ALIGNMENT - position % FROZEN_ALIGNMENT) % FROZEN_ALIGNMENT);
+}
+
+/**
+ * Writes the given bitmap to the file in frozen serialization, followed by padding,
+ * and stores its offset and size in the given references.
+ */
+bool genealogical_cache_writer::write_bitmap(const Roaring & bitmap, uint64_t & offset, uint32_t & size) {
+	offset = position;
+	size = roaring_bitmap_frozen_size_in_bytes(& bitmap.roaring);
+	buffer.resize(size);
+	roaring_bitmap_frozen_serialize(& bitmap.roaring, buffer.data());
+	return write_bytes(buffer.data(), size) && write_padding();
+}
+
+/**
+ * Returns a flag indicating whether the writer's file was opened successfully and has not yet been closed.
+ */
+bool genealogical_cache_writer::is_open() const {
+	return file != NULL;
+}
+
+/**
+ * Writes the genealogical comparison of the secondary witness with the given ID relative to the primary witness with the given ID.
+ * The return value is false if either witness is not in the cache or if the write fails.
+ */
+bool genealogical_cache_writer::add(const string & primary_wit_id, const string & secondary_wit_id, const genealogical_comparison & comp) {
+	if (file == NULL || wit_inds.find(primary_wit_id) == wit_inds.end() || wit_inds.find(secondary_wit_id) == wit_inds.end()) {
+		return false;
+	}
+	genealogical_cache_entry & entry = entries[wit_inds.at(primary_wit_id) * wit_inds.size() + wit_inds.at(secondary_wit_id)];
+	if (!write_bitmap(*comp.agreements, entry.agreements_offset, entry.agreements_size) || !write_bitmap(*comp.explained, entry.explained_offset, entry.explained_size)) {
+		return false;
+	}
+	entry.cost = comp.cost;
+	entry.present = 1;
+	return true;
+}
+
+/**
+ * Writes the offset table, fills in the header, and closes the file.
+ * The return value is false if any of these writes fail.
+ */
+bool genealogical_cache_writer::close() {
+	if (file == NULL) {
+		return false;
+	}
+	genealogical_cache_header header;
+	memset(& header, 0, sizeof(header));
+	memcpy(header.magic, GENEALOGICAL_CACHE_MAGIC, sizeof(header.magic));
+	header.byte_order = GENEALOGICAL_CACHE_BYTE_ORDER;
+	header.n_witnesses = wit_inds.size();
+	header.table_offset = position;
+	bool ok = write_bytes(entries.data(), entries.size() * sizeof(genealogical_cache_entry));
+	header.file_size = position;
+	ok = ok && fseek(file, 0, SEEK_SET) == 0 && fwrite(& header, 1, sizeof(header), file) == sizeof(header);
+	ok = (fclose(file) == 0) && ok;
+	file = NULL;
+	return ok;
+}
+
+/**
+ * Default constructor for genealogical_cache.
+ */
+genealogical_cache::genealogical_cache() {
+
+}
+
+/**
+ * Constructs a genealogical cache by memory-mapping the binary genealogical cache file at the given path.
+ * If the file cannot be opened or is not a valid cache, then the cache will not be open.
+ */
+genealogical_cache::genealogical_cache(const string & path) {
+	#ifdef _WIN32
+		//Without mmap() support, read the file into memory instead:
+		FILE * file = fopen(path.c_str(), "rb");
+		if (file == NULL) {
+			return;
+		}
+		fseek(file, 0, SEEK_END);
+		long file_size = ftell(file);
+		fseek(file, 0, SEEK_SET);
+		if (file_size <= 0) {
+			fclose(file);
+			return;
+		}
+		size = file_size;
+		char * buffer = (char *) _aligned_malloc(size, FROZEN_ALIGNMENT);
+		if (buffer == NULL || fread(buffer, 1, size, file) != size) {
+			_aligned_free(buffer);
+			fclose(file);
+			return;
+		}
+		fclose(file);
+		data = buffer;
+	#else
+		int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			return;
+		}
+		struct stat st;
+		if (fstat(fd, & st) != 0 || st.st_size <= 0) {
+			::close(fd);
+			return;
+		}
+		size = st.st_size;
+		void * addr = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+		::close(fd);
+		if (addr == MAP_FAILED) {
+			return;
+		}
+		data = (const char *) addr;
+	#endif
+	mapped = true;
+	//Validate the header:
+	genealogical_cache_header header;
+	if (size < sizeof(header)) {
+		close();
+		return;
+	}
+	memcpy(& header, data, sizeof(header));
+	if (memcmp(header.magic, GENEALOGICAL_CACHE_MAGIC, sizeof(header.magic)) != 0 || header.byte_order != GENEALOGICAL_CACHE_BYTE_ORDER || header.file_size != size) {
+		close();
+		return;
+	}
+	uint64_t n_entries = uint64_t(header.n_witnesses) * header.n_witnesses;
+	if (header.table_offset % FROZEN_ALIGNMENT != 0 || header.table_offset > size || (size - header.table_offset) / sizeof(genealogical_cache_entry) < n_entries) {
+		close();
+		return;
+	}
+	//Then read the witness IDs:
+	uint64_t offset = sizeof(header);
+	wit_ids = vector<string>();
+	wit_ids.reserve(header.n_witnesses);
+	for (uint32_t i = 0; i < header.n_witnesses; i++) {
+		uint32_t length;
+		if (offset + sizeof(length) > header.table_offset) {
+			close();
+			return;
+		}
+		memcpy(& length, data + offset, sizeof(length));
+		offset += sizeof(length);
+		if (offset + length > header.table_offset) {
+			close();
+			return;
+		}
+		string wit_id = string(data + offset, length);
+		offset += length;
+		wit_inds[wit_id] = wit_ids.size();
+		wit_ids.push_back(wit_id);
+	}
+	//Then check that every bitmap in the offset table lies between the witness IDs and the table:
+	entries = (const genealogical_cache_entry *) (data + header.table_offset);
+	for (uint64_t i = 0; i < n_entries; i++) {
+		const genealogical_cache_entry & entry = entries[i];
+		if (!entry.present) {
+			continue;
+		}
+		if (entry.agreements_offset < offset || entry.agreements_offset + entry.agreements_size > header.table_offset || entry.explained_offset < offset || entry.explained_offset + entry.explained_size > header.table_offset) {
+			close();
+			return;
+		}
+	}
+	views = vector<const roaring_bitmap_t *>(2 * n_entries, NULL);
+}
+
+/**
+ * Default destructor for genealogical_cache.
+ */
+genealogical_cache::~genealogical_cache() {
+	close();
+}
+
+/**
+ * Frees any frozen views and unmaps the file.
+ */
+void genealogical_cache::close() {
+	for (const roaring_bitmap_t * view : views) {
+		if (view != NULL) {
+			roaring_bitmap_free(view);
+		}
+	}
+	views.clear();
+	if (mapped) {
+		#ifdef _WIN32
+			_aligned_free((void *) data);
+		#else
+			munmap((void *) data, size);
+		#endif
+	}
+	data = NULL;
+	size = 0;
+	mapped = false;
+	wit_ids.clear();
+	wit_inds.clear();
+	entries = NULL;
+	return;
+}
+
+/**
+ * Returns the frozen view of the bitmap at the given offset and size, creating it if it has not been accessed before.
+ * The return value is NULL if the bytes there are not a valid frozen bitmap.
+ */
+const roaring_bitmap_t * genealogical_cache::get_view(uint64_t offset, uint32_t n_bytes, size_t view_ind) const {
+	if (views[view_ind] == NULL) {
+		views[view_ind] = roaring_bitmap_frozen_view(data + offset, n_bytes);
+	}
+	return views[view_ind];
+}
+
+/**
+ * Returns a flag indicating whether the cache file was opened and validated successfully.
+ */
+bool genealogical_cache::is_open() const {
+	return entries != NULL;
+}
+
+/**
+ * Returns the IDs of the witnesses in this cache, in the order of their indices.
+ */
+const vector<string> & genealogical_cache::get_witness_ids() const {
+	return wit_ids;
+}
+
+/**
+ * Returns the index of the witness with the given ID in this cache, or -1 if the cache does not contain that witness.
+ */
+int genealogical_cache::get_witness_index(const string & wit_id) const {
+	unordered_map<string, unsigned int>::const_iterator it = wit_inds.find(wit_id);
+	return it == wit_inds.end() ? -1 : int(it->second);
+}
+
+/**
+ * Returns a flag indicating whether the witness at the second index was compared with the witness at the first index.
+ */
+bool genealogical_cache::has_genealogical_comparison(unsigned int wit_ind, unsigned int other_wit_ind) const {
+	return entries[wit_ind * wit_ids.size() + other_wit_ind].present != 0;
+}
+
+/**
+ * Returns a frozen view of the agreements bitmap of the witness at the second index relative to the witness at the first index.
+ * The view is owned by the cache and remains valid for as long as the cache is open.
+ */
+const roaring_bitmap_t * genealogical_cache::get_agreements(unsigned int wit_ind, unsigned int other_wit_ind) const {
+	size_t entry_ind = wit_ind * wit_ids.size() + other_wit_ind;
+	return get_view(entries[entry_ind].agreements_offset, entries[entry_ind].agreements_size, 2 * entry_ind);
+}
+
+/**
+ * Returns a frozen view of the explained bitmap of the witness at the second index relative to the witness at the first index.
+ * The view is owned by the cache and remains valid for as long as the cache is open.
+ */
+const roaring_bitmap_t * genealogical_cache::get_explained(unsigned int wit_ind, unsigned int other_wit_ind) const {
+	size_t entry_ind = wit_ind * wit_ids.size() + other_wit_ind;
+	return get_view(entries[entry_ind].explained_offset, entries[entry_ind].explained_size, 2 * entry_ind + 1);
+}
+
+/**
+ * Returns the cost of the witness at the second index relative to the witness at the first index.
+ */
+float genealogical_cache::get_cost(unsigned int wit_ind, unsigned int other_wit_ind) const {
+	return entries[wit_ind * wit_ids.size() + other_wit_ind].cost;
+}
+
+/**
+ * Returns the genealogical comparison of the witness at the second index relative to the witness at the first index.
+ * Its bitmaps are copied from the frozen views, which only copies their containers rather than parsing them.
+ */
+genealogical_comparison genealogical_cache::get_genealogical_comparison(unsigned int wit_ind, unsigned int other_wit_ind) const {
+	genealogical_comparison comp;
+	const roaring_bitmap_t * agreements = get_agreements(wit_ind, other_wit_ind);
+	comp.agreements = agreements != NULL ? make_shared<const Roaring>(Roaring(roaring_bitmap_copy(agreements))) : make_shared<const Roaring>();
+	const roaring_bitmap_t * explained = get_explained(wit_ind, other_wit_ind);
+	comp.explained = explained != NULL ? make_shared<const Roaring>(Roaring(roaring_bitmap_copy(explained))) : make_shared<const Roaring>();
+	comp.cost = get_cost(wit_ind, other_wit_ind);
+	return comp;
+}
+
+/**
+ * Returns a map of the genealogical comparisons of all witnesses relative to the witness with the given ID, keyed by witness ID.
+ * If the cache does not contain that witness, then the map will be empty.
+ */
+unordered_map<string, genealogical_comparison> genealogical_cache::get_genealogical_comparisons(const string & wit_id) const {
+	unordered_map<string, genealogical_comparison> comps = unordered_map<string, genealogical_comparison>();
+	int wit_ind = get_witness_index(wit_id);
+	if (wit_ind < 0) {
+		return comps;
+	}
+	for (unsigned int other_wit_ind = 0; other_wit_ind < wit_ids.size(); other_wit_ind++) {
+		if (has_genealogical_comparison(wit_ind, other_wit_ind)) {
+			comps[wit_ids[other_wit_ind]] = get_genealogical_comparison(wit_ind, other_wit_ind);
+		}
+	}
+	return comps;
+}
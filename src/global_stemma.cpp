@@ -8,6 +8,7 @@
 #include <iostream>
 #include <string>
 #include <list>
+#include <vector>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -53,7 +54,7 @@ global_stemma::global_stemma(const list<witness> & witnesses) {
 			continue;
 		}
 		//Get the number of extant passages for this witness:
-		unsigned int extant = wit.get_genealogical_comparison_for_witness(wit_id).explained.cardinality();
+		unsigned int extant = wit.get_genealogical_comparison_for_witness(wit_id).explained->cardinality();
 		//Now, add an edge for each ancestor:
 		for (string ancestor_id : global_stemma_ancestor_ids) {
 			witness ancestor = witnesses_by_id.at(ancestor_id);
@@ -61,12 +62,27 @@ global_stemma::global_stemma(const list<witness> & witnesses) {
 			global_stemma_edge e;
 			e.ancestor = ancestor_id;
 			e.descendant = wit_id;
-			e.weight = float(comp.agreements.cardinality()) / float(extant);
+			e.weight = float(comp.agreements->cardinality()) / float(extant);
 			graph.edges.push_back(e);
 		}
 	}
 }
 
+/**
+ * Constructs a global stemma from a list of witness IDs and the edges between them,
+ * as read from a cache of the witnesses' optimal substemmata.
+ */
+global_stemma::global_stemma(const vector<string> & list_wit, const list<global_stemma_edge> & edges) {
+	graph.vertices = list<global_stemma_vertex>();
+	graph.edges = edges;
+	//Create a vertex for each witness:
+	for (string wit_id : list_wit) {
+		global_stemma_vertex v;
+		v.id = wit_id;
+		graph.vertices.push_back(v);
+	}
+}
+
 /**
  * Default destructor.
  */
@@ -9,67 +9,17 @@
 #include <iomanip>
 #include <string>
 #include <list>
-#include <queue>
+#include <vector>
 #include <set> //used instead of unordered_set because pair does not have a default hash function and readings are few enough for tree structures to be more efficient
 #include <map> //used instead of unordered_map because readings are few enough for tree structures to be more efficient
+#include <algorithm>
+#include <limits>
 
 #include "pugixml.h"
 #include "local_stemma.h"
 
 using namespace std;
 
-/**
- * Populates a given shortest paths map
- * by applying Dijkstra's algorithm to the given graph represented by an adjacency map.
- */
-void populate_shortest_paths(const map<string, list<local_stemma_edge>> & adjacency_map, map<pair<string, string>, float> & shortest_paths) {
-	//Proceed for each vertex:
-	for (pair<string, list<local_stemma_edge>> kv : adjacency_map) {
-		string s = kv.first;
-		//Initialize a min priority queue of paths proceeding from this source (which we will represent using local_stemma_edge data structures):
-		auto compare = [](local_stemma_edge e1, local_stemma_edge e2) {
-			return e1.weight > e2.weight;
-		};
-		priority_queue<local_stemma_edge, vector<local_stemma_edge>, decltype(compare)> queue = priority_queue<local_stemma_edge, vector<local_stemma_edge>, decltype(compare)>(compare);
-		local_stemma_edge p0;
-		p0.prior = s;
-		p0.posterior = s;
-		p0.weight = 0;
-		queue.push(p0);
-		//Add a shortest path of length 0 from the current source to itself:
-		shortest_paths[pair<string, string>(s, s)] = 0;
-		//Then proceed by best-first search:
-		while (!queue.empty()) {
-			//Pop the minimum-length path from the queue:
-			local_stemma_edge p = queue.top();
-			queue.pop();
-			//Get the destination vertex of this edge and the length of the path to it:
-			string u = p.posterior;
-			float p_length = p.weight;
-			//Then proceed for each edge proceeding from the destination vertex:
-			for (local_stemma_edge e : adjacency_map.at(u)) {
-				local_stemma_edge q;
-				q.prior = s;
-				q.posterior = e.posterior;
-				q.weight = p_length + e.weight;
-				//Check if the path from the source to the endpoint of this edge has already been processed:
-				pair<string, string> endpoints = pair<string, string>(q.prior, q.posterior);
-				if (shortest_paths.find(endpoints) == shortest_paths.end()) {
-					//If it hasn't, then add its length to the shortest paths map:
-					shortest_paths[endpoints] = q.weight;
-					//Then add the path itself to the queue:
-					queue.push(q);
-				}
-				else {
-					//If it has, then update its length in the shortest paths map if necessary:
-					shortest_paths[endpoints] = min(shortest_paths.at(endpoints), q.weight);
-				}
-			}
-		}
-	}
-	return;
-}
-
 /**
  * Default constructor.
  */
@@ -83,7 +33,16 @@ local_stemma::local_stemma() {
  * A set of trivial readings may also be specified, whose in-edges will be assigned weights of 0.
  * A set of dropped readings may also be specified, whose vertices and edges will not be added.
  */
-local_stemma::local_stemma(const pugi::xml_node & xml, const string & vu_id, const string & vu_label, const set<pair<string, string>> & split_pairs, const set<string> & trivial_readings, const set<string> & dropped_readings) {
+local_stemma::local_stemma(const pugi::xml_node & xml, const string & vu_id, const string & vu_label, const set<pair<string, string>> & split_pairs, const set<string> & trivial_readings, const set<string> & dropped_readings) : local_stemma(xml, vu_id, vu_label, vector<string>(), split_pairs, trivial_readings, dropped_readings) {
+
+}
+
+/**
+ * Constructs a local stemma from a <graph/> XML element using the parent variation_unit's ID, label, and reading IDs.
+ * The given readings are assigned the first indices in the local stemma, in order, so that they can be referred to by the same indices as in the variation unit.
+ * Split reading pairs, trivial readings, and dropped readings are handled as in the constructor above.
+ */
+local_stemma::local_stemma(const pugi::xml_node & xml, const string & vu_id, const string & vu_label, const vector<string> & readings, const set<pair<string, string>> & split_pairs, const set<string> & trivial_readings, const set<string> & dropped_readings) {
 	graph.vertices = list<local_stemma_vertex>();
 	graph.edges = list<local_stemma_edge>();
 	//Set the ID:
@@ -145,17 +104,9 @@ local_stemma::local_stemma(const pugi::xml_node & xml, const string & vu_id, con
 		graph.edges.push_back(e1);
 		graph.edges.push_back(e2);
 	}
-	//Construct an adjacency map from the graph:
-	map<string, list<local_stemma_edge>> adjacency_map = map<string, list<local_stemma_edge>>();
-	for (local_stemma_vertex v: graph.vertices) {
-		adjacency_map[v.id] = list<local_stemma_edge>();
-	}
-	for (local_stemma_edge e : graph.edges) {
-		adjacency_map[e.prior].push_back(e);
-	}
-	//Now use Dijkstra's algorithm to populate the map of shortest paths:
-	shortest_paths = map<pair<string, string>, float>();
-	populate_shortest_paths(adjacency_map, shortest_paths);
+	//Index the readings, then populate the matrix of shortest paths:
+	index_readings(readings);
+	populate_shortest_paths();
 }
 
 /**
@@ -165,17 +116,9 @@ local_stemma::local_stemma(const string & _id, const string & _label, const loca
 	id = _id;
 	label = _label;
 	graph = _graph;
-	//Construct an adjacency map from the graph:
-	map<string, list<local_stemma_edge>> adjacency_map = map<string, list<local_stemma_edge>>();
-	for (local_stemma_vertex v: graph.vertices) {
-		adjacency_map[v.id] = list<local_stemma_edge>();
-	}
-	for (local_stemma_edge e : graph.edges) {
-		adjacency_map[e.prior].push_back(e);
-	}
-	//Now use Dijkstra's algorithm to populate the map of shortest paths:
-	shortest_paths = map<pair<string, string>, float>();
-	populate_shortest_paths(adjacency_map, shortest_paths);
+	//Index the readings in the order of the graph's vertices, then populate the matrix of shortest paths:
+	index_readings(vector<string>());
+	populate_shortest_paths();
 }
 
 /**
@@ -185,6 +128,83 @@ local_stemma::~local_stemma() {
 
 }
 
+/**
+ * Assigns consecutive indices to this local stemma's readings,
+ * starting with the given reading IDs in order and followed by any other vertices or edge endpoints in the graph.
+ */
+void local_stemma::index_readings(const vector<string> & readings) {
+	reading_inds = map<string, unsigned int>();
+	auto add_reading = [&](const string & r) {
+		if (reading_inds.find(r) == reading_inds.end()) {
+			reading_inds[r] = reading_inds.size();
+		}
+	};
+	for (string r : readings) {
+		add_reading(r);
+	}
+	for (local_stemma_vertex v : graph.vertices) {
+		add_reading(v.id);
+	}
+	for (local_stemma_edge e : graph.edges) {
+		add_reading(e.prior);
+		add_reading(e.posterior);
+	}
+	n_readings = reading_inds.size();
+}
+
+/**
+ * Populates the matrix of shortest path lengths between all pairs of readings using the Floyd-Warshall algorithm,
+ * and then populates the reachability bitmask of each reading from it.
+ */
+void local_stemma::populate_shortest_paths() {
+	float inf = numeric_limits<float>::infinity();
+	shortest_path_lengths = vector<float>(n_readings * n_readings, inf);
+	//Every reading in the graph has a path of length 0 to itself
+	//(readings that are not in the graph have no paths at all, not even to themselves):
+	for (local_stemma_vertex v : graph.vertices) {
+		unsigned int i = reading_inds.at(v.id);
+		shortest_path_lengths[i * n_readings + i] = 0;
+	}
+	for (local_stemma_edge e : graph.edges) {
+		unsigned int i = reading_inds.at(e.prior);
+		unsigned int j = reading_inds.at(e.posterior);
+		shortest_path_lengths[i * n_readings + i] = 0;
+		shortest_path_lengths[j * n_readings + j] = 0;
+	}
+	//Then add each edge, keeping the lightest one between any pair of readings:
+	for (local_stemma_edge e : graph.edges) {
+		unsigned int i = reading_inds.at(e.prior);
+		unsigned int j = reading_inds.at(e.posterior);
+		shortest_path_lengths[i * n_readings + j] = min(shortest_path_lengths[i * n_readings + j], e.weight);
+	}
+	//Then shorten the paths through each intermediate reading in turn:
+	for (unsigned int k = 0; k < n_readings; k++) {
+		for (unsigned int i = 0; i < n_readings; i++) {
+			float d_ik = shortest_path_lengths[i * n_readings + k];
+			if (d_ik == inf) {
+				continue;
+			}
+			for (unsigned int j = 0; j < n_readings; j++) {
+				float d_ikj = d_ik + shortest_path_lengths[k * n_readings + j];
+				if (d_ikj < shortest_path_lengths[i * n_readings + j]) {
+					shortest_path_lengths[i * n_readings + j] = d_ikj;
+				}
+			}
+		}
+	}
+	//Finally, set the bit for each reachable reading in each reading's row of the reachability bitmask:
+	unsigned int n_words = (n_readings + 63) / 64;
+	reachability = vector<uint64_t>(n_readings * n_words, 0);
+	for (unsigned int i = 0; i < n_readings; i++) {
+		for (unsigned int j = 0; j < n_readings; j++) {
+			if (shortest_path_lengths[i * n_readings + j] < inf) {
+				reachability[i * n_words + j / 64] |= uint64_t(1) << (j % 64);
+			}
+		}
+	}
+	return;
+}
+
 /**
  * Returns the ID for this local_stemma.
  */
@@ -207,25 +227,52 @@ local_stemma_graph local_stemma::get_graph() const {
 }
 
 /**
- * Return the map of shortest paths for this local_stemma's graph.
+ * Returns the number of indexed readings in this local_stemma.
+ */
+unsigned int local_stemma::get_n_readings() const {
+	return n_readings;
+}
+
+/**
+ * Given a reading ID, returns its index in this local_stemma, or -1 if there is no such reading.
  */
-map<pair<string, string>, float> local_stemma::get_shortest_paths() const {
-	return shortest_paths;
+int local_stemma::get_reading_index(const string & r) const {
+	return reading_inds.find(r) != reading_inds.end() ? int(reading_inds.at(r)) : -1;
 }
 
 /**
  * Given two reading IDs, checks if a path exists between them in the local stemma.
  */
 bool local_stemma::path_exists(const string & r1, const string & r2) const {
-	return shortest_paths.find(pair<string, string>(r1, r2)) != shortest_paths.end();
+	if (reading_inds.find(r1) == reading_inds.end() || reading_inds.find(r2) == reading_inds.end()) {
+		return false;
+	}
+	return path_exists(reading_inds.at(r1), reading_inds.at(r2));
 }
 
 /**
- * Given two reading IDs, returns the length of the shortest path between them in the local stemma.
- * It is assumed that a path exists between the two readings.
+ * Given two reading indices, checks if a path exists between them in the local stemma.
+ */
+bool local_stemma::path_exists(unsigned int r1, unsigned int r2) const {
+	unsigned int n_words = (n_readings + 63) / 64;
+	return (reachability[r1 * n_words + r2 / 64] >> (r2 % 64)) & 1;
+}
+
+/**
+ * Given two reading IDs, returns the length of the shortest path between them in the local stemma,
+ * or infinity if there is no such path.
+ * It is assumed that both readings are in the local stemma.
  */
 float local_stemma::get_shortest_path_length(const string & r1, const string & r2) const {
-	return shortest_paths.at(pair<string, string>(r1, r2));
+	return get_shortest_path_length(reading_inds.at(r1), reading_inds.at(r2));
+}
+
+/**
+ * Given two reading indices, returns the length of the shortest path between them in the local stemma,
+ * or infinity if there is no such path.
+ */
+float local_stemma::get_shortest_path_length(unsigned int r1, unsigned int r2) const {
+	return shortest_path_lengths[r1 * n_readings + r2];
 }
 
 /**
@@ -11,13 +11,18 @@
 #include <list>
 #include <vector>
 #include <set>
+#include <map>
 #include <unordered_map>
 #include <limits>
+#include <thread>
+#include <algorithm>
 
 #include "cxxopts.h"
 #include "sqlite3.h"
+#include "cache_reader.h"
 #include "roaring.hh"
 #include "witness.h"
+#include "genealogical_cache.h"
 #include "apparatus.h"
 #include "variation_unit.h"
 #include "set_cover_solver.h"
@@ -25,131 +30,45 @@
 using namespace std;
 
 /**
- * Determines if the WITNESSES table of the given SQLite database
- * contains a row with the given witness ID.
- */
-bool witness_id_exists(sqlite3 * input_db, const string & wit_id) {
-	bool witness_id_exists = false;
-	int rc; //to store SQLite macros
-	sqlite3_stmt * select_from_witnesses_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM WITNESSES WHERE WITNESS=?", -1, & select_from_witnesses_stmt, 0);
-	sqlite3_bind_text(select_from_witnesses_stmt, 1, wit_id.c_str(), -1, SQLITE_STATIC);
-	rc = sqlite3_step(select_from_witnesses_stmt);
-	witness_id_exists = (rc == SQLITE_ROW) ? true : false;
-	sqlite3_finalize(select_from_witnesses_stmt);
-	return witness_id_exists;
-}
-
-/**
- * Retrieves all rows from the WITNESSES table of the given SQLite database
- * and returns a list of witness IDs populated with its contents.
- */
-list<string> get_witness_ids(sqlite3 * input_db) {
-	list<string> witness_ids = list<string>();
-	int rc; //to store SQLite macros
-	cout << "Retrieving witness IDs..." << endl;
-	sqlite3_stmt * select_from_witnesses_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM WITNESSES ORDER BY ROWID", -1, & select_from_witnesses_stmt, 0);
-	rc = sqlite3_step(select_from_witnesses_stmt);
-	while (rc == SQLITE_ROW) {
-		string wit_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_witnesses_stmt, 0)));
-		witness_ids.push_back(wit_id);
-		rc = sqlite3_step(select_from_witnesses_stmt);
-	}
-	sqlite3_finalize(select_from_witnesses_stmt);
-	return witness_ids;
-}
-
-/**
- * Retrieves rows relative to the given primary witness ID from the GENEALOGICAL_COMPARISONS table of the given SQLite database
+ * Retrieves the genealogical comparisons relative to the given primary witness ID from the given binary genealogical cache
  * and returns a map of genealogical comparisons populated with its contents.
  */
-unordered_map<string, genealogical_comparison> get_primary_witness_genealogical_comparisons(sqlite3 * input_db, const string & _primary_wit_id) {
-	unordered_map<string, genealogical_comparison> primary_witness_genealogical_comparisons = unordered_map<string, genealogical_comparison>();
-	int rc; //to store SQLite macros
+unordered_map<string, genealogical_comparison> get_primary_witness_genealogical_comparisons(const genealogical_cache & cache, const string & _primary_wit_id) {
 	cout << "Retrieving genealogical comparisons relative to primary witness " << _primary_wit_id << "..." << endl;
-	sqlite3_stmt * select_from_genealogical_comparisons_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM GENEALOGICAL_COMPARISONS WHERE PRIMARY_WIT=?", -1, & select_from_genealogical_comparisons_stmt, 0);
-	sqlite3_bind_text(select_from_genealogical_comparisons_stmt, 1, _primary_wit_id.c_str(), -1, SQLITE_STATIC);
-	rc = sqlite3_step(select_from_genealogical_comparisons_stmt);
-	while (rc == SQLITE_ROW) {
-		genealogical_comparison comp;
-		string primary_wit_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_genealogical_comparisons_stmt, 0)));
-		string secondary_wit_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_genealogical_comparisons_stmt, 1)));
-		int agreements_bytes = sqlite3_column_bytes(select_from_genealogical_comparisons_stmt, 2);
-		const char * agreements_buf = reinterpret_cast<const char *>(sqlite3_column_blob(select_from_genealogical_comparisons_stmt, 2));
-		Roaring agreements = Roaring::readSafe(agreements_buf, agreements_bytes);
-		comp.agreements = agreements;
-		int explained_bytes = sqlite3_column_bytes(select_from_genealogical_comparisons_stmt, 3);
-		const char * explained_buf = reinterpret_cast<const char *>(sqlite3_column_blob(select_from_genealogical_comparisons_stmt, 3));
-		Roaring explained = Roaring::readSafe(explained_buf, explained_bytes);
-		comp.explained = explained;
-		float cost = float(sqlite3_column_double(select_from_genealogical_comparisons_stmt, 4));
-		comp.cost = cost;
-		primary_witness_genealogical_comparisons[secondary_wit_id] = comp;
-		rc = sqlite3_step(select_from_genealogical_comparisons_stmt);
-	}
-	sqlite3_finalize(select_from_genealogical_comparisons_stmt);
-	return primary_witness_genealogical_comparisons;
+	return cache.get_genealogical_comparisons(_primary_wit_id);
 }
 
 /**
- * Retrieves rows corresponding to the each secondary witness's genealogical comparisons relative to itself and the given primary witness
- * from the GENEALOGICAL_COMPARISONS table of the given SQLite database
+ * Retrieves each secondary witness's genealogical comparisons relative to itself and the given primary witness
+ * from the given binary genealogical cache
  * and returns a map of genealogical comparison maps populated with its contents.
  */
-unordered_map<string, unordered_map<string, genealogical_comparison>> get_secondary_witness_genealogical_comparisons(sqlite3 * input_db, const string & _primary_wit_id) {
+unordered_map<string, unordered_map<string, genealogical_comparison>> get_secondary_witness_genealogical_comparisons(const genealogical_cache & cache, const string & _primary_wit_id) {
 	unordered_map<string, unordered_map<string, genealogical_comparison>> secondary_witness_genealogical_comparisons = unordered_map<string, unordered_map<string, genealogical_comparison>>();
-	int rc; //to store SQLite macros
 	cout << "Retrieving genealogical comparisons relative to secondary witnesses..." << endl;
-	sqlite3_stmt * select_from_genealogical_comparisons_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM GENEALOGICAL_COMPARISONS WHERE (PRIMARY_WIT=SECONDARY_WIT) <> (SECONDARY_WIT=?)", -1, & select_from_genealogical_comparisons_stmt, 0);
-	sqlite3_bind_text(select_from_genealogical_comparisons_stmt, 1, _primary_wit_id.c_str(), -1, SQLITE_STATIC);
-	rc = sqlite3_step(select_from_genealogical_comparisons_stmt);
-	while (rc == SQLITE_ROW) {
-		genealogical_comparison comp;
-		string primary_wit_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_genealogical_comparisons_stmt, 0)));
-		//Check if there is already a comparison map for this witness in the output map, and create one if not:
-		if (secondary_witness_genealogical_comparisons.find(primary_wit_id) == secondary_witness_genealogical_comparisons.end()) {
-			secondary_witness_genealogical_comparisons[primary_wit_id] = unordered_map<string, genealogical_comparison>();
+	int primary_wit_ind = cache.get_witness_index(_primary_wit_id);
+	if (primary_wit_ind < 0) {
+		return secondary_witness_genealogical_comparisons;
+	}
+	const vector<string> & wit_ids = cache.get_witness_ids();
+	for (unsigned int wit_ind = 0; wit_ind < wit_ids.size(); wit_ind++) {
+		if (int(wit_ind) == primary_wit_ind) {
+			continue;
+		}
+		unordered_map<string, genealogical_comparison> comps = unordered_map<string, genealogical_comparison>();
+		if (cache.has_genealogical_comparison(wit_ind, wit_ind)) {
+			comps[wit_ids[wit_ind]] = cache.get_genealogical_comparison(wit_ind, wit_ind);
+		}
+		if (cache.has_genealogical_comparison(wit_ind, primary_wit_ind)) {
+			comps[_primary_wit_id] = cache.get_genealogical_comparison(wit_ind, primary_wit_ind);
+		}
+		if (!comps.empty()) {
+			secondary_witness_genealogical_comparisons[wit_ids[wit_ind]] = comps;
 		}
-		string secondary_wit_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_genealogical_comparisons_stmt, 1)));
-		int agreements_bytes = sqlite3_column_bytes(select_from_genealogical_comparisons_stmt, 2);
-		const char * agreements_buf = reinterpret_cast<const char *>(sqlite3_column_blob(select_from_genealogical_comparisons_stmt, 2));
-		Roaring agreements = Roaring::readSafe(agreements_buf, agreements_bytes);
-		comp.agreements = agreements;
-		int explained_bytes = sqlite3_column_bytes(select_from_genealogical_comparisons_stmt, 3);
-		const char * explained_buf = reinterpret_cast<const char *>(sqlite3_column_blob(select_from_genealogical_comparisons_stmt, 3));
-		Roaring explained = Roaring::readSafe(explained_buf, explained_bytes);
-		comp.explained = explained;
-		float cost = float(sqlite3_column_double(select_from_genealogical_comparisons_stmt, 4));
-		comp.cost = cost;
-		secondary_witness_genealogical_comparisons.at(primary_wit_id)[secondary_wit_id] = comp;
-		rc = sqlite3_step(select_from_genealogical_comparisons_stmt);
 	}
-	sqlite3_finalize(select_from_genealogical_comparisons_stmt);
 	return secondary_witness_genealogical_comparisons;
 }
 
-/**
- * Retrieves all rows from the VARIATION_UNITS table of the given SQLite database
- * and returns a vector of variation_unit labels populated with its contents.
- */
-vector<string> get_variation_unit_labels(sqlite3 * input_db) {
-	vector<string> variation_unit_labels = vector<string>();
-	int rc; //to store SQLite macros
-	sqlite3_stmt * select_from_variation_units_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM VARIATION_UNITS ORDER BY ROWID", -1, & select_from_variation_units_stmt, 0);
-	rc = sqlite3_step(select_from_variation_units_stmt);
-	while (rc == SQLITE_ROW) {
-		string vu_label = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_variation_units_stmt, 1)));
-		variation_unit_labels.push_back(vu_label);
-		rc = sqlite3_step(select_from_variation_units_stmt);
-	}
-	sqlite3_finalize(select_from_variation_units_stmt);
-	return variation_unit_labels;
-}
-
 /**
  * Given primary witness ID and a list of set cover solutions (assumed to be sorted from lowest cost to highest),
  * prints the corresponding best-found substemmata for the primary witness, along with their costs and number of agreements with the primary witness.
@@ -180,21 +99,63 @@ void print_substemmata(const string & primary_wit_id, const list<set_cover_solut
 	return;
 }
 
+/**
+ * Given primary witness ID, the statistics of the reduction of its substemma problem, and the statistics of the branch and bound search for its substemmata,
+ * prints the rows and columns removed by the reduction, the number of nodes visited, and the number of nodes at which each lower bound was evaluated and which it pruned.
+ */
+void print_statistics(const string & primary_wit_id, const reduction_statistics & reduction, const branch_and_bound_statistics & statistics) {
+	const map<bound_type, string> bound_names = {{ACCEPTED_COST, "accepted cost"}, {COLUMN_COST, "column cost"}, {DISJOINT_COLUMNS, "disjoint columns"}, {LAGRANGIAN, "Lagrangian"}};
+	//Print the reduction caption and statistics:
+	cout << "Reduction statistics for witness W1 = " << primary_wit_id << ":\n\n";
+	cout << "Passes: " << reduction.passes << "\n";
+	cout << "Rows fixed: " << reduction.fixed_rows << "\n";
+	cout << "Dominated rows removed: " << reduction.dominated_rows << "\n";
+	cout << "Dominated columns removed: " << reduction.dominated_columns << "\n";
+	cout << "Rows remaining: " << reduction.remaining_rows << "\n";
+	cout << "Columns remaining: " << reduction.remaining_columns << "\n\n";
+	//Print the caption:
+	cout << "Branch and bound statistics for witness W1 = " << primary_wit_id << ":\n\n";
+	cout << "Nodes visited: " << statistics.nodes << "\n";
+	cout << "Nodes with no feasible solution: " << statistics.infeasible << "\n\n";
+	//Print the header row:
+	cout << std::left << std::setw(24) << "BOUND";
+	cout << std::right << std::setw(12) << "EVALUATED";
+	cout << std::right << std::setw(12) << "PRUNED";
+	cout << "\n\n";
+	//Print the subsequent rows:
+	for (pair<bound_type, bound_statistics> kv : statistics.bounds) {
+		cout << std::left << std::setw(24) << bound_names.at(kv.first);
+		cout << std::right << std::setw(12) << kv.second.evaluations;
+		cout << std::right << std::setw(12) << kv.second.prunes;
+		cout << "\n";
+	}
+	cout << endl;
+	return;
+}
+
 /**
  * Entry point to the script.
  */
 int main(int argc, char* argv[]) {
 	//Read in the command-line options:
 	float fixed_ub = numeric_limits<float>::infinity();
+	unsigned int n_threads = max(1u, thread::hardware_concurrency());
 	string input_db_name = string();
+	string binary_cache_name = string();
 	string primary_wit_id = string();
+	bool lagrangian = false;
+	bool stats = false;
 	try {
 		cxxopts::Options options("optimize_substemmata", "Get a table of best-found substemmata for the witness with the given ID.");
-		options.custom_help("[-h] [-b bound] input_db witness");
+		options.custom_help("[-h] [-b bound] [-j threads] [--lagrangian] [--stats] [--binary-cache path] input_db witness");
 		//options.positional_help("").show_positional_help();
 		options.add_options("")
 				("h,help", "print this help")
-				("b,bound", "fixed upper bound on substemmata cost; if specified, list all substemmata with costs within this bound", cxxopts::value<float>());
+				("b,bound", "fixed upper bound on substemmata cost; if specified, list all substemmata with costs within this bound", cxxopts::value<float>())
+				("j,threads", "number of threads to use for finding substemmata (defaults to the number of hardware threads)", cxxopts::value<int>())
+				("lagrangian", "also prune the search for substemmata with a Lagrangian relaxation bound")
+				("stats", "print the rows and columns removed before the search and the number of search nodes visited and pruned by each bound")
+				("binary-cache", "read genealogical relationships from the binary cache file at this path (as written by populate_db) instead of from the database", cxxopts::value<string>());
 		options.add_options("positional")
 				("input_db", "genealogical cache database", cxxopts::value<string>())
 				("witness", "ID of the witness whose relatives are desired, as found in its <witness> element in the XML file", cxxopts::value<vector<string>>());
@@ -205,10 +166,27 @@ int main(int argc, char* argv[]) {
 			cout << options.help({""}) << endl;
 			exit(0);
 		}
+		if (args.count("binary-cache")) {
+			binary_cache_name = args["binary-cache"].as<string>();
+		}
 		//Parse the optional arguments:
 		if (args.count("b")) {
 			fixed_ub = args["b"].as<float>();
 		}
+		if (args.count("j")) {
+			int j = args["j"].as<int>();
+			if (j < 1) {
+				cerr << "Error: the number of threads must be positive." << endl;
+				exit(1);
+			}
+			n_threads = j;
+		}
+		if (args.count("lagrangian")) {
+			lagrangian = true;
+		}
+		if (args.count("stats")) {
+			stats = true;
+		}
 		//Parse the positional arguments:
 		if (!args.count("input_db") || args.count("witness") != 1) {
 			cerr << "Error: 2 positional arguments (input_db and witness) are required." << endl;
@@ -231,37 +209,90 @@ int main(int argc, char* argv[]) {
 		cerr << "Error opening database " << input_db_name << ": " << sqlite3_errmsg(input_db) << endl;
 		exit(1);
 	}
+	cache_reader reader(input_db);
+	if (!reader.is_open()) {
+		cerr << "Error reading database " << input_db_name << ": " << sqlite3_errmsg(input_db) << endl;
+		exit(1);
+	}
 	//Check if the primary witness ID is in the database:
-	bool primary_wit_exists = witness_id_exists(input_db, primary_wit_id);
+	bool primary_wit_exists = reader.witness_id_exists(primary_wit_id);
 	if (!primary_wit_exists) {
 		cerr << "Error: The WITNESSES table has no rows with WITNESS = " << primary_wit_id << "." << endl;
 		exit(1);
 	}
+	//If no fixed upper bound was specified, no search statistics were requested, and the database has a SUBSTEMMATA table, then read the primary witness's optimal substemmata from it;
+	//if the table has none for this witness, then they are sought below, so the user can be told why none exist:
+	if (fixed_ub == numeric_limits<float>::infinity() && binary_cache_name.empty() && !stats && reader.has_substemmata()) {
+		cout << "Retrieving optimal substemmata for witness " << primary_wit_id << "..." << endl;
+		list<set_cover_solution> solutions = reader.get_substemmata(primary_wit_id);
+		if (!solutions.empty()) {
+			//Close the database:
+			cout << "Closing database..." << endl;
+			reader.close();
+			sqlite3_close(input_db);
+			cout << "Database closed." << endl;
+			print_substemmata(primary_wit_id, solutions);
+			exit(0);
+		}
+	}
 	//Retrieve a list of all witness IDs:
-	list<string> list_wit = get_witness_ids(input_db);
-	//Retrieve all necessary genealogical comparisons relative to the primary witness:
-	unordered_map<string, genealogical_comparison> primary_witness_genealogical_comparisons = get_primary_witness_genealogical_comparisons(input_db, primary_wit_id);
-	//Retrieve all necessary genealogical comparisons relative to the secondary witnesses:
-	unordered_map<string, unordered_map<string, genealogical_comparison>> secondary_witness_genealogical_comparisons = get_secondary_witness_genealogical_comparisons(input_db, primary_wit_id);
+	cout << "Retrieving witness IDs..." << endl;
+	list<string> list_wit = list<string>(reader.get_witness_ids().begin(), reader.get_witness_ids().end());
+	//Retrieve all necessary genealogical comparisons relative to the primary witness,
+	//either from the binary cache, if one was specified, or from the database:
+	unordered_map<string, genealogical_comparison> primary_witness_genealogical_comparisons;
+	unordered_map<string, unordered_map<string, genealogical_comparison>> secondary_witness_genealogical_comparisons;
+	//If the database has a POTENTIAL_ANCESTORS table, then the primary witness's potential ancestors can be read from it;
+	//otherwise, they must be ranked using the genealogical comparisons relative to the secondary witnesses as well:
+	bool has_potential_ancestors = binary_cache_name.empty() && reader.has_potential_ancestor_rankings();
+	if (binary_cache_name.empty()) {
+		cout << "Retrieving genealogical comparisons relative to primary witness " << primary_wit_id << "..." << endl;
+		primary_witness_genealogical_comparisons = reader.get_genealogical_comparisons(primary_wit_id);
+		if (!has_potential_ancestors) {
+			cout << "Retrieving genealogical comparisons relative to secondary witnesses..." << endl;
+			secondary_witness_genealogical_comparisons = reader.get_secondary_witness_genealogical_comparisons(primary_wit_id);
+		}
+	}
+	else {
+		genealogical_cache cache(binary_cache_name);
+		if (!cache.is_open()) {
+			cerr << "Error opening binary cache " << binary_cache_name << ": not a valid genealogical cache file." << endl;
+			exit(1);
+		}
+		primary_witness_genealogical_comparisons = get_primary_witness_genealogical_comparisons(cache, primary_wit_id);
+		secondary_witness_genealogical_comparisons = get_secondary_witness_genealogical_comparisons(cache, primary_wit_id);
+	}
 	//Initialize the primary witness:
 	witness primary_wit = witness(primary_wit_id, primary_witness_genealogical_comparisons);
-	//Then initialize a list of all witnesses:
-	list<witness> witnesses = list<witness>();
-	for (string wit_id : list_wit) {
-		//The primary witness is initialized using genealogical comparisons with all witnesses:
-		if (wit_id == primary_wit_id) {
-			witness wit = witness(wit_id, primary_witness_genealogical_comparisons);
-			witnesses.push_back(wit);
+	//Then populate the primary witness's list of potential ancestors:
+	if (has_potential_ancestors) {
+		cout << "Retrieving potential ancestors of primary witness " << primary_wit_id << "..." << endl;
+		list<string> potential_ancestor_ids = list<string>();
+		for (const potential_ancestor_ranking & ranking : reader.get_potential_ancestor_rankings(primary_wit_id)) {
+			if (ranking.potential_ancestor) {
+				potential_ancestor_ids.push_back(ranking.id);
+			}
 		}
-		//Secondary witnesses are initialized using genealogical comparisons with just themselves and the primary witness:
-		else {
-			unordered_map<string, genealogical_comparison> genealogical_comparisons = secondary_witness_genealogical_comparisons.at(wit_id);
-			witness wit = witness(wit_id, genealogical_comparisons);
-			witnesses.push_back(wit);
+		primary_wit.set_potential_ancestor_ids(potential_ancestor_ids);
+	}
+	else {
+		//Initialize a list of all witnesses:
+		list<witness> witnesses = list<witness>();
+		for (string wit_id : list_wit) {
+			//The primary witness is initialized using genealogical comparisons with all witnesses:
+			if (wit_id == primary_wit_id) {
+				witness wit = witness(wit_id, primary_witness_genealogical_comparisons);
+				witnesses.push_back(wit);
+			}
+			//Secondary witnesses are initialized using genealogical comparisons with just themselves and the primary witness:
+			else {
+				unordered_map<string, genealogical_comparison> genealogical_comparisons = secondary_witness_genealogical_comparisons.at(wit_id);
+				witness wit = witness(wit_id, genealogical_comparisons);
+				witnesses.push_back(wit);
+			}
 		}
+		primary_wit.set_potential_ancestor_ids(witnesses);
 	}
-	//Then populate the primary witness's list of potential ancestors:
-	primary_wit.set_potential_ancestor_ids(witnesses);
 	//If the primary witness has no potential ancestors, then let the user know:
 	if (primary_wit.get_potential_ancestor_ids().empty()) {
 		cout << "The witness with ID " << primary_wit_id << " has no potential ancestors. This may be because it is too fragmentary or because it has equal priority to the Ausgangstext according to local stemmata." << endl;
@@ -279,8 +310,8 @@ int main(int argc, char* argv[]) {
 		genealogical_comparison comp = primary_wit.get_genealogical_comparison_for_witness(wit_id);
 		set_cover_row row;
 		row.id = wit_id;
-		row.agreements = comp.agreements;
-		row.explained = comp.explained;
+		row.agreements = *comp.agreements;
+		row.explained = *comp.explained;
 		row.cost = comp.cost;
 		rows.push_back(row);
 	}
@@ -289,11 +320,17 @@ int main(int argc, char* argv[]) {
 		return r1.cost < r2.cost ? true : (r1.cost > r2.cost ? false : (r1.agreements.cardinality() > r2.agreements.cardinality()));
 	});
 	//Initialize the bitmap of the target set to be covered:
-	Roaring target = primary_wit.get_genealogical_comparison_for_witness(primary_wit_id).explained;
+	Roaring target = *primary_wit.get_genealogical_comparison_for_witness(primary_wit_id).explained;
 	//Initialize the list of solutions to be populated:
 	list<set_cover_solution> solutions;
 	//Then populate it using the solver:
 	set_cover_solver solver = fixed_ub < numeric_limits<float>::infinity() ? set_cover_solver(rows, target, fixed_ub) : set_cover_solver(rows, target);
+	solver.set_n_threads(n_threads);
+	if (lagrangian) {
+		list<bound_type> bounds = solver.get_bounds();
+		bounds.push_back(bound_type::LAGRANGIAN);
+		solver.set_bounds(bounds);
+	}
 	solver.solve(solutions);
 	//If the solution set is empty, then find out why:
 	if (solutions.empty()) {
@@ -301,7 +338,7 @@ int main(int argc, char* argv[]) {
 		Roaring uncovered_columns = solver.get_uncovered_columns();
 		if (!uncovered_columns.isEmpty()) {
 			cout << "The witness with ID " << primary_wit_id << " cannot be explained by any of its potential ancestors at the following variation units: ";
-			vector<string> vu_labels = get_variation_unit_labels(input_db);
+			const vector<string> & vu_labels = reader.get_variation_unit_labels();
 			for (Roaring::const_iterator it = uncovered_columns.begin(); it != uncovered_columns.end(); it++) {
 				unsigned int col_ind = *it;
 				string vu_label = vu_labels[col_ind];
@@ -327,9 +364,13 @@ int main(int argc, char* argv[]) {
 	}
 	//Close the database:
 	cout << "Closing database..." << endl;
+	reader.close();
 	sqlite3_close(input_db);
 	cout << "Database closed." << endl;
 	//Otherwise, print the solutions and their costs:
 	print_substemmata(primary_wit_id, solutions);
+	if (stats) {
+		print_statistics(primary_wit_id, solver.get_reduction_statistics(), solver.get_statistics());
+	}
 	exit(0);
 }
@@ -10,50 +10,133 @@
 #include <list>
 #include <vector>
 #include <set>
+#include <map>
 #include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+#include <memory>
 
 #include "cxxopts.h"
 #include "pugixml.h"
 #include "roaring.hh"
 #include "witness.h"
+#include "genealogical_cache.h"
 #include "apparatus.h"
 #include "variation_unit.h"
 #include "local_stemma.h"
 #include "sqlite3.h"
+#include "cache_schema.h"
+#include "cache_reader.h"
+#include "textual_flow.h"
 
 using namespace std;
 
+//Define the page size of the database in bytes, which is large enough to hold most rows of the BITMAPS table without overflow pages:
+const unsigned int PAGE_SIZE = 16384;
+
 /**
- * Creates, indexes, and populates the READINGS table.
+ * Mixes the given bytes into the given 64-bit FNV-1a hash.
+ * Unlike std::hash, this hash is the same on every platform and in every build, so it can be stored in the database.
+ */
+void hash_bytes(uint64_t & hash, const void * bytes, size_t n_bytes) {
+	const unsigned char * p = (const unsigned char *) bytes;
+	for (size_t i = 0; i < n_bytes; i++) {
+		hash ^= p[i];
+		hash *= 1099511628211ULL;
+	}
+	return;
+}
+
+/**
+ * Mixes the given string into the given hash, prefixed with its length so that consecutive strings cannot run together.
+ */
+void hash_string(uint64_t & hash, const string & str) {
+	uint64_t size = str.size();
+	hash_bytes(hash, & size, sizeof(size));
+	hash_bytes(hash, str.data(), str.size());
+	return;
+}
+
+/**
+ * Returns the given hash as a string of 16 hexadecimal digits.
+ */
+string hash_to_hex(uint64_t hash) {
+	const char * digits = "0123456789abcdef";
+	string hex = string(16, '0');
+	for (int i = 15; i >= 0; i--) {
+		hex[i] = digits[hash & 0xf];
+		hash >>= 4;
+	}
+	return hex;
+}
+
+//Define the initial value of a 64-bit FNV-1a hash:
+const uint64_t HASH_OFFSET_BASIS = 14695981039346656037ULL;
+
+/**
+ * Drops all tables from the given database and sets its page size, so that the genealogical cache can be built from scratch.
  */
-void populate_readings_table(sqlite3 * output_db, const list<variation_unit> & variation_units) {
+void clear_database(sqlite3 * output_db) {
 	int rc; //to store SQLite macros
-	cout << "Populating table READINGS..." << endl;
-	//Create the READINGS table:
-	string create_readings_sql = "DROP TABLE IF EXISTS READINGS;"
-			"CREATE TABLE READINGS ("
-			"VARIATION_UNIT TEXT NOT NULL, "
-			"READING TEXT NOT NULL);";
-	char * create_readings_error_msg;
-	rc = sqlite3_exec(output_db, create_readings_sql.c_str(), NULL, 0, & create_readings_error_msg);
+	cout << "Clearing database..." << endl;
+	//Get the names of all tables in the database, apart from SQLite's internal tables:
+	sqlite3_stmt * select_tables_stmt;
+	rc = sqlite3_prepare(output_db, "SELECT name FROM sqlite_master WHERE type='table' AND name NOT LIKE 'sqlite_%'", -1, & select_tables_stmt, 0);
 	if (rc != SQLITE_OK) {
-		cerr << "Error creating table READINGS: " << create_readings_error_msg << endl;
-		sqlite3_free(create_readings_error_msg);
+		cerr << "Error preparing statement." << endl;
+		exit(1);
+	}
+	string clear_sql = string();
+	while (sqlite3_step(select_tables_stmt) == SQLITE_ROW) {
+		string table = string(reinterpret_cast<const char *>(sqlite3_column_text(select_tables_stmt, 0)));
+		clear_sql += "DROP TABLE IF EXISTS \"" + table + "\";";
+	}
+	sqlite3_finalize(select_tables_stmt);
+	//Then drop them, and vacuum the empty database so that the new page size takes effect:
+	clear_sql += "PRAGMA page_size = " + to_string(PAGE_SIZE) + ";"
+			"VACUUM;";
+	char * clear_error_msg;
+	rc = sqlite3_exec(output_db, clear_sql.c_str(), NULL, 0, & clear_error_msg);
+	if (rc != SQLITE_OK) {
+		cerr << "Error clearing database: " << clear_error_msg << endl;
+		sqlite3_free(clear_error_msg);
 		exit(1);
 	}
-	//Denormalize it:
-	string create_readings_idx_sql = "DROP INDEX IF EXISTS READINGS_IDX;"
-			"CREATE INDEX READINGS_IDX ON READINGS (VARIATION_UNIT, READING);";
+	return;
+}
+
+/**
+ * Indexes the READINGS table.
+ */
+void index_readings_table(sqlite3 * output_db) {
+	int rc; //to store SQLite macros
 	char * create_readings_idx_error_msg;
-	rc = sqlite3_exec(output_db, create_readings_idx_sql.c_str(), NULL, 0, & create_readings_idx_error_msg);
+	rc = sqlite3_exec(output_db, CREATE_READINGS_INDEX_SQL.c_str(), NULL, 0, & create_readings_idx_error_msg);
 	if (rc != SQLITE_OK) {
 		cerr << "Error creating index READINGS_IDX: " << create_readings_idx_error_msg << endl;
 		sqlite3_free(create_readings_idx_error_msg);
 		exit(1);
 	}
-	//Then populate it using prepared statements within a single transaction:
+	return;
+}
+
+/**
+ * Inserts the rows for the given variation units into the READINGS table.
+ * The given map should map each variation unit's ID to its index, which is its key in the VARIATION_UNITS table.
+ */
+void insert_into_readings_table(sqlite3 * output_db, const list<variation_unit> & variation_units, const unordered_map<string, unsigned int> & vu_inds) {
+	int rc; //to store SQLite macros
+	//Populate it using prepared statements within a single transaction, unless the caller has already begun one:
 	char * transaction_error_msg;
-	sqlite3_exec(output_db, "BEGIN TRANSACTION", NULL, NULL, & transaction_error_msg);
+	bool own_transaction = sqlite3_get_autocommit(output_db) != 0;
+	if (own_transaction) {
+		sqlite3_exec(output_db, "BEGIN TRANSACTION", NULL, NULL, & transaction_error_msg);
+	}
 	sqlite3_stmt * insert_into_readings_stmt;
 	rc = sqlite3_prepare(output_db, "INSERT INTO READINGS VALUES (?,?)", -1, & insert_into_readings_stmt, 0);
 	if (rc != SQLITE_OK) {
@@ -61,12 +144,12 @@ void populate_readings_table(sqlite3 * output_db, const list<variation_unit> & v
 		exit(1);
 	}
 	for (variation_unit vu : variation_units) {
-		string vu_id = vu.get_id();
+		unsigned int vu_ind = vu_inds.at(vu.get_id());
 		local_stemma ls = vu.get_local_stemma();
 		list<local_stemma_vertex> vertices = ls.get_graph().vertices;
 		for (local_stemma_vertex v : vertices) {
 			//Then insert a row containing these values:
-			sqlite3_bind_text(insert_into_readings_stmt, 1, vu_id.c_str(), -1, SQLITE_STATIC);
+			sqlite3_bind_int(insert_into_readings_stmt, 1, vu_ind);
 			sqlite3_bind_text(insert_into_readings_stmt, 2, v.id.c_str(), -1, SQLITE_STATIC);
 			rc = sqlite3_step(insert_into_readings_stmt);
 			if (rc != SQLITE_DONE) {
@@ -78,43 +161,63 @@ void populate_readings_table(sqlite3 * output_db, const list<variation_unit> & v
 		}
 	}
 	sqlite3_finalize(insert_into_readings_stmt);
-	sqlite3_exec(output_db, "END TRANSACTION", NULL, NULL, & transaction_error_msg);
+	if (own_transaction) {
+		sqlite3_exec(output_db, "END TRANSACTION", NULL, NULL, & transaction_error_msg);
+	}
 	return;
 }
 
 /**
- * Creates, indexes, and populates the READING_RELATIONS table.
+ * Creates, indexes, and populates the READINGS table.
+ * If the given flag is set, then the index is not created, so that it can be built after the table has been populated.
  */
-void populate_reading_relations_table(sqlite3 * output_db, const list<variation_unit> & variation_units) {
+void populate_readings_table(sqlite3 * output_db, const list<variation_unit> & variation_units, const unordered_map<string, unsigned int> & vu_inds, bool defer_index) {
 	int rc; //to store SQLite macros
-	cout << "Populating table READING_RELATIONS..." << endl;
-	//Create the READING_RELATIONS table:
-	string create_reading_relations_sql = "DROP TABLE IF EXISTS READING_RELATIONS;"
-			"CREATE TABLE READING_RELATIONS ("
-			"VARIATION_UNIT TEXT NOT NULL, "
-			"PRIOR TEXT NOT NULL, "
-			"POSTERIOR TEXT NOT NULL, "
-			"WEIGHT REAL NOT NULL);";
-	char * create_reading_relations_error_msg;
-	rc = sqlite3_exec(output_db, create_reading_relations_sql.c_str(), NULL, 0, & create_reading_relations_error_msg);
+	cout << "Populating table READINGS..." << endl;
+	//Create the READINGS table:
+	char * create_readings_error_msg;
+	rc = sqlite3_exec(output_db, CREATE_READINGS_TABLE_SQL.c_str(), NULL, 0, & create_readings_error_msg);
 	if (rc != SQLITE_OK) {
-		cerr << "Error creating table READING_RELATIONS: " << create_reading_relations_error_msg << endl;
-		sqlite3_free(create_reading_relations_error_msg);
+		cerr << "Error creating table READINGS: " << create_readings_error_msg << endl;
+		sqlite3_free(create_readings_error_msg);
 		exit(1);
 	}
-	//Denormalize it:
-	string create_reading_relations_idx_sql = "DROP INDEX IF EXISTS READING_RELATIONS_IDX;"
-			"CREATE INDEX READING_RELATIONS_IDX ON READING_RELATIONS (VARIATION_UNIT, PRIOR, POSTERIOR);";
+	//Denormalize it, unless this is deferred until the table has been populated:
+	if (!defer_index) {
+		index_readings_table(output_db);
+	}
+	//Then populate it:
+	insert_into_readings_table(output_db, variation_units, vu_inds);
+	return;
+}
+
+/**
+ * Indexes the READING_RELATIONS table.
+ */
+void index_reading_relations_table(sqlite3 * output_db) {
+	int rc; //to store SQLite macros
 	char * create_reading_relations_idx_error_msg;
-	rc = sqlite3_exec(output_db, create_reading_relations_idx_sql.c_str(), NULL, 0, & create_reading_relations_idx_error_msg);
+	rc = sqlite3_exec(output_db, CREATE_READING_RELATIONS_INDEX_SQL.c_str(), NULL, 0, & create_reading_relations_idx_error_msg);
 	if (rc != SQLITE_OK) {
 		cerr << "Error creating index READING_RELATIONS_IDX: " << create_reading_relations_idx_error_msg << endl;
 		sqlite3_free(create_reading_relations_idx_error_msg);
 		exit(1);
 	}
-	//Then populate it using prepared statements within a single transaction:
+	return;
+}
+
+/**
+ * Inserts the rows for the given variation units into the READING_RELATIONS table.
+ * The given map should map each variation unit's ID to its index, which is its key in the VARIATION_UNITS table.
+ */
+void insert_into_reading_relations_table(sqlite3 * output_db, const list<variation_unit> & variation_units, const unordered_map<string, unsigned int> & vu_inds) {
+	int rc; //to store SQLite macros
+	//Populate it using prepared statements within a single transaction, unless the caller has already begun one:
 	char * transaction_error_msg;
-	sqlite3_exec(output_db, "BEGIN TRANSACTION", NULL, NULL, & transaction_error_msg);
+	bool own_transaction = sqlite3_get_autocommit(output_db) != 0;
+	if (own_transaction) {
+		sqlite3_exec(output_db, "BEGIN TRANSACTION", NULL, NULL, & transaction_error_msg);
+	}
 	sqlite3_stmt * insert_into_reading_relations_stmt;
 	rc = sqlite3_prepare(output_db, "INSERT INTO READING_RELATIONS VALUES (?,?,?,?)", -1, & insert_into_reading_relations_stmt, 0);
 	if (rc != SQLITE_OK) {
@@ -122,12 +225,12 @@ void populate_reading_relations_table(sqlite3 * output_db, const list<variation_
 		exit(1);
 	}
 	for (variation_unit vu : variation_units) {
-		string vu_id = vu.get_id();
+		unsigned int vu_ind = vu_inds.at(vu.get_id());
 		local_stemma ls = vu.get_local_stemma();
 		list<local_stemma_edge> edges = ls.get_graph().edges;
 		for (local_stemma_edge e : edges) {
 			//Then insert a row containing these values:
-			sqlite3_bind_text(insert_into_reading_relations_stmt, 1, vu_id.c_str(), -1, SQLITE_STATIC);
+			sqlite3_bind_int(insert_into_reading_relations_stmt, 1, vu_ind);
 			sqlite3_bind_text(insert_into_reading_relations_stmt, 2, e.prior.c_str(), -1, SQLITE_STATIC);
 			sqlite3_bind_text(insert_into_reading_relations_stmt, 3, e.posterior.c_str(), -1, SQLITE_STATIC);
 			sqlite3_bind_double(insert_into_reading_relations_stmt, 4, e.weight);
@@ -141,42 +244,65 @@ void populate_reading_relations_table(sqlite3 * output_db, const list<variation_
 		}
 	}
 	sqlite3_finalize(insert_into_reading_relations_stmt);
-	sqlite3_exec(output_db, "END TRANSACTION", NULL, NULL, & transaction_error_msg);
+	if (own_transaction) {
+		sqlite3_exec(output_db, "END TRANSACTION", NULL, NULL, & transaction_error_msg);
+	}
 	return;
 }
 
 /**
- * Creates, indexes, and populates the READING_SUPPORT table.
+ * Creates, indexes, and populates the READING_RELATIONS table.
+ * If the given flag is set, then the index is not created, so that it can be built after the table has been populated.
  */
-void populate_reading_support_table(sqlite3 * output_db, const list<variation_unit> & variation_units) {
+void populate_reading_relations_table(sqlite3 * output_db, const list<variation_unit> & variation_units, const unordered_map<string, unsigned int> & vu_inds, bool defer_index) {
 	int rc; //to store SQLite macros
-	cout << "Populating table READING_SUPPORT..." << endl;
-	//Create the READING_SUPPORT table:
-	string create_reading_support_sql = "DROP TABLE IF EXISTS READING_SUPPORT;"
-			"CREATE TABLE READING_SUPPORT ("
-			"VARIATION_UNIT TEXT NOT NULL, "
-			"WITNESS TEXT NOT NULL, "
-			"READING TEXT NOT NULL);";
-	char * create_reading_support_error_msg;
-	rc = sqlite3_exec(output_db, create_reading_support_sql.c_str(), NULL, 0, & create_reading_support_error_msg);
+	cout << "Populating table READING_RELATIONS..." << endl;
+	//Create the READING_RELATIONS table:
+	char * create_reading_relations_error_msg;
+	rc = sqlite3_exec(output_db, CREATE_READING_RELATIONS_TABLE_SQL.c_str(), NULL, 0, & create_reading_relations_error_msg);
 	if (rc != SQLITE_OK) {
-		cerr << "Error creating table READING_SUPPORT: " << create_reading_support_error_msg << endl;
-		sqlite3_free(create_reading_support_error_msg);
+		cerr << "Error creating table READING_RELATIONS: " << create_reading_relations_error_msg << endl;
+		sqlite3_free(create_reading_relations_error_msg);
 		exit(1);
 	}
-	//Denormalize it:
-	string create_reading_support_idx_sql = "DROP INDEX IF EXISTS READING_SUPPORT_IDX;"
-			"CREATE INDEX READING_SUPPORT_IDX ON READING_SUPPORT (VARIATION_UNIT, WITNESS, READING);";
+	//Denormalize it, unless this is deferred until the table has been populated:
+	if (!defer_index) {
+		index_reading_relations_table(output_db);
+	}
+	//Then populate it:
+	insert_into_reading_relations_table(output_db, variation_units, vu_inds);
+	return;
+}
+
+/**
+ * Indexes the READING_SUPPORT table.
+ */
+void index_reading_support_table(sqlite3 * output_db) {
+	int rc; //to store SQLite macros
 	char * create_reading_support_idx_error_msg;
-	rc = sqlite3_exec(output_db, create_reading_support_idx_sql.c_str(), NULL, 0, & create_reading_support_idx_error_msg);
+	rc = sqlite3_exec(output_db, CREATE_READING_SUPPORT_INDEX_SQL.c_str(), NULL, 0, & create_reading_support_idx_error_msg);
 	if (rc != SQLITE_OK) {
 		cerr << "Error creating index READING_SUPPORT_IDX: " << create_reading_support_idx_error_msg << endl;
 		sqlite3_free(create_reading_support_idx_error_msg);
 		exit(1);
 	}
-	//Then populate it using prepared statements within a single transaction:
+	return;
+}
+
+/**
+ * Inserts the rows for the given variation units into the READING_SUPPORT table.
+ * The given list of all witness IDs should be in the order of the witness indices used in the variation units' reading support,
+ * and the given map should map the ID of each witness in the WITNESSES table to its key there;
+ * rows are only inserted for the witnesses in that table.
+ */
+void insert_into_reading_support_table(sqlite3 * output_db, const list<variation_unit> & variation_units, const unordered_map<string, unsigned int> & vu_inds, const list<string> & all_wits, const unordered_map<string, unsigned int> & wit_inds) {
+	int rc; //to store SQLite macros
+	//Populate it using prepared statements within a single transaction, unless the caller has already begun one:
 	char * transaction_error_msg;
-	sqlite3_exec(output_db, "BEGIN TRANSACTION", NULL, NULL, & transaction_error_msg);
+	bool own_transaction = sqlite3_get_autocommit(output_db) != 0;
+	if (own_transaction) {
+		sqlite3_exec(output_db, "BEGIN TRANSACTION", NULL, NULL, & transaction_error_msg);
+	}
 	sqlite3_stmt * insert_into_reading_support_stmt;
 	rc = sqlite3_prepare(output_db, "INSERT INTO READING_SUPPORT VALUES (?,?,?)", -1, & insert_into_reading_support_stmt, 0);
 	if (rc != SQLITE_OK) {
@@ -184,14 +310,21 @@ void populate_reading_support_table(sqlite3 * output_db, const list<variation_un
 		exit(1);
 	}
 	for (variation_unit vu : variation_units) {
-		string vu_id = vu.get_id();
-		unordered_map<string, string> reading_support = vu.get_reading_support();
-		for (pair<string, string> kv : reading_support) {
-			string wit_id = kv.first;
-			string wit_rdg = kv.second;
+		unsigned int vu_ind = vu_inds.at(vu.get_id());
+		const vector<string> & readings = vu.get_readings();
+		const vector<uint16_t> & reading_support = vu.get_reading_support();
+		unsigned int app_wit_ind = 0;
+		for (string wit_id : all_wits) {
+			//Skip any witnesses that are lacunose here or that are not in the WITNESSES table:
+			uint16_t rdg_ind = reading_support[app_wit_ind];
+			app_wit_ind++;
+			if (rdg_ind == LACUNA || wit_inds.find(wit_id) == wit_inds.end()) {
+				continue;
+			}
+			string wit_rdg = readings[rdg_ind];
 			//Then insert a row containing these values:
-			sqlite3_bind_text(insert_into_reading_support_stmt, 1, vu_id.c_str(), -1, SQLITE_STATIC);
-			sqlite3_bind_text(insert_into_reading_support_stmt, 2, wit_id.c_str(), -1, SQLITE_STATIC);
+			sqlite3_bind_int(insert_into_reading_support_stmt, 1, vu_ind);
+			sqlite3_bind_int(insert_into_reading_support_stmt, 2, wit_inds.at(wit_id));
 			sqlite3_bind_text(insert_into_reading_support_stmt, 3, wit_rdg.c_str(), -1, SQLITE_STATIC);
 			rc = sqlite3_step(insert_into_reading_support_stmt);
 			if (rc != SQLITE_DONE) {
@@ -203,56 +336,90 @@ void populate_reading_support_table(sqlite3 * output_db, const list<variation_un
 		}
 	}
 	sqlite3_finalize(insert_into_reading_support_stmt);
-	sqlite3_exec(output_db, "END TRANSACTION", NULL, NULL, & transaction_error_msg);
+	if (own_transaction) {
+		sqlite3_exec(output_db, "END TRANSACTION", NULL, NULL, & transaction_error_msg);
+	}
+	return;
+}
+
+/**
+ * Creates, indexes, and populates the READING_SUPPORT table.
+ * If the given flag is set, then the index is not created, so that it can be built after the table has been populated.
+ */
+void populate_reading_support_table(sqlite3 * output_db, const list<variation_unit> & variation_units, const unordered_map<string, unsigned int> & vu_inds, const list<string> & all_wits, const unordered_map<string, unsigned int> & wit_inds, bool defer_index) {
+	int rc; //to store SQLite macros
+	cout << "Populating table READING_SUPPORT..." << endl;
+	//Create the READING_SUPPORT table:
+	char * create_reading_support_error_msg;
+	rc = sqlite3_exec(output_db, CREATE_READING_SUPPORT_TABLE_SQL.c_str(), NULL, 0, & create_reading_support_error_msg);
+	if (rc != SQLITE_OK) {
+		cerr << "Error creating table READING_SUPPORT: " << create_reading_support_error_msg << endl;
+		sqlite3_free(create_reading_support_error_msg);
+		exit(1);
+	}
+	//Denormalize it, unless this is deferred until the table has been populated:
+	if (!defer_index) {
+		index_reading_support_table(output_db);
+	}
+	//Then populate it:
+	insert_into_reading_support_table(output_db, variation_units, vu_inds, all_wits, wit_inds);
+	return;
+}
+
+/**
+ * Indexes the VARIATION_UNITS table by variation unit ID.
+ */
+void index_variation_units_table(sqlite3 * output_db) {
+	int rc; //to store SQLite macros
+	char * create_variation_units_idx_error_msg;
+	rc = sqlite3_exec(output_db, CREATE_VARIATION_UNITS_INDEX_SQL.c_str(), NULL, 0, & create_variation_units_idx_error_msg);
+	if (rc != SQLITE_OK) {
+		cerr << "Error creating index VARIATION_UNITS_IDX: " << create_variation_units_idx_error_msg << endl;
+		sqlite3_free(create_variation_units_idx_error_msg);
+		exit(1);
+	}
 	return;
 }
 
 /**
  * Creates, indexes, and populates the VARIATION_UNITS table.
+ * Each variation unit is keyed by its index, which is also its position in the genealogical comparison bitmaps.
+ * If the given flag is set, then the index is not created, so that it can be built after the table has been populated.
  */
-void populate_variation_units_table(sqlite3 * output_db, const list<variation_unit> & variation_units) {
+void populate_variation_units_table(sqlite3 * output_db, const list<variation_unit> & variation_units, bool defer_index) {
 	int rc; //to store SQLite macros
 	cout << "Populating table VARIATION_UNITS..." << endl;
 	//Create the VARIATION_UNITS table:
-	string create_variation_units_sql = "DROP TABLE IF EXISTS VARIATION_UNITS;"
-			"CREATE TABLE VARIATION_UNITS ("
-			"VARIATION_UNIT TEXT NOT NULL, "
-			"LABEL TEXT, "
-			"CONNECTIVITY INT NOT NULL);";
 	char * create_variation_units_error_msg;
-	rc = sqlite3_exec(output_db, create_variation_units_sql.c_str(), NULL, 0, & create_variation_units_error_msg);
+	rc = sqlite3_exec(output_db, CREATE_VARIATION_UNITS_TABLE_SQL.c_str(), NULL, 0, & create_variation_units_error_msg);
 	if (rc != SQLITE_OK) {
 		cerr << "Error creating table VARIATION_UNITS: " << create_variation_units_error_msg << endl;
 		sqlite3_free(create_variation_units_error_msg);
 		exit(1);
 	}
-	//Denormalize it:
-	string create_variation_units_idx_sql = "DROP INDEX IF EXISTS VARIATION_UNITS_IDX;"
-			"CREATE INDEX VARIATION_UNITS_IDX ON VARIATION_UNITS (VARIATION_UNIT);";
-	char * create_variation_units_idx_error_msg;
-	rc = sqlite3_exec(output_db, create_variation_units_idx_sql.c_str(), NULL, 0, & create_variation_units_idx_error_msg);
-	if (rc != SQLITE_OK) {
-		cerr << "Error creating index VARIATION_UNITS_IDX: " << create_variation_units_idx_error_msg << endl;
-		sqlite3_free(create_variation_units_idx_error_msg);
-		exit(1);
+	//Denormalize it, unless this is deferred until the table has been populated:
+	if (!defer_index) {
+		index_variation_units_table(output_db);
 	}
 	//Then populate it using prepared statements within a single transaction:
 	char * transaction_error_msg;
 	sqlite3_exec(output_db, "BEGIN TRANSACTION", NULL, NULL, & transaction_error_msg);
 	sqlite3_stmt * insert_into_variation_units_stmt;
-	rc = sqlite3_prepare(output_db, "INSERT INTO VARIATION_UNITS VALUES (?,?,?)", -1, & insert_into_variation_units_stmt, 0);
+	rc = sqlite3_prepare(output_db, "INSERT INTO VARIATION_UNITS VALUES (?,?,?,?)", -1, & insert_into_variation_units_stmt, 0);
 	if (rc != SQLITE_OK) {
 		cerr << "Error preparing statement." << endl;
 		exit(1);
 	}
+	unsigned int vu_ind = 0;
 	for (variation_unit vu : variation_units) {
 		string id = vu.get_id();
 		string label = vu.get_label();
 		int connectivity = vu.get_connectivity();
 		//Then insert a row containing these values:
-		sqlite3_bind_text(insert_into_variation_units_stmt, 1, id.c_str(), -1, SQLITE_STATIC);
-		sqlite3_bind_text(insert_into_variation_units_stmt, 2, label.c_str(), -1, SQLITE_STATIC);
-		sqlite3_bind_int(insert_into_variation_units_stmt, 3, connectivity);
+		sqlite3_bind_int(insert_into_variation_units_stmt, 1, vu_ind);
+		sqlite3_bind_text(insert_into_variation_units_stmt, 2, id.c_str(), -1, SQLITE_STATIC);
+		sqlite3_bind_text(insert_into_variation_units_stmt, 3, label.c_str(), -1, SQLITE_STATIC);
+		sqlite3_bind_int(insert_into_variation_units_stmt, 4, connectivity);
 		rc = sqlite3_step(insert_into_variation_units_stmt);
 		if (rc != SQLITE_DONE) {
 			cerr << "Error executing prepared statement." << endl;
@@ -260,6 +427,7 @@ void populate_variation_units_table(sqlite3 * output_db, const list<variation_un
 		}
 		//Then reset the prepared statement so we can bind the next values to it:
 		sqlite3_reset(insert_into_variation_units_stmt);
+		vu_ind++;
 	}
 	sqlite3_finalize(insert_into_variation_units_stmt);
 	sqlite3_exec(output_db, "END TRANSACTION", NULL, NULL, & transaction_error_msg);
@@ -267,200 +435,1585 @@ void populate_variation_units_table(sqlite3 * output_db, const list<variation_un
 }
 
 /**
- * Creates, indexes, and populates the GENEALOGICAL_COMPARISONS table.
+ * Indexes the GENEALOGICAL_COMPARISONS table by secondary witness key.
  */
-void populate_genealogical_comparisons_table(sqlite3 * output_db, const list<witness> & witnesses) {
+void index_genealogical_comparisons_table(sqlite3 * output_db) {
 	int rc; //to store SQLite macros
-	cout << "Populating table GENEALOGICAL_COMPARISONS..." << endl;
-	//Create the GENEALOGICAL_COMPARISONS table:
-	string create_genealogical_comparisons_sql = "DROP TABLE IF EXISTS GENEALOGICAL_COMPARISONS;"
-			"CREATE TABLE GENEALOGICAL_COMPARISONS ("
-			"PRIMARY_WIT TEXT NOT NULL, "
-			"SECONDARY_WIT TEXT NOT NULL, "
-			"AGREEMENTS BLOB NOT NULL, "
-			"EXPLAINED BLOB NOT NULL, "
-			"COST REAL NOT NULL);";
-	char * create_genealogical_comparisons_error_msg;
-	rc = sqlite3_exec(output_db, create_genealogical_comparisons_sql.c_str(), NULL, 0, & create_genealogical_comparisons_error_msg);
-	if (rc != SQLITE_OK) {
-		cerr << "Error creating table GENEALOGICAL_COMPARISONS: " << create_genealogical_comparisons_error_msg << endl;
-		sqlite3_free(create_genealogical_comparisons_error_msg);
-		exit(1);
-	}
-	//Denormalize it:
-	string create_genealogical_comparisons_idx_sql = "DROP INDEX IF EXISTS GENEALOGICAL_COMPARISONS_IDX;"
-			"CREATE INDEX GENEALOGICAL_COMPARISONS_IDX ON GENEALOGICAL_COMPARISONS (PRIMARY_WIT, SECONDARY_WIT);";
 	char * create_genealogical_comparisons_idx_error_msg;
-	rc = sqlite3_exec(output_db, create_genealogical_comparisons_idx_sql.c_str(), NULL, 0, & create_genealogical_comparisons_idx_error_msg);
+	rc = sqlite3_exec(output_db, CREATE_GENEALOGICAL_COMPARISONS_INDEX_SQL.c_str(), NULL, 0, & create_genealogical_comparisons_idx_error_msg);
 	if (rc != SQLITE_OK) {
-		cerr << "Error creating index GENEALOGICAL_COMPARISONS_IDX: " << create_genealogical_comparisons_idx_error_msg << endl;
+		cerr << "Error creating index GENEALOGICAL_COMPARISONS_SECONDARY_IDX: " << create_genealogical_comparisons_idx_error_msg << endl;
 		sqlite3_free(create_genealogical_comparisons_idx_error_msg);
 		exit(1);
 	}
-	//Then populate it using prepared statements within a single transaction:
-	char * transaction_error_msg;
-	sqlite3_exec(output_db, "BEGIN TRANSACTION", NULL, NULL, & transaction_error_msg);
-	sqlite3_stmt * insert_into_genealogical_comparisons_stmt;
-	rc = sqlite3_prepare(output_db, "INSERT INTO GENEALOGICAL_COMPARISONS VALUES (?,?,?,?,?)", -1, & insert_into_genealogical_comparisons_stmt, 0);
-	if (rc != SQLITE_OK) {
-		cerr << "Error preparing statement." << endl;
-		exit(1);
-	}
-	for (witness primary_wit : witnesses) {
-		string primary_wit_id = primary_wit.get_id();
-		unordered_map<string, genealogical_comparison> genealogical_comparisons = primary_wit.get_genealogical_comparisons();
-		for (pair<string, genealogical_comparison> kv : genealogical_comparisons) {
-			string secondary_wit_id = kv.first;
-			genealogical_comparison comp = kv.second;
-			//Serialize the bitmaps into byte arrays:
-			Roaring agreements = comp.agreements;
-			uint32_t agreements_expected_size = agreements.getSizeInBytes();
-			char * agreements_buf = new char [agreements_expected_size];
-			agreements.write(agreements_buf);
-			Roaring explained = comp.explained;
-			uint32_t explained_expected_size = explained.getSizeInBytes();
-			char * explained_buf = new char [explained_expected_size];
-			explained.write(explained_buf);
-			//Get the genealogical cost:
-			float cost = comp.cost;
-			//Then insert a row containing these values:
-			sqlite3_bind_text(insert_into_genealogical_comparisons_stmt, 1, primary_wit_id.c_str(), -1, SQLITE_STATIC);
-			sqlite3_bind_text(insert_into_genealogical_comparisons_stmt, 2, secondary_wit_id.c_str(), -1, SQLITE_STATIC);
-			sqlite3_bind_blob(insert_into_genealogical_comparisons_stmt, 3, agreements_buf, agreements_expected_size, SQLITE_STATIC);
-			sqlite3_bind_blob(insert_into_genealogical_comparisons_stmt, 4, explained_buf, explained_expected_size, SQLITE_STATIC);
-			sqlite3_bind_double(insert_into_genealogical_comparisons_stmt, 5, cost);
-			rc = sqlite3_step(insert_into_genealogical_comparisons_stmt);
-			if (rc != SQLITE_DONE) {
-				cerr << "Error executing prepared statement." << endl;
-				delete[] agreements_buf;
-				delete[] explained_buf;
-				exit(1);
-			}
-			//Then clean up allocated memory and reset the prepared statement so we can bind the next values to it:
-			delete[] agreements_buf;
-			delete[] explained_buf;
-			sqlite3_reset(insert_into_genealogical_comparisons_stmt);
-		}
-	}
-	sqlite3_finalize(insert_into_genealogical_comparisons_stmt);
-	sqlite3_exec(output_db, "END TRANSACTION", NULL, NULL, & transaction_error_msg);
 	return;
 }
 
 /**
- * Creates, indexes, and populates the WITNESSES table.
+ * Creates and indexes the GENEALOGICAL_COMPARISONS table, along with the BITMAPS table that holds its bitmaps.
+ * The table is clustered on its primary key of primary and secondary witness keys,
+ * so the comparisons relative to each witness are stored together and need no separate index;
+ * the secondary witness index serves queries for the comparisons of all witnesses relative to one.
+ * If the given flag is set, then the index is not created, so that it can be built after the table has been populated.
  */
-void populate_witnesses_table(sqlite3 * output_db, const list<witness> & witnesses) {
+void create_genealogical_comparisons_table(sqlite3 * output_db, bool defer_index) {
 	int rc; //to store SQLite macros
-	cout << "Populating table WITNESSES..." << endl;
-	//Create the WITNESSES table:
-	string create_witnesses_sql = "DROP TABLE IF EXISTS WITNESSES;"
-			"CREATE TABLE WITNESSES ("
-			"WITNESS TEXT NOT NULL);";
-	char * create_witnesses_error_msg;
-	rc = sqlite3_exec(output_db, create_witnesses_sql.c_str(), NULL, 0, & create_witnesses_error_msg);
-	if (rc != SQLITE_OK) {
-		cerr << "Error creating table WITNESSES: " << create_witnesses_error_msg << endl;
-		sqlite3_free(create_witnesses_error_msg);
-		exit(1);
-	}
-	//Denormalize it:
-	string create_witnesses_idx_sql = "DROP INDEX IF EXISTS WITNESSES_IDX;"
-			"CREATE INDEX WITNESSES_IDX ON WITNESSES (WITNESS);";
-	char * create_witnesses_idx_error_msg;
-	rc = sqlite3_exec(output_db, create_witnesses_idx_sql.c_str(), NULL, 0, & create_witnesses_idx_error_msg);
+	//Create the BITMAPS table that its rows refer to:
+	char * create_bitmaps_error_msg;
+	rc = sqlite3_exec(output_db, CREATE_BITMAPS_TABLE_SQL.c_str(), NULL, 0, & create_bitmaps_error_msg);
 	if (rc != SQLITE_OK) {
-		cerr << "Error creating index WITNESSES_IDX: " << create_witnesses_idx_error_msg << endl;
-		sqlite3_free(create_witnesses_idx_error_msg);
+		cerr << "Error creating table BITMAPS: " << create_bitmaps_error_msg << endl;
+		sqlite3_free(create_bitmaps_error_msg);
 		exit(1);
 	}
-	//Then populate it using prepared statements within a single transaction:
-	char * transaction_error_msg;
-	sqlite3_exec(output_db, "BEGIN TRANSACTION", NULL, NULL, & transaction_error_msg);
-	sqlite3_stmt * insert_into_witnesses_stmt;
-	rc = sqlite3_prepare(output_db, "INSERT INTO WITNESSES VALUES (?)", -1, & insert_into_witnesses_stmt, 0);
+	//Create the GENEALOGICAL_COMPARISONS table:
+	char * create_genealogical_comparisons_error_msg;
+	rc = sqlite3_exec(output_db, CREATE_GENEALOGICAL_COMPARISONS_TABLE_SQL.c_str(), NULL, 0, & create_genealogical_comparisons_error_msg);
 	if (rc != SQLITE_OK) {
-		cerr << "Error preparing statement." << endl;
+		cerr << "Error creating table GENEALOGICAL_COMPARISONS: " << create_genealogical_comparisons_error_msg << endl;
+		sqlite3_free(create_genealogical_comparisons_error_msg);
 		exit(1);
 	}
-	for (witness wit : witnesses) {
-		string wit_id = wit.get_id();
-		//Then insert a row containing these values:
-		sqlite3_bind_text(insert_into_witnesses_stmt, 1, wit_id.c_str(), -1, SQLITE_STATIC);
-		rc = sqlite3_step(insert_into_witnesses_stmt);
-		if (rc != SQLITE_DONE) {
-			cerr << "Error executing prepared statement." << endl;
-			exit(1);
-		}
-		//Then reset the prepared statement so we can bind the next values to it:
-		sqlite3_reset(insert_into_witnesses_stmt);
+	//Denormalize it, unless this is deferred until the table has been populated:
+	if (!defer_index) {
+		index_genealogical_comparisons_table(output_db);
 	}
-	sqlite3_finalize(insert_into_witnesses_stmt);
-	sqlite3_exec(output_db, "END TRANSACTION", NULL, NULL, & transaction_error_msg);
 	return;
 }
 
+//Define data structure for a serialized row of the GENEALOGICAL_COMPARISONS table:
+struct serialized_comparison {
+	unsigned int secondary_wit_ind;
+	vector<char> agreements;
+	uint64_t agreements_hash;
+	vector<char> explained;
+	uint64_t explained_hash;
+	float cost;
+};
+
 /**
- * Entry point to the script.
+ * Interns serialized bitmaps in the BITMAPS table of a database, so that each distinct bitmap is stored there only once.
+ * Bitmaps are looked up by their FNV-1a hashes, and a bitmap whose hash matches a stored one is compared with it byte for byte,
+ * so a hash collision only costs a lookup and never merges different bitmaps.
  */
-int main(int argc, char* argv[]) {
-	//Read in the command-line options:
-	set<string> trivial_reading_types = set<string>();
-	bool drop_ambiguous = false;
-	bool merge_splits = false;
-	int threshold = 0;
-	string input_xml_name = string();
-	string output_db_name = string();
-	try {
-		cxxopts::Options options("populate_db", "Parses the given collation XML file and populates the genealogical cache in the given SQLite database.");
-		options.custom_help("[-h] [-t threshold] [-z trivial_reading_type_1 -z trivial_reading_type_2 ...] [--drop-ambiguous] [--merge-splits] input_xml output_db");
-		//options.positional_help("").show_positional_help();
-		options.add_options("")
-				("h,help", "print this help")
-				("t,threshold", "minimum extant readings threshold", cxxopts::value<int>())
-				("z", "reading type to treat as trivial (this may be used multiple times)", cxxopts::value<vector<string>>())
-				("drop-ambiguous", "treat ambiguous readings as lacunose", cxxopts::value<bool>())
-				("merge-splits", "merge split attestations of the same reading", cxxopts::value<bool>());
-		options.add_options("positional")
-				("input_xml", "collation file in TEI XML format", cxxopts::value<string>())
-				("output_db", "output SQLite database (if an existing database is provided, its contents will be overwritten)", cxxopts::value<vector<string>>());
-		options.parse_positional({"input_xml", "output_db"});
-		auto args = options.parse(argc, argv);
-		//Print help documentation and exit if specified:
-		if (args.count("help")) {
-			cout << options.help({""}) << endl;
-			exit(0);
+class bitmap_table_writer {
+private:
+	sqlite3 * db;
+	sqlite3_stmt * insert_into_bitmaps_stmt;
+	sqlite3_stmt * select_bitmap_stmt;
+	unordered_multimap<uint64_t, sqlite3_int64> bitmap_ids; //keys of the stored bitmaps, keyed by their hashes
+	sqlite3_int64 next_bitmap_id = 0;
+public:
+	/**
+	 * Constructs a writer for the BITMAPS table of the given database, which must already exist,
+	 * reading the hashes of any bitmaps already stored in it.
+	 */
+	bitmap_table_writer(sqlite3 * _db) {
+		int rc; //to store SQLite macros
+		db = _db;
+		rc = sqlite3_prepare(db, "INSERT INTO BITMAPS VALUES (?,?,?)", -1, & insert_into_bitmaps_stmt, 0);
+		if (rc != SQLITE_OK) {
+			cerr << "Error preparing statement." << endl;
+			exit(1);
 		}
-		//Parse the optional arguments:
-		if (args.count("t")) {
-			threshold = args["t"].as<int>();
+		rc = sqlite3_prepare(db, SELECT_BITMAP_SQL.c_str(), -1, & select_bitmap_stmt, 0);
+		if (rc != SQLITE_OK) {
+			cerr << "Error preparing statement." << endl;
+			exit(1);
 		}
-		if (args.count("z")) {
-			for (string trivial_reading_type : args["z"].as<vector<string>>()) {
-				trivial_reading_types.insert(trivial_reading_type);
-			}
+		sqlite3_stmt * select_bitmap_hashes_stmt;
+		rc = sqlite3_prepare(db, "SELECT BITMAP_ID, HASH FROM BITMAPS", -1, & select_bitmap_hashes_stmt, 0);
+		if (rc != SQLITE_OK) {
+			cerr << "Error preparing statement." << endl;
+			exit(1);
 		}
-		if (args.count("drop-ambiguous")) {
-			drop_ambiguous = args["drop-ambiguous"].as<bool>();
+		while (sqlite3_step(select_bitmap_hashes_stmt) == SQLITE_ROW) {
+			sqlite3_int64 bitmap_id = sqlite3_column_int64(select_bitmap_hashes_stmt, 0);
+			bitmap_ids.insert(make_pair(uint64_t(sqlite3_column_int64(select_bitmap_hashes_stmt, 1)), bitmap_id));
+			next_bitmap_id = max(next_bitmap_id, bitmap_id + 1);
 		}
-		if (args.count("merge-splits")) {
-			merge_splits = args["merge-splits"].as<bool>();
+		sqlite3_finalize(select_bitmap_hashes_stmt);
+	}
+	bitmap_table_writer(const bitmap_table_writer &) = delete;
+	bitmap_table_writer & operator=(const bitmap_table_writer &) = delete;
+	/**
+	 * Finalizes the writer's prepared statements.
+	 */
+	virtual ~bitmap_table_writer() {
+		sqlite3_finalize(insert_into_bitmaps_stmt);
+		sqlite3_finalize(select_bitmap_stmt);
+	}
+	/**
+	 * Returns the key of the given serialized bitmap with the given hash in the BITMAPS table,
+	 * inserting it into the table if it is not already there.
+	 */
+	sqlite3_int64 add(const vector<char> & bytes, uint64_t hash) {
+		int rc; //to store SQLite macros
+		auto range = bitmap_ids.equal_range(hash);
+		for (auto it = range.first; it != range.second; it++) {
+			sqlite3_bind_int64(select_bitmap_stmt, 1, it->second);
+			bool same = false;
+			if (sqlite3_step(select_bitmap_stmt) == SQLITE_ROW) {
+				const char * stored_bytes = reinterpret_cast<const char *>(sqlite3_column_blob(select_bitmap_stmt, 0));
+				size_t n_stored_bytes = sqlite3_column_bytes(select_bitmap_stmt, 0);
+				same = n_stored_bytes == bytes.size() && equal(bytes.begin(), bytes.end(), stored_bytes);
+			}
+			sqlite3_reset(select_bitmap_stmt);
+			if (same) {
+				return it->second;
+			}
 		}
-		//Parse the positional arguments:
-		if (!args.count("input_xml") || args.count("output_db") != 1) {
-			cerr << "Error: 2 positional arguments (input_xml and output_db) are required." << endl;
+		sqlite3_int64 bitmap_id = next_bitmap_id++;
+		sqlite3_bind_int64(insert_into_bitmaps_stmt, 1, bitmap_id);
+		sqlite3_bind_int64(insert_into_bitmaps_stmt, 2, sqlite3_int64(hash));
+		sqlite3_bind_blob(insert_into_bitmaps_stmt, 3, bytes.data(), bytes.size(), SQLITE_STATIC);
+		rc = sqlite3_step(insert_into_bitmaps_stmt);
+		if (rc != SQLITE_DONE) {
+			cerr << "Error executing prepared statement." << endl;
 			exit(1);
 		}
-		else {
-			input_xml_name = args["input_xml"].as<string>();
-			output_db_name = args["output_db"].as<vector<string>>()[0];
-		}
-	}
-	catch (const cxxopts::OptionException & e) {
-		cerr << "Error parsing options: " << e.what() << endl;
-		exit(-1);
+		sqlite3_reset(insert_into_bitmaps_stmt);
+		bitmap_ids.insert(make_pair(hash, bitmap_id));
+		return bitmap_id;
 	}
-	//Attempt to parse the input XML file as an apparatus:
+};
+
+//Define data structure for the parts of a genealogical comparison that the POTENTIAL_ANCESTORS table is calculated from:
+struct comparison_summary {
+	unsigned int agreements;
+	unsigned int explained;
+	unsigned int prior; //variation units where the primary witness has a prior reading
+	unsigned int posterior; //variation units where the primary witness has a posterior reading
+	float cost;
+};
+
+//Define data structure for the summaries of the genealogical comparisons of every pair of witnesses, along with each witness's extant passages,
+//which are gathered while the comparisons are calculated so that the POTENTIAL_ANCESTORS table can be populated without decoding them again:
+struct comparison_summaries {
+	unsigned int n_wits;
+	vector<comparison_summary> comps; //comparison of the witness with key j relative to the witness with key i at index i * n_wits + j
+	vector<Roaring> extant; //variation units where each witness is extant
+};
+
+/**
+ * Resets the given comparison summaries for the given number of witnesses.
+ */
+void init_comparison_summaries(comparison_summaries & summaries, unsigned int n_wits) {
+	summaries.n_wits = n_wits;
+	comparison_summary empty_summary;
+	empty_summary.agreements = 0;
+	empty_summary.explained = 0;
+	empty_summary.prior = 0;
+	empty_summary.posterior = 0;
+	empty_summary.cost = 0;
+	summaries.comps.assign(size_t(n_wits) * n_wits, empty_summary);
+	summaries.extant.assign(n_wits, Roaring());
+	return;
+}
+
+/**
+ * Records the given genealogical comparison of the secondary witness with the given key relative to the primary witness with the given key in the given comparison summaries,
+ * along with the variation units where the primary witness explains the secondary witness in the reverse comparison.
+ * Distinct pairs of witnesses are recorded in distinct places, so different threads can record different pairs at once.
+ */
+void summarize_genealogical_comparison(comparison_summaries & summaries, unsigned int primary_wit_ind, unsigned int secondary_wit_ind, const genealogical_comparison & comp, const Roaring & reverse_explained) {
+	comparison_summary & summary = summaries.comps[size_t(primary_wit_ind) * summaries.n_wits + secondary_wit_ind];
+	summary.agreements = comp.agreements->cardinality();
+	summary.explained = comp.explained->cardinality();
+	//Agreements need not be explained in both directions (e.g., when trivial readings are ignored),
+	//so count the explained variation units that are not agreements, and vice versa:
+	summary.prior = reverse_explained.xor_cardinality(*comp.agreements);
+	summary.posterior = comp.explained->xor_cardinality(*comp.agreements);
+	summary.cost = comp.cost;
+	//A witness's comparison relative to itself explains exactly the variation units where it is extant:
+	if (primary_wit_ind == secondary_wit_ind) {
+		summaries.extant[primary_wit_ind] = *comp.explained;
+	}
+	return;
+}
+
+/**
+ * A bounded queue whose items are pushed with consecutive indices in any order but popped in order of index.
+ * A push blocks until its index is within the queue's capacity of the next index to be popped,
+ * so the queue never holds more than that many items, and the item with the next index can always be pushed.
+ */
+template <typename T>
+class ordered_queue {
+private:
+	mutex queue_mutex;
+	condition_variable changed;
+	unsigned int capacity;
+	unsigned int next_ind = 0;
+	unsigned int end_ind;
+	map<unsigned int, T> items;
+public:
+	/**
+	 * Constructs an ordered queue with the given capacity for the items with indices from 0 up to the given end index.
+	 */
+	ordered_queue(unsigned int _capacity, unsigned int _end_ind) {
+		capacity = max(1u, _capacity);
+		end_ind = _end_ind;
+	}
+	/**
+	 * Pushes the given item with the given index onto the queue, waiting until there is room for it.
+	 */
+	void push(unsigned int ind, T item) {
+		unique_lock<mutex> lock(queue_mutex);
+		changed.wait(lock, [&]() { return ind < next_ind + capacity; });
+		items[ind] = move(item);
+		changed.notify_all();
+	}
+	/**
+	 * Pops the item with the next index from the queue into the given item, waiting until it has been pushed.
+	 * The return value is false if all items have already been popped.
+	 */
+	bool pop(T & item) {
+		unique_lock<mutex> lock(queue_mutex);
+		if (next_ind >= end_ind) {
+			return false;
+		}
+		changed.wait(lock, [&]() { return items.find(next_ind) != items.end(); });
+		item = move(items[next_ind]);
+		items.erase(next_ind);
+		next_ind++;
+		changed.notify_all();
+		return true;
+	}
+};
+
+/**
+ * Serializes the genealogical comparison of the secondary witness with the given index into the given GENEALOGICAL_COMPARISONS row,
+ * along with the hashes of its bitmaps, so that they can be looked up in the BITMAPS table.
+ * The row's byte arrays are resized rather than reallocated, so a row can be reused as a buffer for many comparisons.
+ */
+void serialize_genealogical_comparison(unsigned int secondary_wit_ind, const genealogical_comparison & comp, serialized_comparison & row) {
+	row.secondary_wit_ind = secondary_wit_ind;
+	//Serialize the bitmaps into byte arrays and hash them:
+	row.agreements.resize(comp.agreements->getSizeInBytes());
+	comp.agreements->write(row.agreements.data());
+	row.agreements_hash = HASH_OFFSET_BASIS;
+	hash_bytes(row.agreements_hash, row.agreements.data(), row.agreements.size());
+	row.explained.resize(comp.explained->getSizeInBytes());
+	comp.explained->write(row.explained.data());
+	row.explained_hash = HASH_OFFSET_BASIS;
+	hash_bytes(row.explained_hash, row.explained.data(), row.explained.size());
+	//Get the genealogical cost:
+	row.cost = comp.cost;
+	return;
+}
+
+//Define the maximum number of GENEALOGICAL_COMPARISONS rows to insert in a single transaction:
+const unsigned int ROWS_PER_TRANSACTION = 100000;
+
+/**
+ * Inserts the given serialized GENEALOGICAL_COMPARISONS rows for the primary witness with the given index using the given prepared INSERT statement,
+ * adding their bitmaps to the BITMAPS table through the given writer.
+ * To keep transactions at a bounded size, the current transaction is committed and a new one begun every ROWS_PER_TRANSACTION rows,
+ * using the given count of rows inserted since the last commit.
+ */
+void insert_genealogical_comparisons(sqlite3 * output_db, sqlite3_stmt * insert_into_genealogical_comparisons_stmt, bitmap_table_writer & bitmaps, unsigned int primary_wit_ind, const vector<serialized_comparison> & rows, unsigned int & n_uncommitted_rows) {
+	int rc; //to store SQLite macros
+	char * transaction_error_msg;
+	for (const serialized_comparison & row : rows) {
+		//Insert a row containing these values:
+		sqlite3_bind_int(insert_into_genealogical_comparisons_stmt, 1, primary_wit_ind);
+		sqlite3_bind_int(insert_into_genealogical_comparisons_stmt, 2, row.secondary_wit_ind);
+		sqlite3_bind_int64(insert_into_genealogical_comparisons_stmt, 3, bitmaps.add(row.agreements, row.agreements_hash));
+		sqlite3_bind_int64(insert_into_genealogical_comparisons_stmt, 4, bitmaps.add(row.explained, row.explained_hash));
+		sqlite3_bind_double(insert_into_genealogical_comparisons_stmt, 5, row.cost);
+		rc = sqlite3_step(insert_into_genealogical_comparisons_stmt);
+		if (rc != SQLITE_DONE) {
+			cerr << "Error executing prepared statement." << endl;
+			exit(1);
+		}
+		//Then reset the prepared statement so we can bind the next values to it:
+		sqlite3_reset(insert_into_genealogical_comparisons_stmt);
+		n_uncommitted_rows++;
+		if (n_uncommitted_rows == ROWS_PER_TRANSACTION) {
+			sqlite3_exec(output_db, "END TRANSACTION", NULL, NULL, & transaction_error_msg);
+			sqlite3_exec(output_db, "BEGIN TRANSACTION", NULL, NULL, & transaction_error_msg);
+			n_uncommitted_rows = 0;
+		}
+	}
+	return;
+}
+
+/**
+ * Creates, indexes, and populates the GENEALOGICAL_COMPARISONS table.
+ * Given a list of witness IDs, a textual apparatus, a comparison kernel, and a number of worker threads,
+ * the worker threads calculate the genealogical comparisons of the witnesses while the calling thread writes them to the table,
+ * one primary witness at a time and in the order of the list, as soon as they are complete.
+ * By default, each pair of witnesses is compared in both directions at once, when the first witness of the pair in the list is processed,
+ * and the comparisons are held in memory until they are written.
+ * If the stream flag is set, then the comparisons relative to each primary witness are instead calculated and serialized by its worker,
+ * and only a few witnesses per worker are held in memory at once, apart from the fixed-size summary of each comparison.
+ * The rows refer to their bitmaps by key, and each distinct bitmap is stored only once in the BITMAPS table, in the order in which it is first written.
+ * In either case, the contents of the table do not depend on the number of threads,
+ * and the rows are inserted in the order of the table's primary key, with each witness keyed by its index in the list.
+ * The workers also record a summary of every comparison in the given comparison summaries.
+ * If the given flag is set, then the index is not created, so that it can be built after the table has been populated.
+ */
+void populate_genealogical_comparisons_table(sqlite3 * output_db, const list<string> & list_wit, const apparatus & app, comparison_kernel kernel, unsigned int n_threads, bool stream, bool defer_index, comparison_summaries & summaries) {
+	int rc; //to store SQLite macros
+	cout << "Populating table GENEALOGICAL_COMPARISONS using " << n_threads << " thread(s) (this may take a while)..." << endl;
+	create_genealogical_comparisons_table(output_db, defer_index);
+	//Then populate it using prepared statements within batched transactions:
+	char * transaction_error_msg;
+	sqlite3_exec(output_db, "BEGIN TRANSACTION", NULL, NULL, & transaction_error_msg);
+	sqlite3_stmt * insert_into_genealogical_comparisons_stmt;
+	rc = sqlite3_prepare(output_db, "INSERT INTO GENEALOGICAL_COMPARISONS VALUES (?,?,?,?,?)", -1, & insert_into_genealogical_comparisons_stmt, 0);
+	if (rc != SQLITE_OK) {
+		cerr << "Error preparing statement." << endl;
+		exit(1);
+	}
+	bitmap_table_writer bitmaps(output_db);
+	unsigned int n_uncommitted_rows = 0;
+	//Copy the witness IDs to a vector so that workers can claim them by index:
+	vector<string> wit_ids = vector<string>(list_wit.begin(), list_wit.end());
+	unsigned int n_wits = wit_ids.size();
+	init_comparison_summaries(summaries, n_wits);
+	//Don't start more workers than there are witnesses:
+	n_threads = max(1u, min(n_threads, n_wits));
+	//Each worker repeatedly claims the next unprocessed witness until none are left:
+	atomic<unsigned int> next_wit_ind(0);
+	mutex cout_mutex;
+	vector<thread> workers = vector<thread>();
+	if (stream) {
+		//Each worker passes the serialized rows of its witness to the writer through a queue with room for a few witnesses per worker,
+		//and the writer returns the rows that it has written to a pool of spare buffers:
+		ordered_queue<vector<serialized_comparison>> queue(2 * n_threads, n_wits);
+		vector<vector<serialized_comparison>> spare_rows = vector<vector<serialized_comparison>>();
+		mutex spare_rows_mutex;
+		auto work = [&]() {
+			vector<genealogical_comparison> row_comps = vector<genealogical_comparison>();
+			vector<genealogical_comparison> reverse_comps = vector<genealogical_comparison>();
+			unsigned int wit_ind = next_wit_ind++;
+			while (wit_ind < n_wits) {
+				string wit_id = wit_ids[wit_ind];
+				{
+					lock_guard<mutex> lock(cout_mutex);
+					cout << "Calculating coherences for witness " << wit_id << "..." << endl;
+				}
+				//The reverse comparisons are only kept long enough to count the variation units where this witness has prior readings:
+				compare_witnesses_both_ways(wit_id, list_wit, app, kernel, row_comps, reverse_comps);
+				vector<serialized_comparison> rows = vector<serialized_comparison>(n_wits);
+				{
+					lock_guard<mutex> lock(spare_rows_mutex);
+					if (!spare_rows.empty()) {
+						rows.swap(spare_rows.back());
+						spare_rows.pop_back();
+					}
+				}
+				for (unsigned int other_wit_ind = 0; other_wit_ind < n_wits; other_wit_ind++) {
+					serialize_genealogical_comparison(other_wit_ind, row_comps[other_wit_ind], rows[other_wit_ind]);
+					summarize_genealogical_comparison(summaries, wit_ind, other_wit_ind, row_comps[other_wit_ind], *reverse_comps[other_wit_ind].explained);
+				}
+				queue.push(wit_ind, move(rows));
+				wit_ind = next_wit_ind++;
+			}
+		};
+		for (unsigned int i = 0; i < n_threads; i++) {
+			workers.push_back(thread(work));
+		}
+		//Meanwhile, write the rows of each witness as they become available:
+		vector<serialized_comparison> rows;
+		unsigned int wit_ind = 0;
+		while (queue.pop(rows)) {
+			insert_genealogical_comparisons(output_db, insert_into_genealogical_comparisons_stmt, bitmaps, wit_ind, rows, n_uncommitted_rows);
+			{
+				lock_guard<mutex> lock(spare_rows_mutex);
+				spare_rows.push_back(move(rows));
+			}
+			wit_ind++;
+		}
+	}
+	else {
+		//Initialize a matrix of comparisons, where each row holds the comparisons of all witnesses relative to one witness:
+		vector<vector<genealogical_comparison>> comps = vector<vector<genealogical_comparison>>(n_wits, vector<genealogical_comparison>(n_wits));
+		//Row i of the matrix is complete once the witnesses up to i have been processed,
+		//so the workers signal the writer through a queue that can hold every witness:
+		ordered_queue<unsigned int> queue(n_wits, n_wits);
+		auto work = [&]() {
+			vector<genealogical_comparison> row_comps = vector<genealogical_comparison>();
+			vector<genealogical_comparison> reverse_comps = vector<genealogical_comparison>();
+			unsigned int wit_ind = next_wit_ind++;
+			while (wit_ind < n_wits) {
+				string wit_id = wit_ids[wit_ind];
+				{
+					lock_guard<mutex> lock(cout_mutex);
+					cout << "Calculating coherences for witness " << wit_id << "..." << endl;
+				}
+				//Compare this witness to itself and the witnesses after it, and fill in the comparisons in both directions:
+				list<string> later_wit_ids = list<string>(wit_ids.begin() + wit_ind, wit_ids.end());
+				compare_witnesses_both_ways(wit_id, later_wit_ids, app, kernel, row_comps, reverse_comps);
+				for (unsigned int i = 0; i < row_comps.size(); i++) {
+					unsigned int other_wit_ind = wit_ind + i;
+					summarize_genealogical_comparison(summaries, wit_ind, other_wit_ind, row_comps[i], *reverse_comps[i].explained);
+					if (other_wit_ind != wit_ind) {
+						summarize_genealogical_comparison(summaries, other_wit_ind, wit_ind, reverse_comps[i], *row_comps[i].explained);
+						comps[other_wit_ind][wit_ind] = move(reverse_comps[i]);
+					}
+					comps[wit_ind][other_wit_ind] = move(row_comps[i]);
+				}
+				queue.push(wit_ind, wit_ind);
+				wit_ind = next_wit_ind++;
+			}
+		};
+		for (unsigned int i = 0; i < n_threads; i++) {
+			workers.push_back(thread(work));
+		}
+		//Meanwhile, write each row as soon as it is complete, reusing the same serialization buffers for every row and freeing each row once it has been written:
+		vector<serialized_comparison> rows = vector<serialized_comparison>(n_wits);
+		unsigned int wit_ind;
+		while (queue.pop(wit_ind)) {
+			for (unsigned int other_wit_ind = 0; other_wit_ind < n_wits; other_wit_ind++) {
+				serialize_genealogical_comparison(other_wit_ind, comps[wit_ind][other_wit_ind], rows[other_wit_ind]);
+			}
+			vector<genealogical_comparison>().swap(comps[wit_ind]);
+			insert_genealogical_comparisons(output_db, insert_into_genealogical_comparisons_stmt, bitmaps, wit_ind, rows, n_uncommitted_rows);
+		}
+	}
+	for (thread & worker : workers) {
+		worker.join();
+	}
+	sqlite3_finalize(insert_into_genealogical_comparisons_stmt);
+	sqlite3_exec(output_db, "END TRANSACTION", NULL, NULL, & transaction_error_msg);
+	return;
+}
+
+/**
+ * Creates the POTENTIAL_ANCESTORS table.
+ * The table is clustered on its primary key of primary and secondary witness keys,
+ * so the rankings relative to each witness are stored together and need no separate index.
+ */
+void create_potential_ancestors_table(sqlite3 * output_db) {
+	int rc; //to store SQLite macros
+	char * create_potential_ancestors_error_msg;
+	rc = sqlite3_exec(output_db, CREATE_POTENTIAL_ANCESTORS_TABLE_SQL.c_str(), NULL, 0, & create_potential_ancestors_error_msg);
+	if (rc != SQLITE_OK) {
+		cerr << "Error creating table POTENTIAL_ANCESTORS: " << create_potential_ancestors_error_msg << endl;
+		sqlite3_free(create_potential_ancestors_error_msg);
+		exit(1);
+	}
+	return;
+}
+
+/**
+ * Creates and populates the POTENTIAL_ANCESTORS table, replacing any existing contents,
+ * using the given list of witness IDs and the summaries of the genealogical comparisons between them.
+ * The worker threads rank the other witnesses relative to each witness in the same way as the witness class does from full genealogical comparisons,
+ * while the calling thread writes the rankings of each witness to the table in order of witness key.
+ */
+void populate_potential_ancestors_table(sqlite3 * output_db, const list<string> & list_wit, const comparison_summaries & summaries, unsigned int n_threads) {
+	int rc; //to store SQLite macros
+	cout << "Populating table POTENTIAL_ANCESTORS using " << n_threads << " thread(s)..." << endl;
+	create_potential_ancestors_table(output_db);
+	//Then populate it using a prepared statement within batched transactions, unless the caller has already begun a transaction:
+	char * transaction_error_msg;
+	bool own_transaction = sqlite3_get_autocommit(output_db) != 0;
+	if (own_transaction) {
+		sqlite3_exec(output_db, "BEGIN TRANSACTION", NULL, NULL, & transaction_error_msg);
+	}
+	sqlite3_stmt * insert_into_potential_ancestors_stmt;
+	rc = sqlite3_prepare(output_db, "INSERT INTO POTENTIAL_ANCESTORS VALUES (?,?,?,?,?,?,?,?,?)", -1, & insert_into_potential_ancestors_stmt, 0);
+	if (rc != SQLITE_OK) {
+		cerr << "Error preparing statement." << endl;
+		exit(1);
+	}
+	vector<string> wit_ids = vector<string>(list_wit.begin(), list_wit.end());
+	unordered_map<string, unsigned int> wit_inds = unordered_map<string, unsigned int>();
+	for (unsigned int wit_ind = 0; wit_ind < wit_ids.size(); wit_ind++) {
+		wit_inds[wit_ids[wit_ind]] = wit_ind;
+	}
+	unsigned int n_wits = wit_ids.size();
+	n_threads = max(1u, min(n_threads, n_wits));
+	//Each worker repeatedly claims the next unprocessed witness and passes its rankings to the writer through a queue with room for a few witnesses per worker:
+	atomic<unsigned int> next_wit_ind(0);
+	ordered_queue<list<potential_ancestor_ranking>> queue(2 * n_threads, n_wits);
+	auto work = [&]() {
+		unsigned int wit_ind = next_wit_ind++;
+		while (wit_ind < n_wits) {
+			list<potential_ancestor_ranking> rankings = list<potential_ancestor_ranking>();
+			for (unsigned int other_wit_ind = 0; other_wit_ind < n_wits; other_wit_ind++) {
+				if (other_wit_ind == wit_ind) {
+					continue;
+				}
+				const comparison_summary & comp = summaries.comps[size_t(wit_ind) * n_wits + other_wit_ind];
+				const comparison_summary & reverse_comp = summaries.comps[size_t(other_wit_ind) * n_wits + wit_ind];
+				potential_ancestor_ranking ranking;
+				ranking.id = wit_ids[other_wit_ind];
+				ranking.rank = 0;
+				ranking.agreements = comp.agreements;
+				ranking.pass = summaries.extant[wit_ind].and_cardinality(summaries.extant[other_wit_ind]);
+				ranking.prior = comp.prior;
+				ranking.posterior = comp.posterior;
+				ranking.potential_ancestor = comp.explained > reverse_comp.explained;
+				ranking.cost = comp.cost;
+				rankings.push_back(ranking);
+			}
+			rank_potential_ancestors(rankings);
+			queue.push(wit_ind, move(rankings));
+			wit_ind = next_wit_ind++;
+		}
+	};
+	vector<thread> workers = vector<thread>();
+	for (unsigned int i = 0; i < n_threads; i++) {
+		workers.push_back(thread(work));
+	}
+	//Meanwhile, write the rankings of each witness as they become available:
+	list<potential_ancestor_ranking> rankings;
+	unsigned int wit_ind = 0;
+	unsigned int n_uncommitted_rows = 0;
+	while (queue.pop(rankings)) {
+		for (const potential_ancestor_ranking & ranking : rankings) {
+			sqlite3_bind_int(insert_into_potential_ancestors_stmt, 1, wit_ind);
+			sqlite3_bind_int(insert_into_potential_ancestors_stmt, 2, wit_inds.at(ranking.id));
+			sqlite3_bind_int(insert_into_potential_ancestors_stmt, 3, ranking.rank);
+			sqlite3_bind_int(insert_into_potential_ancestors_stmt, 4, ranking.potential_ancestor ? 1 : 0);
+			sqlite3_bind_int(insert_into_potential_ancestors_stmt, 5, ranking.agreements);
+			sqlite3_bind_int(insert_into_potential_ancestors_stmt, 6, ranking.pass);
+			sqlite3_bind_int(insert_into_potential_ancestors_stmt, 7, ranking.prior);
+			sqlite3_bind_int(insert_into_potential_ancestors_stmt, 8, ranking.posterior);
+			sqlite3_bind_double(insert_into_potential_ancestors_stmt, 9, ranking.cost);
+			rc = sqlite3_step(insert_into_potential_ancestors_stmt);
+			if (rc != SQLITE_DONE) {
+				cerr << "Error executing prepared statement." << endl;
+				exit(1);
+			}
+			sqlite3_reset(insert_into_potential_ancestors_stmt);
+			n_uncommitted_rows++;
+			if (own_transaction && n_uncommitted_rows == ROWS_PER_TRANSACTION) {
+				sqlite3_exec(output_db, "END TRANSACTION", NULL, NULL, & transaction_error_msg);
+				sqlite3_exec(output_db, "BEGIN TRANSACTION", NULL, NULL, & transaction_error_msg);
+				n_uncommitted_rows = 0;
+			}
+		}
+		wit_ind++;
+	}
+	for (thread & worker : workers) {
+		worker.join();
+	}
+	sqlite3_finalize(insert_into_potential_ancestors_stmt);
+	if (own_transaction) {
+		sqlite3_exec(output_db, "END TRANSACTION", NULL, NULL, & transaction_error_msg);
+	}
+	return;
+}
+
+/**
+ * Creates the SUBSTEMMATA table.
+ * The table is clustered on its primary key of primary witness key, solution index, and ancestor index,
+ * so the substemmata of each witness are stored together and need no separate index.
+ */
+void create_substemmata_table(sqlite3 * output_db) {
+	int rc; //to store SQLite macros
+	char * create_substemmata_error_msg;
+	rc = sqlite3_exec(output_db, CREATE_SUBSTEMMATA_TABLE_SQL.c_str(), NULL, 0, & create_substemmata_error_msg);
+	if (rc != SQLITE_OK) {
+		cerr << "Error creating table SUBSTEMMATA: " << create_substemmata_error_msg << endl;
+		sqlite3_free(create_substemmata_error_msg);
+		exit(1);
+	}
+	return;
+}
+
+/**
+ * Drops the SUBSTEMMATA table, if it exists, so that an outdated table is not read in place of the current genealogical comparisons.
+ */
+void drop_substemmata_table(sqlite3 * output_db) {
+	int rc; //to store SQLite macros
+	char * drop_substemmata_error_msg;
+	rc = sqlite3_exec(output_db, DROP_SUBSTEMMATA_TABLE_SQL.c_str(), NULL, 0, & drop_substemmata_error_msg);
+	if (rc != SQLITE_OK) {
+		cerr << "Error dropping table SUBSTEMMATA: " << drop_substemmata_error_msg << endl;
+		sqlite3_free(drop_substemmata_error_msg);
+		exit(1);
+	}
+	return;
+}
+
+/**
+ * Determines if the given database has a table with the given name.
+ */
+bool has_table(sqlite3 * output_db, const string & table) {
+	sqlite3_stmt * select_table_stmt;
+	int rc = sqlite3_prepare_v2(output_db, "SELECT 1 FROM sqlite_master WHERE type='table' AND name=?", -1, & select_table_stmt, 0);
+	if (rc != SQLITE_OK) {
+		return false;
+	}
+	sqlite3_bind_text(select_table_stmt, 1, table.c_str(), -1, SQLITE_STATIC);
+	bool exists = sqlite3_step(select_table_stmt) == SQLITE_ROW;
+	sqlite3_finalize(select_table_stmt);
+	return exists;
+}
+
+//Define a compact representation of an optimal substemma, as it is written to the SUBSTEMMATA table:
+struct stored_substemma {
+	float cost; //total cost of the substemma
+	int agreements; //total agreements of the primary witness with the ancestors in the substemma
+	vector<pair<unsigned int, float>> ancestors; //keys of the ancestors in the substemma, with the weights of their edges in the global stemma
+};
+
+/**
+ * Creates and populates the SUBSTEMMATA table, replacing any existing contents,
+ * using the finished GENEALOGICAL_COMPARISONS, POTENTIAL_ANCESTORS, and WITNESSES tables.
+ * The worker threads each claim the next unprocessed witness, read its genealogical comparisons and potential ancestors through a shared reader,
+ * and find its optimal substemmata in the same way as the witness class does;
+ * once all witnesses have been processed, the calling thread writes their substemmata to the table in order of witness key.
+ */
+void populate_substemmata_table(sqlite3 * output_db, unsigned int n_threads) {
+	int rc; //to store SQLite macros
+	cout << "Populating table SUBSTEMMATA using " << n_threads << " thread(s) (this may take a while)..." << endl;
+	//Each witness's comparisons are copied into a witness as soon as they are read, so the reader does not need to keep them:
+	cache_reader reader(output_db, 0);
+	if (!reader.is_open() || !reader.has_potential_ancestor_rankings()) {
+		cerr << "Error reading database: " << sqlite3_errmsg(output_db) << endl;
+		exit(1);
+	}
+	const vector<string> & wit_ids = reader.get_witness_ids();
+	unsigned int n_wits = wit_ids.size();
+	n_threads = max(1u, min(n_threads, n_wits));
+	//The reader is not thread-safe, so the workers take turns with it, and each one finds its witness's substemmata on its own:
+	mutex reader_mutex;
+	atomic<unsigned int> next_wit_ind(0);
+	vector<list<stored_substemma>> substemmata = vector<list<stored_substemma>>(n_wits);
+	auto work = [&]() {
+		unsigned int wit_ind = next_wit_ind++;
+		while (wit_ind < n_wits) {
+			const string & wit_id = wit_ids[wit_ind];
+			witness wit;
+			list<string> potential_ancestor_ids = list<string>();
+			{
+				lock_guard<mutex> lock(reader_mutex);
+				wit = witness(wit_id, reader.get_genealogical_comparisons(wit_id));
+				for (const potential_ancestor_ranking & ranking : reader.get_potential_ancestor_rankings(wit_id)) {
+					if (ranking.potential_ancestor) {
+						potential_ancestor_ids.push_back(ranking.id);
+					}
+				}
+			}
+			wit.set_potential_ancestor_ids(potential_ancestor_ids);
+			//Skip any witnesses with no potential ancestors (such as the Ausgangstext and highly lacunose witnesses):
+			if (!potential_ancestor_ids.empty()) {
+				//Get the number of extant passages for this witness:
+				unsigned int extant = wit.get_genealogical_comparison_for_witness(wit_id).explained->cardinality();
+				for (const set_cover_solution & solution : wit.get_optimal_substemmata()) {
+					stored_substemma substemma;
+					substemma.cost = solution.cost;
+					substemma.agreements = solution.agreements;
+					substemma.ancestors = vector<pair<unsigned int, float>>();
+					for (const set_cover_row & row : solution.rows) {
+						substemma.ancestors.push_back(pair<unsigned int, float>(reader.get_witness_index(row.id), float(row.agreements.cardinality()) / float(extant)));
+					}
+					substemmata[wit_ind].push_back(substemma);
+				}
+			}
+			wit_ind = next_wit_ind++;
+		}
+	};
+	vector<thread> workers = vector<thread>();
+	for (unsigned int i = 0; i < n_threads; i++) {
+		workers.push_back(thread(work));
+	}
+	for (thread & worker : workers) {
+		worker.join();
+	}
+	reader.close();
+	create_substemmata_table(output_db);
+	//Then populate it using a prepared statement within batched transactions:
+	char * transaction_error_msg;
+	sqlite3_exec(output_db, "BEGIN TRANSACTION", NULL, NULL, & transaction_error_msg);
+	sqlite3_stmt * insert_into_substemmata_stmt;
+	rc = sqlite3_prepare(output_db, "INSERT INTO SUBSTEMMATA VALUES (?,?,?,?,?,?,?)", -1, & insert_into_substemmata_stmt, 0);
+	if (rc != SQLITE_OK) {
+		cerr << "Error preparing statement." << endl;
+		exit(1);
+	}
+	unsigned int n_uncommitted_rows = 0;
+	for (unsigned int wit_ind = 0; wit_ind < n_wits; wit_ind++) {
+		unsigned int solution_ind = 0;
+		for (const stored_substemma & substemma : substemmata[wit_ind]) {
+			for (unsigned int ancestor_ind = 0; ancestor_ind < substemma.ancestors.size(); ancestor_ind++) {
+				sqlite3_bind_int(insert_into_substemmata_stmt, 1, wit_ind);
+				sqlite3_bind_int(insert_into_substemmata_stmt, 2, solution_ind);
+				sqlite3_bind_int(insert_into_substemmata_stmt, 3, ancestor_ind);
+				sqlite3_bind_int(insert_into_substemmata_stmt, 4, substemma.ancestors[ancestor_ind].first);
+				sqlite3_bind_double(insert_into_substemmata_stmt, 5, substemma.ancestors[ancestor_ind].second);
+				sqlite3_bind_double(insert_into_substemmata_stmt, 6, substemma.cost);
+				sqlite3_bind_int(insert_into_substemmata_stmt, 7, substemma.agreements);
+				rc = sqlite3_step(insert_into_substemmata_stmt);
+				if (rc != SQLITE_DONE) {
+					cerr << "Error executing prepared statement." << endl;
+					exit(1);
+				}
+				sqlite3_reset(insert_into_substemmata_stmt);
+				n_uncommitted_rows++;
+				if (n_uncommitted_rows == ROWS_PER_TRANSACTION) {
+					sqlite3_exec(output_db, "END TRANSACTION", NULL, NULL, & transaction_error_msg);
+					sqlite3_exec(output_db, "BEGIN TRANSACTION", NULL, NULL, & transaction_error_msg);
+					n_uncommitted_rows = 0;
+				}
+			}
+			solution_ind++;
+		}
+	}
+	sqlite3_finalize(insert_into_substemmata_stmt);
+	sqlite3_exec(output_db, "END TRANSACTION", NULL, NULL, & transaction_error_msg);
+	return;
+}
+
+/**
+ * Creates the TEXTUAL_FLOW_EDGES table.
+ * The table is clustered on its primary key of variation unit key and descendant witness key,
+ * so the edges at each variation unit are stored together and need no separate index.
+ */
+void create_textual_flow_edges_table(sqlite3 * output_db) {
+	int rc; //to store SQLite macros
+	char * create_textual_flow_edges_error_msg;
+	rc = sqlite3_exec(output_db, CREATE_TEXTUAL_FLOW_EDGES_TABLE_SQL.c_str(), NULL, 0, & create_textual_flow_edges_error_msg);
+	if (rc != SQLITE_OK) {
+		cerr << "Error creating table TEXTUAL_FLOW_EDGES: " << create_textual_flow_edges_error_msg << endl;
+		sqlite3_free(create_textual_flow_edges_error_msg);
+		exit(1);
+	}
+	return;
+}
+
+/**
+ * Drops the TEXTUAL_FLOW_EDGES table, if it exists, so that an outdated table is not read in place of the current genealogical comparisons.
+ */
+void drop_textual_flow_edges_table(sqlite3 * output_db) {
+	int rc; //to store SQLite macros
+	char * drop_textual_flow_edges_error_msg;
+	rc = sqlite3_exec(output_db, DROP_TEXTUAL_FLOW_EDGES_TABLE_SQL.c_str(), NULL, 0, & drop_textual_flow_edges_error_msg);
+	if (rc != SQLITE_OK) {
+		cerr << "Error dropping table TEXTUAL_FLOW_EDGES: " << drop_textual_flow_edges_error_msg << endl;
+		sqlite3_free(drop_textual_flow_edges_error_msg);
+		exit(1);
+	}
+	return;
+}
+
+/**
+ * Creates and populates the TEXTUAL_FLOW_EDGES table, replacing any existing contents,
+ * using the finished READINGS, READING_RELATIONS, READING_SUPPORT, VARIATION_UNITS, POTENTIAL_ANCESTORS, and WITNESSES tables.
+ * The worker threads each claim the next unprocessed variation unit and find its textual flow edges in the same way as the textual_flow class does,
+ * while the calling thread writes the edges at each variation unit to the table in order of variation unit key.
+ */
+void populate_textual_flow_edges_table(sqlite3 * output_db, unsigned int n_threads) {
+	int rc; //to store SQLite macros
+	cout << "Populating table TEXTUAL_FLOW_EDGES using " << n_threads << " thread(s)..." << endl;
+	//Read everything the textual flow needs up front, so the workers do not need the database:
+	cache_reader reader(output_db, 0);
+	if (!reader.is_open() || !reader.has_potential_ancestor_rankings()) {
+		cerr << "Error reading database: " << sqlite3_errmsg(output_db) << endl;
+		exit(1);
+	}
+	list<string> list_wit = list<string>(reader.get_witness_ids().begin(), reader.get_witness_ids().end());
+	const unordered_map<string, list<potential_ancestor_ranking>> potential_ancestors = reader.get_potential_ancestors();
+	set<unsigned int> all_vu_inds = set<unsigned int>();
+	for (unsigned int vu_ind = 0; vu_ind < reader.get_variation_unit_ids().size(); vu_ind++) {
+		all_vu_inds.insert(vu_ind);
+	}
+	list<variation_unit> variation_units_list = reader.get_variation_units(all_vu_inds);
+	const vector<variation_unit> variation_units = vector<variation_unit>(variation_units_list.begin(), variation_units_list.end());
+	variation_units_list.clear();
+	reader.close();
+	create_textual_flow_edges_table(output_db);
+	//Then populate it using a prepared statement within batched transactions:
+	char * transaction_error_msg;
+	sqlite3_exec(output_db, "BEGIN TRANSACTION", NULL, NULL, & transaction_error_msg);
+	sqlite3_stmt * insert_into_textual_flow_edges_stmt;
+	rc = sqlite3_prepare(output_db, "INSERT INTO TEXTUAL_FLOW_EDGES VALUES (?,?,?,?,?,?)", -1, & insert_into_textual_flow_edges_stmt, 0);
+	if (rc != SQLITE_OK) {
+		cerr << "Error preparing statement." << endl;
+		exit(1);
+	}
+	unsigned int n_vus = variation_units.size();
+	n_threads = max(1u, min(n_threads, n_vus));
+	//Each worker repeatedly claims the next unprocessed variation unit and passes its edges to the writer through a queue with room for a few variation units per worker:
+	atomic<unsigned int> next_vu_ind(0);
+	ordered_queue<list<textual_flow_edge>> queue(2 * n_threads, n_vus);
+	auto work = [&]() {
+		unsigned int vu_ind = next_vu_ind++;
+		while (vu_ind < n_vus) {
+			queue.push(vu_ind, get_textual_flow_edges(variation_units[vu_ind], list_wit, potential_ancestors));
+			vu_ind = next_vu_ind++;
+		}
+	};
+	vector<thread> workers = vector<thread>();
+	for (unsigned int i = 0; i < n_threads; i++) {
+		workers.push_back(thread(work));
+	}
+	//Meanwhile, write the edges at each variation unit as they become available:
+	list<textual_flow_edge> edges;
+	unsigned int vu_ind = 0;
+	unsigned int n_uncommitted_rows = 0;
+	while (queue.pop(edges)) {
+		for (const textual_flow_edge & e : edges) {
+			sqlite3_bind_int(insert_into_textual_flow_edges_stmt, 1, vu_ind);
+			sqlite3_bind_int(insert_into_textual_flow_edges_stmt, 2, reader.get_witness_index(e.descendant));
+			sqlite3_bind_int(insert_into_textual_flow_edges_stmt, 3, reader.get_witness_index(e.ancestor));
+			sqlite3_bind_int(insert_into_textual_flow_edges_stmt, 4, int(e.type));
+			sqlite3_bind_int(insert_into_textual_flow_edges_stmt, 5, e.connectivity);
+			sqlite3_bind_double(insert_into_textual_flow_edges_stmt, 6, e.strength);
+			rc = sqlite3_step(insert_into_textual_flow_edges_stmt);
+			if (rc != SQLITE_DONE) {
+				cerr << "Error executing prepared statement." << endl;
+				exit(1);
+			}
+			sqlite3_reset(insert_into_textual_flow_edges_stmt);
+			n_uncommitted_rows++;
+			if (n_uncommitted_rows == ROWS_PER_TRANSACTION) {
+				sqlite3_exec(output_db, "END TRANSACTION", NULL, NULL, & transaction_error_msg);
+				sqlite3_exec(output_db, "BEGIN TRANSACTION", NULL, NULL, & transaction_error_msg);
+				n_uncommitted_rows = 0;
+			}
+		}
+		vu_ind++;
+	}
+	for (thread & worker : workers) {
+		worker.join();
+	}
+	sqlite3_finalize(insert_into_textual_flow_edges_stmt);
+	sqlite3_exec(output_db, "END TRANSACTION", NULL, NULL, & transaction_error_msg);
+	return;
+}
+
+/**
+ * Indexes the WITNESSES table by witness ID.
+ */
+void index_witnesses_table(sqlite3 * output_db) {
+	int rc; //to store SQLite macros
+	char * create_witnesses_idx_error_msg;
+	rc = sqlite3_exec(output_db, CREATE_WITNESSES_INDEX_SQL.c_str(), NULL, 0, & create_witnesses_idx_error_msg);
+	if (rc != SQLITE_OK) {
+		cerr << "Error creating index WITNESSES_IDX: " << create_witnesses_idx_error_msg << endl;
+		sqlite3_free(create_witnesses_idx_error_msg);
+		exit(1);
+	}
+	return;
+}
+
+/**
+ * Creates, indexes, and populates the WITNESSES table.
+ * Each witness is keyed by its index in the given list.
+ * If the given flag is set, then the index is not created, so that it can be built after the table has been populated.
+ */
+void populate_witnesses_table(sqlite3 * output_db, const list<string> & list_wit, bool defer_index) {
+	int rc; //to store SQLite macros
+	cout << "Populating table WITNESSES..." << endl;
+	//Create the WITNESSES table:
+	char * create_witnesses_error_msg;
+	rc = sqlite3_exec(output_db, CREATE_WITNESSES_TABLE_SQL.c_str(), NULL, 0, & create_witnesses_error_msg);
+	if (rc != SQLITE_OK) {
+		cerr << "Error creating table WITNESSES: " << create_witnesses_error_msg << endl;
+		sqlite3_free(create_witnesses_error_msg);
+		exit(1);
+	}
+	//Denormalize it, unless this is deferred until the table has been populated:
+	if (!defer_index) {
+		index_witnesses_table(output_db);
+	}
+	//Then populate it using prepared statements within a single transaction:
+	char * transaction_error_msg;
+	sqlite3_exec(output_db, "BEGIN TRANSACTION", NULL, NULL, & transaction_error_msg);
+	sqlite3_stmt * insert_into_witnesses_stmt;
+	rc = sqlite3_prepare(output_db, "INSERT INTO WITNESSES VALUES (?,?)", -1, & insert_into_witnesses_stmt, 0);
+	if (rc != SQLITE_OK) {
+		cerr << "Error preparing statement." << endl;
+		exit(1);
+	}
+	unsigned int wit_ind = 0;
+	for (string wit_id : list_wit) {
+		//Then insert a row containing these values:
+		sqlite3_bind_int(insert_into_witnesses_stmt, 1, wit_ind);
+		sqlite3_bind_text(insert_into_witnesses_stmt, 2, wit_id.c_str(), -1, SQLITE_STATIC);
+		rc = sqlite3_step(insert_into_witnesses_stmt);
+		if (rc != SQLITE_DONE) {
+			cerr << "Error executing prepared statement." << endl;
+			exit(1);
+		}
+		//Then reset the prepared statement so we can bind the next values to it:
+		sqlite3_reset(insert_into_witnesses_stmt);
+		wit_ind++;
+	}
+	sqlite3_finalize(insert_into_witnesses_stmt);
+	sqlite3_exec(output_db, "END TRANSACTION", NULL, NULL, & transaction_error_msg);
+	return;
+}
+
+//Define the version of the database schema written by this script:
+const string SCHEMA_VERSION = "7";
+
+/**
+ * Returns a hash of everything about the cache's configuration that determines the layout of its tables:
+ * the processing options, the full and filtered lists of witnesses, the IDs of the variation units in order, and the schema version.
+ * A cache can only be updated incrementally if this hash has not changed.
+ */
+string hash_configuration(const set<string> & trivial_reading_types, bool drop_ambiguous, bool merge_splits, const list<string> & all_wits, const list<string> & list_wit, const list<variation_unit> & variation_units) {
+	uint64_t hash = HASH_OFFSET_BASIS;
+	for (const string & trivial_reading_type : trivial_reading_types) {
+		hash_string(hash, trivial_reading_type);
+	}
+	hash_string(hash, drop_ambiguous ? "drop-ambiguous" : "");
+	hash_string(hash, merge_splits ? "merge-splits" : "");
+	for (const string & wit_id : all_wits) {
+		hash_string(hash, wit_id);
+	}
+	hash_string(hash, "");
+	for (const string & wit_id : list_wit) {
+		hash_string(hash, wit_id);
+	}
+	hash_string(hash, "");
+	for (const variation_unit & vu : variation_units) {
+		hash_string(hash, vu.get_id());
+	}
+	//Include the version of the database schema, so that caches written with an older schema are rebuilt:
+	hash_string(hash, SCHEMA_VERSION);
+	return hash_to_hex(hash);
+}
+
+/**
+ * Returns a hash of the processed contents of the given variation unit:
+ * its label, connectivity, readings, reading support, and local stemma.
+ */
+string hash_variation_unit(const variation_unit & vu) {
+	uint64_t hash = HASH_OFFSET_BASIS;
+	hash_string(hash, vu.get_id());
+	hash_string(hash, vu.get_label());
+	int connectivity = vu.get_connectivity();
+	hash_bytes(hash, & connectivity, sizeof(connectivity));
+	for (const string & rdg : vu.get_readings()) {
+		hash_string(hash, rdg);
+	}
+	const vector<uint16_t> & reading_support = vu.get_reading_support();
+	hash_bytes(hash, reading_support.data(), reading_support.size() * sizeof(uint16_t));
+	local_stemma_graph graph = vu.get_local_stemma().get_graph();
+	for (const local_stemma_vertex & v : graph.vertices) {
+		hash_string(hash, v.id);
+	}
+	for (const local_stemma_edge & e : graph.edges) {
+		hash_string(hash, e.prior);
+		hash_string(hash, e.posterior);
+		hash_bytes(hash, & e.weight, sizeof(e.weight));
+	}
+	return hash_to_hex(hash);
+}
+
+/**
+ * Creates and populates the CACHE_CONFIGURATION and VARIATION_UNIT_HASHES tables,
+ * which record the given configuration hash and the hash of each variation unit so that later runs can update the cache incrementally.
+ */
+void populate_cache_hashes_tables(sqlite3 * output_db, const string & configuration_hash, const list<variation_unit> & variation_units) {
+	int rc; //to store SQLite macros
+	cout << "Populating tables CACHE_CONFIGURATION and VARIATION_UNIT_HASHES..." << endl;
+	//Create the tables:
+	string create_cache_hashes_sql = "DROP TABLE IF EXISTS CACHE_CONFIGURATION;"
+			"CREATE TABLE CACHE_CONFIGURATION ("
+			"HASH TEXT NOT NULL);"
+			"DROP TABLE IF EXISTS VARIATION_UNIT_HASHES;"
+			"CREATE TABLE VARIATION_UNIT_HASHES ("
+			"VARIATION_UNIT_ID INTEGER PRIMARY KEY, "
+			"HASH TEXT NOT NULL);";
+	char * create_cache_hashes_error_msg;
+	rc = sqlite3_exec(output_db, create_cache_hashes_sql.c_str(), NULL, 0, & create_cache_hashes_error_msg);
+	if (rc != SQLITE_OK) {
+		cerr << "Error creating tables CACHE_CONFIGURATION and VARIATION_UNIT_HASHES: " << create_cache_hashes_error_msg << endl;
+		sqlite3_free(create_cache_hashes_error_msg);
+		exit(1);
+	}
+	//Then populate them using prepared statements within a single transaction:
+	char * transaction_error_msg;
+	sqlite3_exec(output_db, "BEGIN TRANSACTION", NULL, NULL, & transaction_error_msg);
+	sqlite3_stmt * insert_into_cache_configuration_stmt;
+	rc = sqlite3_prepare(output_db, "INSERT INTO CACHE_CONFIGURATION VALUES (?)", -1, & insert_into_cache_configuration_stmt, 0);
+	if (rc != SQLITE_OK) {
+		cerr << "Error preparing statement." << endl;
+		exit(1);
+	}
+	sqlite3_bind_text(insert_into_cache_configuration_stmt, 1, configuration_hash.c_str(), -1, SQLITE_STATIC);
+	rc = sqlite3_step(insert_into_cache_configuration_stmt);
+	if (rc != SQLITE_DONE) {
+		cerr << "Error executing prepared statement." << endl;
+		exit(1);
+	}
+	sqlite3_finalize(insert_into_cache_configuration_stmt);
+	sqlite3_stmt * insert_into_variation_unit_hashes_stmt;
+	rc = sqlite3_prepare(output_db, "INSERT INTO VARIATION_UNIT_HASHES VALUES (?,?)", -1, & insert_into_variation_unit_hashes_stmt, 0);
+	if (rc != SQLITE_OK) {
+		cerr << "Error preparing statement." << endl;
+		exit(1);
+	}
+	unsigned int vu_ind = 0;
+	for (const variation_unit & vu : variation_units) {
+		string vu_hash = hash_variation_unit(vu);
+		sqlite3_bind_int(insert_into_variation_unit_hashes_stmt, 1, vu_ind);
+		sqlite3_bind_text(insert_into_variation_unit_hashes_stmt, 2, vu_hash.c_str(), -1, SQLITE_STATIC);
+		rc = sqlite3_step(insert_into_variation_unit_hashes_stmt);
+		if (rc != SQLITE_DONE) {
+			cerr << "Error executing prepared statement." << endl;
+			exit(1);
+		}
+		sqlite3_reset(insert_into_variation_unit_hashes_stmt);
+		vu_ind++;
+	}
+	sqlite3_finalize(insert_into_variation_unit_hashes_stmt);
+	sqlite3_exec(output_db, "END TRANSACTION", NULL, NULL, & transaction_error_msg);
+	return;
+}
+
+/**
+ * Checks whether the given database holds a cache that was built with the given configuration hash,
+ * and if so, populates the given vector with the indices of the given variation units whose hashes have changed since then.
+ * The return value is false if the cache cannot be updated incrementally and must be rebuilt.
+ */
+bool get_changed_variation_units(sqlite3 * output_db, const string & configuration_hash, const list<variation_unit> & variation_units, vector<unsigned int> & changed_vu_inds) {
+	int rc; //to store SQLite macros
+	//If the database has no configuration hash (e.g., because it is new), or if its hash differs, then it must be rebuilt:
+	sqlite3_stmt * select_from_cache_configuration_stmt;
+	rc = sqlite3_prepare(output_db, "SELECT HASH FROM CACHE_CONFIGURATION", -1, & select_from_cache_configuration_stmt, 0);
+	if (rc != SQLITE_OK) {
+		return false;
+	}
+	string stored_configuration_hash = string();
+	if (sqlite3_step(select_from_cache_configuration_stmt) == SQLITE_ROW) {
+		stored_configuration_hash = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_cache_configuration_stmt, 0)));
+	}
+	sqlite3_finalize(select_from_cache_configuration_stmt);
+	if (stored_configuration_hash != configuration_hash) {
+		return false;
+	}
+	//Otherwise, compare the hash of each variation unit with its stored hash:
+	sqlite3_stmt * select_from_variation_unit_hashes_stmt;
+	rc = sqlite3_prepare(output_db, "SELECT HASH FROM VARIATION_UNIT_HASHES ORDER BY VARIATION_UNIT_ID", -1, & select_from_variation_unit_hashes_stmt, 0);
+	if (rc != SQLITE_OK) {
+		return false;
+	}
+	vector<string> stored_vu_hashes = vector<string>();
+	while (sqlite3_step(select_from_variation_unit_hashes_stmt) == SQLITE_ROW) {
+		stored_vu_hashes.push_back(string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_variation_unit_hashes_stmt, 0))));
+	}
+	sqlite3_finalize(select_from_variation_unit_hashes_stmt);
+	if (stored_vu_hashes.size() != variation_units.size()) {
+		return false;
+	}
+	//The comparison summaries are also read back from the POTENTIAL_ANCESTORS table, so it must be there:
+	if (!has_table(output_db, "POTENTIAL_ANCESTORS")) {
+		return false;
+	}
+	changed_vu_inds = vector<unsigned int>();
+	unsigned int vu_ind = 0;
+	for (const variation_unit & vu : variation_units) {
+		if (hash_variation_unit(vu) != stored_vu_hashes[vu_ind]) {
+			changed_vu_inds.push_back(vu_ind);
+		}
+		vu_ind++;
+	}
+	return true;
+}
+
+/**
+ * Replaces the rows of the READINGS, READING_RELATIONS, READING_SUPPORT, and VARIATION_UNITS tables
+ * for the given changed variation units, using the given maps of variation unit and witness IDs to their keys.
+ * The VARIATION_UNITS rows are updated in place, since their keys are also their positions in the genealogical comparison bitmaps.
+ * The caller is expected to have begun a transaction, so that the rows are only replaced if the whole update succeeds.
+ */
+void update_variation_unit_tables(sqlite3 * output_db, const list<variation_unit> & changed_variation_units, const unordered_map<string, unsigned int> & vu_inds, const list<string> & all_wits, const unordered_map<string, unsigned int> & wit_inds) {
+	int rc; //to store SQLite macros
+	cout << "Updating tables for " << changed_variation_units.size() << " changed variation unit(s)..." << endl;
+	//Delete the old rows of the changed variation units from the tables that have several rows per variation unit:
+	for (string table : list<string>({"READINGS", "READING_RELATIONS", "READING_SUPPORT"})) {
+		sqlite3_stmt * delete_stmt;
+		rc = sqlite3_prepare(output_db, ("DELETE FROM " + table + " WHERE VARIATION_UNIT_ID=?").c_str(), -1, & delete_stmt, 0);
+		if (rc != SQLITE_OK) {
+			cerr << "Error preparing statement." << endl;
+			exit(1);
+		}
+		for (const variation_unit & vu : changed_variation_units) {
+			sqlite3_bind_int(delete_stmt, 1, vu_inds.at(vu.get_id()));
+			rc = sqlite3_step(delete_stmt);
+			if (rc != SQLITE_DONE) {
+				cerr << "Error executing prepared statement." << endl;
+				exit(1);
+			}
+			sqlite3_reset(delete_stmt);
+		}
+		sqlite3_finalize(delete_stmt);
+	}
+	//Then insert their new rows:
+	insert_into_readings_table(output_db, changed_variation_units, vu_inds);
+	insert_into_reading_relations_table(output_db, changed_variation_units, vu_inds);
+	insert_into_reading_support_table(output_db, changed_variation_units, vu_inds, all_wits, wit_inds);
+	//Then update their VARIATION_UNITS rows in place:
+	sqlite3_stmt * update_variation_units_stmt;
+	rc = sqlite3_prepare(output_db, "UPDATE VARIATION_UNITS SET LABEL=?, CONNECTIVITY=? WHERE VARIATION_UNIT_ID=?", -1, & update_variation_units_stmt, 0);
+	if (rc != SQLITE_OK) {
+		cerr << "Error preparing statement." << endl;
+		exit(1);
+	}
+	for (const variation_unit & vu : changed_variation_units) {
+		string vu_label = vu.get_label();
+		int connectivity = vu.get_connectivity();
+		sqlite3_bind_text(update_variation_units_stmt, 1, vu_label.c_str(), -1, SQLITE_STATIC);
+		sqlite3_bind_int(update_variation_units_stmt, 2, connectivity);
+		sqlite3_bind_int(update_variation_units_stmt, 3, vu_inds.at(vu.get_id()));
+		rc = sqlite3_step(update_variation_units_stmt);
+		if (rc != SQLITE_DONE) {
+			cerr << "Error executing prepared statement." << endl;
+			exit(1);
+		}
+		sqlite3_reset(update_variation_units_stmt);
+	}
+	sqlite3_finalize(update_variation_units_stmt);
+	return;
+}
+
+/**
+ * Records the new hashes of the given changed variation units in the VARIATION_UNIT_HASHES table, using the given map of variation unit IDs to their keys.
+ * This should be the last step of an incremental update, within the same transaction as the rest of it,
+ * so that the cache is never taken to be up to date with variation units whose other rows have not been updated.
+ */
+void update_variation_unit_hashes(sqlite3 * output_db, const list<variation_unit> & changed_variation_units, const unordered_map<string, unsigned int> & vu_inds) {
+	int rc; //to store SQLite macros
+	sqlite3_stmt * update_variation_unit_hashes_stmt;
+	rc = sqlite3_prepare(output_db, "UPDATE VARIATION_UNIT_HASHES SET HASH=? WHERE VARIATION_UNIT_ID=?", -1, & update_variation_unit_hashes_stmt, 0);
+	if (rc != SQLITE_OK) {
+		cerr << "Error preparing statement." << endl;
+		exit(1);
+	}
+	for (const variation_unit & vu : changed_variation_units) {
+		string vu_hash = hash_variation_unit(vu);
+		sqlite3_bind_text(update_variation_unit_hashes_stmt, 1, vu_hash.c_str(), -1, SQLITE_STATIC);
+		sqlite3_bind_int(update_variation_unit_hashes_stmt, 2, vu_inds.at(vu.get_id()));
+		rc = sqlite3_step(update_variation_unit_hashes_stmt);
+		if (rc != SQLITE_DONE) {
+			cerr << "Error executing prepared statement." << endl;
+			exit(1);
+		}
+		sqlite3_reset(update_variation_unit_hashes_stmt);
+	}
+	sqlite3_finalize(update_variation_unit_hashes_stmt);
+	return;
+}
+
+/**
+ * Returns copies of the variation units with the given indices in the given apparatus,
+ * with their reading support indexed by the keys of the given witnesses (i.e., by their positions in the given list) rather than by their indices in the apparatus,
+ * in the same way as the variation units read back from the cache.
+ */
+vector<variation_unit> get_keyed_variation_units(const apparatus & app, const list<string> & list_wit, const vector<unsigned int> & vu_inds) {
+	vector<variation_unit> keyed_variation_units = vector<variation_unit>();
+	for (unsigned int vu_ind : vu_inds) {
+		const variation_unit & vu = app.get_variation_units()[vu_ind];
+		const vector<uint16_t> & reading_support = vu.get_reading_support();
+		vector<uint16_t> keyed_reading_support = vector<uint16_t>();
+		for (const string & wit_id : list_wit) {
+			int wit_ind = app.get_witness_index(wit_id);
+			keyed_reading_support.push_back(wit_ind >= 0 && wit_ind < int(reading_support.size()) ? reading_support[wit_ind] : LACUNA);
+		}
+		keyed_variation_units.push_back(variation_unit(vu.get_id(), vu.get_label(), vu.get_readings(), keyed_reading_support, vu.get_connectivity(), vu.get_local_stemma()));
+	}
+	return keyed_variation_units;
+}
+
+/**
+ * Returns the number of set bits in the given words.
+ */
+unsigned int count_set_bits(const vector<uint64_t> & words) {
+	unsigned int n = 0;
+	for (uint64_t word : words) {
+#ifdef __GNUC__
+		n += __builtin_popcountll(word);
+#else
+		while (word != 0) {
+			word &= word - 1;
+			n++;
+		}
+#endif
+	}
+	return n;
+}
+
+/**
+ * Returns the number of bits that are set in exactly one of the given vectors of words, which must have the same size.
+ */
+unsigned int count_differing_bits(const vector<uint64_t> & words, const vector<uint64_t> & other_words) {
+	vector<uint64_t> differing_words = vector<uint64_t>(words.size());
+	for (size_t i = 0; i < words.size(); i++) {
+		differing_words[i] = words[i] ^ other_words[i];
+	}
+	return count_set_bits(differing_words);
+}
+
+/**
+ * Populates the given comparison summaries for the given number of witnesses from the stored POTENTIAL_ANCESTORS table
+ * and the stored comparisons of each witness with itself, which explain exactly the variation units where it is extant.
+ */
+void read_comparison_summaries(sqlite3 * output_db, unsigned int n_wits, comparison_summaries & summaries) {
+	int rc; //to store SQLite macros
+	init_comparison_summaries(summaries, n_wits);
+	sqlite3_stmt * select_from_potential_ancestors_stmt;
+	rc = sqlite3_prepare(output_db, "SELECT PRIMARY_WIT_ID, SECONDARY_WIT_ID, AGREEMENTS, PRIOR, POSTERIOR, COST FROM POTENTIAL_ANCESTORS", -1, & select_from_potential_ancestors_stmt, 0);
+	if (rc != SQLITE_OK) {
+		cerr << "Error preparing statement." << endl;
+		exit(1);
+	}
+	while (sqlite3_step(select_from_potential_ancestors_stmt) == SQLITE_ROW) {
+		unsigned int primary_wit_ind = sqlite3_column_int(select_from_potential_ancestors_stmt, 0);
+		unsigned int secondary_wit_ind = sqlite3_column_int(select_from_potential_ancestors_stmt, 1);
+		if (primary_wit_ind >= n_wits || secondary_wit_ind >= n_wits) {
+			continue;
+		}
+		comparison_summary & summary = summaries.comps[size_t(primary_wit_ind) * n_wits + secondary_wit_ind];
+		summary.agreements = sqlite3_column_int(select_from_potential_ancestors_stmt, 2);
+		summary.prior = sqlite3_column_int(select_from_potential_ancestors_stmt, 3);
+		summary.posterior = sqlite3_column_int(select_from_potential_ancestors_stmt, 4);
+		summary.cost = float(sqlite3_column_double(select_from_potential_ancestors_stmt, 5));
+		//The agreements are all explained, so the explained variation units are the agreements and the posterior variation units:
+		summary.explained = summary.agreements + summary.posterior;
+	}
+	sqlite3_finalize(select_from_potential_ancestors_stmt);
+	sqlite3_stmt * select_from_genealogical_comparisons_stmt;
+	rc = sqlite3_prepare(output_db, "SELECT G.PRIMARY_WIT_ID, E.BITMAP FROM GENEALOGICAL_COMPARISONS AS G INNER JOIN BITMAPS AS E ON E.BITMAP_ID=G.EXPLAINED_ID "
+			"WHERE G.PRIMARY_WIT_ID=G.SECONDARY_WIT_ID", -1, & select_from_genealogical_comparisons_stmt, 0);
+	if (rc != SQLITE_OK) {
+		cerr << "Error preparing statement." << endl;
+		exit(1);
+	}
+	while (sqlite3_step(select_from_genealogical_comparisons_stmt) == SQLITE_ROW) {
+		unsigned int wit_ind = sqlite3_column_int(select_from_genealogical_comparisons_stmt, 0);
+		if (wit_ind >= n_wits) {
+			continue;
+		}
+		summaries.extant[wit_ind] = Roaring::read(reinterpret_cast<const char *>(sqlite3_column_blob(select_from_genealogical_comparisons_stmt, 1)));
+		comparison_summary & summary = summaries.comps[size_t(wit_ind) * n_wits + wit_ind];
+		summary.agreements = summaries.extant[wit_ind].cardinality();
+		summary.explained = summary.agreements;
+	}
+	sqlite3_finalize(select_from_genealogical_comparisons_stmt);
+	return;
+}
+
+/**
+ * Updates the GENEALOGICAL_COMPARISONS table in place after the variation units with the given indices have changed,
+ * where the given list of witness IDs is the one with which the table was populated,
+ * and the given old and new versions of the changed variation units (in the same order as their indices) have their reading support indexed by witness key.
+ * Every pair of witnesses is compared only at the changed variation units, both as they were and as they are now,
+ * so only the bits of those variation units are patched in the stored bitmaps, and the stored cost is adjusted by the difference in their contributions.
+ * (Since the costs are sums of path lengths, the adjusted costs match a full rebuild exactly as long as those lengths are integers.)
+ * Only the rows that actually change are rewritten, with their patched bitmaps added to the BITMAPS table if they are not already there,
+ * and any bitmaps that are no longer referred to are then deleted.
+ * The given comparison summaries are read from the stored POTENTIAL_ANCESTORS table and adjusted in the same way, so every comparison, changed or not, is recorded in them.
+ */
+void update_genealogical_comparisons_table(sqlite3 * output_db, const list<string> & list_wit, const vector<unsigned int> & changed_vu_inds, const vector<variation_unit> & old_variation_units, const vector<variation_unit> & new_variation_units, comparison_summaries & summaries) {
+	int rc; //to store SQLite macros
+	cout << "Updating table GENEALOGICAL_COMPARISONS..." << endl;
+	unsigned int n_wits = list_wit.size();
+	const reading_matrix old_matrix = reading_matrix(old_variation_units, n_wits);
+	const reading_matrix new_matrix = reading_matrix(new_variation_units, n_wits);
+	read_comparison_summaries(output_db, n_wits, summaries);
+	sqlite3_stmt * select_from_genealogical_comparisons_stmt;
+	rc = sqlite3_prepare(output_db, "SELECT A.BITMAP, E.BITMAP, G.COST "
+			"FROM GENEALOGICAL_COMPARISONS AS G INNER JOIN BITMAPS AS A ON A.BITMAP_ID=G.AGREEMENTS_ID INNER JOIN BITMAPS AS E ON E.BITMAP_ID=G.EXPLAINED_ID "
+			"WHERE G.PRIMARY_WIT_ID=? AND G.SECONDARY_WIT_ID=?", -1, & select_from_genealogical_comparisons_stmt, 0);
+	if (rc != SQLITE_OK) {
+		cerr << "Error preparing statement." << endl;
+		exit(1);
+	}
+	sqlite3_stmt * update_genealogical_comparisons_stmt;
+	rc = sqlite3_prepare(output_db, "UPDATE GENEALOGICAL_COMPARISONS SET AGREEMENTS_ID=?, EXPLAINED_ID=?, COST=? WHERE PRIMARY_WIT_ID=? AND SECONDARY_WIT_ID=?", -1, & update_genealogical_comparisons_stmt, 0);
+	if (rc != SQLITE_OK) {
+		cerr << "Error preparing statement." << endl;
+		exit(1);
+	}
+	bitmap_table_writer bitmaps(output_db);
+	unsigned int n_rows = 0;
+	unsigned int n_updated_rows = 0;
+	//Adjusts the summary of the comparison of the given secondary witness relative to the given primary witness by the differences at the changed variation units,
+	//and patches its stored row if it has changed:
+	auto update_comparison = [&](unsigned int primary_wit_ind, unsigned int secondary_wit_ind, const row_comparison & old_comp, const row_comparison & new_comp, const row_comparison & old_reverse_comp, const row_comparison & new_reverse_comp) {
+		n_rows++;
+		comparison_summary & summary = summaries.comps[size_t(primary_wit_ind) * n_wits + secondary_wit_ind];
+		summary.agreements = summary.agreements + count_set_bits(new_comp.agreements) - count_set_bits(old_comp.agreements);
+		summary.explained = summary.explained + count_set_bits(new_comp.explained) - count_set_bits(old_comp.explained);
+		summary.prior = summary.prior + count_differing_bits(new_reverse_comp.explained, new_comp.agreements) - count_differing_bits(old_reverse_comp.explained, old_comp.agreements);
+		summary.posterior = summary.posterior + count_differing_bits(new_comp.explained, new_comp.agreements) - count_differing_bits(old_comp.explained, old_comp.agreements);
+		if (new_comp.agreements == old_comp.agreements && new_comp.explained == old_comp.explained && new_comp.cost == old_comp.cost) {
+			return;
+		}
+		sqlite3_bind_int(select_from_genealogical_comparisons_stmt, 1, primary_wit_ind);
+		sqlite3_bind_int(select_from_genealogical_comparisons_stmt, 2, secondary_wit_ind);
+		if (sqlite3_step(select_from_genealogical_comparisons_stmt) != SQLITE_ROW) {
+			cerr << "Error: The GENEALOGICAL_COMPARISONS table has no row for the witnesses with keys " << primary_wit_ind << " and " << secondary_wit_ind << "." << endl;
+			exit(1);
+		}
+		Roaring agreements = Roaring::read(reinterpret_cast<const char *>(sqlite3_column_blob(select_from_genealogical_comparisons_stmt, 0)));
+		Roaring explained = Roaring::read(reinterpret_cast<const char *>(sqlite3_column_blob(select_from_genealogical_comparisons_stmt, 1)));
+		float stored_cost = float(sqlite3_column_double(select_from_genealogical_comparisons_stmt, 2));
+		sqlite3_reset(select_from_genealogical_comparisons_stmt);
+		for (unsigned int k = 0; k < changed_vu_inds.size(); k++) {
+			uint64_t bit = uint64_t(1) << (k % 64);
+			(new_comp.agreements[k / 64] & bit) != 0 ? agreements.add(changed_vu_inds[k]) : agreements.remove(changed_vu_inds[k]);
+			(new_comp.explained[k / 64] & bit) != 0 ? explained.add(changed_vu_inds[k]) : explained.remove(changed_vu_inds[k]);
+		}
+		genealogical_comparison comp;
+		comp.cost = stored_cost + (new_comp.cost - old_comp.cost);
+		comp.agreements = make_shared<const Roaring>(move(agreements));
+		comp.explained = make_shared<const Roaring>(move(explained));
+		summary.cost = comp.cost;
+		//A witness's comparison relative to itself explains exactly the variation units where it is extant:
+		if (primary_wit_ind == secondary_wit_ind) {
+			summaries.extant[primary_wit_ind] = *comp.explained;
+		}
+		serialized_comparison row;
+		serialize_genealogical_comparison(secondary_wit_ind, comp, row);
+		sqlite3_bind_int64(update_genealogical_comparisons_stmt, 1, bitmaps.add(row.agreements, row.agreements_hash));
+		sqlite3_bind_int64(update_genealogical_comparisons_stmt, 2, bitmaps.add(row.explained, row.explained_hash));
+		sqlite3_bind_double(update_genealogical_comparisons_stmt, 3, row.cost);
+		sqlite3_bind_int(update_genealogical_comparisons_stmt, 4, primary_wit_ind);
+		sqlite3_bind_int(update_genealogical_comparisons_stmt, 5, secondary_wit_ind);
+		rc = sqlite3_step(update_genealogical_comparisons_stmt);
+		if (rc != SQLITE_DONE) {
+			cerr << "Error executing prepared statement." << endl;
+			exit(1);
+		}
+		sqlite3_reset(update_genealogical_comparisons_stmt);
+		n_updated_rows++;
+	};
+	//Compare each pair of witnesses in both directions at once, at the changed variation units as they were and as they are now:
+	row_comparison old_comp, old_reverse_comp, new_comp, new_reverse_comp;
+	for (unsigned int wit_ind = 0; wit_ind < n_wits; wit_ind++) {
+		for (unsigned int other_wit_ind = wit_ind; other_wit_ind < n_wits; other_wit_ind++) {
+			old_matrix.compare_both_ways(wit_ind, other_wit_ind, old_comp, old_reverse_comp);
+			new_matrix.compare_both_ways(wit_ind, other_wit_ind, new_comp, new_reverse_comp);
+			update_comparison(wit_ind, other_wit_ind, old_comp, new_comp, old_reverse_comp, new_reverse_comp);
+			if (other_wit_ind != wit_ind) {
+				update_comparison(other_wit_ind, wit_ind, old_reverse_comp, new_reverse_comp, old_comp, new_comp);
+			}
+		}
+	}
+	sqlite3_finalize(select_from_genealogical_comparisons_stmt);
+	sqlite3_finalize(update_genealogical_comparisons_stmt);
+	//Then delete the bitmaps that the updated rows no longer refer to:
+	char * delete_bitmaps_error_msg;
+	rc = sqlite3_exec(output_db, DELETE_UNREFERENCED_BITMAPS_SQL.c_str(), NULL, 0, & delete_bitmaps_error_msg);
+	if (rc != SQLITE_OK) {
+		cerr << "Error deleting unreferenced bitmaps: " << delete_bitmaps_error_msg << endl;
+		sqlite3_free(delete_bitmaps_error_msg);
+		exit(1);
+	}
+	cout << "Updated " << n_updated_rows << " of " << n_rows << " genealogical comparisons." << endl;
+	return;
+}
+
+/**
+ * Writes the contents of the GENEALOGICAL_COMPARISONS table of the given database to a binary genealogical cache file at the given path,
+ * which the other scripts can memory-map instead of querying the table.
+ */
+void write_binary_cache(sqlite3 * output_db, const list<string> & list_wit, const string & binary_cache_name) {
+	cout << "Writing binary cache " << binary_cache_name << "..." << endl;
+	genealogical_cache_writer writer(binary_cache_name, list_wit);
+	if (!writer.is_open()) {
+		cerr << "Error opening binary cache " << binary_cache_name << " for writing." << endl;
+		exit(1);
+	}
+	//Each witness's comparisons are written as soon as they are read, so the reader does not need to keep them:
+	cache_reader reader(output_db, 0);
+	if (!reader.is_open()) {
+		cerr << "Error reading database: " << sqlite3_errmsg(output_db) << endl;
+		exit(1);
+	}
+	const vector<string> & wit_ids = reader.get_witness_ids();
+	for (const string & primary_wit_id : wit_ids) {
+		const unordered_map<string, genealogical_comparison> & comps = reader.get_genealogical_comparisons(primary_wit_id);
+		//Add the comparisons in order of the secondary witnesses' keys:
+		for (const string & secondary_wit_id : wit_ids) {
+			unordered_map<string, genealogical_comparison>::const_iterator it = comps.find(secondary_wit_id);
+			if (it == comps.end()) {
+				continue;
+			}
+			if (!writer.add(primary_wit_id, secondary_wit_id, it->second)) {
+				cerr << "Error writing the comparison of " << secondary_wit_id << " relative to " << primary_wit_id << " to binary cache " << binary_cache_name << "." << endl;
+				exit(1);
+			}
+		}
+	}
+	reader.close();
+	if (!writer.close()) {
+		cerr << "Error writing binary cache " << binary_cache_name << "." << endl;
+		exit(1);
+	}
+	return;
+}
+
+/**
+ * Configures the given database connection for a bulk load of the genealogical cache for the given list of witnesses.
+ * Journaling and syncing are turned off, since a cache that is interrupted while being built can simply be built again,
+ * and the page cache is sized to hold the largest index, which is built after its table is populated.
+ */
+void begin_bulk_load(sqlite3 * output_db, const list<string> & list_wit, const list<variation_unit> & variation_units) {
+	int rc; //to store SQLite macros
+	//Estimate the size of the READING_SUPPORT index, which has an entry of two integer keys and a reading for every witness at every variation unit:
+	uint64_t index_bytes = 16 * list_wit.size() * variation_units.size();
+	//Use at least SQLite's default page cache of 2 MiB and at most 1 GiB:
+	uint64_t cache_kib = min(max(index_bytes / 1024, uint64_t(2048)), uint64_t(1048576));
+	string bulk_load_sql = "PRAGMA journal_mode = OFF;"
+			"PRAGMA synchronous = OFF;"
+			"PRAGMA locking_mode = EXCLUSIVE;"
+			"PRAGMA cache_size = -" + to_string(cache_kib) + ";";
+	char * bulk_load_error_msg;
+	rc = sqlite3_exec(output_db, bulk_load_sql.c_str(), NULL, 0, & bulk_load_error_msg);
+	if (rc != SQLITE_OK) {
+		cerr << "Error configuring database for bulk load: " << bulk_load_error_msg << endl;
+		sqlite3_free(bulk_load_error_msg);
+		exit(1);
+	}
+	return;
+}
+
+/**
+ * Completes a bulk load of the genealogical cache by indexing all tables and gathering statistics on them for the query planner.
+ */
+void end_bulk_load(sqlite3 * output_db) {
+	int rc; //to store SQLite macros
+	cout << "Indexing tables..." << endl;
+	index_readings_table(output_db);
+	index_reading_relations_table(output_db);
+	index_reading_support_table(output_db);
+	index_variation_units_table(output_db);
+	index_genealogical_comparisons_table(output_db);
+	index_witnesses_table(output_db);
+	cout << "Analyzing tables..." << endl;
+	char * analyze_error_msg;
+	rc = sqlite3_exec(output_db, "ANALYZE;", NULL, 0, & analyze_error_msg);
+	if (rc != SQLITE_OK) {
+		cerr << "Error analyzing database: " << analyze_error_msg << endl;
+		sqlite3_free(analyze_error_msg);
+		exit(1);
+	}
+	return;
+}
+
+/**
+ * Entry point to the script.
+ */
+int main(int argc, char* argv[]) {
+	//Read in the command-line options:
+	set<string> trivial_reading_types = set<string>();
+	bool drop_ambiguous = false;
+	bool merge_splits = false;
+	bool stream = false;
+	bool bulk = false;
+	bool rebuild = false;
+	bool substemmata = false;
+	bool flow_edges = false;
+	string binary_cache_name = string();
+	int threshold = 0;
+	unsigned int n_threads = max(1u, thread::hardware_concurrency());
+	comparison_kernel kernel = comparison_kernel::SIMD;
+	string input_xml_name = string();
+	string output_db_name = string();
+	try {
+		cxxopts::Options options("populate_db", "Parses the given collation XML file and populates the genealogical cache in the given SQLite database.");
+		options.custom_help("[-h] [-t threshold] [-j threads] [-k kernel] [-z trivial_reading_type_1 -z trivial_reading_type_2 ...] [--drop-ambiguous] [--merge-splits] [--stream] [--bulk] [--rebuild] [--substemmata] [--textual-flow] [--binary-cache path] input_xml output_db");
+		//options.positional_help("").show_positional_help();
+		options.add_options("")
+				("h,help", "print this help")
+				("t,threshold", "minimum extant readings threshold", cxxopts::value<int>())
+				("j,threads", "number of worker threads to use for calculating genealogical comparisons (defaults to the number of hardware threads)", cxxopts::value<int>())
+				("k,kernel", "kernel to use for calculating genealogical comparisons (scalar, unit-major, or simd; defaults to simd)", cxxopts::value<string>())
+				("z", "reading type to treat as trivial (this may be used multiple times)", cxxopts::value<vector<string>>())
+				("drop-ambiguous", "treat ambiguous readings as lacunose", cxxopts::value<bool>())
+				("merge-splits", "merge split attestations of the same reading", cxxopts::value<bool>())
+				("stream", "calculate and write the genealogical comparisons one witness at a time to limit memory usage", cxxopts::value<bool>())
+				("bulk", "build the database from scratch as quickly as possible, without journaling or syncing, and index and analyze it at the end", cxxopts::value<bool>())
+				("rebuild", "rebuild the database from scratch, even if it holds a cache that could be updated incrementally", cxxopts::value<bool>())
+				("substemmata", "also find the optimal substemmata of all witnesses and store them in the database, so they do not have to be found again (this may take a while)", cxxopts::value<bool>())
+				("textual-flow", "also find the textual flow at every variation unit and store its edges in the database", cxxopts::value<bool>())
+				("binary-cache", "also write the genealogical relationships to a memory-mappable binary cache file at this path", cxxopts::value<string>());
+		options.add_options("positional")
+				("input_xml", "collation file in TEI XML format", cxxopts::value<string>())
+				("output_db", "output SQLite database (if an existing database is provided, its contents will be overwritten)", cxxopts::value<vector<string>>());
+		options.parse_positional({"input_xml", "output_db"});
+		auto args = options.parse(argc, argv);
+		//Print help documentation and exit if specified:
+		if (args.count("help")) {
+			cout << options.help({""}) << endl;
+			exit(0);
+		}
+		//Parse the optional arguments:
+		if (args.count("t")) {
+			threshold = args["t"].as<int>();
+		}
+		if (args.count("j")) {
+			int j = args["j"].as<int>();
+			if (j < 1) {
+				cerr << "Error: the number of threads must be positive." << endl;
+				exit(1);
+			}
+			n_threads = j;
+		}
+		if (args.count("k")) {
+			string kernel_name = args["k"].as<string>();
+			if (kernel_name == "scalar") {
+				kernel = comparison_kernel::SCALAR;
+			}
+			else if (kernel_name == "unit-major") {
+				kernel = comparison_kernel::UNIT_MAJOR;
+			}
+			else if (kernel_name == "simd") {
+				kernel = comparison_kernel::SIMD;
+			}
+			else {
+				cerr << "Error: Unrecognized kernel " << kernel_name << "; the kernel must be scalar, unit-major, or simd." << endl;
+				exit(1);
+			}
+		}
+		if (args.count("z")) {
+			for (string trivial_reading_type : args["z"].as<vector<string>>()) {
+				trivial_reading_types.insert(trivial_reading_type);
+			}
+		}
+		if (args.count("drop-ambiguous")) {
+			drop_ambiguous = args["drop-ambiguous"].as<bool>();
+		}
+		if (args.count("merge-splits")) {
+			merge_splits = args["merge-splits"].as<bool>();
+		}
+		if (args.count("stream")) {
+			stream = args["stream"].as<bool>();
+		}
+		if (args.count("bulk")) {
+			bulk = args["bulk"].as<bool>();
+		}
+		if (args.count("rebuild")) {
+			rebuild = args["rebuild"].as<bool>();
+		}
+		if (args.count("substemmata")) {
+			substemmata = args["substemmata"].as<bool>();
+		}
+		if (args.count("textual-flow")) {
+			flow_edges = args["textual-flow"].as<bool>();
+		}
+		if (args.count("binary-cache")) {
+			binary_cache_name = args["binary-cache"].as<string>();
+		}
+		//Parse the positional arguments:
+		if (!args.count("input_xml") || args.count("output_db") != 1) {
+			cerr << "Error: 2 positional arguments (input_xml and output_db) are required." << endl;
+			exit(1);
+		}
+		else {
+			input_xml_name = args["input_xml"].as<string>();
+			output_db_name = args["output_db"].as<vector<string>>()[0];
+		}
+	}
+	catch (const cxxopts::OptionException & e) {
+		cerr << "Error parsing options: " << e.what() << endl;
+		exit(-1);
+	}
+	//Attempt to parse the input XML file as an apparatus:
 	pugi::xml_document doc;
 	pugi::xml_parse_result pr = doc.load_file(input_xml_name.c_str());
 	if (!pr) {
@@ -493,14 +2046,6 @@ int main(int argc, char* argv[]) {
 	else {
 		list_wit = app.get_list_wit();
 	}
-	//Then initialize all of these witnesses:
-	cout << "Initializing all witnesses (this may take a while)... " << endl;
-	list<witness> witnesses = list<witness>();
-	for (string wit_id : list_wit) {
-		cout << "Calculating coherences for witness " << wit_id << "..." << endl;
-		witness wit = witness(wit_id, list_wit, app);
-		witnesses.push_back(wit);
-	}
 	//Now open the output database:
 	cout << "Opening database..." << endl;
 	sqlite3 * output_db;
@@ -509,13 +2054,85 @@ int main(int argc, char* argv[]) {
 		cerr << "Error opening database " << output_db_name << ": " << sqlite3_errmsg(output_db) << endl;
 		exit(1);
 	}
-	//Populate each table:
-	populate_readings_table(output_db, variation_units);
-	populate_reading_relations_table(output_db, variation_units);
-	populate_reading_support_table(output_db, variation_units);
-	populate_variation_units_table(output_db, variation_units);
-	populate_genealogical_comparisons_table(output_db, witnesses);
-	populate_witnesses_table(output_db, witnesses);
+	//Map each variation unit and each included witness to its key in the database:
+	unordered_map<string, unsigned int> vu_inds = unordered_map<string, unsigned int>();
+	unsigned int vu_ind = 0;
+	for (const variation_unit & vu : variation_units) {
+		vu_inds[vu.get_id()] = vu_ind;
+		vu_ind++;
+	}
+	unordered_map<string, unsigned int> wit_inds = unordered_map<string, unsigned int>();
+	unsigned int wit_ind = 0;
+	for (const string & wit_id : list_wit) {
+		wit_inds[wit_id] = wit_ind;
+		wit_ind++;
+	}
+	//Unless the user has asked for a full rebuild, check if the database already holds a cache with the same configuration;
+	//if it does, then only the variation units that have changed since it was built need to be updated:
+	string configuration_hash = hash_configuration(trivial_reading_types, drop_ambiguous, merge_splits, app.get_list_wit(), list_wit, variation_units);
+	vector<unsigned int> changed_vu_inds = vector<unsigned int>();
+	bool up_to_date = false;
+	if (!rebuild && get_changed_variation_units(output_db, configuration_hash, variation_units, changed_vu_inds)) {
+		if (changed_vu_inds.empty()) {
+			cout << "The database is already up to date." << endl;
+			up_to_date = true;
+		}
+		else {
+			list<variation_unit> changed_variation_units = list<variation_unit>();
+			for (unsigned int vu_ind : changed_vu_inds) {
+				changed_variation_units.push_back(app.get_variation_units()[vu_ind]);
+			}
+			//Make the whole update in a single transaction, so that if it is interrupted, the cache is left as it was:
+			char * transaction_error_msg;
+			sqlite3_exec(output_db, "BEGIN TRANSACTION", NULL, NULL, & transaction_error_msg);
+			//Read the old versions of the changed variation units before their rows are replaced:
+			cache_reader reader(output_db, 0);
+			list<variation_unit> old_variation_units = reader.get_variation_units(set<unsigned int>(changed_vu_inds.begin(), changed_vu_inds.end()));
+			reader.close();
+			update_variation_unit_tables(output_db, changed_variation_units, vu_inds, app.get_list_wit(), wit_inds);
+			comparison_summaries summaries;
+			update_genealogical_comparisons_table(output_db, list_wit, changed_vu_inds, vector<variation_unit>(old_variation_units.begin(), old_variation_units.end()), get_keyed_variation_units(app, list_wit, changed_vu_inds), summaries);
+			populate_potential_ancestors_table(output_db, list_wit, summaries, n_threads);
+			//The stored substemmata and textual flow edges are now outdated, so drop them:
+			drop_substemmata_table(output_db);
+			drop_textual_flow_edges_table(output_db);
+			//Finally, record the new hashes of the changed variation units:
+			update_variation_unit_hashes(output_db, changed_variation_units, vu_inds);
+			sqlite3_exec(output_db, "END TRANSACTION", NULL, NULL, & transaction_error_msg);
+		}
+	}
+	else {
+		//Otherwise, populate each table from scratch; in a bulk load, configure the connection for speed, and defer indexing until the tables have been populated:
+		if (bulk) {
+			begin_bulk_load(output_db, list_wit, variation_units);
+		}
+		clear_database(output_db);
+		populate_readings_table(output_db, variation_units, vu_inds, bulk);
+		populate_reading_relations_table(output_db, variation_units, vu_inds, bulk);
+		populate_reading_support_table(output_db, variation_units, vu_inds, app.get_list_wit(), wit_inds, bulk);
+		populate_variation_units_table(output_db, variation_units, bulk);
+		comparison_summaries summaries;
+		populate_genealogical_comparisons_table(output_db, list_wit, app, kernel, n_threads, stream, bulk, summaries);
+		populate_potential_ancestors_table(output_db, list_wit, summaries, n_threads);
+		populate_witnesses_table(output_db, list_wit, bulk);
+		populate_cache_hashes_tables(output_db, configuration_hash, variation_units);
+		if (bulk) {
+			end_bulk_load(output_db);
+		}
+	}
+	//If substemmata were requested, then find them from the finished tables, unless they are already stored and up to date
+	//(any outdated substemmata have been dropped above):
+	if (substemmata && (!up_to_date || !has_table(output_db, "SUBSTEMMATA"))) {
+		populate_substemmata_table(output_db, n_threads);
+	}
+	//Do the same for the textual flow edges:
+	if (flow_edges && (!up_to_date || !has_table(output_db, "TEXTUAL_FLOW_EDGES"))) {
+		populate_textual_flow_edges_table(output_db, n_threads);
+	}
+	//If a binary cache was requested, then write it from the finished GENEALOGICAL_COMPARISONS table:
+	if (!binary_cache_name.empty()) {
+		write_binary_cache(output_db, list_wit, binary_cache_name);
+	}
 	//Finally, close the output database:
 	cout << "Closing database..." << endl;
 	sqlite3_close(output_db);
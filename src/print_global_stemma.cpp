@@ -17,10 +17,14 @@
 #include <vector>
 #include <set>
 #include <unordered_map>
+#include <thread>
+#include <algorithm>
 
 #include "cxxopts.h"
 #include "sqlite3.h"
 #include "witness.h"
+#include "genealogical_cache.h"
+#include "cache_reader.h"
 #include "global_stemma.h"
 
 
@@ -39,70 +43,24 @@ int create_dir(const string & dir) {
 	#endif
 }
 
-/**
- * Retrieves all rows from the WITNESSES table of the given SQLite database
- * and returns a list of witness IDs populated with its contents.
- */
-list<string> get_witness_ids(sqlite3 * input_db) {
-	list<string> witness_ids = list<string>();
-	int rc; //to store SQLite macros
-	sqlite3_stmt * select_from_witnesses_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM WITNESSES ORDER BY ROWID", -1, & select_from_witnesses_stmt, 0);
-	rc = sqlite3_step(select_from_witnesses_stmt);
-	while (rc == SQLITE_ROW) {
-		string wit_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_witnesses_stmt, 0)));
-		witness_ids.push_back(wit_id);
-		rc = sqlite3_step(select_from_witnesses_stmt);
-	}
-	sqlite3_finalize(select_from_witnesses_stmt);
-	return witness_ids;
-}
-
-/**
- * Retrieves rows relative to the given witness ID from the GENEALOGICAL_COMPARISONS table of the given SQLite database
- * and returns a map of genealogical comparisons populated with its contents.
- */
-unordered_map<string, genealogical_comparison> get_genealogical_comparisons_for_witness(sqlite3 * input_db, const string & wit_id) {
-	unordered_map<string, genealogical_comparison> genealogical_comparisons = unordered_map<string, genealogical_comparison>();
-	int rc; //to store SQLite macros
-	sqlite3_stmt * select_from_genealogical_comparisons_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM GENEALOGICAL_COMPARISONS WHERE PRIMARY_WIT=?", -1, & select_from_genealogical_comparisons_stmt, 0);
-	sqlite3_bind_text(select_from_genealogical_comparisons_stmt, 1, wit_id.c_str(), -1, SQLITE_STATIC);
-	rc = sqlite3_step(select_from_genealogical_comparisons_stmt);
-	while (rc == SQLITE_ROW) {
-		genealogical_comparison comp;
-		string secondary_wit_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_genealogical_comparisons_stmt, 1)));
-		int agreements_bytes = sqlite3_column_bytes(select_from_genealogical_comparisons_stmt, 2);
-		const char * agreements_buf = reinterpret_cast<const char *>(sqlite3_column_blob(select_from_genealogical_comparisons_stmt, 2));
-		Roaring agreements = Roaring::readSafe(agreements_buf, agreements_bytes);
-		comp.agreements = agreements;
-		int explained_bytes = sqlite3_column_bytes(select_from_genealogical_comparisons_stmt, 3);
-		const char * explained_buf = reinterpret_cast<const char *>(sqlite3_column_blob(select_from_genealogical_comparisons_stmt, 3));
-		Roaring explained = Roaring::readSafe(explained_buf, explained_bytes);
-		comp.explained = explained;
-		float cost = float(sqlite3_column_double(select_from_genealogical_comparisons_stmt, 4));
-		comp.cost = cost;
-		genealogical_comparisons[secondary_wit_id] = comp;
-		rc = sqlite3_step(select_from_genealogical_comparisons_stmt);
-	}
-	sqlite3_finalize(select_from_genealogical_comparisons_stmt);
-	return genealogical_comparisons;
-}
-
 /**
  * Entry point to the script.
  */
 int main(int argc, char* argv[]) {
 	//Read in the command-line options:
 	bool format_edges = false;
+	unsigned int n_threads = max(1u, thread::hardware_concurrency());
 	string input_db_name = string();
+	string binary_cache_name = string();
 	try {
 		cxxopts::Options options("print_global_stemma", "Prints a global stemma graph to a .dot output files. The output file will be placed in the \"global\" directory.");
-		options.custom_help("[-h] [--format-edges] input_db");
+		options.custom_help("[-h] [--format-edges] [-j threads] [--binary-cache path] input_db");
 		//options.positional_help("").show_positional_help();
 		options.add_options("")
 				("h,help", "print this help")
-				("format-edges", "format edges to reflect proportions of agreements with stemmatic ancestors");
+				("format-edges", "format edges to reflect proportions of agreements with stemmatic ancestors")
+				("j,threads", "number of threads to use for optimizing each witness's substemmata (defaults to the number of hardware threads)", cxxopts::value<int>())
+				("binary-cache", "read genealogical relationships from the binary cache file at this path (as written by populate_db) instead of from the database", cxxopts::value<string>());
 		options.add_options("positional")
 				("input_db", "genealogical cache database", cxxopts::value<vector<string>>());
 		options.parse_positional({"input_db"});
@@ -112,9 +70,20 @@ int main(int argc, char* argv[]) {
 			cout << options.help({""}) << endl;
 			exit(0);
 		}
+		if (args.count("binary-cache")) {
+			binary_cache_name = args["binary-cache"].as<string>();
+		}
 		if (args.count("format-edges")) {
 			format_edges = args["format-edges"].as<bool>();
 		}
+		if (args.count("j")) {
+			int j = args["j"].as<int>();
+			if (j < 1) {
+				cerr << "Error: the number of threads must be positive." << endl;
+				exit(1);
+			}
+			n_threads = j;
+		}
 		//Parse the positional arguments:
 		if (!args.count("input_db")) {
 			cerr << "Error: 1 positional argument (input_db) is required." << endl;
@@ -136,29 +105,77 @@ int main(int argc, char* argv[]) {
 		cerr << "Error opening database " << input_db_name << ": " << sqlite3_errmsg(input_db) << endl;
 		exit(1);
 	}
-	cout << "Retrieving genealogical relationships for all witnesses..." << endl;
+	//Each witness's comparisons are copied into a witness as soon as they are read, so the reader does not need to keep them:
+	cache_reader reader(input_db, 0);
+	if (!reader.is_open()) {
+		cerr << "Error reading database " << input_db_name << ": " << sqlite3_errmsg(input_db) << endl;
+		exit(1);
+	}
 	//Populate a list of witness IDs:
-	list<string> list_wit = get_witness_ids(input_db);
-	//Populate a list of witnesses:
-	list<witness> witnesses = list<witness>();
-	for (string wit_id : list_wit) {
-		unordered_map<string, genealogical_comparison> genealogical_comparisons = get_genealogical_comparisons_for_witness(input_db, wit_id);
-		witness wit = witness(wit_id, genealogical_comparisons);
-		witnesses.push_back(wit);
+	const vector<string> & list_wit = reader.get_witness_ids();
+	global_stemma gs;
+	//If the database has a SUBSTEMMATA table, then read the edges of the global stemma from it, so no substemmata have to be optimized here:
+	if (binary_cache_name.empty() && reader.has_substemmata()) {
+		cout << "Retrieving optimal substemmata for all witnesses..." << endl;
+		list<global_stemma_edge> edges = reader.get_global_stemma_edges();
+		//Close the database:
+		cout << "Closing database..." << endl;
+		reader.close();
+		sqlite3_close(input_db);
+		cout << "Database closed." << endl;
+		cout << "Generating global stemma..." << endl;
+		gs = global_stemma(list_wit, edges);
 	}
-	//Close the database:
-	cout << "Closing database..." << endl;
-	sqlite3_close(input_db);
-	cout << "Database closed." << endl;
-	cout << "Optimizing substemmata (this may take a moment)..." << endl;
-	//Then populate each witness's list of potential ancestors and optimize its substemma:
-	for (witness & wit : witnesses) {
-		wit.set_potential_ancestor_ids(witnesses);
-		wit.set_global_stemma_ancestor_ids();
+	else {
+		cout << "Retrieving genealogical relationships for all witnesses..." << endl;
+		//Populate a list of witnesses, reading their genealogical comparisons from the binary cache, if one was specified, or from the database:
+		list<witness> witnesses = list<witness>();
+		if (binary_cache_name.empty()) {
+			for (string wit_id : list_wit) {
+				witness wit = witness(wit_id, reader.get_genealogical_comparisons(wit_id));
+				witnesses.push_back(wit);
+			}
+		}
+		else {
+			genealogical_cache cache(binary_cache_name);
+			if (!cache.is_open()) {
+				cerr << "Error opening binary cache " << binary_cache_name << ": not a valid genealogical cache file." << endl;
+				exit(1);
+			}
+			for (string wit_id : list_wit) {
+				witnesses.push_back(witness(wit_id, cache.get_genealogical_comparisons(wit_id)));
+			}
+		}
+		//If the database has a POTENTIAL_ANCESTORS table, then read each witness's potential ancestors from it, so they do not have to be ranked here:
+		unordered_map<string, list<potential_ancestor_ranking>> potential_ancestors;
+		bool has_potential_ancestors = binary_cache_name.empty() && reader.has_potential_ancestor_rankings();
+		if (has_potential_ancestors) {
+			potential_ancestors = reader.get_potential_ancestors();
+		}
+		//Close the database:
+		cout << "Closing database..." << endl;
+		reader.close();
+		sqlite3_close(input_db);
+		cout << "Database closed." << endl;
+		cout << "Optimizing substemmata (this may take a moment)..." << endl;
+		//Then populate each witness's list of potential ancestors and optimize its substemma:
+		for (witness & wit : witnesses) {
+			if (has_potential_ancestors) {
+				list<string> potential_ancestor_ids = list<string>();
+				for (const potential_ancestor_ranking & ranking : potential_ancestors[wit.get_id()]) {
+					potential_ancestor_ids.push_back(ranking.id);
+				}
+				wit.set_potential_ancestor_ids(potential_ancestor_ids);
+			}
+			else {
+				wit.set_potential_ancestor_ids(witnesses);
+			}
+			wit.set_global_stemma_ancestor_ids(n_threads);
+		}
+		cout << "Generating global stemma..." << endl;
+		//Construct the global stemma using the witnesses:
+		gs = global_stemma(witnesses);
 	}
-	cout << "Generating global stemma..." << endl;
-	//Construct the global stemma using the witnesses:
-	global_stemma gs = global_stemma(witnesses);
 	//Create the directory to write the file to:
 	string global_dir = "global";
 	create_dir(global_dir);
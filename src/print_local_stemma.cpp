@@ -21,6 +21,7 @@
 #include "cxxopts.h"
 #include "sqlite3.h"
 #include "local_stemma.h"
+#include "cache_reader.h"
 
 using namespace std;
 
@@ -37,94 +38,6 @@ int create_dir(const string & dir) {
 	#endif
 }
 
-/**
- * Determines if the VARIATION_UNITS table of the given SQLite database
- * contains a row with the given variation unit ID.
- */
-bool variation_unit_id_exists(sqlite3 * input_db, const string & vu_id) {
-	bool variation_unit_id_exists = false;
-	int rc; //to store SQLite macros
-	sqlite3_stmt * select_from_variation_units_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM VARIATION_UNITS WHERE VARIATION_UNIT=?", -1, & select_from_variation_units_stmt, 0);
-	sqlite3_bind_text(select_from_variation_units_stmt, 1, vu_id.c_str(), -1, SQLITE_STATIC);
-	rc = sqlite3_step(select_from_variation_units_stmt);
-	variation_unit_id_exists = (rc == SQLITE_ROW) ? true : false;
-	sqlite3_finalize(select_from_variation_units_stmt);
-	return variation_unit_id_exists;
-}
-
-/**
- * Retrieves all rows from the VARIATION_UNITS table of the given SQLite database
- * and returns a vector of variation_unit IDs populated with its contents.
- */
-vector<string> get_variation_unit_ids(sqlite3 * input_db) {
-	vector<string> variation_unit_ids = vector<string>();
-	int rc; //to store SQLite macros
-	sqlite3_stmt * select_from_variation_units_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM VARIATION_UNITS ORDER BY ROWID", -1, & select_from_variation_units_stmt, 0);
-	rc = sqlite3_step(select_from_variation_units_stmt);
-	while (rc == SQLITE_ROW) {
-		string vu_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_variation_units_stmt, 0)));
-		variation_unit_ids.push_back(vu_id);
-		rc = sqlite3_step(select_from_variation_units_stmt);
-	}
-	sqlite3_finalize(select_from_variation_units_stmt);
-	return variation_unit_ids;
-}
-
-/**
- * Using rows from the READINGS and READING_RELATIONS tables of the given SQLite database with the given variation unit ID,
- * constructs and returns the corresponding local stemma.
- */
-local_stemma get_local_stemma_for_variation_unit(sqlite3 * input_db, const string & vu_id) {
-	local_stemma stemma = local_stemma();
-	int rc; //to store SQLite macros
-	string id = vu_id;
-	//Get the variation unit label first:
-	string label = string();
-	sqlite3_stmt * select_from_variation_units_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM VARIATION_UNITS WHERE VARIATION_UNITS.VARIATION_UNIT=?", -1, & select_from_variation_units_stmt, 0);
-	sqlite3_bind_text(select_from_variation_units_stmt, 1, vu_id.c_str(), -1, SQLITE_STATIC);
-	rc = sqlite3_step(select_from_variation_units_stmt);
-	while (rc == SQLITE_ROW) {
-		label = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_variation_units_stmt, 1)));
-		break;
-	}
-	sqlite3_finalize(select_from_variation_units_stmt);
-	//Then populate the local stemma graph:
-	local_stemma_graph graph;
-	//Add the vertices of the local stemma:
-	graph.vertices = list<local_stemma_vertex>();
-	sqlite3_stmt * select_from_readings_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM READINGS WHERE READINGS.VARIATION_UNIT=?", -1, & select_from_readings_stmt, 0);
-	sqlite3_bind_text(select_from_readings_stmt, 1, vu_id.c_str(), -1, SQLITE_STATIC);
-	rc = sqlite3_step(select_from_readings_stmt);
-	while (rc == SQLITE_ROW) {
-		local_stemma_vertex v;
-		v.id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_readings_stmt, 1)));
-		graph.vertices.push_back(v);
-		rc = sqlite3_step(select_from_readings_stmt);
-	}
-	sqlite3_finalize(select_from_readings_stmt);
-	//Add the edges of the local_stemma:
-	graph.edges = list<local_stemma_edge>();
-	sqlite3_stmt * select_from_reading_relations_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM READING_RELATIONS WHERE READING_RELATIONS.VARIATION_UNIT=?", -1, & select_from_reading_relations_stmt, 0);
-	sqlite3_bind_text(select_from_reading_relations_stmt, 1, vu_id.c_str(), -1, SQLITE_STATIC);
-	rc = sqlite3_step(select_from_reading_relations_stmt);
-	while (rc == SQLITE_ROW) {
-		local_stemma_edge e;
-		e.prior = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_reading_relations_stmt, 1)));
-		e.posterior = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_reading_relations_stmt, 2)));
-		e.weight = float(sqlite3_column_double(select_from_reading_relations_stmt, 3));
-		graph.edges.push_back(e);
-		rc = sqlite3_step(select_from_reading_relations_stmt);
-	}
-	sqlite3_finalize(select_from_reading_relations_stmt);
-	stemma = local_stemma(id, label, graph);
-	return stemma;
-}
-
 /**
  * Entry point to the script.
  */
@@ -181,25 +94,28 @@ int main(int argc, char* argv[]) {
 		cerr << "Error opening database " << input_db_name << ": " << sqlite3_errmsg(input_db) << endl;
 		exit(1);
 	}
+	cache_reader reader(input_db);
+	if (!reader.is_open()) {
+		cerr << "Error reading database " << input_db_name << ": " << sqlite3_errmsg(input_db) << endl;
+		exit(1);
+	}
 	cout << "Retrieving local stemmata for variation units..." << endl;
 	//Retrieve a vector of all variation unit IDs:
-	vector<string> vu_ids = get_variation_unit_ids(input_db);
-	//Then populate a list of IDs for all variation units to process:
-	list<string> vu_ids_to_process = list<string>();
+	const vector<string> & vu_ids = reader.get_variation_unit_ids();
+	//Then populate a set of keys for all variation units to process:
+	set<unsigned int> vu_inds_to_process = set<unsigned int>();
 	//If no filter variation unit IDs were specified, then process all variation units:
 	if (filter_vu_ids.empty()) {
-		for (string vu_id : vu_ids) {
-			vu_ids_to_process.push_back(vu_id);
+		for (unsigned int vu_ind = 0; vu_ind < vu_ids.size(); vu_ind++) {
+			vu_inds_to_process.insert(vu_ind);
 		}
 	}
 	//If any filter variation unit IDs were specified, then make sure they are valid:
 	else {
 		for (string filter_vu_id : filter_vu_ids) {
-			//Check if the input passage is a variation unit ID in the database:
-			bool variation_unit_matched = variation_unit_id_exists(input_db, filter_vu_id);
-			//If a match is found, then add the variation unit ID to the list to be processed:
-			if (variation_unit_matched) {
-				vu_ids_to_process.push_back(filter_vu_id);
+			//If the input passage is a variation unit ID in the database, then add its key to the set to be processed:
+			if (reader.variation_unit_id_exists(filter_vu_id)) {
+				vu_inds_to_process.insert(reader.get_variation_unit_index(filter_vu_id));
 			}
 			//Otherwise, try to treat the ID as an index:
 			else {
@@ -221,20 +137,16 @@ int main(int argc, char* argv[]) {
 					cerr << "Error: The VARIATION_UNITS table has no rows with VARIATION_UNIT = " << filter_vu_id << "; if the variation unit ID was specified as an index, then it is out of range, as there are only " << vu_ids.size() << " variation units." << endl;
 					exit(1);
 				}
-				//Otherwise, get the variation unit corresponding to this ID:
-				vu_ids_to_process.push_back(vu_ids[filter_vu_ind]);
+				//Otherwise, add this index to the set to be processed:
+				vu_inds_to_process.insert(filter_vu_ind);
 			}
 		}
 	}
-	list<local_stemma> local_stemmata = list<local_stemma>();
 	//Now populate a list of local stemmata:
-	for (string vu_id : vu_ids_to_process) {
-		//Get the local stemma for this variation unit:
-		local_stemma ls = get_local_stemma_for_variation_unit(input_db, vu_id);
-		local_stemmata.push_back(ls);
-	}
+	list<local_stemma> local_stemmata = reader.get_local_stemmata(vu_inds_to_process);
 	//Close the database:
 	cout << "Closing database..." << endl;
+	reader.close();
 	sqlite3_close(input_db);
 	cout << "Database closed." << endl;
 	cout << "Generating local stemmata..." << endl;
@@ -24,6 +24,8 @@
 #include "local_stemma.h"
 #include "variation_unit.h"
 #include "witness.h"
+#include "genealogical_cache.h"
+#include "cache_reader.h"
 #include "textual_flow.h"
 
 
@@ -42,217 +44,6 @@ int create_dir(const string & dir) {
 	#endif
 }
 
-/**
- * Retrieves all rows from the WITNESSES table of the given SQLite database
- * and returns a list of witness IDs populated with its contents.
- */
-list<string> get_witness_ids(sqlite3 * input_db) {
-	list<string> witness_ids = list<string>();
-	int rc; //to store SQLite macros
-	sqlite3_stmt * select_from_witnesses_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM WITNESSES ORDER BY ROWID", -1, & select_from_witnesses_stmt, 0);
-	rc = sqlite3_step(select_from_witnesses_stmt);
-	while (rc == SQLITE_ROW) {
-		string wit_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_witnesses_stmt, 0)));
-		witness_ids.push_back(wit_id);
-		rc = sqlite3_step(select_from_witnesses_stmt);
-	}
-	sqlite3_finalize(select_from_witnesses_stmt);
-	return witness_ids;
-}
-
-/**
- * Retrieves rows relative to the given witness ID from the GENEALOGICAL_COMPARISONS table of the given SQLite database
- * and returns a map of genealogical comparisons populated with its contents.
- */
-unordered_map<string, genealogical_comparison> get_genealogical_comparisons_for_witness(sqlite3 * input_db, const string & wit_id) {
-	unordered_map<string, genealogical_comparison> genealogical_comparisons = unordered_map<string, genealogical_comparison>();
-	int rc; //to store SQLite macros
-	sqlite3_stmt * select_from_genealogical_comparisons_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM GENEALOGICAL_COMPARISONS WHERE PRIMARY_WIT=?", -1, & select_from_genealogical_comparisons_stmt, 0);
-	sqlite3_bind_text(select_from_genealogical_comparisons_stmt, 1, wit_id.c_str(), -1, SQLITE_STATIC);
-	rc = sqlite3_step(select_from_genealogical_comparisons_stmt);
-	while (rc == SQLITE_ROW) {
-		genealogical_comparison comp;
-		string secondary_wit_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_genealogical_comparisons_stmt, 1)));
-		int agreements_bytes = sqlite3_column_bytes(select_from_genealogical_comparisons_stmt, 2);
-		const char * agreements_buf = reinterpret_cast<const char *>(sqlite3_column_blob(select_from_genealogical_comparisons_stmt, 2));
-		Roaring agreements = Roaring::readSafe(agreements_buf, agreements_bytes);
-		comp.agreements = agreements;
-		int explained_bytes = sqlite3_column_bytes(select_from_genealogical_comparisons_stmt, 3);
-		const char * explained_buf = reinterpret_cast<const char *>(sqlite3_column_blob(select_from_genealogical_comparisons_stmt, 3));
-		Roaring explained = Roaring::readSafe(explained_buf, explained_bytes);
-		comp.explained = explained;
-		float cost = float(sqlite3_column_double(select_from_genealogical_comparisons_stmt, 4));
-		comp.cost = cost;
-		genealogical_comparisons[secondary_wit_id] = comp;
-		rc = sqlite3_step(select_from_genealogical_comparisons_stmt);
-	}
-	sqlite3_finalize(select_from_genealogical_comparisons_stmt);
-	return genealogical_comparisons;
-}
-
-/**
- * Determines if the VARIATION_UNITS table of the given SQLite database
- * contains a row with the given variation unit ID.
- */
-bool variation_unit_id_exists(sqlite3 * input_db, const string & vu_id) {
-	bool variation_unit_id_exists = false;
-	int rc; //to store SQLite macros
-	sqlite3_stmt * select_from_variation_units_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM VARIATION_UNITS WHERE VARIATION_UNIT=?", -1, & select_from_variation_units_stmt, 0);
-	sqlite3_bind_text(select_from_variation_units_stmt, 1, vu_id.c_str(), -1, SQLITE_STATIC);
-	rc = sqlite3_step(select_from_variation_units_stmt);
-	variation_unit_id_exists = (rc == SQLITE_ROW) ? true : false;
-	sqlite3_finalize(select_from_variation_units_stmt);
-	return variation_unit_id_exists;
-}
-
-/**
- * Retrieves all rows from the VARIATION_UNITS table of the given SQLite database
- * and returns a vector of variation_unit IDs populated with its contents.
- */
-vector<string> get_variation_unit_ids(sqlite3 * input_db) {
-	vector<string> variation_unit_ids = vector<string>();
-	int rc; //to store SQLite macros
-	sqlite3_stmt * select_from_variation_units_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM VARIATION_UNITS ORDER BY ROWID", -1, & select_from_variation_units_stmt, 0);
-	rc = sqlite3_step(select_from_variation_units_stmt);
-	while (rc == SQLITE_ROW) {
-		string vu_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_variation_units_stmt, 0)));
-		variation_unit_ids.push_back(vu_id);
-		rc = sqlite3_step(select_from_variation_units_stmt);
-	}
-	sqlite3_finalize(select_from_variation_units_stmt);
-	return variation_unit_ids;
-}
-
-/**
- * Retrieves rows for the given variation unit from the READINGS table of the given SQLite database
- * and returns a list of reading IDs populated with its contents.
- */
-list<string> get_readings_for_variation_unit(sqlite3 * input_db, const string & vu_id) {
-	list<string> readings = list<string>();
-	int rc; //to store SQLite macros
-	sqlite3_stmt * select_from_readings_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM READINGS WHERE READINGS.VARIATION_UNIT=? ORDER BY ROWID", -1, & select_from_readings_stmt, 0);
-	sqlite3_bind_text(select_from_readings_stmt, 1, vu_id.c_str(), -1, SQLITE_STATIC);
-	rc = sqlite3_step(select_from_readings_stmt);
-	while (rc == SQLITE_ROW) {
-		string rdg = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_readings_stmt, 1)));
-		readings.push_back(rdg);
-		rc = sqlite3_step(select_from_readings_stmt);
-	}
-	sqlite3_finalize(select_from_readings_stmt);
-	return readings;
-}
-
-/**
- * Retrieves rows for the given variation unit from the READING_SUPPORT table of the given SQLite database
- * and returns a reading support map populated with its contents.
- */
-unordered_map<string, string> get_reading_support_for_variation_unit(sqlite3 * input_db, const string & vu_id) {
-	unordered_map<string, string> reading_support = unordered_map<string, string>();
-	int rc; //to store SQLite macros
-	sqlite3_stmt * select_from_reading_support_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM READING_SUPPORT WHERE VARIATION_UNIT=?", -1, & select_from_reading_support_stmt, 0);
-	sqlite3_bind_text(select_from_reading_support_stmt, 1, vu_id.c_str(), -1, SQLITE_STATIC);
-	rc = sqlite3_step(select_from_reading_support_stmt);
-	while (rc == SQLITE_ROW) {
-		string wit_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_reading_support_stmt, 1)));
-		string rdg_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_reading_support_stmt, 2)));
-		reading_support[wit_id] = rdg_id;
-		rc = sqlite3_step(select_from_reading_support_stmt);
-	}
-	sqlite3_finalize(select_from_reading_support_stmt);
-	return reading_support;
-}
-
-/**
- * Using rows from the READINGS and READING_RELATIONS tables of the given SQLite database with the given variation unit ID,
- * constructs and returns the corresponding local stemma.
- */
-local_stemma get_local_stemma_for_variation_unit(sqlite3 * input_db, const string & vu_id) {
-	local_stemma stemma = local_stemma();
-	int rc; //to store SQLite macros
-	string id = vu_id;
-	//Get the variation unit label first:
-	string label = string();
-	sqlite3_stmt * select_from_variation_units_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM VARIATION_UNITS WHERE VARIATION_UNITS.VARIATION_UNIT=?", -1, & select_from_variation_units_stmt, 0);
-	sqlite3_bind_text(select_from_variation_units_stmt, 1, vu_id.c_str(), -1, SQLITE_STATIC);
-	rc = sqlite3_step(select_from_variation_units_stmt);
-	while (rc == SQLITE_ROW) {
-		label = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_variation_units_stmt, 1)));
-		break;
-	}
-	sqlite3_finalize(select_from_variation_units_stmt);
-	//Then populate the local stemma graph:
-	local_stemma_graph graph;
-	//Add the vertices of the local stemma:
-	graph.vertices = list<local_stemma_vertex>();
-	sqlite3_stmt * select_from_readings_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM READINGS WHERE READINGS.VARIATION_UNIT=? ORDER BY ROWID", -1, & select_from_readings_stmt, 0);
-	sqlite3_bind_text(select_from_readings_stmt, 1, vu_id.c_str(), -1, SQLITE_STATIC);
-	rc = sqlite3_step(select_from_readings_stmt);
-	while (rc == SQLITE_ROW) {
-		local_stemma_vertex v;
-		v.id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_readings_stmt, 1)));
-		graph.vertices.push_back(v);
-		rc = sqlite3_step(select_from_readings_stmt);
-	}
-	sqlite3_finalize(select_from_readings_stmt);
-	//Add the edges of the local_stemma:
-	graph.edges = list<local_stemma_edge>();
-	sqlite3_stmt * select_from_reading_relations_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM READING_RELATIONS WHERE READING_RELATIONS.VARIATION_UNIT=? ORDER BY ROWID", -1, & select_from_reading_relations_stmt, 0);
-	sqlite3_bind_text(select_from_reading_relations_stmt, 1, vu_id.c_str(), -1, SQLITE_STATIC);
-	rc = sqlite3_step(select_from_reading_relations_stmt);
-	while (rc == SQLITE_ROW) {
-		local_stemma_edge e;
-		e.prior = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_reading_relations_stmt, 1)));
-		e.posterior = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_reading_relations_stmt, 2)));
-		e.weight = float(sqlite3_column_double(select_from_reading_relations_stmt, 3));
-		graph.edges.push_back(e);
-		rc = sqlite3_step(select_from_reading_relations_stmt);
-	}
-	sqlite3_finalize(select_from_reading_relations_stmt);
-	stemma = local_stemma(id, label, graph);
-	return stemma;
-}
-
-/**
- * Using rows from the VARIATION_UNITS table of the given SQLite database with the given variation unit ID,
- * constructs and returns the corresponding variation unit.
- */
-variation_unit get_variation_unit(sqlite3 * input_db, const string & vu_id) {
-	variation_unit vu = variation_unit();
-	int rc; //to store SQLite macros
-	string id = vu_id;
-	//Get the variation unit label and connectivity first:
-	string label = string();
-	int connectivity = numeric_limits<int>::max();
-	sqlite3_stmt * select_from_variation_units_stmt;
-	sqlite3_prepare(input_db, "SELECT * FROM VARIATION_UNITS WHERE VARIATION_UNITS.VARIATION_UNIT=?", -1, & select_from_variation_units_stmt, 0);
-	sqlite3_bind_text(select_from_variation_units_stmt, 1, vu_id.c_str(), -1, SQLITE_STATIC);
-	rc = sqlite3_step(select_from_variation_units_stmt);
-	while (rc == SQLITE_ROW) {
-		label = string(reinterpret_cast<const char *>(sqlite3_column_text(select_from_variation_units_stmt, 1)));
-		connectivity = sqlite3_column_int(select_from_variation_units_stmt, 2);
-		break;
-	}
-	sqlite3_finalize(select_from_variation_units_stmt);
-	//Then get the readings list:
-	list<string> readings = get_readings_for_variation_unit(input_db, vu_id);
-	//Then get the reading support map:
-	unordered_map<string, string> reading_support = get_reading_support_for_variation_unit(input_db, vu_id);
-	//Then get the local stemma:
-	local_stemma stemma = get_local_stemma_for_variation_unit(input_db, vu_id);
-	//Then construct the variation unit:
-	vu = variation_unit(id, label, readings, reading_support, connectivity, stemma);
-	return vu;
-}
-
 /**
  * Entry point to the script.
  */
@@ -264,16 +55,18 @@ int main(int argc, char* argv[]) {
 	bool flow_strengths = false;
 	set<string> filter_vu_ids = set<string>();
 	string input_db_name = string();
+	string binary_cache_name = string();
 	try {
 		cxxopts::Options options("print_textual_flow", "Prints multiple types of textual flow diagrams to .dot output files. The output files will be placed in the \"flow\", \"attestations\", and \"variants\" directories.");
-		options.custom_help("[-h] [--flow] [--attestations] [--variants] [--strengths] input_db [passages]");
+		options.custom_help("[-h] [--flow] [--attestations] [--variants] [--strengths] [--binary-cache path] input_db [passages]");
 		//options.positional_help("").show_positional_help();
 		options.add_options("")
 				("h,help", "print this help")
 				("flow", "print complete textual flow diagrams", cxxopts::value<bool>())
 				("attestations", "print coherence in attestation textual flow diagrams for all readings at all passages", cxxopts::value<bool>())
 				("variants", "print coherence at variant passages diagrams (i.e., textual flow diagrams restricted to flow between different readings) at all passages", cxxopts::value<bool>())
-				("strengths", "format edges to reflect flow strengths", cxxopts::value<bool>());
+				("strengths", "format edges to reflect flow strengths", cxxopts::value<bool>())
+				("binary-cache", "read genealogical relationships from the binary cache file at this path (as written by populate_db) instead of from the database", cxxopts::value<string>());
 		options.add_options("positional")
 				("input_db", "genealogical cache database", cxxopts::value<string>())
 				("passages", "if specified, only print graphs for the variation units with the given IDs or (one-based) indices; otherwise, print graphs for all variation units", cxxopts::value<vector<string>>());
@@ -284,6 +77,9 @@ int main(int argc, char* argv[]) {
 			cout << options.help({""}) << endl;
 			exit(0);
 		}
+		if (args.count("binary-cache")) {
+			binary_cache_name = args["binary-cache"].as<string>();
+		}
 		if (args.count("flow")) {
 			flow = args["flow"].as<bool>();
 		}
@@ -330,39 +126,65 @@ int main(int argc, char* argv[]) {
 		cerr << "Error opening database " << input_db_name << ": " << sqlite3_errmsg(input_db) << endl;
 		exit(1);
 	}
-	cout << "Retrieving genealogical relationships for all witnesses..." << endl;
-	//Populate a list of witness IDs:
-	list<string> list_wit = get_witness_ids(input_db);
-	//Populate a list of witnesses:
-	list<witness> witnesses = list<witness>();
-	for (string wit_id : list_wit) {
-		unordered_map<string, genealogical_comparison> genealogical_comparisons = get_genealogical_comparisons_for_witness(input_db, wit_id);
-		witness wit = witness(wit_id, genealogical_comparisons);
-		witnesses.push_back(wit);
+	//Each witness's comparisons are copied into a witness as soon as they are read, so the reader does not need to keep them:
+	cache_reader reader(input_db, 0);
+	if (!reader.is_open()) {
+		cerr << "Error reading database " << input_db_name << ": " << sqlite3_errmsg(input_db) << endl;
+		exit(1);
 	}
-	//Then populate each witness's list of potential ancestors:
-	for (witness & wit : witnesses) {
-		wit.set_potential_ancestor_ids(witnesses);
+	//Populate a list of witness IDs:
+	list<string> list_wit = list<string>(reader.get_witness_ids().begin(), reader.get_witness_ids().end());
+	//If the database has a TEXTUAL_FLOW_EDGES table, then the edges at each variation unit can be read from it,
+	//so the witnesses' potential ancestors are not needed:
+	bool has_textual_flow_edges = binary_cache_name.empty() && reader.has_textual_flow_edges();
+	unordered_map<string, list<potential_ancestor_ranking>> potential_ancestors;
+	if (!has_textual_flow_edges) {
+		cout << "Retrieving genealogical relationships for all witnesses..." << endl;
+		//Retrieve the rankings of each witness's potential ancestors from the POTENTIAL_ANCESTORS table, if there is one,
+		//since they are all that the textual flow needs;
+		//otherwise, calculate them from the witnesses' genealogical comparisons, read either from the binary cache, if one was specified, or from the database:
+		if (binary_cache_name.empty() && reader.has_potential_ancestor_rankings()) {
+			potential_ancestors = reader.get_potential_ancestors();
+		}
+		else {
+			list<witness> witnesses = list<witness>();
+			if (binary_cache_name.empty()) {
+				for (string wit_id : list_wit) {
+					witness wit = witness(wit_id, reader.get_genealogical_comparisons(wit_id));
+					witnesses.push_back(wit);
+				}
+			}
+			else {
+				genealogical_cache cache(binary_cache_name);
+				if (!cache.is_open()) {
+					cerr << "Error opening binary cache " << binary_cache_name << ": not a valid genealogical cache file." << endl;
+					exit(1);
+				}
+				for (string wit_id : list_wit) {
+					witnesses.push_back(witness(wit_id, cache.get_genealogical_comparisons(wit_id)));
+				}
+			}
+			//Then rank each witness's potential ancestors:
+			potential_ancestors = rank_all_potential_ancestors(witnesses);
+		}
 	}
 	cout << "Retrieving variation units..." << endl;
 	//Retrieve a vector of all variation unit IDs:
-	vector<string> vu_ids = get_variation_unit_ids(input_db);
-	//Then populate a list of IDs for all variation units to process:
-	list<string> vu_ids_to_process = list<string>();
+	const vector<string> & vu_ids = reader.get_variation_unit_ids();
+	//Then populate a set of keys for all variation units to process:
+	set<unsigned int> vu_inds_to_process = set<unsigned int>();
 	//If no filter variation unit IDs were specified, then process all variation units:
 	if (filter_vu_ids.empty()) {
-		for (string vu_id : vu_ids) {
-			vu_ids_to_process.push_back(vu_id);
+		for (unsigned int vu_ind = 0; vu_ind < vu_ids.size(); vu_ind++) {
+			vu_inds_to_process.insert(vu_ind);
 		}
 	}
 	//If any filter variation unit IDs were specified, then make sure they are valid:
 	else {
 		for (string filter_vu_id : filter_vu_ids) {
-			//Check if the input passage is a variation unit ID in the database:
-			bool variation_unit_matched = variation_unit_id_exists(input_db, filter_vu_id);
-			//If a match is found, then add the variation unit ID to the list to be processed:
-			if (variation_unit_matched) {
-				vu_ids_to_process.push_back(filter_vu_id);
+			//If the input passage is a variation unit ID in the database, then add its key to the set to be processed:
+			if (reader.variation_unit_id_exists(filter_vu_id)) {
+				vu_inds_to_process.insert(reader.get_variation_unit_index(filter_vu_id));
 			}
 			//Otherwise, try to treat the ID as an index:
 			else {
@@ -384,19 +206,24 @@ int main(int argc, char* argv[]) {
 					cerr << "Error: The VARIATION_UNITS table has no rows with VARIATION_UNIT = " << filter_vu_id << "; if the variation unit ID was specified as an index, then it is out of range, as there are only " << vu_ids.size() << " variation units." << endl;
 					exit(1);
 				}
-				//Otherwise, get the variation unit corresponding to this ID:
-				vu_ids_to_process.push_back(vu_ids[filter_vu_ind]);
+				//Otherwise, add this index to the set to be processed:
+				vu_inds_to_process.insert(filter_vu_ind);
 			}
 		}
 	}
-	//Now populate a list of variation units:
-	list<variation_unit> variation_units = list<variation_unit>();
-	for (string vu_id : vu_ids_to_process) {
-		variation_unit vu = get_variation_unit(input_db, vu_id);
-		variation_units.push_back(vu);
+	//Now populate a list of variation units, indexing their reading support by the order of the witnesses:
+	list<variation_unit> variation_units = reader.get_variation_units(vu_inds_to_process);
+	//If the textual flow edges are stored in the database, then read the ones at these variation units:
+	unordered_map<string, list<textual_flow_edge>> textual_flow_edges = unordered_map<string, list<textual_flow_edge>>();
+	if (has_textual_flow_edges) {
+		cout << "Retrieving textual flow edges..." << endl;
+		for (unsigned int vu_ind : vu_inds_to_process) {
+			textual_flow_edges[vu_ids[vu_ind]] = reader.get_textual_flow_edges(vu_ind);
+		}
 	}
 	//Close the database:
 	cout << "Closing database..." << endl;
+	reader.close();
 	sqlite3_close(input_db);
 	cout << "Database closed." << endl;
 	cout << "Generating textual flow diagrams..." << endl;
@@ -410,8 +237,8 @@ int main(int argc, char* argv[]) {
 	//Now generate the graphs for each variation unit:
 	for (variation_unit vu : variation_units) {
 		string vu_id = vu.get_id();
-		//Construct the underlying textual flow data structure using this variation unit and the list of witnesses:
-		textual_flow tf = textual_flow(vu, witnesses);
+		//Construct the underlying textual flow data structure using this variation unit and either its stored edges or the witnesses' potential ancestors:
+		textual_flow tf = has_textual_flow_edges ? textual_flow(vu, list_wit, textual_flow_edges.at(vu_id)) : textual_flow(vu, list_wit, potential_ancestors);
 		if (flow) {
 			//Complete the path to the file:
 			string filepath = flow_dir + "/" + vu_id + "-textual-flow.dot";
@@ -0,0 +1,396 @@
+/*
+ * reading_matrix.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: jjmccollum
+ */
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define READING_MATRIX_X86
+#include <immintrin.h>
+#endif
+
+#include "reading_matrix.h"
+#include "variation_unit.h"
+#include "local_stemma.h"
+
+using namespace std;
+
+/**
+ * Returns the index of the lowest set bit in the given nonzero word.
+ */
+static inline unsigned int count_trailing_zeros(uint64_t word) {
+#ifdef __GNUC__
+	return __builtin_ctzll(word);
+#else
+	unsigned int n = 0;
+	while ((word & 1) == 0) {
+		word >>= 1;
+		n++;
+	}
+	return n;
+#endif
+}
+
+/**
+ * Sets the agreement and explained bits for the variation units in the range [begin, end)
+ * by looking up the path length from the other witness's reading to this witness's reading one unit at a time.
+ * If both_ways is set, then the bits for the path lengths in the opposite direction are set in the reverse words, too.
+ */
+template <bool both_ways, typename T>
+static void compare_rows_scalar(const T * row, const T * other_row, const float * path_lengths, const int32_t * offsets, const int32_t * strides, unsigned int begin, unsigned int end, uint64_t * agreements, uint64_t * explained, uint64_t * reverse_agreements, uint64_t * reverse_explained) {
+	for (unsigned int u = begin; u < end; u++) {
+		uint64_t bit = uint64_t(1) << (u % 64);
+		float path_length = path_lengths[offsets[u] + strides[u] * other_row[u] + row[u]];
+		if (path_length < numeric_limits<float>::infinity()) {
+			explained[u / 64] |= bit;
+			if (path_length == 0) {
+				agreements[u / 64] |= bit;
+			}
+		}
+		if (both_ways) {
+			float reverse_path_length = path_lengths[offsets[u] + strides[u] * row[u] + other_row[u]];
+			if (reverse_path_length < numeric_limits<float>::infinity()) {
+				reverse_explained[u / 64] |= bit;
+				if (reverse_path_length == 0) {
+					reverse_agreements[u / 64] |= bit;
+				}
+			}
+		}
+	}
+	return;
+}
+
+#ifdef READING_MATRIX_X86
+/**
+ * Loads four 8-bit cells as 32-bit integers.
+ */
+__attribute__((target("sse4.2"))) static inline __m128i load_cells_sse4(const uint8_t * p) {
+	int32_t cells;
+	memcpy(&cells, p, sizeof(cells));
+	return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(cells));
+}
+
+/**
+ * Loads four 16-bit cells as 32-bit integers.
+ */
+__attribute__((target("sse4.2"))) static inline __m128i load_cells_sse4(const uint16_t * p) {
+	return _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *) p));
+}
+
+/**
+ * Gathers the four path lengths at the given table indices.
+ */
+__attribute__((target("sse4.2"))) static inline __m128 gather_sse4(const float * path_lengths, __m128i inds) {
+	int32_t i[4];
+	_mm_storeu_si128((__m128i *) i, inds);
+	return _mm_set_ps(path_lengths[i[3]], path_lengths[i[2]], path_lengths[i[1]], path_lengths[i[0]]);
+}
+
+/**
+ * Sets the agreement and explained bits for all variation units four at a time, gathering the path lengths by hand.
+ */
+template <bool both_ways, typename T>
+__attribute__((target("sse4.2"))) static void compare_rows_sse4(const T * row, const T * other_row, const float * path_lengths, const int32_t * offsets, const int32_t * strides, unsigned int n_units, uint64_t * agreements, uint64_t * explained, uint64_t * reverse_agreements, uint64_t * reverse_explained) {
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 infinity = _mm_set1_ps(numeric_limits<float>::infinity());
+	unsigned int u = 0;
+	for (; u + 4 <= n_units; u += 4) {
+		__m128i cells = load_cells_sse4(row + u);
+		__m128i other_cells = load_cells_sse4(other_row + u);
+		__m128i unit_offsets = _mm_loadu_si128((const __m128i *) (offsets + u));
+		__m128i unit_strides = _mm_loadu_si128((const __m128i *) (strides + u));
+		__m128 lengths = gather_sse4(path_lengths, _mm_add_epi32(unit_offsets, _mm_add_epi32(_mm_mullo_epi32(other_cells, unit_strides), cells)));
+		//Since 64 is a multiple of 4, the four bits never straddle two words:
+		agreements[u / 64] |= uint64_t(_mm_movemask_ps(_mm_cmpeq_ps(lengths, zero))) << (u % 64);
+		explained[u / 64] |= uint64_t(_mm_movemask_ps(_mm_cmplt_ps(lengths, infinity))) << (u % 64);
+		if (both_ways) {
+			__m128 reverse_lengths = gather_sse4(path_lengths, _mm_add_epi32(unit_offsets, _mm_add_epi32(_mm_mullo_epi32(cells, unit_strides), other_cells)));
+			reverse_agreements[u / 64] |= uint64_t(_mm_movemask_ps(_mm_cmpeq_ps(reverse_lengths, zero))) << (u % 64);
+			reverse_explained[u / 64] |= uint64_t(_mm_movemask_ps(_mm_cmplt_ps(reverse_lengths, infinity))) << (u % 64);
+		}
+	}
+	compare_rows_scalar<both_ways>(row, other_row, path_lengths, offsets, strides, u, n_units, agreements, explained, reverse_agreements, reverse_explained);
+	return;
+}
+
+/**
+ * Loads eight 8-bit cells as 32-bit integers.
+ */
+__attribute__((target("avx2"))) static inline __m256i load_cells_avx2(const uint8_t * p) {
+	return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) p));
+}
+
+/**
+ * Loads eight 16-bit cells as 32-bit integers.
+ */
+__attribute__((target("avx2"))) static inline __m256i load_cells_avx2(const uint16_t * p) {
+	return _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *) p));
+}
+
+/**
+ * Sets the agreement and explained bits for all variation units eight at a time, using a hardware gather for the path lengths.
+ */
+template <bool both_ways, typename T>
+__attribute__((target("avx2"))) static void compare_rows_avx2(const T * row, const T * other_row, const float * path_lengths, const int32_t * offsets, const int32_t * strides, unsigned int n_units, uint64_t * agreements, uint64_t * explained, uint64_t * reverse_agreements, uint64_t * reverse_explained) {
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 infinity = _mm256_set1_ps(numeric_limits<float>::infinity());
+	unsigned int u = 0;
+	for (; u + 8 <= n_units; u += 8) {
+		__m256i cells = load_cells_avx2(row + u);
+		__m256i other_cells = load_cells_avx2(other_row + u);
+		__m256i unit_offsets = _mm256_loadu_si256((const __m256i *) (offsets + u));
+		__m256i unit_strides = _mm256_loadu_si256((const __m256i *) (strides + u));
+		__m256 lengths = _mm256_i32gather_ps(path_lengths, _mm256_add_epi32(unit_offsets, _mm256_add_epi32(_mm256_mullo_epi32(other_cells, unit_strides), cells)), 4);
+		//Since 64 is a multiple of 8, the eight bits never straddle two words:
+		agreements[u / 64] |= uint64_t(_mm256_movemask_ps(_mm256_cmp_ps(lengths, zero, _CMP_EQ_OQ))) << (u % 64);
+		explained[u / 64] |= uint64_t(_mm256_movemask_ps(_mm256_cmp_ps(lengths, infinity, _CMP_LT_OQ))) << (u % 64);
+		if (both_ways) {
+			__m256 reverse_lengths = _mm256_i32gather_ps(path_lengths, _mm256_add_epi32(unit_offsets, _mm256_add_epi32(_mm256_mullo_epi32(cells, unit_strides), other_cells)), 4);
+			reverse_agreements[u / 64] |= uint64_t(_mm256_movemask_ps(_mm256_cmp_ps(reverse_lengths, zero, _CMP_EQ_OQ))) << (u % 64);
+			reverse_explained[u / 64] |= uint64_t(_mm256_movemask_ps(_mm256_cmp_ps(reverse_lengths, infinity, _CMP_LT_OQ))) << (u % 64);
+		}
+	}
+	compare_rows_scalar<both_ways>(row, other_row, path_lengths, offsets, strides, u, n_units, agreements, explained, reverse_agreements, reverse_explained);
+	return;
+}
+#endif
+
+/**
+ * Sets the agreement and explained bits for all variation units using the given instruction set.
+ */
+template <bool both_ways, typename T>
+static void compare_rows(const T * row, const T * other_row, const float * path_lengths, const int32_t * offsets, const int32_t * strides, unsigned int n_units, uint64_t * agreements, uint64_t * explained, uint64_t * reverse_agreements, uint64_t * reverse_explained, instruction_set isa) {
+	switch (isa) {
+#ifdef READING_MATRIX_X86
+		case instruction_set::AVX2_INSTRUCTIONS:
+			compare_rows_avx2<both_ways>(row, other_row, path_lengths, offsets, strides, n_units, agreements, explained, reverse_agreements, reverse_explained);
+			break;
+		case instruction_set::SSE4_INSTRUCTIONS:
+			compare_rows_sse4<both_ways>(row, other_row, path_lengths, offsets, strides, n_units, agreements, explained, reverse_agreements, reverse_explained);
+			break;
+#endif
+		default:
+			compare_rows_scalar<both_ways>(row, other_row, path_lengths, offsets, strides, 0, n_units, agreements, explained, reverse_agreements, reverse_explained);
+			break;
+	}
+	return;
+}
+
+/**
+ * Returns the total length of the paths from the other witness's readings to this witness's readings
+ * at the variation units where the first is explained by but does not agree with the second.
+ * The lengths are summed in order of variation unit, so that the total matches a unit-by-unit sum exactly.
+ */
+template <typename T>
+static float sum_costs(const T * row, const T * other_row, const float * path_lengths, const int32_t * offsets, const int32_t * strides, const vector<uint64_t> & agreements, const vector<uint64_t> & explained) {
+	float cost = 0;
+	for (unsigned int w = 0; w < explained.size(); w++) {
+		uint64_t prior_bits = explained[w] & ~agreements[w];
+		while (prior_bits != 0) {
+			unsigned int u = w * 64 + count_trailing_zeros(prior_bits);
+			prior_bits &= prior_bits - 1;
+			cost += path_lengths[offsets[u] + strides[u] * other_row[u] + row[u]];
+		}
+	}
+	return cost;
+}
+
+/**
+ * Returns the most capable instruction set supported by the current processor.
+ */
+static instruction_set detect_instruction_set() {
+#ifdef READING_MATRIX_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		return instruction_set::AVX2_INSTRUCTIONS;
+	}
+	if (__builtin_cpu_supports("sse4.2")) {
+		return instruction_set::SSE4_INSTRUCTIONS;
+	}
+#endif
+	return instruction_set::SCALAR_INSTRUCTIONS;
+}
+
+/**
+ * Default constructor.
+ */
+reading_matrix::reading_matrix() {
+
+}
+
+/**
+ * Constructs a reading matrix from a vector of variation units, each of which has reading support for the given number of witnesses.
+ */
+reading_matrix::reading_matrix(const vector<variation_unit> & variation_units, unsigned int _n_witnesses) {
+	n_witnesses = _n_witnesses;
+	n_units = variation_units.size();
+	//Lay out the table of path lengths for each variation unit, with an extra row and column for lacunae:
+	offsets = vector<int32_t>();
+	strides = vector<int32_t>();
+	path_lengths = vector<float>();
+	for (const variation_unit & vu : variation_units) {
+		unsigned int n_readings = vu.get_readings().size();
+		if (n_readings > numeric_limits<uint8_t>::max() - 1) {
+			wide = true;
+		}
+		const local_stemma & ls = vu.get_local_stemma();
+		offsets.push_back(path_lengths.size());
+		strides.push_back(n_readings + 1);
+		for (unsigned int prior_rdg_ind = 0; prior_rdg_ind <= n_readings; prior_rdg_ind++) {
+			for (unsigned int posterior_rdg_ind = 0; posterior_rdg_ind <= n_readings; posterior_rdg_ind++) {
+				if (prior_rdg_ind == n_readings || posterior_rdg_ind == n_readings) {
+					path_lengths.push_back(numeric_limits<float>::infinity());
+				}
+				else {
+					path_lengths.push_back(ls.get_shortest_path_length(prior_rdg_ind, posterior_rdg_ind));
+				}
+			}
+		}
+	}
+	//Then fill in each witness's row, using the extra row and column of each table for lacunae:
+	if (wide) {
+		wide_cells = vector<uint16_t>(size_t(n_witnesses) * n_units);
+	}
+	else {
+		narrow_cells = vector<uint8_t>(size_t(n_witnesses) * n_units);
+	}
+	for (unsigned int vu_ind = 0; vu_ind < n_units; vu_ind++) {
+		const variation_unit & vu = variation_units[vu_ind];
+		const vector<uint16_t> & reading_support = vu.get_reading_support();
+		uint16_t lacuna_ind = vu.get_readings().size();
+		for (unsigned int wit_ind = 0; wit_ind < n_witnesses; wit_ind++) {
+			uint16_t rdg_ind = reading_support[wit_ind] == LACUNA ? lacuna_ind : reading_support[wit_ind];
+			if (wide) {
+				wide_cells[size_t(wit_ind) * n_units + vu_ind] = rdg_ind;
+			}
+			else {
+				narrow_cells[size_t(wit_ind) * n_units + vu_ind] = (uint8_t) rdg_ind;
+			}
+		}
+	}
+}
+
+/**
+ * Default destructor.
+ */
+reading_matrix::~reading_matrix() {
+
+}
+
+/**
+ * Returns the number of witnesses (rows) in this reading matrix.
+ */
+unsigned int reading_matrix::get_n_witnesses() const {
+	return n_witnesses;
+}
+
+/**
+ * Returns the number of variation units (columns) in this reading matrix.
+ */
+unsigned int reading_matrix::get_n_units() const {
+	return n_units;
+}
+
+/**
+ * Returns the most capable instruction set supported by the current processor, which compare uses by default.
+ */
+instruction_set reading_matrix::get_instruction_set() {
+	static const instruction_set isa = detect_instruction_set();
+	return isa;
+}
+
+/**
+ * Appends the indices of the set bits in the given vector of words to the given vector of indices in increasing order.
+ */
+void reading_matrix::get_set_bits(const vector<uint64_t> & words, vector<uint32_t> & inds) {
+	for (unsigned int w = 0; w < words.size(); w++) {
+		uint64_t bits = words[w];
+		while (bits != 0) {
+			inds.push_back(w * 64 + count_trailing_zeros(bits));
+			bits &= bits - 1;
+		}
+	}
+	return;
+}
+
+/**
+ * Compares the witness with the given index to the witness with the other given index using the best available instruction set.
+ * See the overload below for a description of the outputs.
+ */
+float reading_matrix::compare(unsigned int wit_ind, unsigned int other_wit_ind, vector<uint64_t> & agreements, vector<uint64_t> & explained) const {
+	return compare(wit_ind, other_wit_ind, agreements, explained, get_instruction_set());
+}
+
+/**
+ * Compares the witness with the given index to the witness with the other given index using the given instruction set,
+ * falling back to scalar code if it is not supported.
+ * The bits of the variation units where the two witnesses agree and where the other witness's reading explains this witness's reading
+ * are written to the given vectors of words, which are resized to fit the variation units.
+ * The return value is the total cost of the other witness's explanation of this one.
+ */
+float reading_matrix::compare(unsigned int wit_ind, unsigned int other_wit_ind, vector<uint64_t> & agreements, vector<uint64_t> & explained, instruction_set isa) const {
+	if (isa > get_instruction_set()) {
+		isa = get_instruction_set();
+	}
+	unsigned int n_words = (n_units + 63) / 64;
+	agreements.assign(n_words, 0);
+	explained.assign(n_words, 0);
+	if (wide) {
+		const uint16_t * row = wide_cells.data() + size_t(wit_ind) * n_units;
+		const uint16_t * other_row = wide_cells.data() + size_t(other_wit_ind) * n_units;
+		compare_rows<false>(row, other_row, path_lengths.data(), offsets.data(), strides.data(), n_units, agreements.data(), explained.data(), NULL, NULL, isa);
+		return sum_costs(row, other_row, path_lengths.data(), offsets.data(), strides.data(), agreements, explained);
+	}
+	const uint8_t * row = narrow_cells.data() + size_t(wit_ind) * n_units;
+	const uint8_t * other_row = narrow_cells.data() + size_t(other_wit_ind) * n_units;
+	compare_rows<false>(row, other_row, path_lengths.data(), offsets.data(), strides.data(), n_units, agreements.data(), explained.data(), NULL, NULL, isa);
+	return sum_costs(row, other_row, path_lengths.data(), offsets.data(), strides.data(), agreements, explained);
+}
+
+/**
+ * Compares the witness with the given index to the witness with the other given index in both directions at once,
+ * using the best available instruction set.
+ * See the overload below for a description of the outputs.
+ */
+void reading_matrix::compare_both_ways(unsigned int wit_ind, unsigned int other_wit_ind, row_comparison & comp, row_comparison & reverse_comp) const {
+	compare_both_ways(wit_ind, other_wit_ind, comp, reverse_comp, get_instruction_set());
+	return;
+}
+
+/**
+ * Compares the witness with the given index to the witness with the other given index in both directions at once,
+ * using the given instruction set and falling back to scalar code if it is not supported.
+ * The first comparison describes how the other witness explains this one, as in compare,
+ * and the reverse comparison describes how this witness explains the other one.
+ * Since edges of weight 0 need not go both ways in a local stemma, the two agreement masks are kept separately.
+ */
+void reading_matrix::compare_both_ways(unsigned int wit_ind, unsigned int other_wit_ind, row_comparison & comp, row_comparison & reverse_comp, instruction_set isa) const {
+	if (isa > get_instruction_set()) {
+		isa = get_instruction_set();
+	}
+	unsigned int n_words = (n_units + 63) / 64;
+	comp.agreements.assign(n_words, 0);
+	comp.explained.assign(n_words, 0);
+	reverse_comp.agreements.assign(n_words, 0);
+	reverse_comp.explained.assign(n_words, 0);
+	if (wide) {
+		const uint16_t * row = wide_cells.data() + size_t(wit_ind) * n_units;
+		const uint16_t * other_row = wide_cells.data() + size_t(other_wit_ind) * n_units;
+		compare_rows<true>(row, other_row, path_lengths.data(), offsets.data(), strides.data(), n_units, comp.agreements.data(), comp.explained.data(), reverse_comp.agreements.data(), reverse_comp.explained.data(), isa);
+		comp.cost = sum_costs(row, other_row, path_lengths.data(), offsets.data(), strides.data(), comp.agreements, comp.explained);
+		reverse_comp.cost = sum_costs(other_row, row, path_lengths.data(), offsets.data(), strides.data(), reverse_comp.agreements, reverse_comp.explained);
+		return;
+	}
+	const uint8_t * row = narrow_cells.data() + size_t(wit_ind) * n_units;
+	const uint8_t * other_row = narrow_cells.data() + size_t(other_wit_ind) * n_units;
+	compare_rows<true>(row, other_row, path_lengths.data(), offsets.data(), strides.data(), n_units, comp.agreements.data(), comp.explained.data(), reverse_comp.agreements.data(), reverse_comp.explained.data(), isa);
+	comp.cost = sum_costs(row, other_row, path_lengths.data(), offsets.data(), strides.data(), comp.agreements, comp.explained);
+	reverse_comp.cost = sum_costs(other_row, row, path_lengths.data(), offsets.data(), strides.data(), reverse_comp.agreements, reverse_comp.explained);
+	return;
+}
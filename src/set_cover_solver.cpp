@@ -9,14 +9,55 @@
 #include <list>
 #include <stack>
 #include <vector>
+#include <deque>
 #include <unordered_map>
 #include <limits>
+#include <cmath>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
 
 #include "set_cover_solver.h"
 #include "roaring.hh"
 
 using namespace std;
 
+//Define the minimum number of rows for which branch and bound is worth splitting between threads:
+const unsigned int MIN_ROWS_FOR_PARALLEL_BRANCH_AND_BOUND = 24;
+//Define the maximum number of target columns for which the rows are also stored as dense bit arrays, and the corresponding number of 64-bit words:
+const unsigned int MAX_DENSE_COLUMNS = 1024;
+const unsigned int MAX_DENSE_WORDS = MAX_DENSE_COLUMNS / 64;
+//Define the relative margin by which a lower bound must exceed the upper bound to prune a node, so that rounding errors never prune a solution within the upper bound:
+const double BOUND_TOLERANCE = 1e-5;
+//Define the number of subgradient updates tried by the Lagrangian bound at each node:
+const unsigned int LAGRANGIAN_ITERATIONS = 20;
+
+/**
+ * Returns the number of set bits in the given word.
+ */
+static inline unsigned int count_bits(uint64_t word) {
+#ifdef __GNUC__
+	return __builtin_popcountll(word);
+#else
+	unsigned int n = 0;
+	while (word != 0) {
+		word &= word - 1;
+		n++;
+	}
+	return n;
+#endif
+}
+
+/**
+ * Given a lower bound and an upper bound,
+ * returns a boolean value indicating if the lower bound exceeds the upper bound by more than the rounding tolerance.
+ */
+bool exceeds_upper_bound(double lb, double ub) {
+	return lb > ub + BOUND_TOLERANCE * max(1.0, fabs(ub));
+}
+
 /**
  * Default constructor.
  */
@@ -32,6 +73,7 @@ set_cover_solver::set_cover_solver(const vector<set_cover_row> & _rows, const Ro
 	//Copy the input rows and target set:
 	rows = vector<set_cover_row>(_rows);
 	target = Roaring(_target);
+	index_dense_rows();
 }
 
 /**
@@ -44,6 +86,7 @@ set_cover_solver::set_cover_solver(const vector<set_cover_row> & _rows, const Ro
 	target = Roaring(_target);
 	//Set the fixed upper bound:
 	fixed_ub = _fixed_ub;
+	index_dense_rows();
 }
 
 /**
@@ -53,6 +96,86 @@ set_cover_solver::~set_cover_solver() {
 
 }
 
+/**
+ * If the target set is narrow enough, then stores the target columns covered by each row as a dense bit array,
+ * so that the coverage, density, and redundancy checks on the rows can be done a word at a time rather than through Roaring bitmaps.
+ */
+void set_cover_solver::index_dense_rows() {
+	unsigned int n_cols = target.cardinality();
+	if (n_cols > MAX_DENSE_COLUMNS) {
+		n_words = 0;
+		dense_rows = vector<uint64_t>();
+		dense_target = vector<uint64_t>();
+		return;
+	}
+	n_words = (n_cols + 63) / 64;
+	dense_rows = vector<uint64_t>(size_t(rows.size()) * n_words, 0);
+	dense_target = vector<uint64_t>(n_words, 0);
+	unsigned int col = 0;
+	for (Roaring::const_iterator it = target.begin(); it != target.end(); it++) {
+		unsigned int col_ind = *it;
+		uint64_t bit = uint64_t(1) << (col % 64);
+		dense_target[col / 64] |= bit;
+		for (unsigned int row_ind = 0; row_ind < rows.size(); row_ind++) {
+			if (rows[row_ind].explained.contains(col_ind)) {
+				dense_rows[size_t(row_ind) * n_words + col / 64] |= bit;
+			}
+		}
+		col++;
+	}
+	return;
+}
+
+/**
+ * Returns a boolean value indicating if this solver stores its rows as dense bit arrays.
+ */
+bool set_cover_solver::has_dense_rows() const {
+	return n_words > 0;
+}
+
+/**
+ * Returns the number of threads that this solver uses for branch and bound.
+ */
+unsigned int set_cover_solver::get_n_threads() const {
+	return n_threads;
+}
+
+/**
+ * Sets the number of threads that this solver uses for branch and bound.
+ */
+void set_cover_solver::set_n_threads(unsigned int _n_threads) {
+	n_threads = max(1u, _n_threads);
+}
+
+/**
+ * Returns the list of lower bounds that this solver uses to prune branch and bound nodes, in the order they are tried.
+ */
+const list<bound_type> & set_cover_solver::get_bounds() const {
+	return bounds;
+}
+
+/**
+ * Sets the list of lower bounds that this solver uses to prune branch and bound nodes, in the order they are tried.
+ * Since every bound is a valid lower bound, the solutions found do not depend on the bounds used, only the number of nodes visited.
+ */
+void set_cover_solver::set_bounds(const list<bound_type> & _bounds) {
+	bounds = list<bound_type>(_bounds);
+}
+
+/**
+ * Returns the statistics of the last branch and bound search done by this solver.
+ */
+const branch_and_bound_statistics & set_cover_solver::get_statistics() const {
+	return statistics;
+}
+
+/**
+ * Returns the statistics of the reduction done by this solver before its last branch and bound search.
+ */
+const reduction_statistics & set_cover_solver::get_reduction_statistics() const {
+	return reduction;
+}
+
 /**
  * Given a bitmap representing a set of rows in a solution,
  * returns a set cover solution data structure containing those rows.
@@ -95,6 +218,31 @@ Roaring set_cover_solver::get_unique_rows() const {
 	if (rows.empty()) {
 		return unique_rows;
 	}
+	//If the rows are dense, then find the columns covered exactly once a word at a time, and then the rows that cover them:
+	if (n_words > 0) {
+		vector<uint64_t> covered_once = vector<uint64_t>(n_words, 0);
+		vector<uint64_t> covered_twice = vector<uint64_t>(n_words, 0);
+		for (unsigned int row_ind = 0; row_ind < rows.size(); row_ind++) {
+			const uint64_t * row_words = &dense_rows[size_t(row_ind) * n_words];
+			for (unsigned int w = 0; w < n_words; w++) {
+				covered_twice[w] |= covered_once[w] & row_words[w];
+				covered_once[w] |= row_words[w];
+			}
+		}
+		for (unsigned int w = 0; w < n_words; w++) {
+			covered_once[w] &= ~covered_twice[w];
+		}
+		for (unsigned int row_ind = 0; row_ind < rows.size(); row_ind++) {
+			const uint64_t * row_words = &dense_rows[size_t(row_ind) * n_words];
+			for (unsigned int w = 0; w < n_words; w++) {
+				if ((row_words[w] & covered_once[w]) != 0) {
+					unique_rows.add(row_ind);
+					break;
+				}
+			}
+		}
+		return unique_rows;
+	}
 	//Otherwise, we will construct a union tree from the bitmaps representing the rows;
 	//the tree will consist of 2n - 1 nodes, where n is the number of set cover rows:
 	unsigned int n = rows.size();
@@ -147,7 +295,24 @@ Roaring set_cover_solver::get_unique_rows() const {
  * returns a boolean value indicating if that set of rows constitutes a feasible set cover solution.
  */
 bool set_cover_solver::is_feasible(const Roaring & solution_rows) const {
-	//Check if the target set is covered by the accepted rows:
+	//If the rows are dense, then accumulate their coverage a word at a time:
+	if (n_words > 0) {
+		uint64_t covered[MAX_DENSE_WORDS] = {};
+		for (Roaring::const_iterator it = solution_rows.begin(); it != solution_rows.end(); it++) {
+			unsigned int row_ind = *it;
+			const uint64_t * row_words = &dense_rows[size_t(row_ind) * n_words];
+			bool is_covered = true;
+			for (unsigned int w = 0; w < n_words; w++) {
+				covered[w] |= row_words[w];
+				is_covered &= covered[w] == dense_target[w];
+			}
+			if (is_covered) {
+				return true;
+			}
+		}
+		return false;
+	}
+	//Otherwise, check if the target set is covered by the accepted rows:
 	Roaring row_union = Roaring();
 	for (Roaring::const_iterator it = solution_rows.begin(); it != solution_rows.end(); it++) {
 		unsigned int row_ind = *it;
@@ -195,8 +360,23 @@ set_cover_solution set_cover_solver::get_trivial_solution() const {
 	trivial_solution.rows = list<set_cover_row>();
 	trivial_solution.agreements = 0;
 	trivial_solution.cost = numeric_limits<float>::infinity();
-	for (set_cover_row row : rows) {
-		if (target.isSubset(row.explained) && row.cost < trivial_solution.cost) {
+	for (unsigned int row_ind = 0; row_ind < rows.size(); row_ind++) {
+		const set_cover_row & row = rows[row_ind];
+		if (row.cost >= trivial_solution.cost) {
+			continue;
+		}
+		//If the rows are dense, then check if this row covers the target a word at a time:
+		bool covers_target = true;
+		if (n_words > 0) {
+			const uint64_t * row_words = &dense_rows[size_t(row_ind) * n_words];
+			for (unsigned int w = 0; w < n_words; w++) {
+				covers_target &= row_words[w] == dense_target[w];
+			}
+		}
+		else {
+			covers_target = target.isSubset(row.explained);
+		}
+		if (covers_target) {
 			trivial_solution.rows = list<set_cover_row>({row});
 			trivial_solution.agreements = row.agreements.cardinality();
 			trivial_solution.cost = row.cost;
@@ -211,30 +391,50 @@ set_cover_solution set_cover_solver::get_trivial_solution() const {
 set_cover_solution set_cover_solver::get_greedy_solution() const {
 	Roaring greedy_solution_rows = Roaring();
 	Roaring uncovered = Roaring(target);
+	vector<uint64_t> dense_uncovered = vector<uint64_t>(dense_target);
+	unsigned int n_uncovered = target.cardinality();
 	//Until the target is completely covered, choose the row with the lowest cost-to-coverage proportion:
-	while (!uncovered.isEmpty()) {
+	while (n_uncovered > 0) {
 		float best_density = numeric_limits<float>::infinity();
 		unsigned int best_row_ind = 0;
-		unsigned int row_ind = 0;
-		for (set_cover_row row : rows) {
+		unsigned int best_coverage = 0;
+		for (unsigned int row_ind = 0; row_ind < rows.size(); row_ind++) {
+			const set_cover_row & row = rows[row_ind];
 			float cost = row.cost;
-			float coverage = float((uncovered & row.explained).cardinality());
+			//If the rows are dense, then count the uncovered columns covered by this row a word at a time:
+			unsigned int coverage = 0;
+			if (n_words > 0) {
+				const uint64_t * row_words = &dense_rows[size_t(row_ind) * n_words];
+				for (unsigned int w = 0; w < n_words; w++) {
+					coverage += count_bits(dense_uncovered[w] & row_words[w]);
+				}
+			}
+			else {
+				coverage = uncovered.and_cardinality(row.explained);
+			}
 			//Skip if there is no coverage:
 			if (coverage == 0) {
-				row_ind++;
 				continue;
 			}
-			float density = cost / coverage;
+			float density = cost / float(coverage);
 			if (density < best_density && !greedy_solution_rows.contains(row_ind)) {
 				best_density = density;
 				best_row_ind = row_ind;
+				best_coverage = coverage;
 			}
-			row_ind++;
 		}
 		//Add the best-found row to the initial solution, and remove its overlap with the target set from the target set:
 		greedy_solution_rows.add(best_row_ind);
-		set_cover_row best_row = rows[best_row_ind];
-		uncovered ^= uncovered & best_row.explained;
+		if (n_words > 0) {
+			const uint64_t * best_row_words = &dense_rows[size_t(best_row_ind) * n_words];
+			for (unsigned int w = 0; w < n_words; w++) {
+				dense_uncovered[w] &= ~best_row_words[w];
+			}
+		}
+		else {
+			uncovered ^= uncovered & rows[best_row_ind].explained;
+		}
+		n_uncovered -= best_coverage;
 	}
 	//Now remove any redundant columns from this solution:
 	remove_redundant_rows_from_solution(greedy_solution_rows);
@@ -242,6 +442,141 @@ set_cover_solution set_cover_solver::get_greedy_solution() const {
 	return greedy_solution;
 }
 
+/**
+ * Given an empty bitmap of fixed rows, an empty bitmap of reduced rows, an empty bitmap of reduced target columns, and an upper bound,
+ * reduces this set cover problem until no further reduction applies,
+ * populating the fixed rows with rows that must be included in every solution,
+ * the reduced rows and target with the rows and columns left to be solved by branch and bound,
+ * and lowering the upper bound by the cost of the fixed rows.
+ * Rows that uniquely cover a column are fixed, and columns whose covering rows include all the rows covering another column are dropped.
+ * If no fixed upper bound is given, then rows whose columns are all covered by a strictly cheaper row are dropped as well;
+ * since such rows belong to no minimum-cost solution, this leaves the minimum-cost solutions unchanged.
+ * Returns a boolean value indicating if the reduced problem can still be solved within the upper bound.
+ */
+bool set_cover_solver::reduce(Roaring & fixed_rows, Roaring & reduced_rows, Roaring & reduced_target, float & reduced_ub) {
+	reduction = reduction_statistics();
+	reduced_rows.addRange(0, rows.size());
+	reduced_target = Roaring(target);
+	bool is_ub_fixed = fixed_ub != numeric_limits<float>::infinity();
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		reduction.passes++;
+		//Drop any rows that can no longer be part of a solution:
+		Roaring excluded_rows = Roaring();
+		for (Roaring::const_iterator it = reduced_rows.begin(); it != reduced_rows.end(); it++) {
+			unsigned int row_ind = *it;
+			const set_cover_row & row = rows[row_ind];
+			//If the row has a cost that exceeds the upper bound, then exclude it:
+			if (row.cost > reduced_ub) {
+				excluded_rows.add(row_ind);
+			}
+			//If we're just looking for a minimum-cost solution,
+			//then exclude any rows that have no overlap with the remaining target set:
+			else if (!is_ub_fixed && !row.explained.intersect(reduced_target)) {
+				excluded_rows.add(row_ind);
+			}
+		}
+		reduced_rows -= excluded_rows;
+		//Group the target columns by the rows covering them, so that columns with the same covering rows are only compared once:
+		unordered_map<string, unsigned int> row_sets_to_classes = unordered_map<string, unsigned int>();
+		vector<Roaring> class_rows = vector<Roaring>();
+		vector<Roaring> class_columns = vector<Roaring>();
+		for (Roaring::const_iterator it = reduced_target.begin(); it != reduced_target.end(); it++) {
+			unsigned int col_ind = *it;
+			Roaring covering_rows = Roaring();
+			for (Roaring::const_iterator row_it = reduced_rows.begin(); row_it != reduced_rows.end(); row_it++) {
+				unsigned int row_ind = *row_it;
+				if (rows[row_ind].explained.contains(col_ind)) {
+					covering_rows.add(row_ind);
+				}
+			}
+			string key = covering_rows.toString();
+			if (row_sets_to_classes.find(key) == row_sets_to_classes.end()) {
+				row_sets_to_classes[key] = class_rows.size();
+				class_rows.push_back(covering_rows);
+				class_columns.push_back(Roaring());
+			}
+			class_columns[row_sets_to_classes.at(key)].add(col_ind);
+		}
+		//If any column is covered by no row, then there is no solution;
+		//otherwise, any row that uniquely covers a column must be fixed:
+		Roaring unique_rows = Roaring();
+		for (const Roaring & covering_rows : class_rows) {
+			if (covering_rows.isEmpty()) {
+				return false;
+			}
+			if (covering_rows.cardinality() == 1) {
+				unique_rows.add(covering_rows.minimum());
+			}
+		}
+		if (!unique_rows.isEmpty()) {
+			for (Roaring::const_iterator it = unique_rows.begin(); it != unique_rows.end(); it++) {
+				unsigned int row_ind = *it;
+				const set_cover_row & row = rows[row_ind];
+				reduced_target -= row.explained;
+				reduced_ub -= row.cost;
+			}
+			//If the total cost of the fixed rows exceeds the upper bound, then there is no solution:
+			if (reduced_ub < 0) {
+				return false;
+			}
+			fixed_rows |= unique_rows;
+			reduced_rows -= unique_rows;
+			reduction.fixed_rows += unique_rows.cardinality();
+			changed = true;
+			continue;
+		}
+		//Drop every column whose covering rows include all the rows covering another column,
+		//keeping only the first column of each class of columns covered by the same rows:
+		Roaring dominated_columns = Roaring();
+		for (unsigned int i = 0; i < class_rows.size(); i++) {
+			Roaring first_column = Roaring();
+			first_column.add(class_columns[i].minimum());
+			dominated_columns |= class_columns[i] - first_column;
+			for (unsigned int j = 0; j < class_rows.size(); j++) {
+				if (i != j && class_rows[j].isStrictSubset(class_rows[i])) {
+					dominated_columns.add(first_column.minimum());
+					break;
+				}
+			}
+		}
+		if (!dominated_columns.isEmpty()) {
+			reduced_target -= dominated_columns;
+			reduction.dominated_columns += dominated_columns.cardinality();
+			changed = true;
+		}
+		//If we're just looking for a minimum-cost solution,
+		//then drop every row whose remaining target columns are all covered by a strictly cheaper row:
+		if (!is_ub_fixed) {
+			vector<unsigned int> row_inds = vector<unsigned int>();
+			vector<Roaring> row_columns = vector<Roaring>();
+			for (Roaring::const_iterator it = reduced_rows.begin(); it != reduced_rows.end(); it++) {
+				unsigned int row_ind = *it;
+				row_inds.push_back(row_ind);
+				row_columns.push_back(rows[row_ind].explained & reduced_target);
+			}
+			Roaring dominated_rows = Roaring();
+			for (unsigned int i = 0; i < row_inds.size(); i++) {
+				for (unsigned int j = 0; j < row_inds.size(); j++) {
+					if (rows[row_inds[j]].cost < rows[row_inds[i]].cost && row_columns[i].isSubset(row_columns[j])) {
+						dominated_rows.add(row_inds[i]);
+						break;
+					}
+				}
+			}
+			if (!dominated_rows.isEmpty()) {
+				reduced_rows -= dominated_rows;
+				reduction.dominated_rows += dominated_rows.cardinality();
+				changed = true;
+			}
+		}
+	}
+	reduction.remaining_rows = reduced_rows.cardinality();
+	reduction.remaining_columns = reduced_target.cardinality();
+	return true;
+}
+
 /**
  * Given a bitmap representing rows remaining to be processed and a stack of branch-and-bound nodes,
  * adds the a candidate solution node for the next row to the stack.
@@ -275,18 +610,340 @@ float set_cover_solver::bound(const Roaring & solution_rows) const {
 	return bound;
 }
 
+/**
+ * Indexes the rows covering each target column and the target columns covered by each row,
+ * so that the coverage of the target and the rows covering the uncovered columns at each branch and bound node can be found quickly.
+ */
+void set_cover_solver::index_columns() {
+	column_rows = vector<Roaring>(target.cardinality());
+	row_targets = vector<vector<unsigned int>>(rows.size());
+	unsigned int col = 0;
+	for (Roaring::const_iterator it = target.begin(); it != target.end(); it++) {
+		unsigned int col_ind = *it;
+		for (unsigned int row_ind = 0; row_ind < rows.size(); row_ind++) {
+			if (rows[row_ind].explained.contains(col_ind)) {
+				column_rows[col].add(row_ind);
+				row_targets[row_ind].push_back(col);
+			}
+		}
+		col++;
+	}
+	return;
+}
+
+/**
+ * Given bitmaps representing the accepted and remaining rows at a branch-and-bound node,
+ * initializes the given counts of the accepted and available rows covering each target column.
+ */
+void set_cover_solver::init_coverage_counts(const Roaring & accepted, const Roaring & remaining, coverage_counts & coverage) const {
+	unsigned int n = column_rows.size();
+	coverage.accepted = vector<unsigned int>(n, 0);
+	coverage.available = vector<unsigned int>(n, 0);
+	coverage.uncovered_by_accepted = n;
+	coverage.uncovered_by_available = n;
+	for (Roaring::const_iterator it = accepted.begin(); it != accepted.end(); it++) {
+		unsigned int row_ind = *it;
+		add_available_row(row_ind, coverage);
+		add_accepted_row(row_ind, coverage);
+	}
+	for (Roaring::const_iterator it = remaining.begin(); it != remaining.end(); it++) {
+		unsigned int row_ind = *it;
+		add_available_row(row_ind, coverage);
+	}
+	return;
+}
+
+/**
+ * Updates the given coverage counts for the acceptance of the row with the given index.
+ */
+void set_cover_solver::add_accepted_row(unsigned int row_ind, coverage_counts & coverage) const {
+	for (unsigned int col : row_targets[row_ind]) {
+		if (coverage.accepted[col]++ == 0) {
+			coverage.uncovered_by_accepted--;
+		}
+	}
+	return;
+}
+
+/**
+ * Updates the given coverage counts for the removal of the row with the given index from the accepted rows.
+ */
+void set_cover_solver::remove_accepted_row(unsigned int row_ind, coverage_counts & coverage) const {
+	for (unsigned int col : row_targets[row_ind]) {
+		if (--coverage.accepted[col] == 0) {
+			coverage.uncovered_by_accepted++;
+		}
+	}
+	return;
+}
+
+/**
+ * Updates the given coverage counts for the restoration of the row with the given index to the available rows.
+ */
+void set_cover_solver::add_available_row(unsigned int row_ind, coverage_counts & coverage) const {
+	for (unsigned int col : row_targets[row_ind]) {
+		if (coverage.available[col]++ == 0) {
+			coverage.uncovered_by_available--;
+		}
+	}
+	return;
+}
+
+/**
+ * Updates the given coverage counts for the rejection of the row with the given index from the available rows.
+ */
+void set_cover_solver::remove_available_row(unsigned int row_ind, coverage_counts & coverage) const {
+	for (unsigned int col : row_targets[row_ind]) {
+		if (--coverage.available[col] == 0) {
+			coverage.uncovered_by_available++;
+		}
+	}
+	return;
+}
+
+/**
+ * Given the coverage counts and the bitmap of remaining rows at a branch-and-bound node,
+ * populates the given data structure with the target columns not covered by the accepted rows and the remaining rows that cover them.
+ */
+void set_cover_solver::get_uncovered_column_set(const coverage_counts & coverage, const Roaring & remaining, uncovered_column_set & uncovered) const {
+	//Get the remaining rows covering each target column not covered by the accepted rows:
+	unsigned int n = coverage.uncovered_by_accepted;
+	uncovered.column_rows = vector<Roaring>();
+	uncovered.column_rows.reserve(n);
+	uncovered.row_columns = vector<vector<unsigned int>>(rows.size());
+	unsigned int col = 0;
+	for (unsigned int target_col = 0; target_col < column_rows.size(); target_col++) {
+		if (coverage.accepted[target_col] > 0) {
+			continue;
+		}
+		Roaring covering_rows = column_rows[target_col] & remaining;
+		for (Roaring::const_iterator row_it = covering_rows.begin(); row_it != covering_rows.end(); row_it++) {
+			unsigned int row_ind = *row_it;
+			uncovered.row_columns[row_ind].push_back(col);
+		}
+		uncovered.column_rows.push_back(covering_rows);
+		col++;
+	}
+	//Then find the lowest cost of a row covering each column and the lowest share of a row's cost spent on each column:
+	uncovered.min_costs = vector<float>(n, numeric_limits<float>::infinity());
+	uncovered.min_shares = vector<double>(n, numeric_limits<double>::infinity());
+	for (unsigned int row_ind = 0; row_ind < rows.size(); row_ind++) {
+		const vector<unsigned int> & row_columns = uncovered.row_columns[row_ind];
+		if (row_columns.empty()) {
+			continue;
+		}
+		float cost = rows[row_ind].cost;
+		double share = double(cost) / row_columns.size();
+		for (unsigned int col : row_columns) {
+			uncovered.min_costs[col] = min(uncovered.min_costs[col], cost);
+			uncovered.min_shares[col] = min(uncovered.min_shares[col], share);
+		}
+	}
+	return;
+}
+
+/**
+ * Given the uncovered columns at a branch-and-bound node,
+ * returns a lower bound on the cost of the remaining rows needed to cover them.
+ * Any such cover spends at least the lowest share of a covering row's cost on each column,
+ * where a row's cost is divided evenly between the uncovered columns that it covers.
+ */
+double set_cover_solver::get_column_cost_bound(const uncovered_column_set & uncovered) const {
+	double bound = 0;
+	for (double share : uncovered.min_shares) {
+		bound += share;
+	}
+	return bound;
+}
+
+/**
+ * Given the uncovered columns at a branch-and-bound node,
+ * returns a lower bound on the cost of the remaining rows needed to cover them.
+ * The bound greedily packs the costliest columns to cover into a set in which no two columns are covered by the same remaining row,
+ * so that a different row must be added to cover each column in the set.
+ */
+double set_cover_solver::get_disjoint_columns_bound(const uncovered_column_set & uncovered) const {
+	//Sort the columns by decreasing cost to cover:
+	vector<unsigned int> cols = vector<unsigned int>(uncovered.min_costs.size());
+	for (unsigned int col = 0; col < cols.size(); col++) {
+		cols[col] = col;
+	}
+	stable_sort(begin(cols), end(cols), [&uncovered](unsigned int col1, unsigned int col2) {
+		return uncovered.min_costs[col1] > uncovered.min_costs[col2];
+	});
+	//Then add each column whose covering rows do not cover any column already in the set:
+	double bound = 0;
+	Roaring packed_rows = Roaring();
+	for (unsigned int col : cols) {
+		const Roaring & covering_rows = uncovered.column_rows[col];
+		if (covering_rows.intersect(packed_rows)) {
+			continue;
+		}
+		packed_rows |= covering_rows;
+		bound += uncovered.min_costs[col];
+	}
+	return bound;
+}
+
+/**
+ * Given the uncovered columns at a branch-and-bound node and the gap between the upper bound and the cost of the accepted rows,
+ * returns a lower bound on the cost of the remaining rows needed to cover them.
+ * The bound is the best value of the Lagrangian relaxation of the covering constraints found by subgradient optimization,
+ * starting from the multipliers of the column cost bound (whose Lagrangian value is the column cost bound itself)
+ * and stopping early if the bound exceeds the gap.
+ */
+double set_cover_solver::get_lagrangian_bound(const uncovered_column_set & uncovered, double gap) const {
+	vector<double> multipliers = vector<double>(uncovered.min_shares);
+	double bound = get_column_cost_bound(uncovered);
+	//If there is no finite gap to aim for, then the subgradient step cannot be sized:
+	if (!isfinite(gap)) {
+		return bound;
+	}
+	unsigned int n = multipliers.size();
+	vector<double> subgradient = vector<double>(n);
+	double step_size = 2.0;
+	for (unsigned int iteration = 0; iteration < LAGRANGIAN_ITERATIONS && !exceeds_upper_bound(bound, gap); iteration++) {
+		//Evaluate the Lagrangian at the current multipliers, taking every remaining row whose reduced cost is negative:
+		double lagrangian = 0;
+		for (unsigned int col = 0; col < n; col++) {
+			lagrangian += multipliers[col];
+			subgradient[col] = 1;
+		}
+		for (unsigned int row_ind = 0; row_ind < rows.size(); row_ind++) {
+			const vector<unsigned int> & row_columns = uncovered.row_columns[row_ind];
+			if (row_columns.empty()) {
+				continue;
+			}
+			double reduced_cost = rows[row_ind].cost;
+			for (unsigned int col : row_columns) {
+				reduced_cost -= multipliers[col];
+			}
+			if (reduced_cost < 0) {
+				lagrangian += reduced_cost;
+				for (unsigned int col : row_columns) {
+					subgradient[col] -= 1;
+				}
+			}
+		}
+		//Keep the best value found, and shrink the step size whenever the value does not improve:
+		if (lagrangian > bound) {
+			bound = lagrangian;
+		}
+		else {
+			step_size /= 2;
+		}
+		//If the rows taken cover every column exactly once, then the multipliers are optimal:
+		double norm = 0;
+		for (double g : subgradient) {
+			norm += g * g;
+		}
+		if (norm == 0 || lagrangian >= gap) {
+			break;
+		}
+		//Otherwise, step the multipliers along the subgradient towards the gap:
+		double step = step_size * (gap - lagrangian) / norm;
+		for (unsigned int col = 0; col < n; col++) {
+			multipliers[col] = max(0.0, multipliers[col] + step * subgradient[col]);
+		}
+	}
+	return bound;
+}
+
+/**
+ * Given bitmaps representing the accepted and remaining rows at a branch-and-bound node, the counts of those rows covering each target column,
+ * the current upper bound, a flag indicating whether that bound is fixed,
+ * a map of the distinct solution row sets found so far (keyed by their serializations), and the statistics of the search so far,
+ * adds the solution represented by the accepted rows to the map if it is feasible and within the upper bound.
+ * If the upper bound is not fixed, then the solution's redundant rows are removed first,
+ * and if it is cheaper than the upper bound, then the upper bound is lowered to its cost and the costlier solutions are discarded.
+ * Each of the solver's lower bounds is then tried in turn on the cost of any solution under this node.
+ * The return value indicates whether any solution under this node could still be within the upper bound, so that the node should be branched on.
+ */
+bool set_cover_solver::visit(const Roaring & accepted, const Roaring & remaining, const coverage_counts & coverage, float & ub, bool is_ub_fixed, unordered_map<string, Roaring> & distinct_row_sets, branch_and_bound_statistics & node_statistics) const {
+	node_statistics.nodes++;
+	//Check if current set of accepted rows represents a feasible solution (an empty set of rows never does):
+	if (coverage.uncovered_by_accepted == 0 && !accepted.isEmpty()) {
+		//If it does, then calculate the cost of the solution:
+		Roaring solution_rows = Roaring(accepted);
+		//If we're just looking for the minimum-cost solution, then remove redundant rows:
+		if (!is_ub_fixed) {
+			remove_redundant_rows_from_solution(solution_rows);
+		}
+		float cost = bound(solution_rows);
+		//Check if this cost is within the current upper bound:
+		if (cost <= ub) {
+			//If it is, then make any necessary updates to the upper bound and solution set if we're just looking for minimum-cost solutions:
+			if (!is_ub_fixed && cost < ub) {
+				ub = cost;
+				distinct_row_sets = unordered_map<string, Roaring>();
+			}
+			//Then add the solution row bitmap to the solution set:
+			string serialized = solution_rows.toString();
+			distinct_row_sets[serialized] = solution_rows;
+		}
+		//If we're just looking for minimum-cost solutions, then branching past this point is unnecessary:
+		if (!is_ub_fixed) {
+			return false;
+		}
+	}
+	//Check if there is any feasible solution under the current node:
+	if (coverage.uncovered_by_available > 0) {
+		node_statistics.infeasible++;
+		return false;
+	}
+	//Lower-bound the cost of any solution under the current node with each bound in turn, and prune the node if any of them exceeds the upper bound:
+	double accepted_cost = bound(accepted);
+	uncovered_column_set uncovered;
+	bool is_uncovered_set = false;
+	for (bound_type type : bounds) {
+		if (type != bound_type::ACCEPTED_COST && !is_uncovered_set) {
+			get_uncovered_column_set(coverage, remaining, uncovered);
+			is_uncovered_set = true;
+		}
+		double lb = accepted_cost;
+		if (type == bound_type::COLUMN_COST) {
+			lb += get_column_cost_bound(uncovered);
+		}
+		else if (type == bound_type::DISJOINT_COLUMNS) {
+			lb += get_disjoint_columns_bound(uncovered);
+		}
+		else if (type == bound_type::LAGRANGIAN) {
+			lb += get_lagrangian_bound(uncovered, ub - accepted_cost);
+		}
+		bound_statistics & stats = node_statistics.bounds[type];
+		stats.evaluations++;
+		if (exceeds_upper_bound(lb, ub)) {
+			stats.prunes++;
+			return false;
+		}
+	}
+	//If no bound exceeds the upper bound, then branch on this node:
+	return true;
+}
+
 /**
  * Populates a list of set cover solutions via branch and bound.
  * If the set cover solver was constructed without a fixed upper bound, then the map will consist only of solutions with the lowest cost.
  * If the set cover solver was constructed with a fixed upper bound, then this method will enumerate all solutions with costs within that bound.
+ * If the solver has more than one thread and the problem is large enough, then the search is split between the threads.
  */
 void set_cover_solver::branch_and_bound(list<set_cover_solution> & solutions) {
+	statistics = branch_and_bound_statistics();
+	index_columns();
+	if (n_threads > 1 && rows.size() >= MIN_ROWS_FOR_PARALLEL_BRANCH_AND_BOUND) {
+		parallel_branch_and_bound(solutions);
+		return;
+	}
 	//Initialize a map of solution row set bitmaps, keyed by their serializations:
 	unordered_map<string, Roaring> distinct_row_sets = unordered_map<string, Roaring>();
 	//Initialize bitmaps representing rows included in the current solution and rows to be processed:
 	Roaring accepted = Roaring();
 	Roaring remaining = Roaring();
 	remaining.addRange(0, rows.size());
+	//Initialize the counts of accepted and available rows covering each target column;
+	//the states of the nodes on the stack record which updates to these counts to undo when backtracking:
+	coverage_counts coverage;
+	init_coverage_counts(accepted, remaining, coverage);
 	//Initialize a stack of branch-and-bound nodes:
 	stack<branch_and_bound_node> nodes = stack<branch_and_bound_node>();
 	//If no fixed upper bound is specified, then obtain a good initial upper bound quickly using the trivial solution and the greedy solution:
@@ -309,53 +966,224 @@ void set_cover_solver::branch_and_bound(list<set_cover_solution> & solutions) {
 			//Add the candidate row to the solution:
 			remaining.remove(row);
 			accepted.add(row);
+			add_accepted_row(row, coverage);
 			//Update its state:
 			node.state = node_state::REJECT;
 		}
 		else if (node.state == node_state::REJECT) {
 			//Exclude the candidate row from the solution:
 			accepted.remove(row);
+			remove_accepted_row(row, coverage);
+			remove_available_row(row, coverage);
 			//Update its state:
 			node.state = node_state::DONE;
 		}
 		else {
 			//We're done processing this node, and we can add its row back to the set of available rows:
 			remaining.add(row);
+			add_available_row(row, coverage);
 			nodes.pop();
 			continue;
 		}
-		//Check if current set of accepted rows represents a feasible solution:
-		if (is_feasible(accepted)) {
-			//If it does, then calculate the cost of the solution:
-			Roaring solution_rows = Roaring(accepted);
-			//If we're just looking for the minimum-cost solution, then remove redundant rows:
-			if (!is_ub_fixed) {
-				remove_redundant_rows_from_solution(solution_rows);
-			}
-			float cost = bound(solution_rows);
-			//Check if this cost is within the current upper bound:
-			if (cost <= ub) {
-				//If it is, then make any necessary updates to the upper bound and solution set if we're just looking for minimum-cost solutions:
-				if (!is_ub_fixed && cost < ub) {
-					ub = cost;
-					distinct_row_sets = unordered_map<string, Roaring>();
-				}
-				//Then add the solution row bitmap to the solution set:
-				string serialized = solution_rows.toString();
-				distinct_row_sets[serialized] = solution_rows;
+		//Record the solution at this node, if there is one, and branch on it if a solution within the upper bound could still lie under it:
+		if (visit(accepted, remaining, coverage, ub, is_ub_fixed, distinct_row_sets, statistics)) {
+			branch(remaining, nodes);
+		}
+	}
+	//For each distinct set of solution rows, add a set cover solution data structure to the solutions list:
+	for (pair<string, Roaring> kv : distinct_row_sets) {
+		Roaring solution_rows = kv.second;
+		set_cover_solution solution = get_solution_from_rows(solution_rows);
+		solutions.push_back(solution);
+	}
+	return;
+}
+
+/**
+ * Populates a list of set cover solutions via branch and bound, splitting the search between the solver's threads.
+ * Each thread keeps a deque of subtrees of the search to explore, each given by the rows accepted and remaining at its root.
+ * A thread explores the subtrees in its own deque depth-first, taking them from the back,
+ * and a thread whose deque is empty steals the oldest (and typically largest) subtree from the front of another thread's deque.
+ * While any thread is waiting for work, a thread that has no subtrees waiting in its deque hands off the untried reject branch nearest the root of the subtree it is exploring.
+ * The threads share the upper bound, so that a cheaper solution found by one thread lets all of them prune their searches.
+ * Since no node under which a solution within the final upper bound lies is ever pruned, and only the solutions within that bound are kept,
+ * the solutions are the same as those found by a single thread.
+ */
+void set_cover_solver::parallel_branch_and_bound(list<set_cover_solution> & solutions) {
+	//If no fixed upper bound is specified, then obtain a good initial upper bound quickly using the trivial solution and the greedy solution:
+	bool is_ub_fixed = fixed_ub < numeric_limits<float>::infinity();
+	float initial_ub = fixed_ub;
+	if (!is_ub_fixed) {
+		set_cover_solution trivial_solution = get_trivial_solution();
+		set_cover_solution greedy_solution = get_greedy_solution();
+		initial_ub = min(trivial_solution.cost, greedy_solution.cost);
+	}
+	atomic<float> shared_ub(initial_ub);
+	//Initialize a deque of subtrees for each thread, with the whole search tree in the first one:
+	vector<deque<branch_and_bound_task>> tasks = vector<deque<branch_and_bound_task>>(n_threads);
+	vector<mutex> task_mutexes(n_threads);
+	branch_and_bound_task root;
+	root.accepted = Roaring();
+	root.remaining = Roaring();
+	root.remaining.addRange(0, rows.size());
+	tasks[0].push_back(root);
+	//Keep count of the subtrees that have not been fully explored and of the threads waiting for work:
+	atomic<unsigned int> n_unfinished_tasks(1);
+	atomic<unsigned int> n_idle_threads(0);
+	//Each thread collects its own map of solution row set bitmaps, keyed by their serializations:
+	vector<unordered_map<string, Roaring>> distinct_row_sets_by_thread = vector<unordered_map<string, Roaring>>(n_threads);
+	//Each thread also keeps its own statistics:
+	vector<branch_and_bound_statistics> statistics_by_thread = vector<branch_and_bound_statistics>(n_threads);
+	//Lowers the shared upper bound to the given upper bound, if it is lower:
+	auto lower_shared_ub = [&](float ub) {
+		float current_ub = shared_ub.load();
+		while (ub < current_ub && !shared_ub.compare_exchange_weak(current_ub, ub)) {}
+	};
+	//Takes a subtree from the back of the given thread's deque or, failing that, from the front of another thread's deque:
+	auto take_task = [&](unsigned int thread_ind, branch_and_bound_task & task) {
+		for (unsigned int i = 0; i < n_threads; i++) {
+			unsigned int victim_ind = (thread_ind + i) % n_threads;
+			lock_guard<mutex> lock(task_mutexes[victim_ind]);
+			deque<branch_and_bound_task> & victim_tasks = tasks[victim_ind];
+			if (victim_tasks.empty()) {
+				continue;
 			}
-			//If we're just looking for minimum-cost solutions, then branching past this point is unnecessary:
-			if (!is_ub_fixed) {
+			if (victim_ind == thread_ind) {
+				task = move(victim_tasks.back());
+				victim_tasks.pop_back();
+			}
+			else {
+				task = move(victim_tasks.front());
+				victim_tasks.pop_front();
+			}
+			return true;
+		}
+		return false;
+	};
+	//Explores the given subtree depth-first, as in the single-threaded search:
+	auto search = [&](unsigned int thread_ind, const branch_and_bound_task & task) {
+		unordered_map<string, Roaring> & distinct_row_sets = distinct_row_sets_by_thread[thread_ind];
+		branch_and_bound_statistics & thread_statistics = statistics_by_thread[thread_ind];
+		Roaring accepted = task.accepted;
+		Roaring remaining = task.remaining;
+		coverage_counts coverage;
+		init_coverage_counts(accepted, remaining, coverage);
+		vector<branch_and_bound_node> nodes = vector<branch_and_bound_node>();
+		float ub = shared_ub.load();
+		if (visit(accepted, remaining, coverage, ub, is_ub_fixed, distinct_row_sets, thread_statistics) && !remaining.isEmpty()) {
+			branch_and_bound_node node;
+			node.row = remaining.minimum();
+			node.state = node_state::ACCEPT;
+			nodes.push_back(node);
+		}
+		lower_shared_ub(ub);
+		while (!nodes.empty()) {
+			branch_and_bound_node & node = nodes.back();
+			unsigned int row = node.row;
+			if (node.state == node_state::ACCEPT) {
+				remaining.remove(row);
+				accepted.add(row);
+				add_accepted_row(row, coverage);
+				node.state = node_state::REJECT;
+			}
+			else if (node.state == node_state::REJECT) {
+				accepted.remove(row);
+				remove_accepted_row(row, coverage);
+				remove_available_row(row, coverage);
+				node.state = node_state::DONE;
+			}
+			else {
+				//The row may still be accepted if its reject branch was handed off to another thread:
+				if (accepted.contains(row)) {
+					accepted.remove(row);
+					remove_accepted_row(row, coverage);
+				}
+				else {
+					add_available_row(row, coverage);
+				}
+				remaining.add(row);
+				nodes.pop_back();
 				continue;
 			}
+			//If another thread is waiting for work and this thread has none waiting, then hand off the untried reject branch nearest the root:
+			if (n_idle_threads > 0) {
+				lock_guard<mutex> lock(task_mutexes[thread_ind]);
+				if (tasks[thread_ind].empty()) {
+					for (branch_and_bound_node & handoff_node : nodes) {
+						if (handoff_node.state != node_state::REJECT) {
+							continue;
+						}
+						//The reject branch has the rows accepted before this node's row and the rows remaining after it:
+						Roaring earlier_rows = Roaring();
+						earlier_rows.addRange(0, handoff_node.row);
+						Roaring later_rows = Roaring();
+						later_rows.addRange(handoff_node.row + 1, rows.size());
+						branch_and_bound_task handoff;
+						handoff.accepted = accepted & earlier_rows;
+						handoff.remaining = task.remaining & later_rows;
+						n_unfinished_tasks++;
+						tasks[thread_ind].push_back(move(handoff));
+						handoff_node.state = node_state::DONE;
+						break;
+					}
+				}
+			}
+			//Pick up any improvement to the upper bound found by the other threads, then record the solution at this node and branch on it as before:
+			ub = min(ub, shared_ub.load());
+			if (visit(accepted, remaining, coverage, ub, is_ub_fixed, distinct_row_sets, thread_statistics) && !remaining.isEmpty()) {
+				branch_and_bound_node child;
+				child.row = remaining.minimum();
+				child.state = node_state::ACCEPT;
+				nodes.push_back(child);
+			}
+			lower_shared_ub(ub);
 		}
-		//Check if there is any feasible solution under the current node:
-		if (is_feasible(accepted | remaining)) {
-			//Lower-bound the cost of any solution under the current node:
-			float lb = bound(accepted);
-			//If this lower bound is within the upper bound, then branch on this node:
-			if (lb <= ub) {
-				branch(remaining, nodes);
+	};
+	//Each thread explores subtrees until every subtree has been explored:
+	auto work = [&](unsigned int thread_ind) {
+		bool idle = false;
+		branch_and_bound_task task;
+		while (n_unfinished_tasks > 0) {
+			if (take_task(thread_ind, task)) {
+				if (idle) {
+					n_idle_threads--;
+					idle = false;
+				}
+				search(thread_ind, task);
+				n_unfinished_tasks--;
+			}
+			else {
+				if (!idle) {
+					n_idle_threads++;
+					idle = true;
+				}
+				this_thread::yield();
+			}
+		}
+	};
+	vector<thread> workers = vector<thread>();
+	for (unsigned int i = 0; i < n_threads; i++) {
+		workers.push_back(thread(work, i));
+	}
+	for (thread & worker : workers) {
+		worker.join();
+	}
+	//Add up the statistics of the threads:
+	for (const branch_and_bound_statistics & thread_statistics : statistics_by_thread) {
+		statistics.nodes += thread_statistics.nodes;
+		statistics.infeasible += thread_statistics.infeasible;
+		for (const pair<const bound_type, bound_statistics> & kv : thread_statistics.bounds) {
+			statistics.bounds[kv.first].evaluations += kv.second.evaluations;
+			statistics.bounds[kv.first].prunes += kv.second.prunes;
+		}
+	}
+	//Merge the solutions found by the threads, keeping only those with the lowest cost if we're just looking for minimum-cost solutions:
+	float ub = shared_ub.load();
+	unordered_map<string, Roaring> distinct_row_sets = unordered_map<string, Roaring>();
+	for (const unordered_map<string, Roaring> & thread_distinct_row_sets : distinct_row_sets_by_thread) {
+		for (const pair<const string, Roaring> & kv : thread_distinct_row_sets) {
+			if (is_ub_fixed || bound(kv.second) == ub) {
+				distinct_row_sets[kv.first] = kv.second;
 			}
 		}
 	}
@@ -374,6 +1202,7 @@ void set_cover_solver::branch_and_bound(list<set_cover_solution> & solutions) {
  */
 void set_cover_solver::solve(list<set_cover_solution> & solutions) {
 	solutions = list<set_cover_solution>();
+	statistics = branch_and_bound_statistics();
 	//Create a map of row IDs to their indices:
 	unordered_map<string, unsigned int> row_ids_to_inds = unordered_map<string, unsigned int>();
 	unsigned int row_ind = 0;
@@ -386,19 +1215,12 @@ void set_cover_solver::solve(list<set_cover_solution> & solutions) {
 	if (!get_uncovered_columns().isEmpty()) {
 		return;
 	}
-	//If any rows uniquely cover one or more columns, then those rows must be set aside to be included in the solution:
-	Roaring unique_rows = get_unique_rows();
-	//Reduce the current problem to an easier subproblem by removing all columns covered by the unique coverage rows from the target set:
-	Roaring subproblem_target = Roaring(target);
+	//Reduce the current problem to an easier subproblem, setting aside the rows that must be included in every solution:
+	Roaring unique_rows = Roaring();
+	Roaring subproblem_row_inds = Roaring();
+	Roaring subproblem_target = Roaring();
 	float subproblem_ub = fixed_ub;
-	for (Roaring::const_iterator it = unique_rows.begin(); it != unique_rows.end(); it++) {
-		unsigned int row_ind = *it;
-		set_cover_row row = rows[row_ind];
-		subproblem_target ^= subproblem_target & row.explained;
-		subproblem_ub -= row.cost;
-	}
-	//If the total cost of the unique coverage rows exceeds the upper bound, then there is no solution:
-	if (subproblem_ub < 0) {
+	if (!reduce(unique_rows, subproblem_row_inds, subproblem_target, subproblem_ub)) {
 		return;
 	}
 	//If no columns need to be covered anymore, then the unique coverage rows constitute a feasible solution:
@@ -412,21 +1234,16 @@ void set_cover_solver::solve(list<set_cover_solution> & solutions) {
 	}
 	//Otherwise, solve the subproblem using branch-and-bound:
 	vector<set_cover_row> subproblem_rows = vector<set_cover_row>();
-	for (set_cover_row row : rows) {
-		//If the row has a cost that exceeds the upper bound of the subproblem, then exclude it:
-		if (row.cost > subproblem_ub) {
-			continue;
-		}
-		//If we're just looking for a minimum-cost solution,
-		//then exclude any rows that have no overlap with the remaining target set:
-		if (fixed_ub == numeric_limits<float>::infinity() && (row.explained & target).cardinality() == 0) {
-			continue;
-		}
-		subproblem_rows.push_back(row);
+	for (Roaring::const_iterator it = subproblem_row_inds.begin(); it != subproblem_row_inds.end(); it++) {
+		unsigned int row_ind = *it;
+		subproblem_rows.push_back(rows[row_ind]);
 	}
 	list<set_cover_solution> subproblem_solutions = list<set_cover_solution>();
 	set_cover_solver subproblem_solver = fixed_ub != numeric_limits<float>::infinity() ? set_cover_solver(subproblem_rows, subproblem_target, subproblem_ub) : set_cover_solver(subproblem_rows, subproblem_target);
+	subproblem_solver.set_n_threads(n_threads);
+	subproblem_solver.set_bounds(bounds);
 	subproblem_solver.branch_and_bound(subproblem_solutions);
+	statistics = subproblem_solver.get_statistics();
 	//Then add the unique coverage rows found earlier to the subproblem solutions:
 	set_cover_solution unique_rows_solution = get_solution_from_rows(unique_rows);
 	for (set_cover_solution subproblem_solution : subproblem_solutions) {
@@ -31,45 +31,70 @@ textual_flow::textual_flow() {
 
 }
 
+/**
+ * Returns the IDs of the witnesses in the given list, in order.
+ */
+list<string> get_witness_ids(const list<witness> & witnesses) {
+	list<string> list_wit = list<string>();
+	for (const witness & wit : witnesses) {
+		list_wit.push_back(wit.get_id());
+	}
+	return list_wit;
+}
+
 /**
  * Constructs a textual flow instance from a variation unit
  * and a list of witnesses whose potential ancestors have been set.
+ * The witnesses are expected to be listed in the order of the witness indices used in the variation unit's reading support.
  */
-textual_flow::textual_flow(const variation_unit & vu, const list<witness> & witnesses) {
-	//Copy the label, readings, and connectivity from the variation unit:
-	label = vu.get_label();
-	readings = vu.get_readings();
-	connectivity = vu.get_connectivity();
-	//Get the variation unit's local stemma:
-	local_stemma ls = vu.get_local_stemma();
-	//Initialize the textual flow graph as empty:
-	graph.vertices = list<textual_flow_vertex>();
-	graph.edges = list<textual_flow_edge>();
-	//Get a copy of the variation unit's reading support map:
-	unordered_map<string, string> reading_support = vu.get_reading_support();
-	//Create a map of witnesses keyed by ID:
-	unordered_map<string, witness> witnesses_by_id = unordered_map<string, witness>();
-	for (witness wit : witnesses) {
-		witnesses_by_id[wit.get_id()] = wit;
+textual_flow::textual_flow(const variation_unit & vu, const list<witness> & witnesses) : textual_flow(vu, get_witness_ids(witnesses), rank_all_potential_ancestors(witnesses)) {
+
+}
+
+/**
+ * Returns a map of each witness's ID to the reading it has at the given variation unit (or an empty string if it is lacunose).
+ * The witness IDs are expected to be listed in the order of the witness indices used in the variation unit's reading support.
+ */
+unordered_map<string, string> get_readings_by_witness(const variation_unit & vu, const list<string> & list_wit) {
+	const vector<string> & vu_readings = vu.get_readings();
+	const vector<uint16_t> & vu_reading_support = vu.get_reading_support();
+	unordered_map<string, string> reading_support = unordered_map<string, string>();
+	unsigned int wit_ind = 0;
+	for (const string & wit_id : list_wit) {
+		uint16_t rdg_ind = wit_ind < vu_reading_support.size() ? vu_reading_support[wit_ind] : LACUNA;
+		reading_support[wit_id] = rdg_ind != LACUNA ? vu_readings[rdg_ind] : "";
+		wit_ind++;
 	}
-	//Add vertices and edges for each witness in the input list:
-	for (witness wit : witnesses) {
-		//Get the witness's ID and a list of any readings it has at this variation unit:
-		string wit_id = wit.get_id();
-		string wit_rdg = reading_support.find(wit_id) != reading_support.end() ? reading_support.at(wit_id) : "";
-		//Add a vertex for this witness to the graph:
-		textual_flow_vertex v;
-		v.id = wit_id;
-		v.rdg = wit_rdg;
-		graph.vertices.push_back(v);
+	return reading_support;
+}
+
+/**
+ * Returns the textual flow edges at a variation unit, given a list of witness IDs
+ * and a map of the rankings of each witness's potential ancestors, keyed by witness ID and sorted in decreasing order of agreements.
+ * The witness IDs are expected to be listed in the order of the witness indices used in the variation unit's reading support,
+ * and the edges are returned in the same order of their descendants.
+ * Since the rankings hold the numbers of agreements and mutually extant passages that the textual flow needs,
+ * no genealogical comparisons are needed.
+ */
+list<textual_flow_edge> get_textual_flow_edges(const variation_unit & vu, const list<string> & list_wit, const unordered_map<string, list<potential_ancestor_ranking>> & potential_ancestors) {
+	list<textual_flow_edge> edges = list<textual_flow_edge>();
+	int connectivity = vu.get_connectivity();
+	//Get the variation unit's local stemma:
+	const local_stemma & ls = vu.get_local_stemma();
+	//Map each witness's ID to the reading it has at this variation unit:
+	unordered_map<string, string> reading_support = get_readings_by_witness(vu, list_wit);
+	//Add an edge for each witness in the input list:
+	for (const string & wit_id : list_wit) {
+		//Get any reading the witness has at this variation unit:
+		string wit_rdg = reading_support.at(wit_id);
 		//If this witness has no potential ancestors (i.e., if it has equal priority to the Ausgangstext),
-		//then there are no edges to add, and we can continue:
-		list<string> potential_ancestor_ids = wit.get_potential_ancestor_ids();
-		if (potential_ancestor_ids.empty()) {
+		//then there is no edge to add, and we can continue:
+		if (potential_ancestors.find(wit_id) == potential_ancestors.end() || potential_ancestors.at(wit_id).empty()) {
 			continue;
 		}
+		const list<potential_ancestor_ranking> & rankings = potential_ancestors.at(wit_id);
 		//Otherwise, proceed to identify this witness's textual flow ancestor for this variation unit:
-		string textual_flow_ancestor_id;
+		const potential_ancestor_ranking * textual_flow_ancestor = NULL;
 		int con = -1;
 		int con_value = -1; //connectivity rank only changes when this value changes
 		flow_type type = flow_type::NONE;
@@ -79,12 +104,10 @@ textual_flow::textual_flow(const variation_unit & vu, const list<witness> & witn
 			//then it is the textual flow ancestor:
 			con = -1;
 			con_value = -1;
-			for (string potential_ancestor_id : potential_ancestor_ids) {
+			for (const potential_ancestor_ranking & ranking : rankings) {
 				//Update the connectivity rank if the connectivity value changes:
-				genealogical_comparison comp = wit.get_genealogical_comparison_for_witness(potential_ancestor_id);
-				int agreements = comp.agreements.cardinality();
-				if (agreements != con_value) {
-					con_value = agreements;
+				if (ranking.agreements != con_value) {
+					con_value = ranking.agreements;
 					con++;
 				}
 				//If we reach the connectivity limit, then exit the loop early:
@@ -93,14 +116,14 @@ textual_flow::textual_flow(const variation_unit & vu, const list<witness> & witn
 				}
 				//If this potential ancestor agrees with the current witness here, then we're done:
 				bool agree = false;
-				if (reading_support.find(potential_ancestor_id) != reading_support.end()) {
-					string potential_ancestor_rdg = reading_support.at(potential_ancestor_id);
+				if (reading_support.find(ranking.id) != reading_support.end()) {
+					string potential_ancestor_rdg = reading_support.at(ranking.id);
 					if (ls.path_exists(potential_ancestor_rdg, wit_rdg) && ls.get_shortest_path_length(potential_ancestor_rdg, wit_rdg) == 0) {
 						agree = true;
 					}
 				}
 				if (agree) {
-					textual_flow_ancestor_id = potential_ancestor_id;
+					textual_flow_ancestor = & ranking;
 					type = flow_type::EQUAL;
 					break;
 				}
@@ -108,30 +131,56 @@ textual_flow::textual_flow(const variation_unit & vu, const list<witness> & witn
 		}
 		//If the witness is lacunose or it does not have a potential ancestor with its reading within the connectivity limit,
 		//then its first potential ancestor is its textual flow ancestor:
-		if (textual_flow_ancestor_id.empty()) {
+		if (textual_flow_ancestor == NULL) {
 			con = 0;
-			textual_flow_ancestor_id = potential_ancestor_ids.front();
-			string textual_flow_ancestor_rdg = reading_support.find(textual_flow_ancestor_id) != reading_support.end() ? reading_support.at(textual_flow_ancestor_id) : "";
+			textual_flow_ancestor = & rankings.front();
+			string textual_flow_ancestor_rdg = reading_support.find(textual_flow_ancestor->id) != reading_support.end() ? reading_support.at(textual_flow_ancestor->id) : "";
 			type = wit_rdg.empty() || textual_flow_ancestor_rdg.empty() ? flow_type::LOSS : flow_type::CHANGE;
 		}
 		//Calculate the stability of the textual flow:
-		witness textual_flow_ancestor = witnesses_by_id.at(textual_flow_ancestor_id);
-		genealogical_comparison comp = wit.get_genealogical_comparison_for_witness(textual_flow_ancestor_id);
-		genealogical_comparison reverse_comp = textual_flow_ancestor.get_genealogical_comparison_for_witness(wit_id);
-		Roaring extant = wit.get_genealogical_comparison_for_witness(wit_id).explained & textual_flow_ancestor.get_genealogical_comparison_for_witness(textual_flow_ancestor_id).explained;
-		Roaring agreements = comp.agreements;
-		Roaring prior = comp.explained ^ agreements;
-		Roaring posterior = reverse_comp.explained ^ agreements;
-		float strength = float(prior.cardinality() - posterior.cardinality()) / float(extant.cardinality());
-		//Add an edge to the graph connecting the textual flow ancestor to this witness:
+		float strength = float(textual_flow_ancestor->posterior - textual_flow_ancestor->prior) / float(textual_flow_ancestor->pass);
+		//Add an edge connecting the textual flow ancestor to this witness:
 		textual_flow_edge e;
 		e.descendant = wit_id;
-		e.ancestor = textual_flow_ancestor_id;
+		e.ancestor = textual_flow_ancestor->id;
 		e.type = type;
 		e.connectivity = con;
 		e.strength = strength;
-		graph.edges.push_back(e);
+		edges.push_back(e);
+	}
+	return edges;
+}
+
+/**
+ * Constructs a textual flow instance from a variation unit, a list of witness IDs,
+ * and a map of the rankings of each witness's potential ancestors, keyed by witness ID and sorted in decreasing order of agreements.
+ * The witness IDs are expected to be listed in the order of the witness indices used in the variation unit's reading support.
+ */
+textual_flow::textual_flow(const variation_unit & vu, const list<string> & list_wit, const unordered_map<string, list<potential_ancestor_ranking>> & potential_ancestors) : textual_flow(vu, list_wit, get_textual_flow_edges(vu, list_wit, potential_ancestors)) {
+
+}
+
+/**
+ * Constructs a textual flow instance from a variation unit, a list of witness IDs,
+ * and the textual flow edges at that variation unit (e.g., as read from the TEXTUAL_FLOW_EDGES table of the genealogical cache).
+ * The witness IDs are expected to be listed in the order of the witness indices used in the variation unit's reading support.
+ */
+textual_flow::textual_flow(const variation_unit & vu, const list<string> & list_wit, const list<textual_flow_edge> & edges) {
+	//Copy the label, readings, and connectivity from the variation unit:
+	label = vu.get_label();
+	readings = list<string>(vu.get_readings().begin(), vu.get_readings().end());
+	connectivity = vu.get_connectivity();
+	//Add a vertex for each witness in the input list, with any reading it has at this variation unit:
+	graph.vertices = list<textual_flow_vertex>();
+	unordered_map<string, string> reading_support = get_readings_by_witness(vu, list_wit);
+	for (const string & wit_id : list_wit) {
+		textual_flow_vertex v;
+		v.id = wit_id;
+		v.rdg = reading_support.at(wit_id);
+		graph.vertices.push_back(v);
 	}
+	//Then copy the edges:
+	graph.edges = edges;
 }
 
 /**
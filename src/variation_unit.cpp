@@ -9,6 +9,7 @@
 #include <cstring>
 #include <string>
 #include <list>
+#include <vector>
 #include <set>
 #include <map> //for small maps keyed by readings
 #include <unordered_map> //for large maps keyed by witnesses
@@ -32,18 +33,20 @@ variation_unit::variation_unit() {
 
 /**
  * Constructs a variation unit from an <app/> XML element.
+ * A map from witness IDs to their indices is expected for populating the reading support;
+ * witnesses that are not in this map are ignored.
  * Boolean flags indicating whether or not to drop ambiguous readings and whether or not to merge split readings
  * and a set of strings indicating reading types that should be treated as trivial are also expected.
  */
-variation_unit::variation_unit(const pugi::xml_node & xml, bool drop_ambiguous, bool merge_splits, const set<string> & trivial_reading_types) {
+variation_unit::variation_unit(const pugi::xml_node & xml, const unordered_map<string, unsigned int> & wit_inds, bool drop_ambiguous, bool merge_splits, const set<string> & trivial_reading_types) {
 	//Populate the ID, if one is specified:
 	id = xml.attribute("xml:id") ? xml.attribute("xml:id").value() : (xml.attribute("id") ? xml.attribute("id").value() : (xml.attribute("n") ? xml.attribute("n").value() : ""));
 	//Populate the label, if one is specified (if not, use the ID):
 	label = (xml.child("label") && xml.child("label").text()) ? xml.child("label").text().get() : id;
-	//Populate the list of reading IDs and the witness-to-readings map,
+	//Populate the list of reading IDs and the witness-to-reading vector (with every witness lacunose until we find its reading),
 	//keeping track of reading types and splits to merge as necessary:
-	readings = list<string>();
-	reading_support = unordered_map<string, string>();
+	readings = vector<string>();
+	reading_support = vector<uint16_t>(wit_inds.size(), LACUNA);
 	map<string, set<string>> reading_types_by_reading = map<string, set<string>>(); //to identify trivial reading pairs
 	map<string, string> reading_to_text = map<string, string>(); //to identify split reading pairs
 	map<string, string> text_to_reading = map<string, string>(); //to identify split reading pairs
@@ -72,7 +75,8 @@ variation_unit::variation_unit(const pugi::xml_node & xml, bool drop_ambiguous,
 		}
 		//Otherwise, add it to the map of reading types by reading:
 		reading_types_by_reading[rdg_id] = rdg_types;
-		//Add the reading ID to the list:
+		//Add the reading ID to the list, noting its index:
+		uint16_t rdg_ind = readings.size();
 		readings.push_back(rdg_id);
 		//Split the witness support attribute into a list of witness strings:
 		list<string> wits = list<string>();
@@ -87,10 +91,11 @@ variation_unit::variation_unit(const pugi::xml_node & xml, bool drop_ambiguous,
 			wits.push_back(wit);
 			wit_token = strtok(NULL, delim); //iterate to the next token
 		}
-		//Add these witnesses to the reading support map:
+		//Record this reading for each of these witnesses that we are tracking:
 		for (string wit : wits) {
-			//Add an empty list for each reading we haven't encountered yet:
-			reading_support[wit] = rdg_id;
+			if (wit_inds.find(wit) != wit_inds.end()) {
+				reading_support[wit_inds.at(wit)] = rdg_ind;
+			}
 		}
 		//Map this reading's ID to its text, for later reference:
 		reading_to_text[rdg_id] = rdg_text;
@@ -149,19 +154,23 @@ variation_unit::variation_unit(const pugi::xml_node & xml, bool drop_ambiguous,
 	}
 	//The <graph/> element should contain the local stemma for this variation unit:
 	pugi::xml_node stemma_node = xml.child("graph");
-	stemma = local_stemma(stemma_node, id, label, split_pairs, trivial_readings, dropped_readings);
+	stemma = local_stemma(stemma_node, id, label, readings, split_pairs, trivial_readings, dropped_readings);
+	//Then index the witnesses by their relationships to each reading:
+	populate_witness_bitmaps();
 }
 
 /**
  * Constructs a variation unit using values populated from the genealogical cache.
+ * The readings are expected to be listed in the order of their indices in the local stemma.
  */
-variation_unit::variation_unit(const string & _id, const string & _label, const list<string> & _readings, const unordered_map<string, string> & _reading_support, int _connectivity, const local_stemma _stemma) {
+variation_unit::variation_unit(const string & _id, const string & _label, const vector<string> & _readings, const vector<uint16_t> & _reading_support, int _connectivity, const local_stemma _stemma) {
 	id = _id;
 	label = _label;
 	readings = _readings;
 	reading_support = _reading_support;
 	connectivity = _connectivity;
 	stemma = _stemma;
+	populate_witness_bitmaps();
 }
 
 /**
@@ -171,6 +180,40 @@ variation_unit::~variation_unit() {
 
 }
 
+/**
+ * Populates the bitmaps of witnesses that attest, agree with, or are prior to each reading,
+ * first by gathering the witnesses that attest each reading
+ * and then by combining these bitmaps along the paths of the local stemma.
+ */
+void variation_unit::populate_witness_bitmaps() {
+	unsigned int n_readings = readings.size();
+	//Gather the witnesses that attest each reading:
+	attesting_witnesses = vector<Roaring>(n_readings);
+	for (unsigned int wit_ind = 0; wit_ind < reading_support.size(); wit_ind++) {
+		uint16_t rdg_ind = reading_support[wit_ind];
+		if (rdg_ind != LACUNA) {
+			attesting_witnesses[rdg_ind].add(wit_ind);
+		}
+	}
+	//Then combine the bitmaps of all readings that have a path to each reading:
+	agreeing_witnesses = vector<Roaring>(n_readings);
+	prior_witnesses = vector<Roaring>(n_readings);
+	for (unsigned int r = 0; r < n_readings; r++) {
+		for (unsigned int q = 0; q < n_readings; q++) {
+			if (!stemma.path_exists(q, r)) {
+				continue;
+			}
+			if (stemma.get_shortest_path_length(q, r) == 0) {
+				agreeing_witnesses[r] |= attesting_witnesses[q];
+			}
+			else {
+				prior_witnesses[r] |= attesting_witnesses[q];
+			}
+		}
+	}
+	return;
+}
+
 /**
  * Returns the ID of this variation_unit.
  */
@@ -186,16 +229,17 @@ string variation_unit::get_label() const {
 }
 
 /**
- * Returns this variation unit's list of reading IDs.
+ * Returns this variation unit's vector of reading IDs.
  */
-list<string> variation_unit::get_readings() const {
+const vector<string> & variation_unit::get_readings() const {
 	return readings;
 }
 
 /**
- * Returns the reading support set of this variation_unit.
+ * Returns the reading support vector of this variation_unit.
+ * The entry for each witness index is the index of that witness's reading, or LACUNA if it is lacunose.
  */
-unordered_map<string, string> variation_unit::get_reading_support() const {
+const vector<uint16_t> & variation_unit::get_reading_support() const {
 	return reading_support;
 }
 
@@ -209,6 +253,29 @@ int variation_unit::get_connectivity() const {
 /**
  * Returns the local stemma of this variation_unit.
  */
-local_stemma variation_unit::get_local_stemma() const {
+const local_stemma & variation_unit::get_local_stemma() const {
 	return stemma;
 }
+
+/**
+ * Returns the bitmaps of witness indices that attest each reading of this variation_unit.
+ */
+const vector<Roaring> & variation_unit::get_attesting_witnesses() const {
+	return attesting_witnesses;
+}
+
+/**
+ * Returns the bitmaps of witness indices whose readings agree with each reading of this variation_unit
+ * (i.e., whose readings have paths of length 0 to it in the local stemma).
+ */
+const vector<Roaring> & variation_unit::get_agreeing_witnesses() const {
+	return agreeing_witnesses;
+}
+
+/**
+ * Returns the bitmaps of witness indices whose readings are prior to each reading of this variation_unit
+ * (i.e., whose readings have paths of positive length to it in the local stemma).
+ */
+const vector<Roaring> & variation_unit::get_prior_witnesses() const {
+	return prior_witnesses;
+}
@@ -12,114 +12,453 @@
 #include <unordered_map>
 #include <algorithm>
 #include <limits>
+#include <utility>
+#include <memory>
 
 #include "roaring.hh"
 #include "witness.h"
 #include "set_cover_solver.h"
 #include "apparatus.h"
 #include "variation_unit.h"
+#include "reading_matrix.h"
 #include "local_stemma.h"
 
 using namespace std;
 
 /**
- * Default constructor.
- */
-witness::witness() {
-
-}
-
-/**
- * Constructs a witness using its ID and a textual apparatus.
+ * Calculates the genealogical comparisons of the witness with the given index in the given apparatus
+ * relative to the witnesses with the given indices (where -1 denotes a witness not in the apparatus),
+ * by comparing the readings of each pair of witnesses at each variation unit.
+ * The comparisons are written to the vector of the same size as the other witness indices.
  */
-witness::witness(const string & _id, const apparatus & app) {
-	//Set its ID:
-	id = _id;
-	//Now populate the its map of genealogical_comparisons, keyed by witness ID:
-	genealogical_comparisons = unordered_map<string, genealogical_comparison>();
-	list<string> list_wit = app.get_list_wit();
-	for (string other_id : list_wit) {
-		//Initialize a genealogical_comparison data structure for this witness:
-		genealogical_comparison comp;
-		comp.agreements = Roaring(); //readings in the other witness equal to this witness's readings
-		comp.explained = Roaring(); //readings in the other witness equal or prior to this witness's readings
-		comp.cost = 0; //genealogical cost of the other witness relative to this witness
+void compare_witnesses_scalar(const apparatus & app, int wit_ind, const vector<int> & other_wit_inds, vector<genealogical_comparison> & comps) {
+	const vector<variation_unit> & variation_units = app.get_variation_units();
+	for (unsigned int i = 0; i < other_wit_inds.size(); i++) {
+		int other_ind = other_wit_inds[i];
+		genealogical_comparison & comp = comps[i];
+		//A witness that is not in the apparatus is lacunose everywhere:
+		if (wit_ind < 0 || other_ind < 0) {
+			continue;
+		}
+		Roaring agreements = Roaring();
+		Roaring explained = Roaring();
 		int vu_ind = 0;
-		for (variation_unit vu : app.get_variation_units()) {
-			//Try to get the reading of each witness at this variation unit:
-			unordered_map<string, string> reading_support = vu.get_reading_support();
+		for (const variation_unit & vu : variation_units) {
+			//Get the index of the reading of each witness at this variation unit:
+			const vector<uint16_t> & reading_support = vu.get_reading_support();
+			uint16_t rdg_ind_for_this = reading_support[wit_ind];
+			uint16_t rdg_ind_for_other = reading_support[other_ind];
 			//If either witness is lacunose, then there is no relationship
 			//(including equality, as two lacunae should not be treated as equal):
-			if (reading_support.find(id) == reading_support.end() || reading_support.find(other_id) == reading_support.end()) {
+			if (rdg_ind_for_this == LACUNA || rdg_ind_for_other == LACUNA) {
 				vu_ind++;
 				continue;
 			}
-			//Otherwise, check for a path from the other witness's reading to this one in the local stemma:
-			string reading_for_this = reading_support.at(id);
-			string reading_for_other = reading_support.at(other_id);
-			local_stemma ls = vu.get_local_stemma();
-			float path_length = numeric_limits<float>::infinity();
-			if (ls.path_exists(reading_for_other, reading_for_this)) {
-				path_length = ls.get_shortest_path_length(reading_for_other, reading_for_this);
-			}
+			//Otherwise, look up the length of the path from the other witness's reading to this one in the local stemma
+			//(the readings of a variation unit have the same indices in its local stemma):
+			float path_length = vu.get_local_stemma().get_shortest_path_length(rdg_ind_for_other, rdg_ind_for_this);
 			if (path_length < numeric_limits<float>::infinity()) {
-				comp.explained.add(vu_ind);
+				explained.add(vu_ind);
 				if (path_length == 0) {
-					comp.agreements.add(vu_ind);
+					agreements.add(vu_ind);
 				}
 				comp.cost += path_length;
 			}
 			vu_ind++;
 		}
-		//Add the completed genealogical_comparison to this witness's map:
-		genealogical_comparisons[other_id] = comp;
+		comp.agreements = make_shared<const Roaring>(move(agreements));
+		comp.explained = make_shared<const Roaring>(move(explained));
 	}
+	return;
 }
 
 /**
- * Alternative constructor for a witness relative to a list of other witnesses.
- * This constructor only populates the witness's agreements and explained readings bitmaps relative to itself and the specified witnesses.
+ * Calculates the genealogical comparisons of the witness with the given index in the given apparatus
+ * relative to the witnesses with the given indices (where -1 denotes a witness not in the apparatus),
+ * by walking through the variation units once and looking up the precomputed bitmaps of witnesses
+ * that agree with or are prior to this witness's reading at each one.
+ * The comparisons are written to the vector of the same size as the other witness indices.
  */
-witness::witness(const string & _id, const list<string> & list_wit, const apparatus & app) {
-	//Set its ID:
-	id = _id;
-	//Now populate the its map of genealogical_comparisons, keyed by witness ID:
-	genealogical_comparisons = unordered_map<string, genealogical_comparison>();
-	for (string other_id : list_wit) {
-		//Initialize a genealogical_comparison data structure for this witness:
-		genealogical_comparison comp;
-		comp.agreements = Roaring(); //readings in the other witness equal to this witness's readings
-		comp.explained = Roaring(); //readings in the other witness equal or prior to this witness's readings
-		comp.cost = 0; //genealogical cost of the other witness relative to this witness
-		int vu_ind = 0;
-		for (variation_unit vu : app.get_variation_units()) {
-			//Try to get the reading of each witness at this variation unit:
-			unordered_map<string, string> reading_support = vu.get_reading_support();
-			//If either witness is lacunose, then there is no relationship
-			//(including equality, as two lacunae should not be treated as equal):
-			if (reading_support.find(id) == reading_support.end() || reading_support.find(other_id) == reading_support.end()) {
-				vu_ind++;
-				continue;
+void compare_witnesses_unit_major(const apparatus & app, int wit_ind, const vector<int> & other_wit_inds, vector<genealogical_comparison> & comps) {
+	if (wit_ind < 0) {
+		return;
+	}
+	//Map the apparatus index of each other witness to its position in the output vector:
+	unsigned int n_wits = app.get_list_wit().size();
+	vector<int> positions = vector<int>(n_wits, -1);
+	for (unsigned int i = 0; i < other_wit_inds.size(); i++) {
+		if (other_wit_inds[i] >= 0) {
+			positions[other_wit_inds[i]] = i;
+		}
+	}
+	//Collect the indices of the variation units to be added to each bitmap in increasing order, so that each bitmap can be built at once:
+	vector<vector<uint32_t>> agreements = vector<vector<uint32_t>>(other_wit_inds.size());
+	vector<vector<uint32_t>> explained = vector<vector<uint32_t>>(other_wit_inds.size());
+	const vector<variation_unit> & variation_units = app.get_variation_units();
+	for (uint32_t vu_ind = 0; vu_ind < variation_units.size(); vu_ind++) {
+		const variation_unit & vu = variation_units[vu_ind];
+		const vector<uint16_t> & reading_support = vu.get_reading_support();
+		uint16_t rdg_ind = reading_support[wit_ind];
+		//If this witness is lacunose, then no other witness explains it here:
+		if (rdg_ind == LACUNA) {
+			continue;
+		}
+		//Witnesses with equal readings agree with and explain this witness at no cost:
+		for (uint32_t other_ind : vu.get_agreeing_witnesses()[rdg_ind]) {
+			int i = positions[other_ind];
+			if (i >= 0) {
+				agreements[i].push_back(vu_ind);
+				explained[i].push_back(vu_ind);
+			}
+		}
+		//Witnesses with prior readings explain this witness at the cost of the path from their reading to this one:
+		const local_stemma & ls = vu.get_local_stemma();
+		for (uint32_t other_ind : vu.get_prior_witnesses()[rdg_ind]) {
+			int i = positions[other_ind];
+			if (i >= 0) {
+				explained[i].push_back(vu_ind);
+				comps[i].cost += ls.get_shortest_path_length(reading_support[other_ind], rdg_ind);
 			}
-			//Otherwise, check for a path from the other witness's reading to this one in the local stemma:
-			string reading_for_this = reading_support.at(id);
-			string reading_for_other = reading_support.at(other_id);
-			local_stemma ls = vu.get_local_stemma();
-			float path_length = numeric_limits<float>::infinity();
-			if (ls.path_exists(reading_for_other, reading_for_this)) {
-				path_length = ls.get_shortest_path_length(reading_for_other, reading_for_this);
+		}
+	}
+	//Then build the bitmaps:
+	for (unsigned int i = 0; i < other_wit_inds.size(); i++) {
+		comps[i].agreements = make_shared<const Roaring>(agreements[i].size(), agreements[i].data());
+		comps[i].explained = make_shared<const Roaring>(explained[i].size(), explained[i].data());
+	}
+	return;
+}
+
+/**
+ * Calculates the genealogical comparisons of the witness with the given index in the given apparatus
+ * relative to the witnesses with the given indices (where -1 denotes a witness not in the apparatus),
+ * by comparing rows of the apparatus's reading matrix with the best instruction set available.
+ * The comparisons are written to the vector of the same size as the other witness indices.
+ */
+void compare_witnesses_simd(const apparatus & app, int wit_ind, const vector<int> & other_wit_inds, vector<genealogical_comparison> & comps) {
+	if (wit_ind < 0) {
+		return;
+	}
+	const reading_matrix & matrix = app.get_reading_matrix();
+	vector<uint64_t> agreement_words = vector<uint64_t>();
+	vector<uint64_t> explained_words = vector<uint64_t>();
+	vector<uint32_t> vu_inds = vector<uint32_t>();
+	for (unsigned int i = 0; i < other_wit_inds.size(); i++) {
+		int other_ind = other_wit_inds[i];
+		if (other_ind < 0) {
+			continue;
+		}
+		comps[i].cost = matrix.compare(wit_ind, other_ind, agreement_words, explained_words);
+		//Convert the masks of variation units to bitmaps:
+		vu_inds.clear();
+		reading_matrix::get_set_bits(agreement_words, vu_inds);
+		comps[i].agreements = make_shared<const Roaring>(vu_inds.size(), vu_inds.data());
+		vu_inds.clear();
+		reading_matrix::get_set_bits(explained_words, vu_inds);
+		comps[i].explained = make_shared<const Roaring>(vu_inds.size(), vu_inds.data());
+	}
+	return;
+}
+
+/**
+ * Calculates the genealogical comparisons of the witness with the given index in the given apparatus
+ * relative to the witnesses with the given indices and of those witnesses relative to it,
+ * by looking up the path lengths in both directions between the readings of each pair of witnesses at each variation unit.
+ * The comparisons are written to the two vectors of the same size as the other witness indices.
+ */
+void compare_witnesses_both_ways_scalar(const apparatus & app, int wit_ind, const vector<int> & other_wit_inds, vector<genealogical_comparison> & comps, vector<genealogical_comparison> & reverse_comps) {
+	const vector<variation_unit> & variation_units = app.get_variation_units();
+	for (unsigned int i = 0; i < other_wit_inds.size(); i++) {
+		int other_ind = other_wit_inds[i];
+		//A witness that is not in the apparatus is lacunose everywhere:
+		if (wit_ind < 0 || other_ind < 0) {
+			continue;
+		}
+		Roaring agreements = Roaring();
+		Roaring explained = Roaring();
+		Roaring reverse_agreements = Roaring();
+		Roaring reverse_explained = Roaring();
+		for (uint32_t vu_ind = 0; vu_ind < variation_units.size(); vu_ind++) {
+			const variation_unit & vu = variation_units[vu_ind];
+			const vector<uint16_t> & reading_support = vu.get_reading_support();
+			uint16_t rdg_ind_for_this = reading_support[wit_ind];
+			uint16_t rdg_ind_for_other = reading_support[other_ind];
+			if (rdg_ind_for_this == LACUNA || rdg_ind_for_other == LACUNA) {
+				continue;
 			}
+			//Look up the lengths of the paths between the two readings in both directions:
+			const local_stemma & ls = vu.get_local_stemma();
+			float path_length = ls.get_shortest_path_length(rdg_ind_for_other, rdg_ind_for_this);
 			if (path_length < numeric_limits<float>::infinity()) {
-				comp.explained.add(vu_ind);
+				explained.add(vu_ind);
 				if (path_length == 0) {
-					comp.agreements.add(vu_ind);
+					agreements.add(vu_ind);
 				}
-				comp.cost += path_length;
+				comps[i].cost += path_length;
+			}
+			float reverse_path_length = ls.get_shortest_path_length(rdg_ind_for_this, rdg_ind_for_other);
+			if (reverse_path_length < numeric_limits<float>::infinity()) {
+				reverse_explained.add(vu_ind);
+				if (reverse_path_length == 0) {
+					reverse_agreements.add(vu_ind);
+				}
+				reverse_comps[i].cost += reverse_path_length;
 			}
-			vu_ind++;
 		}
-		//Add the completed genealogical_comparison to this witness's map:
-		genealogical_comparisons[other_id] = comp;
+		comps[i].agreements = make_shared<const Roaring>(move(agreements));
+		comps[i].explained = make_shared<const Roaring>(move(explained));
+		reverse_comps[i].agreements = make_shared<const Roaring>(move(reverse_agreements));
+		reverse_comps[i].explained = make_shared<const Roaring>(move(reverse_explained));
+	}
+	return;
+}
+
+/**
+ * Calculates the genealogical comparisons of the witness with the given index in the given apparatus
+ * relative to the witnesses with the given indices and of those witnesses relative to it,
+ * by walking through the variation units once and visiting the witnesses that attest each reading connected to this witness's reading.
+ * The comparisons are written to the two vectors of the same size as the other witness indices.
+ */
+void compare_witnesses_both_ways_unit_major(const apparatus & app, int wit_ind, const vector<int> & other_wit_inds, vector<genealogical_comparison> & comps, vector<genealogical_comparison> & reverse_comps) {
+	if (wit_ind < 0) {
+		return;
+	}
+	//Map the apparatus index of each other witness to its position in the output vectors:
+	unsigned int n_wits = app.get_list_wit().size();
+	vector<int> positions = vector<int>(n_wits, -1);
+	for (unsigned int i = 0; i < other_wit_inds.size(); i++) {
+		if (other_wit_inds[i] >= 0) {
+			positions[other_wit_inds[i]] = i;
+		}
+	}
+	//Collect the indices of the variation units to be added to each bitmap in increasing order, so that each bitmap can be built at once:
+	vector<vector<uint32_t>> agreements = vector<vector<uint32_t>>(other_wit_inds.size());
+	vector<vector<uint32_t>> explained = vector<vector<uint32_t>>(other_wit_inds.size());
+	vector<vector<uint32_t>> reverse_agreements = vector<vector<uint32_t>>(other_wit_inds.size());
+	vector<vector<uint32_t>> reverse_explained = vector<vector<uint32_t>>(other_wit_inds.size());
+	const vector<variation_unit> & variation_units = app.get_variation_units();
+	for (uint32_t vu_ind = 0; vu_ind < variation_units.size(); vu_ind++) {
+		const variation_unit & vu = variation_units[vu_ind];
+		uint16_t rdg_ind = vu.get_reading_support()[wit_ind];
+		if (rdg_ind == LACUNA) {
+			continue;
+		}
+		//Visit the witnesses attesting each reading with a path to or from this witness's reading:
+		const local_stemma & ls = vu.get_local_stemma();
+		const vector<Roaring> & attesting_witnesses = vu.get_attesting_witnesses();
+		for (uint16_t other_rdg_ind = 0; other_rdg_ind < attesting_witnesses.size(); other_rdg_ind++) {
+			float path_length = ls.get_shortest_path_length(other_rdg_ind, rdg_ind);
+			float reverse_path_length = ls.get_shortest_path_length(rdg_ind, other_rdg_ind);
+			if (path_length == numeric_limits<float>::infinity() && reverse_path_length == numeric_limits<float>::infinity()) {
+				continue;
+			}
+			for (uint32_t other_ind : attesting_witnesses[other_rdg_ind]) {
+				int i = positions[other_ind];
+				if (i < 0) {
+					continue;
+				}
+				if (path_length < numeric_limits<float>::infinity()) {
+					explained[i].push_back(vu_ind);
+					if (path_length == 0) {
+						agreements[i].push_back(vu_ind);
+					}
+					comps[i].cost += path_length;
+				}
+				if (reverse_path_length < numeric_limits<float>::infinity()) {
+					reverse_explained[i].push_back(vu_ind);
+					if (reverse_path_length == 0) {
+						reverse_agreements[i].push_back(vu_ind);
+					}
+					reverse_comps[i].cost += reverse_path_length;
+				}
+			}
+		}
+	}
+	//Then build the bitmaps:
+	for (unsigned int i = 0; i < other_wit_inds.size(); i++) {
+		comps[i].agreements = make_shared<const Roaring>(agreements[i].size(), agreements[i].data());
+		comps[i].explained = make_shared<const Roaring>(explained[i].size(), explained[i].data());
+		reverse_comps[i].agreements = make_shared<const Roaring>(reverse_agreements[i].size(), reverse_agreements[i].data());
+		reverse_comps[i].explained = make_shared<const Roaring>(reverse_explained[i].size(), reverse_explained[i].data());
+	}
+	return;
+}
+
+/**
+ * Calculates the genealogical comparisons of the witness with the given index in the given apparatus
+ * relative to the witnesses with the given indices and of those witnesses relative to it,
+ * by comparing rows of the apparatus's reading matrix in both directions at once.
+ * The comparisons are written to the two vectors of the same size as the other witness indices.
+ */
+void compare_witnesses_both_ways_simd(const apparatus & app, int wit_ind, const vector<int> & other_wit_inds, vector<genealogical_comparison> & comps, vector<genealogical_comparison> & reverse_comps) {
+	if (wit_ind < 0) {
+		return;
+	}
+	const reading_matrix & matrix = app.get_reading_matrix();
+	row_comparison row_comp;
+	row_comparison reverse_row_comp;
+	vector<uint32_t> vu_inds = vector<uint32_t>();
+	for (unsigned int i = 0; i < other_wit_inds.size(); i++) {
+		int other_ind = other_wit_inds[i];
+		if (other_ind < 0) {
+			continue;
+		}
+		matrix.compare_both_ways(wit_ind, other_ind, row_comp, reverse_row_comp);
+		//Convert the masks of variation units to bitmaps:
+		comps[i].cost = row_comp.cost;
+		vu_inds.clear();
+		reading_matrix::get_set_bits(row_comp.agreements, vu_inds);
+		comps[i].agreements = make_shared<const Roaring>(vu_inds.size(), vu_inds.data());
+		vu_inds.clear();
+		reading_matrix::get_set_bits(row_comp.explained, vu_inds);
+		comps[i].explained = make_shared<const Roaring>(vu_inds.size(), vu_inds.data());
+		reverse_comps[i].cost = reverse_row_comp.cost;
+		vu_inds.clear();
+		reading_matrix::get_set_bits(reverse_row_comp.agreements, vu_inds);
+		reverse_comps[i].agreements = make_shared<const Roaring>(vu_inds.size(), vu_inds.data());
+		vu_inds.clear();
+		reading_matrix::get_set_bits(reverse_row_comp.explained, vu_inds);
+		reverse_comps[i].explained = make_shared<const Roaring>(vu_inds.size(), vu_inds.data());
+	}
+	return;
+}
+
+/**
+ * Calculates the genealogical comparisons of the witness with the given ID in the given apparatus relative to the witnesses in the given list,
+ * along with the comparisons of each of those witnesses relative to it, in a single pass with the specified kernel.
+ * The output vectors are resized to the length of the list, and the i-th comparison in the reverse vector
+ * is the comparison that the i-th witness in the list would have for the given witness.
+ * Where the agreements in both directions are equal, the two comparisons share the same agreements bitmap.
+ */
+void compare_witnesses_both_ways(const string & wit_id, const list<string> & list_wit, const apparatus & app, comparison_kernel kernel, vector<genealogical_comparison> & comps, vector<genealogical_comparison> & reverse_comps) {
+	//Get the apparatus indices of this witness and the other witnesses:
+	int wit_ind = app.get_witness_index(wit_id);
+	vector<int> other_wit_inds = vector<int>();
+	for (string other_id : list_wit) {
+		other_wit_inds.push_back(app.get_witness_index(other_id));
+	}
+	//Initialize the genealogical_comparison data structures in both directions:
+	genealogical_comparison empty_comp;
+	empty_comp.agreements = make_shared<const Roaring>();
+	empty_comp.explained = make_shared<const Roaring>();
+	empty_comp.cost = 0;
+	comps.assign(other_wit_inds.size(), empty_comp);
+	reverse_comps.assign(other_wit_inds.size(), empty_comp);
+	//Then calculate them using the specified kernel:
+	switch (kernel) {
+		case comparison_kernel::UNIT_MAJOR:
+			compare_witnesses_both_ways_unit_major(app, wit_ind, other_wit_inds, comps, reverse_comps);
+			break;
+		case comparison_kernel::SIMD:
+			compare_witnesses_both_ways_simd(app, wit_ind, other_wit_inds, comps, reverse_comps);
+			break;
+		default:
+			compare_witnesses_both_ways_scalar(app, wit_ind, other_wit_inds, comps, reverse_comps);
+			break;
+	}
+	//Wherever the two witnesses agree in the same places in both directions, share one agreements bitmap between the two comparisons:
+	for (unsigned int i = 0; i < comps.size(); i++) {
+		if (*comps[i].agreements == *reverse_comps[i].agreements) {
+			reverse_comps[i].agreements = comps[i].agreements;
+		}
+	}
+	return;
+}
+
+/**
+ * Sorts the given rankings of other witnesses relative to a witness as potential ancestors of that witness and assigns their ranks.
+ * The rankings are sorted stably by decreasing number of agreements, so witnesses with the same number of agreements keep their order.
+ * A witness is a potential ancestor if the other witness has more posterior readings than prior ones relative to it;
+ * potential ancestors are ranked from 1, and the rank only increases when the number of agreements decreases.
+ * Witnesses with as many prior readings as posterior ones are given rank 0, and the rest are given rank -1.
+ */
+void rank_potential_ancestors(list<potential_ancestor_ranking> & rankings) {
+	//Sort the rankings by number of agreements:
+	rankings.sort([](const potential_ancestor_ranking & r1, const potential_ancestor_ranking & r2) {
+		return r1.agreements > r2.agreements;
+	});
+	//Then pass through the sorted list to assign ranks:
+	int rank = 0;
+	int rank_value = numeric_limits<int>::max();
+	for (potential_ancestor_ranking & ranking : rankings) {
+		if (ranking.posterior > ranking.prior) {
+			//Only increment the rank if the number of agreements is lower than that of the previous potential ancestor:
+			if (ranking.agreements < rank_value) {
+				rank_value = ranking.agreements;
+				rank++;
+			}
+			ranking.rank = rank;
+		}
+		else if (ranking.posterior == ranking.prior) {
+			ranking.rank = 0;
+		}
+		else {
+			ranking.rank = -1;
+		}
+	}
+	return;
+}
+
+/**
+ * Default constructor.
+ */
+witness::witness() {
+
+}
+
+/**
+ * Constructs a witness using its ID and a textual apparatus.
+ */
+witness::witness(const string & _id, const apparatus & app) : witness(_id, app.get_list_wit(), app) {
+
+}
+
+/**
+ * Alternative constructor for a witness relative to a list of other witnesses.
+ * This constructor only populates the witness's agreements and explained readings bitmaps relative to itself and the specified witnesses.
+ */
+witness::witness(const string & _id, const list<string> & list_wit, const apparatus & app) : witness(_id, list_wit, app, comparison_kernel::SIMD) {
+
+}
+
+/**
+ * Alternative constructor for a witness relative to a list of other witnesses, using the specified kernel to calculate the genealogical comparisons.
+ * All kernels produce the same comparisons.
+ */
+witness::witness(const string & _id, const list<string> & list_wit, const apparatus & app, comparison_kernel kernel) {
+	//Set its ID:
+	id = _id;
+	//Get the apparatus indices of this witness and the other witnesses:
+	int wit_ind = app.get_witness_index(id);
+	vector<int> other_wit_inds = vector<int>();
+	for (string other_id : list_wit) {
+		other_wit_inds.push_back(app.get_witness_index(other_id));
+	}
+	//Initialize a genealogical_comparison data structure for each other witness:
+	vector<genealogical_comparison> comps = vector<genealogical_comparison>(other_wit_inds.size());
+	for (genealogical_comparison & comp : comps) {
+		comp.agreements = make_shared<const Roaring>(); //readings in the other witness equal to this witness's readings
+		comp.explained = make_shared<const Roaring>(); //readings in the other witness equal or prior to this witness's readings
+		comp.cost = 0; //genealogical cost of the other witness relative to this witness
+	}
+	//Then calculate them using the specified kernel:
+	switch (kernel) {
+		case comparison_kernel::UNIT_MAJOR:
+			compare_witnesses_unit_major(app, wit_ind, other_wit_inds, comps);
+			break;
+		case comparison_kernel::SIMD:
+			compare_witnesses_simd(app, wit_ind, other_wit_inds, comps);
+			break;
+		default:
+			compare_witnesses_scalar(app, wit_ind, other_wit_inds, comps);
+			break;
+	}
+	//Now populate the its map of genealogical_comparisons, keyed by witness ID:
+	genealogical_comparisons = unordered_map<string, genealogical_comparison>();
+	unsigned int i = 0;
+	for (string other_id : list_wit) {
+		genealogical_comparisons[other_id] = comps[i];
+		i++;
 	}
 }
 
@@ -133,6 +472,16 @@ witness::witness(const string & _id, const unordered_map<string, genealogical_co
 	genealogical_comparisons = _genealogical_comparisons;
 }
 
+/**
+ * Alternative constructor for a witness using an ID and a map of genealogical comparisons whose contents are moved into the witness.
+ */
+witness::witness(const string & _id, unordered_map<string, genealogical_comparison> && _genealogical_comparisons) {
+	//Set its ID:
+	id = _id;
+	//Then take ownership of the map of genealogical_comparisons, keyed by witness ID:
+	genealogical_comparisons = move(_genealogical_comparisons);
+}
+
 /**
  * Default destructor.
  */
@@ -150,7 +499,7 @@ string witness::get_id() const {
 /**
  * Returns this witness's map of genealogical comparisons, keyed by witness ID.
  */
-unordered_map<string, genealogical_comparison> witness::get_genealogical_comparisons() const {
+const unordered_map<string, genealogical_comparison> & witness::get_genealogical_comparisons() const {
 	return genealogical_comparisons;
 }
 
@@ -168,7 +517,7 @@ genealogical_comparison witness::get_genealogical_comparison_for_witness(const s
 bool witness::potential_ancestor_comp(const witness & w1, const witness & w2) const {
 	genealogical_comparison w1_comp = genealogical_comparisons.at(w1.get_id());
 	genealogical_comparison w2_comp = genealogical_comparisons.at(w2.get_id());
-	return w1_comp.agreements.cardinality() > w2_comp.agreements.cardinality();
+	return w1_comp.agreements->cardinality() > w2_comp.agreements->cardinality();
 }
 
 /**
@@ -196,13 +545,73 @@ void witness::set_potential_ancestor_ids(const list<witness> & witnesses) {
 		string wit_id = wit.get_id();
 		genealogical_comparison comp = genealogical_comparisons.at(wit_id);
 		genealogical_comparison other_comp = wit.get_genealogical_comparison_for_witness(id);
-		if (comp.explained.cardinality() > other_comp.explained.cardinality()) {
+		if (comp.explained->cardinality() > other_comp.explained->cardinality()) {
 			potential_ancestor_ids.push_back(wit_id);
 		}
 	}
 	return;
 }
 
+/**
+ * Sets this witness's list of potential ancestor IDs to the given list,
+ * which is assumed to be sorted in the same way as a list populated from a list of witnesses.
+ */
+void witness::set_potential_ancestor_ids(const list<string> & _potential_ancestor_ids) {
+	potential_ancestor_ids = _potential_ancestor_ids;
+	return;
+}
+
+/**
+ * Given a list of witnesses that includes this one, returns the rankings of all other witnesses as potential ancestors of this witness,
+ * sorted in decreasing order of agreements with this witness.
+ * The potential ancestors in the rankings are the same witnesses, in the same order, as the ones set from the same list of witnesses.
+ */
+list<potential_ancestor_ranking> witness::get_potential_ancestor_rankings(const list<witness> & witnesses) const {
+	list<potential_ancestor_ranking> rankings = list<potential_ancestor_ranking>();
+	const Roaring & extant = *genealogical_comparisons.at(id).explained;
+	for (const witness & wit : witnesses) {
+		string wit_id = wit.get_id();
+		if (wit_id == id) {
+			continue;
+		}
+		const genealogical_comparison & comp = genealogical_comparisons.at(wit_id);
+		const genealogical_comparison & reverse_comp = wit.get_genealogical_comparisons().at(id);
+		const Roaring & other_extant = *wit.get_genealogical_comparisons().at(wit_id).explained;
+		potential_ancestor_ranking ranking;
+		ranking.id = wit_id;
+		ranking.rank = 0;
+		ranking.agreements = comp.agreements->cardinality();
+		ranking.pass = extant.and_cardinality(other_extant);
+		//Agreements need not be explained in both directions (e.g., when trivial readings are ignored),
+		//so count the explained variation units that are not agreements, and vice versa:
+		ranking.prior = reverse_comp.explained->xor_cardinality(*comp.agreements);
+		ranking.posterior = comp.explained->xor_cardinality(*comp.agreements);
+		ranking.potential_ancestor = comp.explained->cardinality() > reverse_comp.explained->cardinality();
+		ranking.cost = comp.cost;
+		rankings.push_back(ranking);
+	}
+	rank_potential_ancestors(rankings);
+	return rankings;
+}
+
+/**
+ * Given a list of witnesses, returns a map of the rankings of each witness's potential ancestors among them, keyed by witness ID.
+ * Each witness's potential ancestors are the same witnesses, in the same order, as the ones set from the same list of witnesses.
+ */
+unordered_map<string, list<potential_ancestor_ranking>> rank_all_potential_ancestors(const list<witness> & witnesses) {
+	unordered_map<string, list<potential_ancestor_ranking>> potential_ancestors = unordered_map<string, list<potential_ancestor_ranking>>();
+	for (const witness & wit : witnesses) {
+		list<potential_ancestor_ranking> rankings = list<potential_ancestor_ranking>();
+		for (const potential_ancestor_ranking & ranking : wit.get_potential_ancestor_rankings(witnesses)) {
+			if (ranking.potential_ancestor) {
+				rankings.push_back(ranking);
+			}
+		}
+		potential_ancestors[wit.get_id()] = rankings;
+	}
+	return potential_ancestors;
+}
+
 /**
  * Returns this witness's list of global stemma ancestor IDs.
  */
@@ -211,19 +620,27 @@ list<string> witness::get_global_stemma_ancestor_ids() const {
 }
 
 /**
- * Identifies the witnesses found in the optimal substemma for this witness.
- * The results are stored in this witness's global_stemma_ancestor_ids list.
+ * Finds the optimal substemmata for this witness among its potential ancestors,
+ * returning the set cover solutions in the order in which the solver found them.
+ * If no substemma can explain all of this witness's extant readings, then the returned list is empty.
  */
-void witness::set_global_stemma_ancestor_ids() {
-	global_stemma_ancestor_ids = list<string>();
+list<set_cover_solution> witness::get_optimal_substemmata() const {
+	return get_optimal_substemmata(1);
+}
+
+/**
+ * Finds the optimal substemmata for this witness among its potential ancestors as above,
+ * splitting the search for them between the given number of threads.
+ */
+list<set_cover_solution> witness::get_optimal_substemmata(unsigned int n_threads) const {
 	//Populate a vector of set cover rows using genealogical_comparisons for this witness's potential ancestors:
 	vector<set_cover_row> rows = vector<set_cover_row>();
 	for (string wit_id : potential_ancestor_ids) {
 		genealogical_comparison comp = genealogical_comparisons.at(wit_id);
 		set_cover_row row;
 		row.id = wit_id;
-		row.agreements = comp.agreements;
-		row.explained = comp.explained;
+		row.agreements = *comp.agreements;
+		row.explained = *comp.explained;
 		row.cost = comp.cost;
 		rows.push_back(row);
 	}
@@ -232,12 +649,32 @@ void witness::set_global_stemma_ancestor_ids() {
 		return r1.cost < r2.cost ? true : (r1.cost > r2.cost ? false : (r1.agreements.cardinality() > r2.agreements.cardinality()));
 	});
 	//Initialize the bitmap of the target set to be covered:
-	Roaring target = genealogical_comparisons.at(id).explained;
+	Roaring target = *genealogical_comparisons.at(id).explained;
 	//Initialize the list of solutions to be populated:
 	list<set_cover_solution> solutions;
 	//Then populate it using the solver:
 	set_cover_solver solver = set_cover_solver(rows, target);
+	solver.set_n_threads(n_threads);
 	solver.solve(solutions);
+	return solutions;
+}
+
+/**
+ * Identifies the witnesses found in the optimal substemma for this witness.
+ * The results are stored in this witness's global_stemma_ancestor_ids list.
+ */
+void witness::set_global_stemma_ancestor_ids() {
+	set_global_stemma_ancestor_ids(1);
+	return;
+}
+
+/**
+ * Identifies the witnesses found in the optimal substemma for this witness as above,
+ * splitting the search for the optimal substemmata between the given number of threads.
+ */
+void witness::set_global_stemma_ancestor_ids(unsigned int n_threads) {
+	global_stemma_ancestor_ids = list<string>();
+	list<set_cover_solution> solutions = get_optimal_substemmata(n_threads);
 	//If it is not empty, then add the IDs corresponding to the optimal solution:
 	if (!solutions.empty()) {
 		set_cover_solution solution = solutions.front();
@@ -13,7 +13,10 @@
 #include <set>
 #include <map>
 #include <unordered_map>
+#include <algorithm>
 #include <limits>
+#include <cstdio>
+#include <iterator>
 
 #include "cxxopts.h"
 #include "config.h" //generated by cmake using template config.h.in
@@ -23,8 +26,13 @@
 #include "global_stemma.h"
 #include "textual_flow.h"
 #include "witness.h"
+#include "genealogical_cache.h"
+#include "cache_schema.h"
+#include "cache_reader.h"
+#include "sqlite3.h"
 #include "set_cover_solver.h"
 #include "apparatus.h"
+#include "reading_matrix.h"
 #include "variation_unit.h"
 #include "local_stemma.h"
 
@@ -281,6 +289,58 @@ void autotest::run() {
 			}
 			mod_test.units.push_back(u_test);
 		}
+		/**
+		 * Unit test local_stemma_constructor_3
+		 */
+		current_unit = "local_stemma_constructor_3";
+		if (target_test.empty() || target_test == current_unit) {
+			//Initialize a container for module-wide test results:
+			unit_test u_test;
+			u_test.name = current_unit;
+			u_test.passed = false;
+			u_test.msg = "";
+			//Run the test:
+			try {
+				//Construct a local stemma whose given readings should be indexed first, in order:
+				local_stemma ls = local_stemma(graph_node, vu_id, vu_label, vector<string>({"c2", "a"}), set<pair<string, string>>(), set<string>(), set<string>());
+				//Check that the number of indexed readings is what we expect:
+				unsigned int expected_n_readings = 5;
+				unsigned int n_readings = ls.get_n_readings();
+				if (n_readings != expected_n_readings) {
+					u_test.msg += "Expected get_n_readings() == " + to_string(expected_n_readings) + ", got " + to_string(n_readings) + "\n";
+				}
+				//Check that the given readings come first:
+				int expected_reading_index = 0;
+				int reading_index = ls.get_reading_index("c2");
+				if (reading_index != expected_reading_index) {
+					u_test.msg += "Expected get_reading_index(\"c2\") == " + to_string(expected_reading_index) + ", got " + to_string(reading_index) + "\n";
+				}
+				expected_reading_index = 1;
+				reading_index = ls.get_reading_index("a");
+				if (reading_index != expected_reading_index) {
+					u_test.msg += "Expected get_reading_index(\"a\") == " + to_string(expected_reading_index) + ", got " + to_string(reading_index) + "\n";
+				}
+				//Check that the remaining vertices follow in order:
+				expected_reading_index = 2;
+				reading_index = ls.get_reading_index("b");
+				if (reading_index != expected_reading_index) {
+					u_test.msg += "Expected get_reading_index(\"b\") == " + to_string(expected_reading_index) + ", got " + to_string(reading_index) + "\n";
+				}
+				//Check that unknown readings have no index:
+				expected_reading_index = -1;
+				reading_index = ls.get_reading_index("z");
+				if (reading_index != expected_reading_index) {
+					u_test.msg += "Expected get_reading_index(\"z\") == " + to_string(expected_reading_index) + ", got " + to_string(reading_index) + "\n";
+				}
+				if (u_test.msg.empty()) {
+					u_test.passed = true;
+				}
+			}
+			catch (const exception & e) {
+				u_test.msg += string(e.what()) + "\n";
+			}
+			mod_test.units.push_back(u_test);
+		}
 		//Do more pre-test work:
 		app_node = doc.select_node("descendant::app[@n=\"B00K0V0U4\"]").node();
 		vu_id = app_node.attribute("n").value();
@@ -319,6 +379,13 @@ void autotest::run() {
 				if (ls.path_exists("b", "c")) {
 					u_test.msg += "For variation unit B00K0V0U4, expected path_exists(\"b\", \"c\") == false, got true\n";
 				}
+				//Test the same relationships using reading indices:
+				if (!ls.path_exists(ls.get_reading_index("a"), ls.get_reading_index("d"))) {
+					u_test.msg += "For variation unit B00K0V0U4, expected path_exists(get_reading_index(\"a\"), get_reading_index(\"d\")) == true, got false\n";
+				}
+				if (ls.path_exists(ls.get_reading_index("c"), ls.get_reading_index("a"))) {
+					u_test.msg += "For variation unit B00K0V0U4, expected path_exists(get_reading_index(\"c\"), get_reading_index(\"a\")) == false, got true\n";
+				}
 				if (u_test.msg.empty()) {
 					u_test.passed = true;
 				}
@@ -358,6 +425,17 @@ void autotest::run() {
 				if (path_length != expected_path_length) {
 					u_test.msg += "For variation unit B00K0V0U4, expected get_shortest_path_length(\"a\", \"d\") == " + to_string(expected_path_length) + ", got " + to_string(path_length) + "\n";
 				}
+				//The same path should have the same length when looked up by reading indices:
+				path_length = ls.get_shortest_path_length(ls.get_reading_index("a"), ls.get_reading_index("d"));
+				if (path_length != expected_path_length) {
+					u_test.msg += "For variation unit B00K0V0U4, expected get_shortest_path_length(get_reading_index(\"a\"), get_reading_index(\"d\")) == " + to_string(expected_path_length) + ", got " + to_string(path_length) + "\n";
+				}
+				//If there is no path between two readings, then the length should be infinite:
+				expected_path_length = numeric_limits<float>::infinity();
+				path_length = ls.get_shortest_path_length("b", "c");
+				if (path_length != expected_path_length) {
+					u_test.msg += "For variation unit B00K0V0U4, expected get_shortest_path_length(\"b\", \"c\") == " + to_string(expected_path_length) + ", got " + to_string(path_length) + "\n";
+				}
 				if (u_test.msg.empty()) {
 					u_test.passed = true;
 				}
@@ -413,6 +491,14 @@ void autotest::run() {
 		pugi::xml_node app_node_2 = doc.select_node("descendant::app[@n=\"B00K0V0U4\"]").node();
 		pugi::xml_node app_node_3 = doc.select_node("descendant::app[@n=\"B00K0V0U6\"]").node();
 		pugi::xml_node app_node_4 = doc.select_node("descendant::app[@n=\"B00K0V0U8\"]").node();
+		//Index the witnesses in the order in which they are listed:
+		unordered_map<string, unsigned int> wit_inds = unordered_map<string, unsigned int>();
+		unsigned int wit_ind = 0;
+		for (pugi::xpath_node wit_path : doc.select_nodes("descendant::listWit/witness")) {
+			string wit_id = wit_path.node().attribute("n").value();
+			wit_inds[wit_id] = wit_ind;
+			wit_ind++;
+		}
 		//Then proceed for each unit test:
 		string current_unit;
 		/**
@@ -428,7 +514,7 @@ void autotest::run() {
 			//Run the test:
 			try {
 				//Construct a variation unit with no dropped ambiguous readings, no merging of split readings, and no trivial reading types:
-				variation_unit vu = variation_unit(app_node_1, false, false, set<string>());
+				variation_unit vu = variation_unit(app_node_1, wit_inds, false, false, set<string>());
 				//Check that the ID is the expected value:
 				string expected_id = "B00K0V0U2";
 				string id = vu.get_id();
@@ -441,20 +527,26 @@ void autotest::run() {
 				if (label != expected_label) {
 					u_test.msg += "Expected label " + expected_label + ", got " + label + "\n";
 				}
-				//Check that the readings list is the correct size:
-				list<string> readings = vu.get_readings();
+				//Check that the readings vector is the correct size:
+				vector<string> readings = vu.get_readings();
 				unsigned int expected_readings_size = 2;
 				unsigned int readings_size = readings.size();
 				if (readings_size != expected_readings_size) {
 					u_test.msg += "Expected readings.size() == " + to_string(expected_readings_size) + ", got " + to_string(readings_size) + "\n";
 				}
-				//Check that the reading support map is the correct size:
-				unordered_map<string, string> reading_support = vu.get_reading_support();
+				//Check that the reading support vector has an entry for each witness:
+				vector<uint16_t> reading_support = vu.get_reading_support();
 				unsigned int expected_reading_support_size = 5;
 				unsigned int reading_support_size = reading_support.size();
 				if (reading_support_size != expected_reading_support_size) {
 					u_test.msg += "Expected reading_support.size() == " + to_string(expected_reading_support_size) + ", got " + to_string(reading_support_size) + "\n";
 				}
+				//Check that the reading support vector refers to the readings by index:
+				unsigned int expected_rdg_ind = 1;
+				unsigned int rdg_ind = reading_support[wit_inds.at("D")];
+				if (rdg_ind != expected_rdg_ind) {
+					u_test.msg += "Expected reading_support[wit_inds.at(\"D\")] == " + to_string(expected_rdg_ind) + ", got " + to_string(rdg_ind) + "\n";
+				}
 				//Check that the connectivity is correct:
 				int expected_connectivity = 5;
 				int connectivity = vu.get_connectivity();
@@ -483,7 +575,7 @@ void autotest::run() {
 			//Run the test:
 			try {
 				//Construct a variation unit with no dropped ambiguous readings, no merging of split readings, and no trivial reading types:
-				variation_unit vu = variation_unit(app_node_2, false, false, set<string>());
+				variation_unit vu = variation_unit(app_node_2, wit_inds, false, false, set<string>());
 				//Check that the label defaults to the ID when not provided:
 				string expected_label = "B00K0V0U4";
 				string label = vu.get_label();
@@ -518,7 +610,7 @@ void autotest::run() {
 			//Run the test:
 			try {
 				//Construct a variation unit with no dropped ambiguous readings, no merging of split readings, and where defective readings are treated as trivial:
-				variation_unit vu = variation_unit(app_node_3, false, false, set<string>({"defective"}));
+				variation_unit vu = variation_unit(app_node_3, wit_inds, false, false, set<string>({"defective"}));
 				//Check that the connectivity is correctly set to the maximum value when no connectivity element is provided:
 				int expected_connectivity = numeric_limits<int>::max();
 				int connectivity = vu.get_connectivity();
@@ -554,13 +646,13 @@ void autotest::run() {
 			//Run the test:
 			try {
 				//Construct a variation unit with dropped ambiguous readings, merging of split readings, and no trivial reading types:
-				variation_unit vu = variation_unit(app_node_4, true, true, set<string>());
-				//Check that the reading support map is the correct size when witnesses are lacunose:
-				unordered_map<string, string> reading_support = vu.get_reading_support();
-				unsigned int expected_reading_support_size = 3;
-				unsigned int reading_support_size = reading_support.size();
-				if (reading_support_size != expected_reading_support_size) {
-					u_test.msg += "Expected reading_support.size() == " + to_string(expected_reading_support_size) + ", got " + to_string(reading_support_size) + "\n";
+				variation_unit vu = variation_unit(app_node_4, wit_inds, true, true, set<string>());
+				//Check that the reading support vector marks the correct number of witnesses as lacunose:
+				vector<uint16_t> reading_support = vu.get_reading_support();
+				unsigned int expected_n_extant = 3;
+				unsigned int n_extant = reading_support.size() - count(reading_support.begin(), reading_support.end(), LACUNA);
+				if (n_extant != expected_n_extant) {
+					u_test.msg += "Expected " + to_string(expected_n_extant) + " extant witnesses in reading_support, got " + to_string(n_extant) + "\n";
 				}
 				//Check that the local stemma for this variation unit has edges in both directions between paired split readings:
 				local_stemma ls = vu.get_local_stemma();
@@ -640,6 +732,39 @@ void autotest::run() {
 		}
 		//Do more pre-test work:
 		apparatus app = apparatus(tei_node, drop_ambiguous, merge_splits, trivial_reading_types);
+		/**
+		 * Unit apparatus_get_witness_index
+		 */
+		current_unit = "apparatus_get_witness_index";
+		if (target_test.empty() || target_test == current_unit) {
+			//Initialize a container for module-wide test results:
+			unit_test u_test;
+			u_test.name = current_unit;
+			u_test.passed = false;
+			u_test.msg = "";
+			//Run the test:
+			try {
+				//Test if witnesses are indexed in the order in which they are listed:
+				int expected_wit_ind = 2;
+				int wit_ind = app.get_witness_index("C");
+				if (wit_ind != expected_wit_ind) {
+					u_test.msg += "Expected index of witness C to be " + to_string(expected_wit_ind) + ", got " + to_string(wit_ind) + "\n";
+				}
+				//Test if an unlisted witness has no index:
+				expected_wit_ind = -1;
+				wit_ind = app.get_witness_index("Z");
+				if (wit_ind != expected_wit_ind) {
+					u_test.msg += "Expected index of witness Z to be " + to_string(expected_wit_ind) + ", got " + to_string(wit_ind) + "\n";
+				}
+				if (u_test.msg.empty()) {
+					u_test.passed = true;
+				}
+			}
+			catch (const exception & e) {
+				u_test.msg += string(e.what()) + "\n";
+			}
+			mod_test.units.push_back(u_test);
+		}
 		/**
 		 * Unit apparatus_get_extant_passages_for_witness
 		 */
@@ -669,6 +794,105 @@ void autotest::run() {
 		}
 		lib_test.modules.push_back(mod_test);
 	}
+	/**
+	 * Module reading_matrix
+	 */
+	current_module = "reading_matrix";
+	if (target_module.empty() || target_module == current_module) {
+		//Initialize a container for module-wide test results:
+		module_test mod_test;
+		mod_test.name = current_module;
+		mod_test.units = list<unit_test>();
+		//Do pre-test work:
+		pugi::xml_document doc;
+		doc.load_file(TEST_XML.c_str());
+		pugi::xml_node tei_node = doc.child("TEI");
+		bool drop_ambiguous = false;
+		bool merge_splits = false;
+		set<string> trivial_reading_types = set<string>({"defective", "orthographic"});
+		apparatus app = apparatus(tei_node, drop_ambiguous, merge_splits, trivial_reading_types);
+		//Then proceed for each unit test:
+		string current_unit;
+		/**
+		 * Unit reading_matrix_constructor
+		 */
+		current_unit = "reading_matrix_constructor";
+		if (target_test.empty() || target_test == current_unit) {
+			//Initialize a container for module-wide test results:
+			unit_test u_test;
+			u_test.name = current_unit;
+			u_test.passed = false;
+			u_test.msg = "";
+			//Run the test:
+			try {
+				//Construct a reading matrix:
+				reading_matrix matrix = reading_matrix(app.get_variation_units(), app.get_list_wit().size());
+				//Check if its number of witnesses is correct:
+				unsigned int expected_n_witnesses = 5;
+				unsigned int n_witnesses = matrix.get_n_witnesses();
+				if (n_witnesses != expected_n_witnesses) {
+					u_test.msg += "Expected n_witnesses == " + to_string(expected_n_witnesses) + ", got " + to_string(n_witnesses) + "\n";
+				}
+				//Check if its number of variation units is correct:
+				unsigned int expected_n_units = 4;
+				unsigned int n_units = matrix.get_n_units();
+				if (n_units != expected_n_units) {
+					u_test.msg += "Expected n_units == " + to_string(expected_n_units) + ", got " + to_string(n_units) + "\n";
+				}
+				if (u_test.msg.empty()) {
+					u_test.passed = true;
+				}
+			}
+			catch (const exception & e) {
+				u_test.msg += string(e.what()) + "\n";
+			}
+			mod_test.units.push_back(u_test);
+		}
+		/**
+		 * Unit reading_matrix_compare
+		 */
+		current_unit = "reading_matrix_compare";
+		if (target_test.empty() || target_test == current_unit) {
+			//Initialize a container for module-wide test results:
+			unit_test u_test;
+			u_test.name = current_unit;
+			u_test.passed = false;
+			u_test.msg = "";
+			//Run the test:
+			try {
+				//Check that every instruction set produces the same comparisons as the scalar witness kernel
+				//(instruction sets that the processor does not support fall back to the best one that it does):
+				const reading_matrix & matrix = app.get_reading_matrix();
+				list<instruction_set> isas = list<instruction_set>({instruction_set::SCALAR_INSTRUCTIONS, instruction_set::SSE4_INSTRUCTIONS, instruction_set::AVX2_INSTRUCTIONS});
+				vector<uint64_t> agreement_words = vector<uint64_t>();
+				vector<uint64_t> explained_words = vector<uint64_t>();
+				for (string wit_id : app.get_list_wit()) {
+					witness wit = witness(wit_id, app.get_list_wit(), app, comparison_kernel::SCALAR);
+					for (string other_id : app.get_list_wit()) {
+						genealogical_comparison expected_comp = wit.get_genealogical_comparison_for_witness(other_id);
+						for (instruction_set isa : isas) {
+							float cost = matrix.compare(app.get_witness_index(wit_id), app.get_witness_index(other_id), agreement_words, explained_words, isa);
+							vector<uint32_t> agreements = vector<uint32_t>();
+							reading_matrix::get_set_bits(agreement_words, agreements);
+							vector<uint32_t> explained = vector<uint32_t>();
+							reading_matrix::get_set_bits(explained_words, explained);
+							if (!(Roaring(agreements.size(), agreements.data()) == *expected_comp.agreements) || !(Roaring(explained.size(), explained.data()) == *expected_comp.explained) || cost != expected_comp.cost) {
+								u_test.msg += "Expected instruction set " + to_string(isa) + " to produce the same comparison for " + other_id + " relative to " + wit_id + " as the scalar kernel\n";
+							}
+						}
+					}
+				}
+				if (u_test.msg.empty()) {
+					u_test.passed = true;
+				}
+			}
+			catch (const exception & e) {
+				u_test.msg += string(e.what()) + "\n";
+			}
+			mod_test.units.push_back(u_test);
+		}
+		lib_test.modules.push_back(mod_test);
+	}
 	/**
 	 * Module set_cover_solver
 	 */
@@ -849,6 +1073,312 @@ void autotest::run() {
 			}
 			mod_test.units.push_back(u_test);
 		}
+		/**
+		 * Unit set_cover_solver_solve_in_parallel
+		 */
+		current_unit = "set_cover_solver_solve_in_parallel";
+		if (target_test.empty() || target_test == current_unit) {
+			//Initialize a container for module-wide test results:
+			unit_test u_test;
+			u_test.name = current_unit;
+			u_test.passed = false;
+			u_test.msg = "";
+			//Run the test:
+			try {
+				//Generate a pseudorandom problem with many rows of similar costs, so that it has several optimal solutions and a large search tree:
+				unsigned int n_rows = 26;
+				unsigned int n_cols = 20;
+				uint32_t state = 12345;
+				vector<set_cover_row> random_rows = vector<set_cover_row>();
+				for (unsigned int i = 0; i < n_rows; i++) {
+					set_cover_row random_row;
+					random_row.id = to_string(i);
+					for (unsigned int j = 0; j < n_cols; j++) {
+						state = state * 1103515245 + 12345;
+						if ((state >> 16) % 3 == 0) {
+							random_row.explained.add(j);
+						}
+						if ((state >> 16) % 6 == 0) {
+							random_row.agreements.add(j);
+						}
+					}
+					random_row.cost = float(2 + i / 8);
+					random_rows.push_back(random_row);
+				}
+				Roaring random_target = Roaring();
+				random_target.addRange(0, n_cols);
+				//The solutions found with several threads should be the same as those found with one, both with and without a fixed upper bound:
+				for (float random_ub : {numeric_limits<float>::infinity(), float(11)}) {
+					list<set_cover_solution> solutions;
+					list<set_cover_solution> parallel_solutions;
+					set_cover_solver serial_solver = random_ub < numeric_limits<float>::infinity() ? set_cover_solver(random_rows, random_target, random_ub) : set_cover_solver(random_rows, random_target);
+					serial_solver.solve(solutions);
+					set_cover_solver parallel_solver = random_ub < numeric_limits<float>::infinity() ? set_cover_solver(random_rows, random_target, random_ub) : set_cover_solver(random_rows, random_target);
+					parallel_solver.set_n_threads(4);
+					parallel_solver.solve(parallel_solutions);
+					if (solutions.size() < 2) {
+						u_test.msg += "Expected at least 2 solutions with upper bound " + to_string(random_ub) + ", got " + to_string(solutions.size()) + "\n";
+					}
+					bool solutions_equal = solutions.size() == parallel_solutions.size() && equal(solutions.begin(), solutions.end(), parallel_solutions.begin(), [](const set_cover_solution & s1, const set_cover_solution & s2) {
+						return s1.cost == s2.cost && s1.agreements == s2.agreements && s1.rows.size() == s2.rows.size() && equal(s1.rows.begin(), s1.rows.end(), s2.rows.begin(), [](const set_cover_row & r1, const set_cover_row & r2) {
+							return r1.id == r2.id;
+						});
+					});
+					if (!solutions_equal) {
+						u_test.msg += "Expected the " + to_string(parallel_solutions.size()) + " solutions found with 4 threads and upper bound " + to_string(random_ub) + " to match the " + to_string(solutions.size()) + " found with 1 thread\n";
+					}
+				}
+				if (u_test.msg.empty()) {
+					u_test.passed = true;
+				}
+			}
+			catch (const exception & e) {
+				u_test.msg += string(e.what()) + "\n";
+			}
+			mod_test.units.push_back(u_test);
+		}
+		/**
+		 * Unit set_cover_solver_solve_with_bounds
+		 */
+		current_unit = "set_cover_solver_solve_with_bounds";
+		if (target_test.empty() || target_test == current_unit) {
+			//Initialize a container for module-wide test results:
+			unit_test u_test;
+			u_test.name = current_unit;
+			u_test.passed = false;
+			u_test.msg = "";
+			//Run the test:
+			try {
+				//Generate a pseudorandom problem with rows of varying costs:
+				unsigned int n_rows = 24;
+				unsigned int n_cols = 20;
+				uint32_t state = 54321;
+				vector<set_cover_row> random_rows = vector<set_cover_row>();
+				for (unsigned int i = 0; i < n_rows; i++) {
+					set_cover_row random_row;
+					random_row.id = to_string(i);
+					for (unsigned int j = 0; j < n_cols; j++) {
+						state = state * 1103515245 + 12345;
+						if ((state >> 16) % 4 == 0) {
+							random_row.explained.add(j);
+							random_row.agreements.add(j);
+						}
+					}
+					random_row.cost = float(1 + i / 4);
+					random_rows.push_back(random_row);
+				}
+				Roaring random_target = Roaring();
+				random_target.addRange(0, n_cols);
+				//Stronger bounds should find the same solutions as the accepted cost bound while visiting no more nodes, both with and without a fixed upper bound:
+				list<list<bound_type>> bound_lists = {{ACCEPTED_COST}, {ACCEPTED_COST, COLUMN_COST, DISJOINT_COLUMNS}, {ACCEPTED_COST, COLUMN_COST, DISJOINT_COLUMNS, LAGRANGIAN}};
+				for (float random_ub : {numeric_limits<float>::infinity(), float(11)}) {
+					list<set_cover_solution> expected_solutions;
+					unsigned long expected_nodes = 0;
+					for (const list<bound_type> & bounds : bound_lists) {
+						list<set_cover_solution> solutions;
+						set_cover_solver solver = random_ub < numeric_limits<float>::infinity() ? set_cover_solver(random_rows, random_target, random_ub) : set_cover_solver(random_rows, random_target);
+						solver.set_bounds(bounds);
+						solver.solve(solutions);
+						const branch_and_bound_statistics & statistics = solver.get_statistics();
+						for (bound_type type : bounds) {
+							if (statistics.bounds.count(type) == 0 || statistics.bounds.at(type).evaluations == 0) {
+								u_test.msg += "Expected bound " + to_string(type) + " to be evaluated with upper bound " + to_string(random_ub) + "\n";
+							}
+						}
+						if (bounds.size() == 1) {
+							expected_solutions = solutions;
+							expected_nodes = statistics.nodes;
+							if (solutions.empty()) {
+								u_test.msg += "Expected at least 1 solution with upper bound " + to_string(random_ub) + ", got 0\n";
+							}
+							continue;
+						}
+						if (statistics.nodes > expected_nodes) {
+							u_test.msg += "Expected " + to_string(bounds.size()) + " bounds with upper bound " + to_string(random_ub) + " to visit at most " + to_string(expected_nodes) + " nodes, got " + to_string(statistics.nodes) + "\n";
+						}
+						bool solutions_equal = solutions.size() == expected_solutions.size() && equal(solutions.begin(), solutions.end(), expected_solutions.begin(), [](const set_cover_solution & s1, const set_cover_solution & s2) {
+							return s1.cost == s2.cost && s1.rows.size() == s2.rows.size() && equal(s1.rows.begin(), s1.rows.end(), s2.rows.begin(), [](const set_cover_row & r1, const set_cover_row & r2) {
+								return r1.id == r2.id;
+							});
+						});
+						if (!solutions_equal) {
+							u_test.msg += "Expected the " + to_string(solutions.size()) + " solutions found with " + to_string(bounds.size()) + " bounds and upper bound " + to_string(random_ub) + " to match the " + to_string(expected_solutions.size()) + " found with the accepted cost bound\n";
+						}
+					}
+				}
+				if (u_test.msg.empty()) {
+					u_test.passed = true;
+				}
+			}
+			catch (const exception & e) {
+				u_test.msg += string(e.what()) + "\n";
+			}
+			mod_test.units.push_back(u_test);
+		}
+		/**
+		 * Unit set_cover_solver_dense_rows
+		 */
+		current_unit = "set_cover_solver_dense_rows";
+		if (target_test.empty() || target_test == current_unit) {
+			//Initialize a container for module-wide test results:
+			unit_test u_test;
+			u_test.name = current_unit;
+			u_test.passed = false;
+			u_test.msg = "";
+			//Run the test:
+			try {
+				//Generate a pseudorandom problem, along with a copy too wide for dense rows in which every column is repeated:
+				unsigned int n_rows = 20;
+				unsigned int n_cols = 20;
+				unsigned int n_copies = 60;
+				uint32_t state = 12345;
+				vector<set_cover_row> narrow_rows = vector<set_cover_row>();
+				vector<set_cover_row> wide_rows = vector<set_cover_row>();
+				for (unsigned int i = 0; i < n_rows; i++) {
+					set_cover_row narrow_row;
+					narrow_row.id = to_string(i);
+					set_cover_row wide_row;
+					wide_row.id = to_string(i);
+					for (unsigned int j = 0; j < n_cols; j++) {
+						state = state * 1103515245 + 12345;
+						if ((state >> 16) % 4 == 0 || j == i) {
+							narrow_row.explained.add(j);
+							narrow_row.agreements.add(j);
+							for (unsigned int k = 0; k < n_copies; k++) {
+								wide_row.explained.add(k * n_cols + j);
+								wide_row.agreements.add(k * n_cols + j);
+							}
+						}
+					}
+					narrow_row.cost = float(1 + i / 5);
+					wide_row.cost = narrow_row.cost;
+					narrow_rows.push_back(narrow_row);
+					wide_rows.push_back(wide_row);
+				}
+				Roaring narrow_target = Roaring();
+				narrow_target.addRange(0, n_cols);
+				Roaring wide_target = Roaring();
+				wide_target.addRange(0, n_copies * n_cols);
+				set_cover_solver narrow_solver = set_cover_solver(narrow_rows, narrow_target, 6);
+				set_cover_solver wide_solver = set_cover_solver(wide_rows, wide_target, 6);
+				if (!narrow_solver.has_dense_rows()) {
+					u_test.msg += "Expected the solver with " + to_string(n_cols) + " columns to have dense rows\n";
+				}
+				if (wide_solver.has_dense_rows()) {
+					u_test.msg += "Expected the solver with " + to_string(n_copies * n_cols) + " columns not to have dense rows\n";
+				}
+				//Both solvers should find the same unique rows, greedy solution, and solutions:
+				if (!(narrow_solver.get_unique_rows() == wide_solver.get_unique_rows())) {
+					u_test.msg += "Expected the unique rows with dense rows to be " + wide_solver.get_unique_rows().toString() + ", got " + narrow_solver.get_unique_rows().toString() + "\n";
+				}
+				set_cover_solution narrow_greedy_solution = narrow_solver.get_greedy_solution();
+				set_cover_solution wide_greedy_solution = wide_solver.get_greedy_solution();
+				bool greedy_solutions_equal = narrow_greedy_solution.cost == wide_greedy_solution.cost && narrow_greedy_solution.rows.size() == wide_greedy_solution.rows.size() && equal(narrow_greedy_solution.rows.begin(), narrow_greedy_solution.rows.end(), wide_greedy_solution.rows.begin(), [](const set_cover_row & r1, const set_cover_row & r2) {
+					return r1.id == r2.id;
+				});
+				if (!greedy_solutions_equal) {
+					u_test.msg += "Expected the greedy solution with dense rows to match the greedy solution without them\n";
+				}
+				list<set_cover_solution> narrow_solutions;
+				narrow_solver.solve(narrow_solutions);
+				list<set_cover_solution> wide_solutions;
+				wide_solver.solve(wide_solutions);
+				if (narrow_solutions.size() < 2) {
+					u_test.msg += "Expected at least 2 solutions, got " + to_string(narrow_solutions.size()) + "\n";
+				}
+				bool solutions_equal = narrow_solutions.size() == wide_solutions.size() && equal(narrow_solutions.begin(), narrow_solutions.end(), wide_solutions.begin(), [](const set_cover_solution & s1, const set_cover_solution & s2) {
+					return s1.cost == s2.cost && s1.rows.size() == s2.rows.size() && equal(s1.rows.begin(), s1.rows.end(), s2.rows.begin(), [](const set_cover_row & r1, const set_cover_row & r2) {
+						return r1.id == r2.id;
+					});
+				});
+				if (!solutions_equal) {
+					u_test.msg += "Expected the " + to_string(narrow_solutions.size()) + " solutions found with dense rows to match the " + to_string(wide_solutions.size()) + " found without them\n";
+				}
+				if (u_test.msg.empty()) {
+					u_test.passed = true;
+				}
+			}
+			catch (const exception & e) {
+				u_test.msg += string(e.what()) + "\n";
+			}
+			mod_test.units.push_back(u_test);
+		}
+		/**
+		 * Unit set_cover_solver_reduce
+		 */
+		current_unit = "set_cover_solver_reduce";
+		if (target_test.empty() || target_test == current_unit) {
+			//Initialize a container for module-wide test results:
+			unit_test u_test;
+			u_test.name = current_unit;
+			u_test.passed = false;
+			u_test.msg = "";
+			//Run the test:
+			try {
+				//Generate two cheap rows covering each half of the target, and several costlier near-copies of them:
+				unsigned int n_cols = 10;
+				unsigned int n_copies = 3;
+				vector<set_cover_row> reduce_rows = vector<set_cover_row>();
+				for (unsigned int half = 0; half < 2; half++) {
+					set_cover_row row;
+					row.id = to_string(half);
+					row.explained.addRange(half * n_cols / 2, (half + 1) * n_cols / 2);
+					row.agreements = row.explained;
+					row.cost = 1;
+					reduce_rows.push_back(row);
+				}
+				for (unsigned int half = 0; half < 2; half++) {
+					for (unsigned int k = 0; k < n_copies; k++) {
+						set_cover_row row;
+						row.id = to_string(reduce_rows.size());
+						row.explained.addRange(half * n_cols / 2 + k % 2, (half + 1) * n_cols / 2);
+						row.agreements = row.explained;
+						row.cost = float(2 + k);
+						reduce_rows.push_back(row);
+					}
+				}
+				Roaring reduce_target = Roaring();
+				reduce_target.addRange(0, n_cols);
+				//Without a fixed upper bound, the reduction should drop every near-copy and fix the two cheap rows:
+				set_cover_solver solver = set_cover_solver(reduce_rows, reduce_target);
+				list<set_cover_solution> solutions;
+				solver.solve(solutions);
+				if (solutions.size() != 1 || solutions.front().rows.size() != 2 || solutions.front().cost != 2) {
+					u_test.msg += "Expected a single solution of 2 rows with cost 2\n";
+				}
+				const reduction_statistics & reduction = solver.get_reduction_statistics();
+				if (reduction.fixed_rows != 2) {
+					u_test.msg += "Expected 2 fixed rows, got " + to_string(reduction.fixed_rows) + "\n";
+				}
+				if (reduction.dominated_rows != 2 * n_copies) {
+					u_test.msg += "Expected " + to_string(2 * n_copies) + " dominated rows, got " + to_string(reduction.dominated_rows) + "\n";
+				}
+				if (reduction.dominated_columns == 0) {
+					u_test.msg += "Expected some dominated columns, got 0\n";
+				}
+				if (reduction.remaining_rows != 0 || reduction.remaining_columns != 0) {
+					u_test.msg += "Expected no rows or columns to remain, got " + to_string(reduction.remaining_rows) + " rows and " + to_string(reduction.remaining_columns) + " columns\n";
+				}
+				//With a fixed upper bound, no rows should be dropped as dominated, so that every solution within the bound is still found:
+				set_cover_solver bounded_solver = set_cover_solver(reduce_rows, reduce_target, 5);
+				list<set_cover_solution> bounded_solutions;
+				bounded_solver.solve(bounded_solutions);
+				unsigned int expected_bounded_solutions_size = 12;
+				if (bounded_solutions.size() != expected_bounded_solutions_size) {
+					u_test.msg += "Expected " + to_string(expected_bounded_solutions_size) + " solutions with upper bound 5, got " + to_string(bounded_solutions.size()) + "\n";
+				}
+				if (bounded_solver.get_reduction_statistics().dominated_rows != 0) {
+					u_test.msg += "Expected no dominated rows with upper bound 5, got " + to_string(bounded_solver.get_reduction_statistics().dominated_rows) + "\n";
+				}
+				if (u_test.msg.empty()) {
+					u_test.passed = true;
+				}
+			}
+			catch (const exception & e) {
+				u_test.msg += string(e.what()) + "\n";
+			}
+			mod_test.units.push_back(u_test);
+		}
 		lib_test.modules.push_back(mod_test);
 	}
 	/**
@@ -934,12 +1464,10 @@ void autotest::run() {
 			}
 			mod_test.units.push_back(u_test);
 		}
-		//Do more pre-test work:
-		witness wit = witness("B", app);
 		/**
-		 * Unit witness_get_genealogical_comparison_for_witness
+		 * Unit witness_constructor_3
 		 */
-		current_unit = "witness_get_genealogical_comparison_for_witness";
+		current_unit = "witness_constructor_3";
 		if (target_test.empty() || target_test == current_unit) {
 			//Initialize a container for module-wide test results:
 			unit_test u_test;
@@ -948,24 +1476,20 @@ void autotest::run() {
 			u_test.msg = "";
 			//Run the test:
 			try {
-				genealogical_comparison comp = wit.get_genealogical_comparison_for_witness("A");
-				//Check that the witness's agreements with A are correct:
-				Roaring expected_agreements = Roaring::bitmapOf(3, 0, 1, 3);
-				Roaring agreements = comp.agreements;
-				if ((agreements ^ expected_agreements).cardinality() != 0) {
-					u_test.msg += "Expected agreements bitmap for A relative to B == " + expected_agreements.toString() + ", got " + agreements.toString() + "\n";
-				}
-				//Check that the witness's explained readings by A are correct:
-				Roaring expected_explained_readings = Roaring::bitmapOf(4, 0, 1, 2, 3);
-				Roaring explained_readings = comp.explained;
-				if ((explained_readings ^ expected_explained_readings).cardinality() != 0) {
-					u_test.msg += "Expected explained readings bitmap for A relative to B == " + expected_explained_readings.toString() + ", got " + explained_readings.toString() + "\n";
-				}
-				//Check that the genealogical cost of A relative to B is correct:
-				float expected_cost = 1;
-				float cost = comp.cost;
-				if (cost != expected_cost) {
-					u_test.msg += "Expected genealogical cost for A relative to B == " + to_string(expected_cost) + ", got " + to_string(cost) + "\n";
+				//Check that every kernel produces the same genealogical comparisons as the scalar kernel:
+				list<comparison_kernel> kernels = list<comparison_kernel>({comparison_kernel::UNIT_MAJOR, comparison_kernel::SIMD});
+				for (comparison_kernel kernel : kernels) {
+					for (string wit_id : app.get_list_wit()) {
+						witness expected_wit = witness(wit_id, app.get_list_wit(), app, comparison_kernel::SCALAR);
+						witness wit = witness(wit_id, app.get_list_wit(), app, kernel);
+						for (string other_id : app.get_list_wit()) {
+							genealogical_comparison expected_comp = expected_wit.get_genealogical_comparison_for_witness(other_id);
+							genealogical_comparison comp = wit.get_genealogical_comparison_for_witness(other_id);
+							if (!(*comp.agreements == *expected_comp.agreements) || !(*comp.explained == *expected_comp.explained) || comp.cost != expected_comp.cost) {
+								u_test.msg += "Expected kernel " + to_string(kernel) + " to produce the same genealogical comparison for " + other_id + " relative to " + wit_id + " as the scalar kernel\n";
+							}
+						}
+					}
 				}
 				if (u_test.msg.empty()) {
 					u_test.passed = true;
@@ -976,17 +1500,107 @@ void autotest::run() {
 			}
 			mod_test.units.push_back(u_test);
 		}
-		//Do more pre-test work:
-		wit = witness("C", app);
-		list<witness> witnesses = list<witness>();
-		for (string wit_id : app.get_list_wit()) {
-			witness other_wit = witness(wit_id, app);
-			witnesses.push_back(other_wit);
-		}
 		/**
-		 * Unit witness_set_potential_ancestor_ids
+		 * Unit witness_compare_witnesses_both_ways
 		 */
-		current_unit = "witness_set_potential_ancestor_ids";
+		current_unit = "witness_compare_witnesses_both_ways";
+		if (target_test.empty() || target_test == current_unit) {
+			//Initialize a container for module-wide test results:
+			unit_test u_test;
+			u_test.name = current_unit;
+			u_test.passed = false;
+			u_test.msg = "";
+			//Run the test:
+			try {
+				//Check that every kernel produces the comparisons of both witnesses in each pair as the witness constructor does:
+				list<comparison_kernel> kernels = list<comparison_kernel>({comparison_kernel::SCALAR, comparison_kernel::UNIT_MAJOR, comparison_kernel::SIMD});
+				for (comparison_kernel kernel : kernels) {
+					for (string wit_id : app.get_list_wit()) {
+						vector<genealogical_comparison> comps = vector<genealogical_comparison>();
+						vector<genealogical_comparison> reverse_comps = vector<genealogical_comparison>();
+						compare_witnesses_both_ways(wit_id, app.get_list_wit(), app, kernel, comps, reverse_comps);
+						witness expected_wit = witness(wit_id, app.get_list_wit(), app, comparison_kernel::SCALAR);
+						unsigned int i = 0;
+						for (string other_id : app.get_list_wit()) {
+							genealogical_comparison expected_comp = expected_wit.get_genealogical_comparison_for_witness(other_id);
+							if (!(*comps[i].agreements == *expected_comp.agreements) || !(*comps[i].explained == *expected_comp.explained) || comps[i].cost != expected_comp.cost) {
+								u_test.msg += "Expected kernel " + to_string(kernel) + " to produce the same genealogical comparison for " + other_id + " relative to " + wit_id + " as the witness constructor\n";
+							}
+							witness expected_other_wit = witness(other_id, app.get_list_wit(), app, comparison_kernel::SCALAR);
+							genealogical_comparison expected_reverse_comp = expected_other_wit.get_genealogical_comparison_for_witness(wit_id);
+							if (!(*reverse_comps[i].agreements == *expected_reverse_comp.agreements) || !(*reverse_comps[i].explained == *expected_reverse_comp.explained) || reverse_comps[i].cost != expected_reverse_comp.cost) {
+								u_test.msg += "Expected kernel " + to_string(kernel) + " to produce the same genealogical comparison for " + wit_id + " relative to " + other_id + " as the witness constructor\n";
+							}
+							//The comparisons in both directions should share their agreements exactly when they are equal:
+							if ((comps[i].agreements == reverse_comps[i].agreements) != (*comps[i].agreements == *reverse_comps[i].agreements)) {
+								u_test.msg += "Expected kernel " + to_string(kernel) + " to share the agreements of " + wit_id + " and " + other_id + " only if they are the same in both directions\n";
+							}
+							i++;
+						}
+					}
+				}
+				if (u_test.msg.empty()) {
+					u_test.passed = true;
+				}
+			}
+			catch (const exception & e) {
+				u_test.msg += string(e.what()) + "\n";
+			}
+			mod_test.units.push_back(u_test);
+		}
+		//Do more pre-test work:
+		witness wit = witness("B", app);
+		/**
+		 * Unit witness_get_genealogical_comparison_for_witness
+		 */
+		current_unit = "witness_get_genealogical_comparison_for_witness";
+		if (target_test.empty() || target_test == current_unit) {
+			//Initialize a container for module-wide test results:
+			unit_test u_test;
+			u_test.name = current_unit;
+			u_test.passed = false;
+			u_test.msg = "";
+			//Run the test:
+			try {
+				genealogical_comparison comp = wit.get_genealogical_comparison_for_witness("A");
+				//Check that the witness's agreements with A are correct:
+				Roaring expected_agreements = Roaring::bitmapOf(3, 0, 1, 3);
+				Roaring agreements = *comp.agreements;
+				if ((agreements ^ expected_agreements).cardinality() != 0) {
+					u_test.msg += "Expected agreements bitmap for A relative to B == " + expected_agreements.toString() + ", got " + agreements.toString() + "\n";
+				}
+				//Check that the witness's explained readings by A are correct:
+				Roaring expected_explained_readings = Roaring::bitmapOf(4, 0, 1, 2, 3);
+				Roaring explained_readings = *comp.explained;
+				if ((explained_readings ^ expected_explained_readings).cardinality() != 0) {
+					u_test.msg += "Expected explained readings bitmap for A relative to B == " + expected_explained_readings.toString() + ", got " + explained_readings.toString() + "\n";
+				}
+				//Check that the genealogical cost of A relative to B is correct:
+				float expected_cost = 1;
+				float cost = comp.cost;
+				if (cost != expected_cost) {
+					u_test.msg += "Expected genealogical cost for A relative to B == " + to_string(expected_cost) + ", got " + to_string(cost) + "\n";
+				}
+				if (u_test.msg.empty()) {
+					u_test.passed = true;
+				}
+			}
+			catch (const exception & e) {
+				u_test.msg += string(e.what()) + "\n";
+			}
+			mod_test.units.push_back(u_test);
+		}
+		//Do more pre-test work:
+		wit = witness("C", app);
+		list<witness> witnesses = list<witness>();
+		for (string wit_id : app.get_list_wit()) {
+			witness other_wit = witness(wit_id, app);
+			witnesses.push_back(other_wit);
+		}
+		/**
+		 * Unit witness_set_potential_ancestor_ids
+		 */
+		current_unit = "witness_set_potential_ancestor_ids";
 		if (target_test.empty() || target_test == current_unit) {
 			//Initialize a container for module-wide test results:
 			unit_test u_test;
@@ -1036,6 +1650,108 @@ void autotest::run() {
 			}
 			mod_test.units.push_back(u_test);
 		}
+		/**
+		 * Unit witness_get_potential_ancestor_rankings
+		 */
+		current_unit = "witness_get_potential_ancestor_rankings";
+		if (target_test.empty() || target_test == current_unit) {
+			//Initialize a container for module-wide test results:
+			unit_test u_test;
+			u_test.name = current_unit;
+			u_test.passed = false;
+			u_test.msg = "";
+			//Run the test:
+			try {
+				//Check if the witnesses flagged as potential ancestors are the potential ancestors, in the same order:
+				wit.set_potential_ancestor_ids(witnesses);
+				list<potential_ancestor_ranking> rankings = wit.get_potential_ancestor_rankings(witnesses);
+				if (rankings.size() != witnesses.size() - 1) {
+					u_test.msg += "Expected rankings.size() == " + to_string(witnesses.size() - 1) + ", got " + to_string(rankings.size()) + "\n";
+				}
+				list<string> ranked_potential_ancestor_ids = list<string>();
+				int last_rank = 0;
+				int last_agreements = -1;
+				for (const potential_ancestor_ranking & ranking : rankings) {
+					if (ranking.potential_ancestor) {
+						ranked_potential_ancestor_ids.push_back(ranking.id);
+					}
+					if (ranking.rank > 0) {
+						//Ranks should only increase when the number of agreements decreases:
+						int expected_rank = ranking.agreements == last_agreements ? last_rank : last_rank + 1;
+						if (ranking.rank != expected_rank) {
+							u_test.msg += "Expected rank " + to_string(expected_rank) + " for " + ranking.id + ", got " + to_string(ranking.rank) + "\n";
+						}
+						last_rank = ranking.rank;
+						last_agreements = ranking.agreements;
+					}
+					//Check the counts against the genealogical comparisons:
+					genealogical_comparison comp = wit.get_genealogical_comparison_for_witness(ranking.id);
+					int expected_posterior = (*comp.explained ^ *comp.agreements).cardinality();
+					if (ranking.agreements != int(comp.agreements->cardinality()) || ranking.posterior != expected_posterior || ranking.cost != comp.cost) {
+						u_test.msg += "Expected the ranking of " + ranking.id + " to match its genealogical comparison\n";
+					}
+				}
+				if (ranked_potential_ancestor_ids != wit.get_potential_ancestor_ids()) {
+					u_test.msg += "Expected the witnesses flagged as potential ancestors to be the potential ancestors\n";
+				}
+				if (u_test.msg.empty()) {
+					u_test.passed = true;
+				}
+			}
+			catch (const exception & e) {
+				u_test.msg += string(e.what()) + "\n";
+			}
+			mod_test.units.push_back(u_test);
+		}
+		/**
+		 * Unit witness_get_potential_ancestor_rankings_trivial_readings
+		 */
+		current_unit = "witness_get_potential_ancestor_rankings_trivial_readings";
+		if (target_test.empty() || target_test == current_unit) {
+			//Initialize a container for module-wide test results:
+			unit_test u_test;
+			u_test.name = current_unit;
+			u_test.passed = false;
+			u_test.msg = "";
+			//Run the test:
+			try {
+				//With defective and orthographic readings treated as trivial, B agrees with A in a place where it does not explain A,
+				//so the counts of prior and posterior readings cannot be found by subtracting the agreements from the explained readings:
+				const witness & other_wit = *find_if(witnesses.begin(), witnesses.end(), [](const witness & w) {
+					return w.get_id() == "B";
+				});
+				list<potential_ancestor_ranking> rankings = other_wit.get_potential_ancestor_rankings(witnesses);
+				vector<string> expected_ids = vector<string>({"A", "C", "D", "E"});
+				vector<int> expected_ranks = vector<int>({0, -1, -1, -1});
+				vector<int> expected_agreements = vector<int>({3, 1, 0, 0});
+				vector<int> expected_passes = vector<int>({4, 4, 4, 3});
+				vector<int> expected_priors = vector<int>({1, 3, 2, 2});
+				vector<int> expected_posteriors = vector<int>({1, 0, 0, 0});
+				if (rankings.size() != expected_ids.size()) {
+					u_test.msg += "Expected rankings.size() == " + to_string(expected_ids.size()) + ", got " + to_string(rankings.size()) + "\n";
+				}
+				else {
+					unsigned int i = 0;
+					for (const potential_ancestor_ranking & ranking : rankings) {
+						if (ranking.id != expected_ids[i]) {
+							u_test.msg += "Expected rankings[" + to_string(i) + "].id == " + expected_ids[i] + ", got " + ranking.id + "\n";
+						}
+						else if (ranking.rank != expected_ranks[i] || ranking.agreements != expected_agreements[i] || ranking.pass != expected_passes[i] || ranking.prior != expected_priors[i] || ranking.posterior != expected_posteriors[i]) {
+							u_test.msg += "Expected (rank, agreements, pass, prior, posterior) == (" + to_string(expected_ranks[i]) + ", " + to_string(expected_agreements[i]) + ", " + to_string(expected_passes[i]) + ", " + to_string(expected_priors[i]) + ", " + to_string(expected_posteriors[i]) + ") for " + ranking.id
+								+ ", got (" + to_string(ranking.rank) + ", " + to_string(ranking.agreements) + ", " + to_string(ranking.pass) + ", " + to_string(ranking.prior) + ", " + to_string(ranking.posterior) + ")\n";
+						}
+						i++;
+					}
+				}
+				if (u_test.msg.empty()) {
+					u_test.passed = true;
+				}
+			}
+			catch (const exception & e) {
+				u_test.msg += string(e.what()) + "\n";
+			}
+			mod_test.units.push_back(u_test);
+		}
 		//Do more pre-test work:
 		wit.set_potential_ancestor_ids(witnesses);
 		/**
@@ -1093,6 +1809,777 @@ void autotest::run() {
 		}
 		lib_test.modules.push_back(mod_test);
 	}
+	/**
+	 * Module genealogical_cache
+	 */
+	current_module = "genealogical_cache";
+	if (target_module.empty() || target_module == current_module) {
+		//Initialize a container for module-wide test results:
+		module_test mod_test;
+		mod_test.name = current_module;
+		mod_test.units = list<unit_test>();
+		//Do pre-test work:
+		pugi::xml_document doc;
+		doc.load_file(TEST_XML.c_str());
+		pugi::xml_node tei_node = doc.child("TEI");
+		bool drop_ambiguous = false;
+		bool merge_splits = false;
+		set<string> trivial_reading_types = set<string>({"defective", "orthographic"});
+		apparatus app = apparatus(tei_node, drop_ambiguous, merge_splits, trivial_reading_types);
+		list<witness> witnesses = list<witness>();
+		for (string wit_id : app.get_list_wit()) {
+			witnesses.push_back(witness(wit_id, app));
+		}
+		//Then proceed for each unit test:
+		string current_unit;
+		/**
+		 * Unit genealogical_cache_write_read
+		 */
+		current_unit = "genealogical_cache_write_read";
+		if (target_test.empty() || target_test == current_unit) {
+			//Initialize a container for module-wide test results:
+			unit_test u_test;
+			u_test.name = current_unit;
+			u_test.passed = false;
+			u_test.msg = "";
+			//Run the test:
+			try {
+				//Write every genealogical comparison except that of the last witness relative to the first to a binary cache:
+				string path = "genealogical_cache_write_read.bin";
+				list<string> list_wit = app.get_list_wit();
+				string first_wit_id = list_wit.front();
+				string last_wit_id = list_wit.back();
+				genealogical_cache_writer writer(path, list_wit);
+				for (const witness & wit : witnesses) {
+					for (pair<string, genealogical_comparison> kv : wit.get_genealogical_comparisons()) {
+						if (wit.get_id() == first_wit_id && kv.first == last_wit_id) {
+							continue;
+						}
+						writer.add(wit.get_id(), kv.first, kv.second);
+					}
+				}
+				if (!writer.close()) {
+					u_test.msg += "Expected the binary cache to be written successfully\n";
+				}
+				//Then read it back and check that it contains the same comparisons:
+				genealogical_cache cache(path);
+				if (!cache.is_open()) {
+					u_test.msg += "Expected the binary cache to be opened successfully\n";
+				}
+				else {
+					if (cache.get_witness_ids() != vector<string>(list_wit.begin(), list_wit.end())) {
+						u_test.msg += "Expected the binary cache to have the same witness IDs as the apparatus\n";
+					}
+					for (const witness & wit : witnesses) {
+						unordered_map<string, genealogical_comparison> comps = cache.get_genealogical_comparisons(wit.get_id());
+						for (pair<string, genealogical_comparison> kv : wit.get_genealogical_comparisons()) {
+							bool expected_present = !(wit.get_id() == first_wit_id && kv.first == last_wit_id);
+							if (comps.find(kv.first) == comps.end()) {
+								if (expected_present) {
+									u_test.msg += "Expected a comparison for " + kv.first + " relative to " + wit.get_id() + "\n";
+								}
+								continue;
+							}
+							if (!expected_present) {
+								u_test.msg += "Expected no comparison for " + kv.first + " relative to " + wit.get_id() + "\n";
+								continue;
+							}
+							genealogical_comparison comp = comps.at(kv.first);
+							if (!(*comp.agreements == *kv.second.agreements) || !(*comp.explained == *kv.second.explained) || comp.cost != kv.second.cost) {
+								u_test.msg += "Expected the comparison for " + kv.first + " relative to " + wit.get_id() + " to match the one written\n";
+							}
+							//The frozen views should match the original bitmaps, too:
+							int wit_ind = cache.get_witness_index(wit.get_id());
+							int other_wit_ind = cache.get_witness_index(kv.first);
+							if (roaring_bitmap_get_cardinality(cache.get_agreements(wit_ind, other_wit_ind)) != kv.second.agreements->cardinality()) {
+								u_test.msg += "Expected the agreements view for " + kv.first + " relative to " + wit.get_id() + " to match the one written\n";
+							}
+						}
+					}
+				}
+				remove(path.c_str());
+				if (u_test.msg.empty()) {
+					u_test.passed = true;
+				}
+			}
+			catch (const exception & e) {
+				u_test.msg += string(e.what()) + "\n";
+			}
+			mod_test.units.push_back(u_test);
+		}
+		lib_test.modules.push_back(mod_test);
+	}
+	/**
+	 * Module cache_schema
+	 */
+	current_module = "cache_schema";
+	if (target_module.empty() || target_module == current_module) {
+		//Initialize a container for module-wide test results:
+		module_test mod_test;
+		mod_test.name = current_module;
+		mod_test.units = list<unit_test>();
+		//Do pre-test work:
+		//Create an in-memory database with the WITNESSES and GENEALOGICAL_COMPARISONS tables,
+		//and populate it with placeholder comparisons of every witness relative to every other, where each cost encodes its pair of witnesses:
+		list<string> list_wit = list<string>({"A", "B", "C", "D"});
+		sqlite3 * db;
+		sqlite3_open(":memory:", & db);
+		sqlite3_exec(db, (CREATE_WITNESSES_TABLE_SQL + CREATE_WITNESSES_INDEX_SQL + CREATE_GENEALOGICAL_COMPARISONS_TABLE_SQL + CREATE_GENEALOGICAL_COMPARISONS_INDEX_SQL).c_str(), NULL, 0, NULL);
+		sqlite3_stmt * insert_into_witnesses_stmt;
+		sqlite3_prepare(db, "INSERT INTO WITNESSES VALUES (?,?)", -1, & insert_into_witnesses_stmt, 0);
+		sqlite3_stmt * insert_into_genealogical_comparisons_stmt;
+		sqlite3_prepare(db, "INSERT INTO GENEALOGICAL_COMPARISONS VALUES (?,?,?,?,?)", -1, & insert_into_genealogical_comparisons_stmt, 0);
+		unsigned int wit_ind = 0;
+		for (string wit_id : list_wit) {
+			sqlite3_bind_int(insert_into_witnesses_stmt, 1, wit_ind);
+			sqlite3_bind_text(insert_into_witnesses_stmt, 2, wit_id.c_str(), -1, SQLITE_TRANSIENT);
+			sqlite3_step(insert_into_witnesses_stmt);
+			sqlite3_reset(insert_into_witnesses_stmt);
+			for (unsigned int other_wit_ind = 0; other_wit_ind < list_wit.size(); other_wit_ind++) {
+				sqlite3_bind_int(insert_into_genealogical_comparisons_stmt, 1, wit_ind);
+				sqlite3_bind_int(insert_into_genealogical_comparisons_stmt, 2, other_wit_ind);
+				sqlite3_bind_int(insert_into_genealogical_comparisons_stmt, 3, 0);
+				sqlite3_bind_int(insert_into_genealogical_comparisons_stmt, 4, 0);
+				sqlite3_bind_double(insert_into_genealogical_comparisons_stmt, 5, 10 * wit_ind + other_wit_ind);
+				sqlite3_step(insert_into_genealogical_comparisons_stmt);
+				sqlite3_reset(insert_into_genealogical_comparisons_stmt);
+			}
+			wit_ind++;
+		}
+		sqlite3_finalize(insert_into_witnesses_stmt);
+		sqlite3_finalize(insert_into_genealogical_comparisons_stmt);
+		//Then proceed for each unit test:
+		string current_unit;
+		/**
+		 * Unit cache_schema_select_secondary_witness_genealogical_comparisons
+		 */
+		current_unit = "cache_schema_select_secondary_witness_genealogical_comparisons";
+		if (target_test.empty() || target_test == current_unit) {
+			//Initialize a container for module-wide test results:
+			unit_test u_test;
+			u_test.name = current_unit;
+			u_test.passed = false;
+			u_test.msg = "";
+			//Run the test:
+			try {
+				//Relative to witness B, we expect the comparisons of A, C, and D relative to themselves and relative to B:
+				set<pair<string, string>> expected_pairs = set<pair<string, string>>({{"A", "A"}, {"A", "B"}, {"C", "C"}, {"C", "B"}, {"D", "D"}, {"D", "B"}});
+				set<pair<string, string>> pairs = set<pair<string, string>>();
+				sqlite3_stmt * select_stmt;
+				sqlite3_prepare(db, SELECT_SECONDARY_WITNESS_GENEALOGICAL_COMPARISONS_SQL.c_str(), -1, & select_stmt, 0);
+				sqlite3_bind_text(select_stmt, 1, "B", -1, SQLITE_STATIC);
+				while (sqlite3_step(select_stmt) == SQLITE_ROW) {
+					string primary_wit_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_stmt, 0)));
+					string secondary_wit_id = string(reinterpret_cast<const char *>(sqlite3_column_text(select_stmt, 1)));
+					pairs.insert(pair<string, string>(primary_wit_id, secondary_wit_id));
+					int expected_cost = 10 * distance(list_wit.begin(), find(list_wit.begin(), list_wit.end(), primary_wit_id)) + distance(list_wit.begin(), find(list_wit.begin(), list_wit.end(), secondary_wit_id));
+					if (sqlite3_column_double(select_stmt, 4) != expected_cost) {
+						u_test.msg += "Expected the row for " + secondary_wit_id + " relative to " + primary_wit_id + " to have cost " + to_string(expected_cost) + "\n";
+					}
+				}
+				sqlite3_finalize(select_stmt);
+				if (pairs != expected_pairs) {
+					u_test.msg += "Expected rows for A, C, and D relative to themselves and to B, but got " + to_string(pairs.size()) + " distinct rows\n";
+				}
+				if (u_test.msg.empty()) {
+					u_test.passed = true;
+				}
+			}
+			catch (const exception & e) {
+				u_test.msg += string(e.what()) + "\n";
+			}
+			mod_test.units.push_back(u_test);
+		}
+		/**
+		 * Unit cache_schema_secondary_witness_query_plan
+		 */
+		current_unit = "cache_schema_secondary_witness_query_plan";
+		if (target_test.empty() || target_test == current_unit) {
+			//Initialize a container for module-wide test results:
+			unit_test u_test;
+			u_test.name = current_unit;
+			u_test.passed = false;
+			u_test.msg = "";
+			//Run the test:
+			try {
+				//Every access to the GENEALOGICAL_COMPARISONS table should be a search by key, and one of them should use the secondary witness index:
+				bool uses_secondary_idx = false;
+				sqlite3_stmt * explain_stmt;
+				sqlite3_prepare(db, ("EXPLAIN QUERY PLAN " + SELECT_SECONDARY_WITNESS_GENEALOGICAL_COMPARISONS_SQL).c_str(), -1, & explain_stmt, 0);
+				while (sqlite3_step(explain_stmt) == SQLITE_ROW) {
+					string detail = string(reinterpret_cast<const char *>(sqlite3_column_text(explain_stmt, 3)));
+					//Depending on the version of SQLite, a step is described as "SCAN G ..." or "SCAN TABLE GENEALOGICAL_COMPARISONS AS G ...":
+					istringstream detail_ss(detail);
+					list<string> tokens = list<string>(istream_iterator<string>(detail_ss), istream_iterator<string>());
+					bool accesses_comparisons = find(tokens.begin(), tokens.end(), "G") != tokens.end() || find(tokens.begin(), tokens.end(), "GENEALOGICAL_COMPARISONS") != tokens.end();
+					if (accesses_comparisons && !tokens.empty() && tokens.front() == "SCAN") {
+						u_test.msg += "Expected no full scan of GENEALOGICAL_COMPARISONS, but got query plan step " + detail + "\n";
+					}
+					if (detail.find("GENEALOGICAL_COMPARISONS_SECONDARY_IDX") != string::npos) {
+						uses_secondary_idx = true;
+					}
+				}
+				sqlite3_finalize(explain_stmt);
+				if (!uses_secondary_idx) {
+					u_test.msg += "Expected the query plan to use index GENEALOGICAL_COMPARISONS_SECONDARY_IDX\n";
+				}
+				if (u_test.msg.empty()) {
+					u_test.passed = true;
+				}
+			}
+			catch (const exception & e) {
+				u_test.msg += string(e.what()) + "\n";
+			}
+			mod_test.units.push_back(u_test);
+		}
+		sqlite3_close(db);
+		lib_test.modules.push_back(mod_test);
+	}
+	/**
+	 * Module cache_reader
+	 */
+	current_module = "cache_reader";
+	if (target_module.empty() || target_module == current_module) {
+		//Initialize a container for module-wide test results:
+		module_test mod_test;
+		mod_test.name = current_module;
+		mod_test.units = list<unit_test>();
+		//Do pre-test work:
+		pugi::xml_document doc;
+		doc.load_file(TEST_XML.c_str());
+		pugi::xml_node tei_node = doc.child("TEI");
+		bool drop_ambiguous = false;
+		bool merge_splits = false;
+		set<string> trivial_reading_types = set<string>({"defective", "orthographic"});
+		apparatus app = apparatus(tei_node, drop_ambiguous, merge_splits, trivial_reading_types);
+		list<string> list_wit = app.get_list_wit();
+		list<witness> witnesses = list<witness>();
+		for (string wit_id : list_wit) {
+			witnesses.push_back(witness(wit_id, app));
+		}
+		//Create an in-memory database with the WITNESSES, VARIATION_UNITS, BITMAPS, and GENEALOGICAL_COMPARISONS tables,
+		//and populate it with the witnesses' genealogical comparisons, storing each distinct bitmap only once, as populate_db does:
+		sqlite3 * db;
+		sqlite3_open(":memory:", & db);
+		sqlite3_exec(db, (CREATE_WITNESSES_TABLE_SQL + CREATE_VARIATION_UNITS_TABLE_SQL + CREATE_READING_SUPPORT_TABLE_SQL + CREATE_BITMAPS_TABLE_SQL + CREATE_GENEALOGICAL_COMPARISONS_TABLE_SQL + CREATE_GENEALOGICAL_COMPARISONS_INDEX_SQL).c_str(), NULL, 0, NULL);
+		sqlite3_stmt * insert_into_witnesses_stmt;
+		sqlite3_prepare(db, "INSERT INTO WITNESSES VALUES (?,?)", -1, & insert_into_witnesses_stmt, 0);
+		sqlite3_stmt * insert_into_bitmaps_stmt;
+		sqlite3_prepare(db, "INSERT INTO BITMAPS VALUES (?,0,?)", -1, & insert_into_bitmaps_stmt, 0);
+		sqlite3_stmt * insert_into_genealogical_comparisons_stmt;
+		sqlite3_prepare(db, "INSERT INTO GENEALOGICAL_COMPARISONS VALUES (?,?,?,?,?)", -1, & insert_into_genealogical_comparisons_stmt, 0);
+		map<string, int> bitmap_ids = map<string, int>();
+		auto add_bitmap = [&](const Roaring & bitmap) {
+			string buf = string(bitmap.getSizeInBytes(), '\0');
+			bitmap.write(& buf[0]);
+			if (bitmap_ids.find(buf) == bitmap_ids.end()) {
+				int bitmap_id = bitmap_ids.size();
+				bitmap_ids[buf] = bitmap_id;
+				sqlite3_bind_int(insert_into_bitmaps_stmt, 1, bitmap_id);
+				sqlite3_bind_blob(insert_into_bitmaps_stmt, 2, buf.data(), buf.size(), SQLITE_TRANSIENT);
+				sqlite3_step(insert_into_bitmaps_stmt);
+				sqlite3_reset(insert_into_bitmaps_stmt);
+			}
+			return bitmap_ids.at(buf);
+		};
+		unsigned int wit_ind = 0;
+		for (const witness & wit : witnesses) {
+			sqlite3_bind_int(insert_into_witnesses_stmt, 1, wit_ind);
+			sqlite3_bind_text(insert_into_witnesses_stmt, 2, wit.get_id().c_str(), -1, SQLITE_TRANSIENT);
+			sqlite3_step(insert_into_witnesses_stmt);
+			sqlite3_reset(insert_into_witnesses_stmt);
+			unsigned int other_wit_ind = 0;
+			for (string other_wit_id : list_wit) {
+				genealogical_comparison comp = wit.get_genealogical_comparison_for_witness(other_wit_id);
+				sqlite3_bind_int(insert_into_genealogical_comparisons_stmt, 1, wit_ind);
+				sqlite3_bind_int(insert_into_genealogical_comparisons_stmt, 2, other_wit_ind);
+				sqlite3_bind_int(insert_into_genealogical_comparisons_stmt, 3, add_bitmap(*comp.agreements));
+				sqlite3_bind_int(insert_into_genealogical_comparisons_stmt, 4, add_bitmap(*comp.explained));
+				sqlite3_bind_double(insert_into_genealogical_comparisons_stmt, 5, comp.cost);
+				sqlite3_step(insert_into_genealogical_comparisons_stmt);
+				sqlite3_reset(insert_into_genealogical_comparisons_stmt);
+				other_wit_ind++;
+			}
+			wit_ind++;
+		}
+		sqlite3_finalize(insert_into_witnesses_stmt);
+		sqlite3_finalize(insert_into_bitmaps_stmt);
+		sqlite3_finalize(insert_into_genealogical_comparisons_stmt);
+		//Then proceed for each unit test:
+		string current_unit;
+		/**
+		 * Unit cache_reader_get_genealogical_comparisons
+		 */
+		current_unit = "cache_reader_get_genealogical_comparisons";
+		if (target_test.empty() || target_test == current_unit) {
+			//Initialize a container for module-wide test results:
+			unit_test u_test;
+			u_test.name = current_unit;
+			u_test.passed = false;
+			u_test.msg = "";
+			//Run the test:
+			try {
+				cache_reader reader(db);
+				if (!reader.is_open()) {
+					u_test.msg += "Expected the reader to be opened successfully\n";
+				}
+				if (reader.get_witness_ids() != vector<string>(list_wit.begin(), list_wit.end())) {
+					u_test.msg += "Expected the reader to have the same witness IDs as the apparatus\n";
+				}
+				for (const witness & wit : witnesses) {
+					const unordered_map<string, genealogical_comparison> & comps = reader.get_genealogical_comparisons(wit.get_id());
+					if (comps.size() != wit.get_genealogical_comparisons().size()) {
+						u_test.msg += "Expected " + to_string(wit.get_genealogical_comparisons().size()) + " comparisons relative to " + wit.get_id() + ", got " + to_string(comps.size()) + "\n";
+					}
+					for (pair<string, genealogical_comparison> kv : wit.get_genealogical_comparisons()) {
+						if (comps.find(kv.first) == comps.end()) {
+							u_test.msg += "Expected a comparison for " + kv.first + " relative to " + wit.get_id() + "\n";
+							continue;
+						}
+						const genealogical_comparison & comp = comps.at(kv.first);
+						if (!(*comp.agreements == *kv.second.agreements) || !(*comp.explained == *kv.second.explained) || comp.cost != kv.second.cost) {
+							u_test.msg += "Expected the comparison for " + kv.first + " relative to " + wit.get_id() + " to match the one stored\n";
+						}
+					}
+				}
+				//A repeated lookup should be served from the cache:
+				size_t cached_bytes = reader.get_cached_bytes();
+				const unordered_map<string, genealogical_comparison> * comps_ptr = & reader.get_genealogical_comparisons(list_wit.front());
+				if (comps_ptr != & reader.get_genealogical_comparisons(list_wit.front()) || reader.get_cached_bytes() != cached_bytes) {
+					u_test.msg += "Expected a repeated lookup to return the cached comparisons\n";
+				}
+				//An unknown witness should have no comparisons:
+				if (!reader.get_genealogical_comparisons("unknown").empty()) {
+					u_test.msg += "Expected no comparisons relative to an unknown witness\n";
+				}
+				if (u_test.msg.empty()) {
+					u_test.passed = true;
+				}
+			}
+			catch (const exception & e) {
+				u_test.msg += string(e.what()) + "\n";
+			}
+			mod_test.units.push_back(u_test);
+		}
+		/**
+		 * Unit cache_reader_get_secondary_witness_genealogical_comparisons
+		 */
+		current_unit = "cache_reader_get_secondary_witness_genealogical_comparisons";
+		if (target_test.empty() || target_test == current_unit) {
+			//Initialize a container for module-wide test results:
+			unit_test u_test;
+			u_test.name = current_unit;
+			u_test.passed = false;
+			u_test.msg = "";
+			//Run the test:
+			try {
+				cache_reader reader(db);
+				string primary_wit_id = list_wit.front();
+				//The result should be the same whether it is read from the database or assembled from cached comparisons:
+				for (string source : {"database", "cache"}) {
+					if (source == "cache") {
+						for (string wit_id : list_wit) {
+							reader.get_genealogical_comparisons(wit_id);
+						}
+					}
+					unordered_map<string, unordered_map<string, genealogical_comparison>> secondary_comps = reader.get_secondary_witness_genealogical_comparisons(primary_wit_id);
+					if (secondary_comps.size() != list_wit.size() - 1) {
+						u_test.msg += "Expected comparisons for " + to_string(list_wit.size() - 1) + " secondary witnesses from the " + source + ", got " + to_string(secondary_comps.size()) + "\n";
+					}
+					for (const witness & wit : witnesses) {
+						if (wit.get_id() == primary_wit_id) {
+							continue;
+						}
+						for (string other_wit_id : {wit.get_id(), primary_wit_id}) {
+							if (secondary_comps.find(wit.get_id()) == secondary_comps.end() || secondary_comps.at(wit.get_id()).find(other_wit_id) == secondary_comps.at(wit.get_id()).end()) {
+								u_test.msg += "Expected a comparison for " + other_wit_id + " relative to " + wit.get_id() + " from the " + source + "\n";
+								continue;
+							}
+							genealogical_comparison comp = secondary_comps.at(wit.get_id()).at(other_wit_id);
+							genealogical_comparison expected_comp = wit.get_genealogical_comparison_for_witness(other_wit_id);
+							if (!(*comp.agreements == *expected_comp.agreements) || !(*comp.explained == *expected_comp.explained) || comp.cost != expected_comp.cost) {
+								u_test.msg += "Expected the comparison for " + other_wit_id + " relative to " + wit.get_id() + " from the " + source + " to match the one stored\n";
+							}
+						}
+					}
+				}
+				if (u_test.msg.empty()) {
+					u_test.passed = true;
+				}
+			}
+			catch (const exception & e) {
+				u_test.msg += string(e.what()) + "\n";
+			}
+			mod_test.units.push_back(u_test);
+		}
+		/**
+		 * Unit cache_reader_shared_bitmaps
+		 */
+		current_unit = "cache_reader_shared_bitmaps";
+		if (target_test.empty() || target_test == current_unit) {
+			//Initialize a container for module-wide test results:
+			unit_test u_test;
+			u_test.name = current_unit;
+			u_test.passed = false;
+			u_test.msg = "";
+			//Run the test:
+			try {
+				//There should be fewer distinct bitmaps than bitmaps referred to by the comparisons:
+				sqlite3_stmt * count_stmt;
+				sqlite3_prepare(db, "SELECT COUNT(*) FROM BITMAPS", -1, & count_stmt, 0);
+				sqlite3_step(count_stmt);
+				int n_bitmaps = sqlite3_column_int(count_stmt, 0);
+				sqlite3_finalize(count_stmt);
+				if (n_bitmaps == 0 || n_bitmaps >= int(2 * list_wit.size() * list_wit.size())) {
+					u_test.msg += "Expected fewer than " + to_string(2 * list_wit.size() * list_wit.size()) + " distinct bitmaps, got " + to_string(n_bitmaps) + "\n";
+				}
+				//Once the comparisons relative to every witness are cached, any two of their bitmaps should be the same object exactly when they have the same contents:
+				cache_reader reader(db);
+				vector<shared_ptr<const Roaring>> cached_bitmaps = vector<shared_ptr<const Roaring>>();
+				for (string wit_id : list_wit) {
+					for (const pair<const string, genealogical_comparison> & kv : reader.get_genealogical_comparisons(wit_id)) {
+						cached_bitmaps.push_back(kv.second.agreements);
+						cached_bitmaps.push_back(kv.second.explained);
+					}
+				}
+				for (unsigned int i = 0; i < cached_bitmaps.size(); i++) {
+					for (unsigned int j = i + 1; j < cached_bitmaps.size(); j++) {
+						if ((cached_bitmaps[i] == cached_bitmaps[j]) != (*cached_bitmaps[i] == *cached_bitmaps[j])) {
+							u_test.msg += "Expected the cached bitmaps " + cached_bitmaps[i]->toString() + " and " + cached_bitmaps[j]->toString() + " to be shared only if they are the same\n";
+						}
+					}
+				}
+				//The comparisons read for a secondary witness should share them, too:
+				string primary_wit_id = list_wit.front();
+				cache_reader secondary_reader(db);
+				unordered_map<string, unordered_map<string, genealogical_comparison>> secondary_comps = secondary_reader.get_secondary_witness_genealogical_comparisons(primary_wit_id);
+				for (const pair<const string, unordered_map<string, genealogical_comparison>> & kv : secondary_comps) {
+					const genealogical_comparison & comp = secondary_reader.get_genealogical_comparisons(primary_wit_id).at(kv.first);
+					const genealogical_comparison & reverse_comp = kv.second.at(primary_wit_id);
+					if ((comp.agreements == reverse_comp.agreements) != (*comp.agreements == *reverse_comp.agreements)) {
+						u_test.msg += "Expected the comparisons of " + primary_wit_id + " and " + kv.first + " read for a secondary witness to share their agreements only if they are the same in both directions\n";
+					}
+					if ((comp.explained == reverse_comp.explained) != (*comp.explained == *reverse_comp.explained)) {
+						u_test.msg += "Expected the comparisons of " + primary_wit_id + " and " + kv.first + " read for a secondary witness to share their explained readings only if they are the same in both directions\n";
+					}
+				}
+				if (u_test.msg.empty()) {
+					u_test.passed = true;
+				}
+			}
+			catch (const exception & e) {
+				u_test.msg += string(e.what()) + "\n";
+			}
+			mod_test.units.push_back(u_test);
+		}
+		/**
+		 * Unit cache_reader_max_cached_bytes
+		 */
+		current_unit = "cache_reader_max_cached_bytes";
+		if (target_test.empty() || target_test == current_unit) {
+			//Initialize a container for module-wide test results:
+			unit_test u_test;
+			u_test.name = current_unit;
+			u_test.passed = false;
+			u_test.msg = "";
+			//Run the test:
+			try {
+				//A reader with the default limit should keep the comparisons relative to every witness:
+				cache_reader reader(db);
+				vector<size_t> n_bytes = vector<size_t>();
+				for (string wit_id : list_wit) {
+					size_t cached_bytes = reader.get_cached_bytes();
+					reader.get_genealogical_comparisons(wit_id);
+					n_bytes.push_back(reader.get_cached_bytes() - cached_bytes);
+				}
+				for (size_t i = 0; i < n_bytes.size(); i++) {
+					if (n_bytes[i] == 0) {
+						u_test.msg += "Expected a nonzero size for the comparisons relative to witness " + to_string(i) + "\n";
+					}
+				}
+				//A reader with a limit of 0 should keep only the comparisons relative to the most recently requested witness:
+				cache_reader small_reader(db, 0);
+				unsigned int i = 0;
+				for (string wit_id : list_wit) {
+					const unordered_map<string, genealogical_comparison> & comps = small_reader.get_genealogical_comparisons(wit_id);
+					if (small_reader.get_cached_bytes() != n_bytes[i]) {
+						u_test.msg += "Expected a limit of 0 to keep only the comparisons relative to " + wit_id + "\n";
+					}
+					if (comps.size() != list_wit.size()) {
+						u_test.msg += "Expected the most recently requested comparisons to be kept\n";
+					}
+					i++;
+				}
+				//A reader with room for two witnesses' comparisons should evict the least recently used one when a third is requested:
+				vector<string> wit_ids = vector<string>(list_wit.begin(), list_wit.end());
+				cache_reader lru_reader(db, n_bytes[0] + n_bytes[1]);
+				lru_reader.get_genealogical_comparisons(wit_ids[0]);
+				lru_reader.get_genealogical_comparisons(wit_ids[1]);
+				lru_reader.get_genealogical_comparisons(wit_ids[0]);
+				lru_reader.get_genealogical_comparisons(wit_ids[2]);
+				//If the comparisons relative to the third witness are larger than those relative to the second, then those relative to the first must be evicted, too:
+				size_t expected_cached_bytes = n_bytes[2] <= n_bytes[1] ? n_bytes[0] + n_bytes[2] : n_bytes[2];
+				if (lru_reader.get_cached_bytes() != expected_cached_bytes) {
+					u_test.msg += "Expected the comparisons relative to " + wit_ids[1] + " to be evicted first\n";
+				}
+				if (u_test.msg.empty()) {
+					u_test.passed = true;
+				}
+			}
+			catch (const exception & e) {
+				u_test.msg += string(e.what()) + "\n";
+			}
+			mod_test.units.push_back(u_test);
+		}
+		/**
+		 * Unit cache_reader_get_potential_ancestor_rankings
+		 */
+		current_unit = "cache_reader_get_potential_ancestor_rankings";
+		if (target_test.empty() || target_test == current_unit) {
+			//Initialize a container for module-wide test results:
+			unit_test u_test;
+			u_test.name = current_unit;
+			u_test.passed = false;
+			u_test.msg = "";
+			//Run the test:
+			try {
+				//Without a POTENTIAL_ANCESTORS table, the reader should have no rankings:
+				cache_reader reader(db);
+				if (reader.has_potential_ancestor_rankings() || !reader.get_potential_ancestor_rankings(list_wit.front()).empty()) {
+					u_test.msg += "Expected no rankings without a POTENTIAL_ANCESTORS table\n";
+				}
+				reader.close();
+				//Populate the table with the witnesses' rankings, in reverse order so that the reader has to sort them:
+				sqlite3_exec(db, CREATE_POTENTIAL_ANCESTORS_TABLE_SQL.c_str(), NULL, 0, NULL);
+				sqlite3_stmt * insert_into_potential_ancestors_stmt;
+				sqlite3_prepare(db, "INSERT INTO POTENTIAL_ANCESTORS VALUES (?,?,?,?,?,?,?,?,?)", -1, & insert_into_potential_ancestors_stmt, 0);
+				unordered_map<string, unsigned int> wit_inds = unordered_map<string, unsigned int>();
+				unsigned int wit_ind = 0;
+				for (string wit_id : list_wit) {
+					wit_inds[wit_id] = wit_ind;
+					wit_ind++;
+				}
+				unordered_map<string, list<potential_ancestor_ranking>> expected_rankings = unordered_map<string, list<potential_ancestor_ranking>>();
+				for (const witness & wit : witnesses) {
+					expected_rankings[wit.get_id()] = wit.get_potential_ancestor_rankings(witnesses);
+					list<potential_ancestor_ranking> rankings = expected_rankings[wit.get_id()];
+					for (list<potential_ancestor_ranking>::reverse_iterator it = rankings.rbegin(); it != rankings.rend(); it++) {
+						sqlite3_bind_int(insert_into_potential_ancestors_stmt, 1, wit_inds.at(wit.get_id()));
+						sqlite3_bind_int(insert_into_potential_ancestors_stmt, 2, wit_inds.at(it->id));
+						sqlite3_bind_int(insert_into_potential_ancestors_stmt, 3, it->rank);
+						sqlite3_bind_int(insert_into_potential_ancestors_stmt, 4, it->potential_ancestor ? 1 : 0);
+						sqlite3_bind_int(insert_into_potential_ancestors_stmt, 5, it->agreements);
+						sqlite3_bind_int(insert_into_potential_ancestors_stmt, 6, it->pass);
+						sqlite3_bind_int(insert_into_potential_ancestors_stmt, 7, it->prior);
+						sqlite3_bind_int(insert_into_potential_ancestors_stmt, 8, it->posterior);
+						sqlite3_bind_double(insert_into_potential_ancestors_stmt, 9, it->cost);
+						sqlite3_step(insert_into_potential_ancestors_stmt);
+						sqlite3_reset(insert_into_potential_ancestors_stmt);
+					}
+				}
+				sqlite3_finalize(insert_into_potential_ancestors_stmt);
+				//Then check that the rankings read back match the ones calculated from the genealogical comparisons:
+				cache_reader table_reader(db);
+				if (!table_reader.has_potential_ancestor_rankings()) {
+					u_test.msg += "Expected rankings with a POTENTIAL_ANCESTORS table\n";
+				}
+				unordered_map<string, list<potential_ancestor_ranking>> expected_potential_ancestors = rank_all_potential_ancestors(witnesses);
+				unordered_map<string, list<potential_ancestor_ranking>> potential_ancestors = table_reader.get_potential_ancestors();
+				auto rankings_equal = [](const list<potential_ancestor_ranking> & l1, const list<potential_ancestor_ranking> & l2) {
+					return l1.size() == l2.size() && equal(l1.begin(), l1.end(), l2.begin(), [](const potential_ancestor_ranking & r1, const potential_ancestor_ranking & r2) {
+						return r1.id == r2.id && r1.rank == r2.rank && r1.potential_ancestor == r2.potential_ancestor && r1.agreements == r2.agreements && r1.pass == r2.pass && r1.prior == r2.prior && r1.posterior == r2.posterior && r1.cost == r2.cost;
+					});
+				};
+				for (string wit_id : list_wit) {
+					if (!rankings_equal(table_reader.get_potential_ancestor_rankings(wit_id), expected_rankings.at(wit_id))) {
+						u_test.msg += "Expected the rankings relative to " + wit_id + " to match the ones calculated from its genealogical comparisons\n";
+					}
+					list<potential_ancestor_ranking> wit_potential_ancestors = potential_ancestors.find(wit_id) != potential_ancestors.end() ? potential_ancestors.at(wit_id) : list<potential_ancestor_ranking>();
+					if (!rankings_equal(wit_potential_ancestors, expected_potential_ancestors.at(wit_id))) {
+						u_test.msg += "Expected the potential ancestors of " + wit_id + " to match the ones calculated from its genealogical comparisons\n";
+					}
+				}
+				if (u_test.msg.empty()) {
+					u_test.passed = true;
+				}
+			}
+			catch (const exception & e) {
+				u_test.msg += string(e.what()) + "\n";
+			}
+			mod_test.units.push_back(u_test);
+		}
+		/**
+		 * Unit cache_reader_get_substemmata
+		 */
+		current_unit = "cache_reader_get_substemmata";
+		if (target_test.empty() || target_test == current_unit) {
+			//Initialize a container for module-wide test results:
+			unit_test u_test;
+			u_test.name = current_unit;
+			u_test.passed = false;
+			u_test.msg = "";
+			//Run the test:
+			try {
+				//Without a SUBSTEMMATA table, the reader should have no substemmata:
+				cache_reader reader(db);
+				if (reader.has_substemmata() || !reader.get_substemmata(list_wit.front()).empty() || !reader.get_global_stemma_edges().empty()) {
+					u_test.msg += "Expected no substemmata without a SUBSTEMMATA table\n";
+				}
+				reader.close();
+				//Populate the table with the witnesses' optimal substemmata:
+				sqlite3_exec(db, CREATE_SUBSTEMMATA_TABLE_SQL.c_str(), NULL, 0, NULL);
+				sqlite3_stmt * insert_into_substemmata_stmt;
+				sqlite3_prepare(db, "INSERT INTO SUBSTEMMATA VALUES (?,?,?,?,?,?,?)", -1, & insert_into_substemmata_stmt, 0);
+				unordered_map<string, unsigned int> wit_inds = unordered_map<string, unsigned int>();
+				unsigned int wit_ind = 0;
+				for (string wit_id : list_wit) {
+					wit_inds[wit_id] = wit_ind;
+					wit_ind++;
+				}
+				list<witness> stemma_witnesses = witnesses;
+				unordered_map<string, list<set_cover_solution>> expected_substemmata = unordered_map<string, list<set_cover_solution>>();
+				for (witness & wit : stemma_witnesses) {
+					wit.set_potential_ancestor_ids(witnesses);
+					wit.set_global_stemma_ancestor_ids();
+					expected_substemmata[wit.get_id()] = wit.get_optimal_substemmata();
+					unsigned int extant = wit.get_genealogical_comparison_for_witness(wit.get_id()).explained->cardinality();
+					unsigned int solution_ind = 0;
+					for (const set_cover_solution & solution : expected_substemmata[wit.get_id()]) {
+						unsigned int ancestor_ind = 0;
+						for (const set_cover_row & row : solution.rows) {
+							sqlite3_bind_int(insert_into_substemmata_stmt, 1, wit_inds.at(wit.get_id()));
+							sqlite3_bind_int(insert_into_substemmata_stmt, 2, solution_ind);
+							sqlite3_bind_int(insert_into_substemmata_stmt, 3, ancestor_ind);
+							sqlite3_bind_int(insert_into_substemmata_stmt, 4, wit_inds.at(row.id));
+							sqlite3_bind_double(insert_into_substemmata_stmt, 5, float(row.agreements.cardinality()) / float(extant));
+							sqlite3_bind_double(insert_into_substemmata_stmt, 6, solution.cost);
+							sqlite3_bind_int(insert_into_substemmata_stmt, 7, solution.agreements);
+							sqlite3_step(insert_into_substemmata_stmt);
+							sqlite3_reset(insert_into_substemmata_stmt);
+							ancestor_ind++;
+						}
+						solution_ind++;
+					}
+				}
+				sqlite3_finalize(insert_into_substemmata_stmt);
+				//Then check that the substemmata read back match the ones found from the genealogical comparisons:
+				cache_reader table_reader(db);
+				if (!table_reader.has_substemmata()) {
+					u_test.msg += "Expected substemmata with a SUBSTEMMATA table\n";
+				}
+				for (string wit_id : list_wit) {
+					list<set_cover_solution> substemmata = table_reader.get_substemmata(wit_id);
+					const list<set_cover_solution> & expected = expected_substemmata.at(wit_id);
+					bool substemmata_equal = substemmata.size() == expected.size() && equal(substemmata.begin(), substemmata.end(), expected.begin(), [](const set_cover_solution & s1, const set_cover_solution & s2) {
+						return s1.cost == s2.cost && s1.agreements == s2.agreements && s1.rows.size() == s2.rows.size() && equal(s1.rows.begin(), s1.rows.end(), s2.rows.begin(), [](const set_cover_row & r1, const set_cover_row & r2) {
+							return r1.id == r2.id;
+						});
+					});
+					if (!substemmata_equal) {
+						u_test.msg += "Expected the substemmata of " + wit_id + " to match the ones found from its genealogical comparisons\n";
+					}
+				}
+				//The edges read back should also match the ones of the global stemma constructed from the witnesses:
+				list<global_stemma_edge> edges = table_reader.get_global_stemma_edges();
+				list<global_stemma_edge> expected_edges = global_stemma(stemma_witnesses).get_graph().edges;
+				bool edges_equal = edges.size() == expected_edges.size() && equal(edges.begin(), edges.end(), expected_edges.begin(), [](const global_stemma_edge & e1, const global_stemma_edge & e2) {
+					return e1.ancestor == e2.ancestor && e1.descendant == e2.descendant && e1.weight == e2.weight;
+				});
+				if (!edges_equal) {
+					u_test.msg += "Expected the global stemma edges to match the ones constructed from the witnesses\n";
+				}
+				if (u_test.msg.empty()) {
+					u_test.passed = true;
+				}
+			}
+			catch (const exception & e) {
+				u_test.msg += string(e.what()) + "\n";
+			}
+			mod_test.units.push_back(u_test);
+		}
+		/**
+		 * Unit cache_reader_get_textual_flow_edges
+		 */
+		current_unit = "cache_reader_get_textual_flow_edges";
+		if (target_test.empty() || target_test == current_unit) {
+			//Initialize a container for module-wide test results:
+			unit_test u_test;
+			u_test.name = current_unit;
+			u_test.passed = false;
+			u_test.msg = "";
+			//Run the test:
+			try {
+				//Without a TEXTUAL_FLOW_EDGES table, the reader should have no edges:
+				cache_reader reader(db);
+				if (reader.has_textual_flow_edges() || !reader.get_textual_flow_edges(0).empty()) {
+					u_test.msg += "Expected no edges without a TEXTUAL_FLOW_EDGES table\n";
+				}
+				reader.close();
+				//Populate the VARIATION_UNITS table and the textual flow edges at each variation unit, in reverse order so that the reader has to sort them:
+				sqlite3_exec(db, CREATE_TEXTUAL_FLOW_EDGES_TABLE_SQL.c_str(), NULL, 0, NULL);
+				sqlite3_stmt * insert_into_variation_units_stmt;
+				sqlite3_prepare(db, "INSERT INTO VARIATION_UNITS VALUES (?,?,?,?)", -1, & insert_into_variation_units_stmt, 0);
+				sqlite3_stmt * insert_into_textual_flow_edges_stmt;
+				sqlite3_prepare(db, "INSERT INTO TEXTUAL_FLOW_EDGES VALUES (?,?,?,?,?,?)", -1, & insert_into_textual_flow_edges_stmt, 0);
+				unordered_map<string, unsigned int> wit_inds = unordered_map<string, unsigned int>();
+				unsigned int wit_ind = 0;
+				for (string wit_id : list_wit) {
+					wit_inds[wit_id] = wit_ind;
+					wit_ind++;
+				}
+				unordered_map<string, list<potential_ancestor_ranking>> potential_ancestors = rank_all_potential_ancestors(witnesses);
+				vector<list<textual_flow_edge>> expected_edges = vector<list<textual_flow_edge>>();
+				for (const variation_unit & vu : app.get_variation_units()) {
+					unsigned int vu_ind = expected_edges.size();
+					sqlite3_bind_int(insert_into_variation_units_stmt, 1, vu_ind);
+					sqlite3_bind_text(insert_into_variation_units_stmt, 2, vu.get_id().c_str(), -1, SQLITE_TRANSIENT);
+					sqlite3_bind_text(insert_into_variation_units_stmt, 3, vu.get_label().c_str(), -1, SQLITE_TRANSIENT);
+					sqlite3_bind_int(insert_into_variation_units_stmt, 4, vu.get_connectivity());
+					sqlite3_step(insert_into_variation_units_stmt);
+					sqlite3_reset(insert_into_variation_units_stmt);
+					expected_edges.push_back(get_textual_flow_edges(vu, list_wit, potential_ancestors));
+					for (list<textual_flow_edge>::const_reverse_iterator it = expected_edges.back().rbegin(); it != expected_edges.back().rend(); it++) {
+						sqlite3_bind_int(insert_into_textual_flow_edges_stmt, 1, vu_ind);
+						sqlite3_bind_int(insert_into_textual_flow_edges_stmt, 2, wit_inds.at(it->descendant));
+						sqlite3_bind_int(insert_into_textual_flow_edges_stmt, 3, wit_inds.at(it->ancestor));
+						sqlite3_bind_int(insert_into_textual_flow_edges_stmt, 4, int(it->type));
+						sqlite3_bind_int(insert_into_textual_flow_edges_stmt, 5, it->connectivity);
+						sqlite3_bind_double(insert_into_textual_flow_edges_stmt, 6, it->strength);
+						sqlite3_step(insert_into_textual_flow_edges_stmt);
+						sqlite3_reset(insert_into_textual_flow_edges_stmt);
+					}
+				}
+				sqlite3_finalize(insert_into_variation_units_stmt);
+				sqlite3_finalize(insert_into_textual_flow_edges_stmt);
+				//Then check that the edges read back match the ones found from the witnesses' potential ancestors:
+				cache_reader table_reader(db);
+				if (!table_reader.has_textual_flow_edges()) {
+					u_test.msg += "Expected edges with a TEXTUAL_FLOW_EDGES table\n";
+				}
+				for (unsigned int vu_ind = 0; vu_ind < expected_edges.size(); vu_ind++) {
+					list<textual_flow_edge> edges = table_reader.get_textual_flow_edges(vu_ind);
+					bool edges_equal = edges.size() == expected_edges[vu_ind].size() && equal(edges.begin(), edges.end(), expected_edges[vu_ind].begin(), [](const textual_flow_edge & e1, const textual_flow_edge & e2) {
+						return e1.ancestor == e2.ancestor && e1.descendant == e2.descendant && e1.type == e2.type && e1.connectivity == e2.connectivity && e1.strength == e2.strength;
+					});
+					if (!edges_equal) {
+						u_test.msg += "Expected the edges at variation unit " + to_string(vu_ind) + " to match the ones found from the witnesses' potential ancestors\n";
+					}
+				}
+				if (!table_reader.get_textual_flow_edges(expected_edges.size()).empty()) {
+					u_test.msg += "Expected no edges at a variation unit key out of range\n";
+				}
+				if (u_test.msg.empty()) {
+					u_test.passed = true;
+				}
+			}
+			catch (const exception & e) {
+				u_test.msg += string(e.what()) + "\n";
+			}
+			mod_test.units.push_back(u_test);
+		}
+		sqlite3_close(db);
+		lib_test.modules.push_back(mod_test);
+	}
 	/**
 	 * Module textual_flow
 	 */
@@ -1174,6 +2661,43 @@ void autotest::run() {
 			}
 			mod_test.units.push_back(u_test);
 		}
+		/**
+		 * Unit textual_flow_constructor_from_edges
+		 */
+		current_unit = "textual_flow_constructor_from_edges";
+		if (target_test.empty() || target_test == current_unit) {
+			//Initialize a container for module-wide test results:
+			unit_test u_test;
+			u_test.name = current_unit;
+			u_test.passed = false;
+			u_test.msg = "";
+			//Run the test:
+			try {
+				//Construct a textual flow instance from precomputed edges, and make sure it matches the one constructed from the witnesses:
+				list<textual_flow_edge> edges = get_textual_flow_edges(vu, app.get_list_wit(), rank_all_potential_ancestors(witnesses));
+				textual_flow_graph expected_graph = textual_flow(vu, witnesses).get_graph();
+				textual_flow_graph graph = textual_flow(vu, app.get_list_wit(), edges).get_graph();
+				bool vertices_equal = graph.vertices.size() == expected_graph.vertices.size() && equal(graph.vertices.begin(), graph.vertices.end(), expected_graph.vertices.begin(), [](const textual_flow_vertex & v1, const textual_flow_vertex & v2) {
+					return v1.id == v2.id && v1.rdg == v2.rdg;
+				});
+				if (!vertices_equal) {
+					u_test.msg += "Expected the vertices to match the ones constructed from the witnesses\n";
+				}
+				bool edges_equal = graph.edges.size() == expected_graph.edges.size() && equal(graph.edges.begin(), graph.edges.end(), expected_graph.edges.begin(), [](const textual_flow_edge & e1, const textual_flow_edge & e2) {
+					return e1.ancestor == e2.ancestor && e1.descendant == e2.descendant && e1.type == e2.type && e1.connectivity == e2.connectivity && e1.strength == e2.strength;
+				});
+				if (!edges_equal) {
+					u_test.msg += "Expected the edges to match the ones constructed from the witnesses\n";
+				}
+				if (u_test.msg.empty()) {
+					u_test.passed = true;
+				}
+			}
+			catch (const exception & e) {
+				u_test.msg += string(e.what()) + "\n";
+			}
+			mod_test.units.push_back(u_test);
+		}
 		//Do more pre-test work:
 		textual_flow tf = textual_flow(vu, witnesses);
 		/**
@@ -1414,20 +2938,28 @@ int main(int argc, char* argv[]) {
 		"local_stemma",
 		"variation_unit",
 		"apparatus",
+		"reading_matrix",
 		"set_cover_solver",
 		"witness",
+		"genealogical_cache",
+		"cache_schema",
+		"cache_reader",
 		"textual_flow",
 		"global_stemma"
 	});
 	//Initialize the map of unit tests, keyed by parent module name:
 	map<string, list<string>> tests_by_module = map<string, list<string>>({
 		{"common", {"common_read_xml"}},
-		{"local_stemma", {"local_stemma_constructor_1", "local_stemma_constructor_2", "local_stemma_path_exists", "local_stemma_get_shortest_path_length", "local_stemma_to_dot"}},
+		{"local_stemma", {"local_stemma_constructor_1", "local_stemma_constructor_2", "local_stemma_constructor_3", "local_stemma_path_exists", "local_stemma_get_shortest_path_length", "local_stemma_to_dot"}},
 		{"variation_unit", {"variation_unit_constructor_1", "variation_unit_constructor_2", "variation_unit_constructor_3", "variation_unit_constructor_4"}},
-		{"apparatus", {"apparatus_constructor", "apparatus_get_extant_passages_for_witness"}},
-		{"set_cover_solver", {"set_cover_solver_constructor", "set_cover_solver_get_unique_rows", "set_cover_solver_get_trivial_solution", "set_cover_solver_get_greedy_solution"}},
-		{"witness", {"witness_constructor_1", "witness_constructor_2", "witness_get_genealogical_comparison_for_witness", "witness_set_potential_ancestor_ids", "witness_set_global_stemma_ancestor_ids"}},
-		{"textual_flow", {"textual_flow_constructor", "textual_flow_textual_flow_to_dot", "textual_flow_coherence_in_attestations_to_dot", "textual_flow_coherence_in_variant_passages_to_dot"}},
+		{"apparatus", {"apparatus_constructor", "apparatus_get_witness_index", "apparatus_get_extant_passages_for_witness"}},
+		{"reading_matrix", {"reading_matrix_constructor", "reading_matrix_compare"}},
+		{"set_cover_solver", {"set_cover_solver_constructor", "set_cover_solver_get_unique_rows", "set_cover_solver_get_trivial_solution", "set_cover_solver_get_greedy_solution", "set_cover_solver_solve_in_parallel", "set_cover_solver_solve_with_bounds", "set_cover_solver_dense_rows", "set_cover_solver_reduce"}},
+		{"witness", {"witness_constructor_1", "witness_constructor_2", "witness_constructor_3", "witness_compare_witnesses_both_ways", "witness_get_genealogical_comparison_for_witness", "witness_set_potential_ancestor_ids", "witness_get_potential_ancestor_rankings", "witness_get_potential_ancestor_rankings_trivial_readings", "witness_set_global_stemma_ancestor_ids"}},
+		{"genealogical_cache", {"genealogical_cache_write_read"}},
+		{"cache_schema", {"cache_schema_select_secondary_witness_genealogical_comparisons", "cache_schema_secondary_witness_query_plan"}},
+		{"cache_reader", {"cache_reader_get_genealogical_comparisons", "cache_reader_get_secondary_witness_genealogical_comparisons", "cache_reader_shared_bitmaps", "cache_reader_max_cached_bytes", "cache_reader_get_potential_ancestor_rankings", "cache_reader_get_substemmata", "cache_reader_get_textual_flow_edges"}},
+		{"textual_flow", {"textual_flow_constructor", "textual_flow_constructor_from_edges", "textual_flow_textual_flow_to_dot", "textual_flow_coherence_in_attestations_to_dot", "textual_flow_coherence_in_variant_passages_to_dot"}},
 		{"global_stemma", {"global_stemma_constructor", "global_stemma_to_dot"}}
 	});
 	//Initialize an autotest instance with these containers: